@@ -0,0 +1,242 @@
+/*
+ * bench/bench_burst.c
+ *
+ * Host throughput benchmark for the receive path raw word -> burst events:
+ * - two-step: aer_decode_word() + aer_burst_feed()
+ * - fused:    aer_burst_feed_raw()
+ *
+ * Input is a pseudo-random stream of bursts (ROW, 1..8 COLs, TAIL) with a small
+ * fraction of corrupted and neutral words, the same shape the firmware drains
+ * from its raw ring buffer.
+ *
+ * Sink cost per event vs burst width:
+ * - per-event: aer_burst_feed_raw() + one framed record write per event
+ * - span:      aer_burst_feed_raw_span() + one framed write per burst
+ * The framed writer mimics usb_stream/hal_stream_write (10-byte AERS v2 header +
+ * 8-byte tick records) into a memory buffer.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../common/include/aer_cfg.h"
+#include "../common/include/aer_types.h"
+#include "../common/include/aer_codec.h"
+#include "../common/include/aer_burst.h"
+
+#define BENCH_WORDS   (1u << 16)
+#define BENCH_ROUNDS  400u
+
+static double now_s(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static aer_raw_word_t encode(uint32_t payload)
+{
+    aer_raw_word_t raw = 0u;
+    (void)aer_encode_payload((uint8_t)payload, &raw, NULL);
+    return raw;
+}
+
+static void fill_bursts(aer_raw_word_t* words, uint32_t n)
+{
+    const uint32_t idx_mask = (1u << AER_INDEX_BITS) - 1u;
+    uint32_t seed = 0x9E3779B9u;
+    uint32_t i = 0u;
+
+    while (i < n) {
+        const uint32_t r = xorshift32(&seed);
+        const uint32_t cols = 1u + (r % 8u);
+
+        words[i++] = encode((r >> 3) & idx_mask);
+        for (uint32_t c = 0u; c < cols && i < n; ++c) {
+            words[i++] = encode((xorshift32(&seed) >> 7) & idx_mask);
+        }
+        if (i < n) words[i++] = encode(AER_TAIL_PAYLOAD);
+
+        /* ~1/32 of bursts carry one corrupted word, ~1/64 a latched neutral. */
+        if ((r >> 16) % 32u == 0u && i > 0u) {
+            words[i - 1u] ^= (aer_raw_word_t)(1u << ((r >> 24) % AER_DATA_WIDTH));
+        }
+        if ((r >> 12) % 64u == 0u && i < n) {
+            words[i++] = 0u;
+        }
+    }
+}
+
+static void count_event(uint8_t row, uint8_t col, void* user)
+{
+    uint32_t* sum = (uint32_t*)user;
+    *sum += (uint32_t)row + (uint32_t)col;
+}
+
+static double run(const char* name, bool fused, const aer_raw_word_t* words, uint32_t n)
+{
+    aer_burst_t b;
+    aer_burst_init(&b);
+    uint32_t checksum = 0u;
+
+    const double t0 = now_s();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+        if (fused) {
+            for (uint32_t i = 0; i < n; ++i) {
+                (void)aer_burst_feed_raw(&b, words[i], count_event, &checksum);
+            }
+        } else {
+            for (uint32_t i = 0; i < n; ++i) {
+                (void)aer_burst_feed(&b, aer_decode_word(words[i]), count_event, &checksum);
+            }
+        }
+    }
+    const double dt = now_s() - t0;
+    const double wps = ((double)n * (double)BENCH_ROUNDS) / dt;
+    printf("  %-10s %8.1f Mwords/s  (%.2f ns/word, events %u, checksum %08x)\n",
+           name, wps * 1e-6, 1e9 / wps, (unsigned)b.events_emitted, (unsigned)checksum);
+    return wps;
+}
+
+/* ---------------- framed sink model ---------------- */
+
+#define SINK_BUF_BYTES  (1u << 16)
+#define SINK_HDR_BYTES  10u
+#define SINK_REC_BYTES  8u
+
+typedef struct {
+    uint8_t  buf[SINK_BUF_BYTES];
+    uint32_t pos;
+    uint32_t packets;
+    uint32_t ticks;
+    uint16_t seq;
+} frame_sink_t;
+
+/* Kept out of line like the real hal_stream_write(). */
+__attribute__((noinline))
+static void frame_write(frame_sink_t* s, const void* payload, uint32_t len)
+{
+    if (s->pos + SINK_HDR_BYTES + len > SINK_BUF_BYTES) s->pos = 0u;
+    const uint16_t seq = s->seq++;
+    const uint8_t hdr[SINK_HDR_BYTES] = { 'A', 'E', 'R', 'S', 2u, 2u,
+                                          (uint8_t)len, (uint8_t)(len >> 8),
+                                          (uint8_t)seq, (uint8_t)(seq >> 8) };
+    memcpy(&s->buf[s->pos], hdr, sizeof(hdr));
+    memcpy(&s->buf[s->pos + SINK_HDR_BYTES], payload, len);
+    s->pos += SINK_HDR_BYTES + len;
+    s->packets++;
+}
+
+static void put_rec(uint8_t* p, uint8_t row, uint8_t col, uint32_t ticks)
+{
+    p[0] = 2u; p[1] = 1u; p[2] = row; p[3] = col;
+    memcpy(&p[4], &ticks, sizeof(ticks));
+}
+
+static void sink_on_event(uint8_t row, uint8_t col, void* user)
+{
+    frame_sink_t* s = (frame_sink_t*)user;
+    uint8_t rec[SINK_REC_BYTES];
+    put_rec(rec, row, col, s->ticks++);
+    frame_write(s, rec, sizeof(rec));
+}
+
+static void sink_on_burst(uint8_t row, const uint8_t* cols, uint16_t count,
+                          const aer_burst_info_t* info, void* user)
+{
+    (void)info;
+    frame_sink_t* s = (frame_sink_t*)user;
+    uint8_t recs[AER_COLS * SINK_REC_BYTES];
+    const uint32_t t = s->ticks++;
+    for (uint16_t i = 0; i < count; ++i) {
+        put_rec(&recs[i * SINK_REC_BYTES], row, cols[i], t);
+    }
+    frame_write(s, recs, (uint32_t)count * SINK_REC_BYTES);
+}
+
+static uint32_t fill_fixed_width(aer_raw_word_t* words, uint32_t n, uint32_t width)
+{
+    uint32_t i = 0u, row = 0u;
+    while (i + width + 2u <= n) {
+        words[i++] = encode(row++ % AER_ROWS);
+        for (uint32_t c = 0u; c < width; ++c) words[i++] = encode(c % AER_COLS);
+        words[i++] = encode(AER_TAIL_PAYLOAD);
+    }
+    return i;
+}
+
+static void run_sink(uint32_t width, aer_raw_word_t* words, uint32_t cap, frame_sink_t* sink)
+{
+    const uint32_t n = fill_fixed_width(words, cap, width);
+    double dt[2];
+    uint32_t events = 0u, packets[2];
+
+    for (int span = 0; span < 2; ++span) {
+        aer_burst_t b;
+        aer_burst_init(&b);
+        sink->pos = 0u;
+        sink->packets = 0u;
+
+        const double t0 = now_s();
+        for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+            if (span) {
+                for (uint32_t i = 0; i < n; ++i) {
+                    (void)aer_burst_feed_raw_span(&b, words[i], sink_on_burst, sink);
+                }
+            } else {
+                for (uint32_t i = 0; i < n; ++i) {
+                    (void)aer_burst_feed_raw(&b, words[i], sink_on_event, sink);
+                }
+            }
+        }
+        dt[span] = now_s() - t0;
+        events = b.events_emitted;
+        packets[span] = sink->packets;
+    }
+
+    printf("  width %2u  per-event %6.2f ns/event (%u pkts)  span %6.2f ns/event (%u pkts)  %.2fx\n",
+           (unsigned)width, dt[0] * 1e9 / events, (unsigned)packets[0],
+           dt[1] * 1e9 / events, (unsigned)packets[1], dt[0] / dt[1]);
+}
+
+int main(void)
+{
+    aer_raw_word_t* words = (aer_raw_word_t*)malloc(BENCH_WORDS * sizeof(*words));
+    if (!words) return 1;
+    fill_bursts(words, BENCH_WORDS);
+
+    printf("bench_burst: %u words x %u rounds (lut %s, %s cols, aer_burst_t %u bytes)\n",
+           (unsigned)BENCH_WORDS, (unsigned)BENCH_ROUNDS, AER_CODEC_USE_LUT ? "on" : "off",
+           AER_BURST_COL_BITMASK ? "bitmask" : "list", (unsigned)sizeof(aer_burst_t));
+
+    const double two_step = run("two-step", false, words, BENCH_WORDS);
+    const double fused    = run("fused", true, words, BENCH_WORDS);
+    printf("  fused speedup: %.2fx\n", fused / two_step);
+
+    frame_sink_t* sink = (frame_sink_t*)calloc(1u, sizeof(*sink));
+    if (sink) {
+        printf("sink cost vs burst width (framed 8-byte tick records):\n");
+        const uint32_t widths[] = { 1u, 4u, 16u, (uint32_t)AER_COLS };
+        for (size_t k = 0; k < sizeof(widths) / sizeof(widths[0]); ++k) {
+            run_sink(widths[k], words, BENCH_WORDS, sink);
+        }
+    }
+    free(sink);
+
+    free(words);
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * bench/bench_codec.c
+ *
+ * Host throughput benchmark for the word decoder:
+ * - aer_decode_word_loop(): per-group popcount/ctz decoder
+ * - aer_decode_word_lut():  table decoder (one load per word)
+ *
+ * - aer_decode_words*():   batch paths (scalar / SSE2 / AVX2), AoS and SoA output
+ *
+ * Input is a fixed pseudo-random mix of valid ROW/COL/TAIL words with a small
+ * fraction of corrupted words, so both the fast and the error paths are hit.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../common/include/aer_cfg.h"
+#include "../common/include/aer_types.h"
+#include "../common/include/aer_codec.h"
+
+#define BENCH_WORDS   (1u << 16)
+#define BENCH_ROUNDS  400u
+
+typedef aer_codec_result_t (*decode_fn_t)(aer_raw_word_t raw);
+
+static double now_s(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static void fill_words(aer_raw_word_t* words, uint32_t n)
+{
+    uint32_t seed = 0x12345678u;
+    for (uint32_t i = 0; i < n; ++i) {
+        const uint32_t r = xorshift32(&seed);
+        uint8_t payload = (uint8_t)(r & ((1u << AER_INDEX_BITS) - 1u));
+        if ((r >> 8) % 16u == 0u) payload = (uint8_t)AER_TAIL_PAYLOAD;
+
+        aer_raw_word_t raw = 0u;
+        (void)aer_encode_payload(payload, &raw, NULL);
+
+        /* ~1/32 of words get a flipped line (multi-hot or zero-hot). */
+        if ((r >> 16) % 32u == 0u) {
+            raw ^= (aer_raw_word_t)(1u << ((r >> 24) % AER_DATA_WIDTH));
+        }
+        words[i] = raw;
+    }
+}
+
+static double run(const char* name, decode_fn_t fn, const aer_raw_word_t* words, uint32_t n)
+{
+    uint32_t checksum = 0u;
+    const double t0 = now_s();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+        for (uint32_t i = 0; i < n; ++i) {
+            const aer_codec_result_t r = fn(words[i]);
+            checksum += (uint32_t)r.payload + (r.ok ? 1u : 0u) + r.err_flags;
+        }
+    }
+    const double dt = now_s() - t0;
+    const double wps = ((double)n * (double)BENCH_ROUNDS) / dt;
+    printf("  %-22s %8.1f Mwords/s  (%.2f ns/word, checksum %08x)\n",
+           name, wps * 1e-6, 1e9 / wps, (unsigned)checksum);
+    return wps;
+}
+
+static const char* impl_name(aer_codec_batch_impl_t impl)
+{
+    switch (impl) {
+        case AER_CODEC_BATCH_SCALAR: return "scalar";
+        case AER_CODEC_BATCH_SSE2:   return "sse2";
+        case AER_CODEC_BATCH_AVX2:   return "avx2";
+        default:                     return "auto";
+    }
+}
+
+static void run_batch(aer_codec_batch_impl_t impl, const aer_raw_word_t* words, uint32_t n,
+                      aer_codec_result_t* out, uint8_t* payload, uint8_t* status)
+{
+    size_t ok = 0u;
+    double t0 = now_s();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+        ok += aer_decode_words_impl(impl, words, n, out);
+    }
+    const double dt_aos = now_s() - t0;
+
+    t0 = now_s();
+    for (uint32_t round = 0; round < BENCH_ROUNDS; ++round) {
+        ok += aer_decode_words_soa_impl(impl, words, n, payload, status);
+    }
+    const double dt_soa = now_s() - t0;
+
+    const double words_total = (double)n * (double)BENCH_ROUNDS;
+    printf("  batch %-6s aos %8.1f Mwords/s  soa %8.1f Mwords/s  (soa input %.2f GB/s, ok %zu)\n",
+           impl_name(impl), words_total / dt_aos * 1e-6, words_total / dt_soa * 1e-6,
+           words_total * (double)sizeof(aer_raw_word_t) / dt_soa * 1e-9, ok);
+}
+
+int main(void)
+{
+    aer_raw_word_t* words = (aer_raw_word_t*)malloc(BENCH_WORDS * sizeof(*words));
+    if (!words) return 1;
+    fill_words(words, BENCH_WORDS);
+
+    printf("bench_codec: %u words x %u rounds (%u data bits)\n",
+           (unsigned)BENCH_WORDS, (unsigned)BENCH_ROUNDS, (unsigned)AER_DATA_WIDTH);
+
+    const double loop = run("aer_decode_word_loop", aer_decode_word_loop, words, BENCH_WORDS);
+#if AER_CODEC_LUT_AVAILABLE
+    const double lut = run("aer_decode_word_lut", aer_decode_word_lut, words, BENCH_WORDS);
+    printf("  lut speedup: %.2fx\n", lut / loop);
+#else
+    (void)loop;
+    printf("  lut decoder unavailable for this bus width\n");
+#endif
+
+    aer_codec_result_t* out = (aer_codec_result_t*)malloc(BENCH_WORDS * sizeof(*out));
+    uint8_t* payload = (uint8_t*)malloc(BENCH_WORDS);
+    uint8_t* status  = (uint8_t*)malloc(BENCH_WORDS);
+    if (out && payload && status) {
+        const aer_codec_batch_impl_t impls[] = {
+            AER_CODEC_BATCH_SCALAR, AER_CODEC_BATCH_SSE2, AER_CODEC_BATCH_AVX2,
+        };
+        for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); ++k) {
+            if (aer_codec_batch_impl_available(impls[k])) {
+                run_batch(impls[k], words, BENCH_WORDS, out, payload, status);
+            }
+        }
+        printf("  auto: aos %s, soa %s\n", impl_name(aer_codec_batch_impl_active()),
+               impl_name(aer_codec_batch_soa_impl_active()));
+    }
+
+    free(out);
+    free(payload);
+    free(status);
+    free(words);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * bench/bench_evpack.c
+ *
+ * Bytes per event for the event record formats on synthetic scenes:
+ * - V1 ticks:   8-byte record per event (one frame each, or batched)
+ * - V2 rowmask: one 12-byte record per row burst (timestamp per burst)
+ * - V2 delta:   aer_evpack delta blocks (timestamp per event)
+ *
+ * Wire bytes include the 10-byte AERS (v2) frame header per packet; batched formats
+ * use PACKET_BYTES payload packets, the same as the firmware default.
+ * Encode/decode throughput of the reference codec is printed as well.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../common/include/aer_cfg.h"
+#include "../common/include/aer_evpack.h"
+
+#define SCENE_EVENTS   (1u << 16)
+#define PACKET_BYTES   256u
+#define FRAME_HDR      10u
+#define V1_REC_BYTES   8u
+#define ROWMASK_BYTES  (8u + (AER_COLS + 7u) / 8u)
+#define CODEC_ROUNDS   200u
+
+typedef struct scene_s {
+    const char* name;
+    uint32_t min_cols, max_cols;   /* events per burst */
+    uint32_t gap_max;              /* ticks between bursts: uniform 0..gap_max */
+    uint32_t col_spacing;          /* ticks between events inside a burst */
+} scene_t;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+/* Fill ev[] with bursts; returns the number of bursts. */
+static uint32_t make_scene(const scene_t* sc, aer_evpack_event_t* ev, uint32_t n)
+{
+    uint32_t seed = 0xA5A5F00Du;
+    uint32_t t = 0u, i = 0u, bursts = 0u;
+
+    while (i < n) {
+        const uint32_t r = xorshift32(&seed);
+        const uint32_t span = sc->max_cols - sc->min_cols + 1u;
+        const uint32_t cols = sc->min_cols + (r % span);
+        const uint8_t row = (uint8_t)((r >> 8) % AER_ROWS);
+
+        t += (sc->gap_max != 0u) ? (xorshift32(&seed) % (sc->gap_max + 1u)) : 0u;
+        for (uint32_t c = 0u; c < cols && i < n; ++c) {
+            ev[i].row = row;
+            ev[i].col = (uint8_t)((cols >= AER_COLS) ? c : (xorshift32(&seed) % AER_COLS));
+            ev[i].t_ticks = t;
+            t += sc->col_spacing;
+            ++i;
+        }
+        ++bursts;
+    }
+    return bursts;
+}
+
+static uint64_t wire_batched(uint64_t payload_bytes)
+{
+    const uint64_t packets = (payload_bytes + PACKET_BYTES - 1u) / PACKET_BYTES;
+    return payload_bytes + packets * FRAME_HDR;
+}
+
+static void run_scene(const scene_t* sc, aer_evpack_event_t* ev, aer_evpack_event_t* dec)
+{
+    const uint32_t n = SCENE_EVENTS;
+    const uint32_t bursts = make_scene(sc, ev, n);
+
+    /* V2 delta: encode into PACKET_BYTES packets. */
+    static uint8_t pkt[PACKET_BYTES];
+    aer_evpack_enc_t enc;
+    aer_evpack_enc_init(&enc, pkt, sizeof(pkt), 0u);
+
+    uint64_t delta_payload = 0u, delta_packets = 0u, anchors = 0u;
+    for (uint32_t i = 0u; i < n; ++i) {
+        if (!aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks)) {
+            delta_payload += aer_evpack_enc_len(&enc);
+            anchors += enc.anchors;
+            delta_packets++;
+            aer_evpack_enc_reset(&enc);
+            (void)aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks);
+        }
+    }
+    delta_payload += aer_evpack_enc_len(&enc);
+    anchors += enc.anchors;
+    delta_packets++;
+
+    const double v1_single  = (double)(V1_REC_BYTES + FRAME_HDR);
+    const double v1_batched = (double)wire_batched((uint64_t)n * V1_REC_BYTES) / n;
+    const double rowmask    = (double)wire_batched((uint64_t)bursts * ROWMASK_BYTES) / n;
+    const double delta      = (double)(delta_payload + delta_packets * FRAME_HDR) / n;
+
+    printf("  %-14s %5.1f ev/burst | v1 %5.2f  v1 batched %5.2f  rowmask %5.2f  delta %5.2f B/ev"
+           "  (anchors/ev %.3f, %.2fx vs v1 batched)\n",
+           sc->name, (double)n / bursts, v1_single, v1_batched, rowmask, delta,
+           (double)anchors / n, v1_batched / delta);
+
+    /* Reference codec throughput on this scene (whole-packet encode + decode). */
+    uint64_t events = 0u;
+    size_t got = 0u;
+    const double t0 = now_s();
+    for (uint32_t round = 0u; round < CODEC_ROUNDS; ++round) {
+        aer_evpack_enc_reset(&enc);
+        for (uint32_t i = 0u; i < n; ++i) {
+            if (!aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks)) {
+                (void)aer_evpack_decode(pkt, aer_evpack_enc_len(&enc), dec, PACKET_BYTES, &got);
+                events += got;
+                aer_evpack_enc_reset(&enc);
+                (void)aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks);
+            }
+        }
+    }
+    const double dt = now_s() - t0;
+    printf("  %-14s codec enc+dec %.1f Mevents/s\n", "", (double)events / dt * 1e-6);
+}
+
+int main(void)
+{
+    aer_evpack_event_t* ev  = (aer_evpack_event_t*)malloc(SCENE_EVENTS * sizeof(*ev));
+    aer_evpack_event_t* dec = (aer_evpack_event_t*)malloc(PACKET_BYTES * sizeof(*dec));
+    if (!ev || !dec) return 1;
+
+    /* Ticks are cycle-counter ticks; at 150 MHz 150 ticks = 1 us. */
+    const scene_t scenes[] = {
+        { "full rows",   AER_COLS, AER_COLS, 3000u,    0u  },
+        { "dense",       4u,       16u,      2000u,    0u  },
+        { "moderate",    1u,       8u,       30000u,   0u  },
+        { "spread burst",1u,       8u,       30000u,   40u },
+        { "sparse",      1u,       1u,       2000000u, 0u  },
+    };
+
+    printf("bench_evpack: %u events/scene, %u-byte packets, %u-bit addresses\n",
+           (unsigned)SCENE_EVENTS, (unsigned)PACKET_BYTES, (unsigned)AER_EVPACK_ADDR_BITS);
+    for (size_t k = 0u; k < sizeof(scenes) / sizeof(scenes[0]); ++k) {
+        run_scene(&scenes[k], ev, dec);
+    }
+
+    free(ev);
+    free(dec);
+    return 0;
+}
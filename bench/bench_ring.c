@@ -0,0 +1,202 @@
+/*
+ * bench/bench_ring.c
+ *
+ * Ring buffer throughput on the host:
+ * - ringbuf_u32: volatile indices, wrap compare, one reserved slot
+ * - spsc_ring_u32: power-of-two masks, acquire/release atomics, cached indices
+ *
+ * Two cases per ring:
+ * - same thread: push BATCH items then pop them (pure bookkeeping cost);
+ *   ringbuf_u32 also with push_n/pop_n and with in-place claim/commit
+ * - two threads: producer thread pushes, main thread pops and checks order
+ *   (ringbuf_u32 has no memory ordering; it only works here because x86 is
+ *   TSO and the compiler keeps the volatile accesses in order)
+ *
+ * On a single-CPU host the two-thread numbers mostly measure scheduling.
+ */
+
+#define _POSIX_C_SOURCE 200809L /* pthreads, sched_yield() */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../common/include/ringbuf.h"
+#include "../common/include/spsc_ring.h"
+
+#define RING_CAP        2048u     /* same as RAW_RB_CAPACITY in the firmware */
+#define BATCH           64u
+#define ST_ITEMS        (1u << 26)
+#define MT_ITEMS        (1u << 24)
+
+static double now_s(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t g_storage_a[RING_CAP];
+static uint32_t g_storage_b[RING_CAP];
+
+/* ---------------- same thread ---------------- */
+
+static void bench_single_ringbuf(void)
+{
+    ringbuf_u32_t rb;
+    (void)ringbuf_u32_init(&rb, g_storage_a, RING_CAP);
+
+    uint32_t sum = 0u;
+    const double t0 = now_s();
+    for (uint32_t i = 0u; i < ST_ITEMS; i += BATCH) {
+        for (uint32_t k = 0u; k < BATCH; ++k) (void)ringbuf_u32_push(&rb, i + k);
+        uint32_t v;
+        while (ringbuf_u32_pop(&rb, &v)) sum += v;
+    }
+    const double dt = now_s() - t0;
+    printf("  %-14s same thread  %7.1f Mitems/s  (%.2f ns/item, sum %08x)\n",
+           "ringbuf_u32", ST_ITEMS / dt * 1e-6, dt * 1e9 / ST_ITEMS, (unsigned)sum);
+}
+
+static void bench_single_ringbuf_bulk(void)
+{
+    ringbuf_u32_t rb;
+    (void)ringbuf_u32_init(&rb, g_storage_a, RING_CAP);
+
+    uint32_t src[BATCH], dst[BATCH];
+    uint32_t sum = 0u;
+    const double t0 = now_s();
+    for (uint32_t i = 0u; i < ST_ITEMS; i += BATCH) {
+        for (uint32_t k = 0u; k < BATCH; ++k) src[k] = i + k;
+        (void)ringbuf_u32_push_n(&rb, src, BATCH);
+        const uint32_t n = ringbuf_u32_pop_n(&rb, dst, BATCH);
+        for (uint32_t k = 0u; k < n; ++k) sum += dst[k];
+    }
+    const double dt = now_s() - t0;
+    printf("  %-14s push_n/pop_n %7.1f Mitems/s  (%.2f ns/item, sum %08x)\n",
+           "ringbuf_u32", ST_ITEMS / dt * 1e-6, dt * 1e9 / ST_ITEMS, (unsigned)sum);
+}
+
+static void bench_single_ringbuf_claim(void)
+{
+    ringbuf_u32_t rb;
+    (void)ringbuf_u32_init(&rb, g_storage_a, RING_CAP);
+
+    uint32_t sum = 0u;
+    const double t0 = now_s();
+    for (uint32_t i = 0u; i < ST_ITEMS; i += BATCH) {
+        ringbuf_u32_span_t s;
+        (void)ringbuf_u32_write_claim(&rb, &s);
+        uint32_t k = 0u;
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            for (uint32_t j = 0u; j < s.len[p] && k < BATCH; ++j, ++k) s.ptr[p][j] = i + k;
+        }
+        ringbuf_u32_write_commit(&rb, k);
+
+        const uint32_t n = ringbuf_u32_read_claim(&rb, &s);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            for (uint32_t j = 0u; j < s.len[p]; ++j) sum += s.ptr[p][j];
+        }
+        ringbuf_u32_read_commit(&rb, n);
+    }
+    const double dt = now_s() - t0;
+    printf("  %-14s claim/commit %7.1f Mitems/s  (%.2f ns/item, sum %08x)\n",
+           "ringbuf_u32", ST_ITEMS / dt * 1e-6, dt * 1e9 / ST_ITEMS, (unsigned)sum);
+}
+
+static void bench_single_spsc(void)
+{
+    spsc_ring_u32_t rb;
+    (void)spsc_ring_u32_init(&rb, g_storage_b, RING_CAP);
+
+    uint32_t sum = 0u;
+    const double t0 = now_s();
+    for (uint32_t i = 0u; i < ST_ITEMS; i += BATCH) {
+        for (uint32_t k = 0u; k < BATCH; ++k) (void)spsc_ring_u32_push(&rb, i + k);
+        uint32_t v;
+        while (spsc_ring_u32_pop(&rb, &v)) sum += v;
+    }
+    const double dt = now_s() - t0;
+    printf("  %-14s same thread  %7.1f Mitems/s  (%.2f ns/item, sum %08x)\n",
+           "spsc_ring_u32", ST_ITEMS / dt * 1e-6, dt * 1e9 / ST_ITEMS, (unsigned)sum);
+}
+
+/* ---------------- two threads ---------------- */
+
+static void* producer_ringbuf(void* p)
+{
+    ringbuf_u32_t* rb = (ringbuf_u32_t*)p;
+    for (uint32_t i = 0u; i < MT_ITEMS; ++i) {
+        while (!ringbuf_u32_push(rb, i)) sched_yield();
+    }
+    return NULL;
+}
+
+static void* producer_spsc(void* p)
+{
+    spsc_ring_u32_t* rb = (spsc_ring_u32_t*)p;
+    for (uint32_t i = 0u; i < MT_ITEMS; ++i) {
+        while (!spsc_ring_u32_push(rb, i)) sched_yield();
+    }
+    return NULL;
+}
+
+static void bench_threads_ringbuf(void)
+{
+    static ringbuf_u32_t rb;
+    (void)ringbuf_u32_init(&rb, g_storage_a, RING_CAP);
+
+    pthread_t th;
+    const double t0 = now_s();
+    if (pthread_create(&th, NULL, producer_ringbuf, &rb) != 0) return;
+
+    uint32_t expect = 0u, errors = 0u;
+    while (expect < MT_ITEMS) {
+        uint32_t v;
+        if (!ringbuf_u32_pop(&rb, &v)) { sched_yield(); continue; }
+        errors += (v != expect);
+        expect++;
+    }
+    pthread_join(th, NULL);
+    const double dt = now_s() - t0;
+    printf("  %-14s two threads  %7.1f Mitems/s  (%.2f ns/item, order errors %u)\n",
+           "ringbuf_u32", MT_ITEMS / dt * 1e-6, dt * 1e9 / MT_ITEMS, (unsigned)errors);
+}
+
+static void bench_threads_spsc(void)
+{
+    static spsc_ring_u32_t rb;
+    (void)spsc_ring_u32_init(&rb, g_storage_b, RING_CAP);
+
+    pthread_t th;
+    const double t0 = now_s();
+    if (pthread_create(&th, NULL, producer_spsc, &rb) != 0) return;
+
+    uint32_t expect = 0u, errors = 0u;
+    while (expect < MT_ITEMS) {
+        uint32_t v;
+        if (!spsc_ring_u32_pop(&rb, &v)) { sched_yield(); continue; }
+        errors += (v != expect);
+        expect++;
+    }
+    pthread_join(th, NULL);
+    const double dt = now_s() - t0;
+    printf("  %-14s two threads  %7.1f Mitems/s  (%.2f ns/item, order errors %u)\n",
+           "spsc_ring_u32", MT_ITEMS / dt * 1e-6, dt * 1e9 / MT_ITEMS, (unsigned)errors);
+}
+
+int main(void)
+{
+    printf("bench_ring: capacity %u, batch %u\n", (unsigned)RING_CAP, (unsigned)BATCH);
+    bench_single_ringbuf();
+    bench_single_ringbuf_bulk();
+    bench_single_ringbuf_claim();
+    bench_single_spsc();
+    bench_threads_ringbuf();
+    bench_threads_spsc();
+    return 0;
+}
@@ -0,0 +1,61 @@
+static const char aer_rx_pio_src[] =
+";\n"
+"; aer_rx.pio\n"
+";\n"
+"; DI 4-phase word receiver (same protocol as aer_rx_poll_step()):\n"
+";   wait DATA != 0 -> latch -> push to RX FIFO -> ACK high\n"
+";   wait DATA == 0 -> ACK low\n"
+";\n"
+"; DATA: DATA_BITS consecutive pins from the IN base. IN_COUNT (RP2350)\n"
+"; masks \"mov x, pins\" to exactly those pins, so each poll is one instruction.\n"
+"; ACK: the side-set pin, active high.\n"
+";\n"
+"; The word is pushed BEFORE ACK rises. With \"push block\" a full RX FIFO\n"
+"; (DMA out of ring space) stalls the state machine with ACK still low: the\n"
+"; sender holds the word on the bus, i.e. backpressure, nothing is lost.\n"
+";\n"
+"; Cycle budget at clkdiv 1: a valid word is seen within 2 cycles, ACK rises\n"
+"; 3 cycles after the sampling mov (mov isr, push, then the side-set of the\n"
+"; next instruction), neutral is seen within 2 cycles and ACK falls on the\n"
+"; following instruction.\n"
+";\n"
+"\n"
+".program aer_rx\n"
+".side_set 1\n"
+"\n"
+".define PUBLIC DATA_BITS 12\n"
+"\n"
+".wrap_target\n"
+"wait_valid:\n"
+"    mov x, pins             side 0  ; sample DATA, ACK low\n"
+"    jmp !x wait_valid       side 0  ; all rails neutral: keep polling\n"
+"    mov isr, x              side 0  ; latch exactly the sampled word\n"
+"    push block              side 0  ; -> RX FIFO (stalls here on backpressure)\n"
+"wait_neutral:\n"
+"    mov x, pins             side 1  ; ACK high\n"
+"    jmp x-- wait_neutral    side 1  ; any rail still up: keep ACK high\n"
+".wrap\n"
+"\n"
+"% c-sdk {\n"
+"// IN pins = DATA, side-set = ACK (driven low here), 8-deep RX FIFO, full speed.\n"
+"static inline void aer_rx_program_init(PIO pio, uint sm, uint offset, uint data_base, uint ack_pin)\n"
+"{\n"
+"    pio_sm_config c = aer_rx_program_get_default_config(offset);\n"
+"    sm_config_set_in_pins(&c, data_base);\n"
+"#if PICO_PIO_VERSION > 0\n"
+"    sm_config_set_in_pin_count(&c, aer_rx_DATA_BITS);\n"
+"#else\n"
+"#error \"aer_rx.pio needs IN_COUNT (RP2350) to poll DATA with one mov\"\n"
+"#endif\n"
+"    sm_config_set_sideset_pins(&c, ack_pin);\n"
+"    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_RX);\n"
+"    sm_config_set_clkdiv(&c, 1.0f);\n"
+"\n"
+"    pio_sm_set_pins_with_mask64(pio, sm, 0u, 1ull << ack_pin);\n"
+"    pio_sm_set_pindirs_with_mask64(pio, sm, 1ull << ack_pin, 1ull << ack_pin);\n"
+"    pio_gpio_init(pio, ack_pin);\n"
+"\n"
+"    pio_sm_init(pio, sm, offset, &c);\n"
+"}\n"
+"%}\n"
+;
@@ -0,0 +1,8 @@
+// Generated by scripts/gen_dlog_table.py from the HAL_DLOG*() sites; do not edit.
+#pragma once
+
+#define HAL_DLOG_TABLE_ID 0x02EBD210u
+#define HAL_DLOG_NUM_IDS  2u
+
+#define DLOG_RX_BP_TIMEOUT 0u
+#define DLOG_RX_NEUTRAL_TIMEOUT 1u
@@ -10,6 +10,7 @@
  * This module is platform-agnostic (no Pico SDK includes).
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -21,6 +22,20 @@
 extern "C" {
 #endif
 
+/* Column storage mode (compile-time).
+ *   0 (default): columns buffered in arrival order in cols[AER_COLS]; repeats
+ *                take slots, extra columns raise AER_BURST_WARN_COL_OVERFLOW.
+ *   1          : per-burst column bitmask; repeats are merged (and flagged with
+ *                AER_BURST_WARN_COL_DUP), a burst can never overflow, and
+ *                columns are emitted in ascending order.
+ */
+#ifndef AER_BURST_COL_BITMASK
+#define AER_BURST_COL_BITMASK 0
+#endif
+
+/* Number of 32-bit words in a column bitmask (bit c of word c/32 = column c). */
+#define AER_BURST_COL_MASK_WORDS ((AER_COLS + 31u) / 32u)
+
 typedef enum aer_burst_state_e {
     AER_BURST_EXPECT_ROW = 0,
     AER_BURST_EXPECT_COL_OR_TAIL = 1
@@ -36,23 +51,74 @@ typedef enum aer_burst_err_e {
     /* Optional warnings (useful in debug). */
     AER_BURST_WARN_ROW_OOR          = 1u << 8,  // row out of [0..AER_ROWS-1]
     AER_BURST_WARN_COL_OOR          = 1u << 9,  // col out of [0..AER_COLS-1]
-    AER_BURST_WARN_COL_OVERFLOW     = 1u << 10  // too many cols buffered
+    AER_BURST_WARN_COL_OVERFLOW     = 1u << 10, // too many cols buffered
+    AER_BURST_WARN_COL_DUP          = 1u << 11  // repeated col in one burst (bitmask mode)
 } aer_burst_err_t;
 
 /* Callback signature for emitted events (row, col). */
 typedef void (*aer_event_cb_t)(uint8_t row, uint8_t col, void* user);
 
+/* Per-burst metadata passed to span callbacks. */
+typedef struct aer_burst_info_s {
+    uint32_t seq;                /* burst sequence number (bursts_completed before this one) */
+    uint32_t err_flags;          /* assembler err_flags at burst end (sticky, aer_burst_err_t) */
+    uint16_t cols_dropped;       /* columns lost to overflow (list mode) or out of range (bitmask mode) */
+    const uint32_t* col_mask;    /* bitmask mode: the burst's AER_BURST_COL_MASK_WORDS mask words; else NULL */
+
+    /* Latch times (aer_burst_feed_raw_words_ts_span() only; timed == false and
+     * all zero/NULL otherwise). Same tick units as the caller's timestamps. */
+    bool timed;
+    uint32_t t_row;              /* latch time of the row word (burst start) */
+    uint32_t t_tail;             /* latch time of the tail word (burst end) */
+    const uint32_t* col_t;       /* list mode: latch time of each cols[] entry; bitmask mode: NULL */
+} aer_burst_info_t;
+
+/* Callback signature for a whole burst: one row and its buffered columns, in
+ * arrival order (ascending in bitmask mode, where info->col_mask also carries
+ * the dense form). cols and col_mask are only valid for the duration of the call.
+ */
+typedef void (*aer_burst_cb_t)(uint8_t row,
+                               const uint8_t* cols,
+                               uint16_t count,
+                               const aer_burst_info_t* info,
+                               void* user);
+
+/* Adapter: span callback that fans a burst out to a per-event callback.
+ * Pass aer_burst_span_to_events as the span callback and a pointer to an
+ * aer_burst_event_adapter_t as its user argument.
+ */
+typedef struct aer_burst_event_adapter_s {
+    aer_event_cb_t cb;
+    void* user;
+} aer_burst_event_adapter_t;
+
+void aer_burst_span_to_events(uint8_t row,
+                              const uint8_t* cols,
+                              uint16_t count,
+                              const aer_burst_info_t* info,
+                              void* user);
+
 /* Burst assembler instance. */
 typedef struct aer_burst_s {
     aer_burst_state_t state;
 
     uint8_t row;                 /* current burst row */
+    bool timed;                  /* current burst is fed with latch times */
+    uint32_t t_row;              /* latch time of the row word (timed feeds) */
+#if AER_BURST_COL_BITMASK
+    uint32_t col_mask[AER_BURST_COL_MASK_WORDS]; /* columns seen in current row burst */
+#else
     uint8_t cols[AER_COLS];      /* buffered columns for current row burst */
-    uint16_t col_count;          /* number of buffered columns */
+    uint32_t col_t[AER_COLS];    /* latch time per buffered column (timed feeds) */
+#endif
+    uint16_t col_count;          /* number of buffered (distinct, in bitmask mode) columns */
+    uint16_t cols_dropped;       /* columns dropped by overflow / range in the current burst */
 
     uint32_t err_flags;          /* aer_burst_err_t bitmask */
     uint32_t bursts_completed;   /* number of bursts ended by TAIL */
     uint32_t events_emitted;     /* total events emitted */
+    uint32_t words_ignored;      /* words dropped because the codec rejected them (!ok) */
+    uint32_t cols_dropped_total; /* cols_dropped summed over all bursts (loss accounting) */
 } aer_burst_t;
 
 /* Initialize burst assembler to a known state (EXPECT_ROW). */
@@ -79,6 +145,90 @@ uint16_t aer_burst_feed(aer_burst_t* b,
                         aer_event_cb_t emit_cb,
                         void* user);
 
+/* Feed one raw (undecoded) word.
+ *
+ * Same result as aer_burst_feed(b, aer_decode_word(raw), emit_cb, user), but
+ * without building the intermediate aer_codec_result_t: with the lookup-table
+ * codec, the word's table entry is the action (INVALID / TAIL / index) and the
+ * state machine is driven straight from it. Use this on hot receive paths.
+ *
+ * Returns: number of events emitted by this call (0 except on tail end-of-burst).
+ */
+uint16_t aer_burst_feed_raw(aer_burst_t* b,
+                            aer_raw_word_t raw,
+                            aer_event_cb_t emit_cb,
+                            void* user);
+
+/* Span variants of aer_burst_feed() / aer_burst_feed_raw(): on a tailword the
+ * whole burst is delivered with one burst_cb call instead of one call per
+ * column. burst_cb may be NULL (events are still counted).
+ *
+ * Returns: number of events emitted by this call (0 except on tail end-of-burst).
+ */
+uint16_t aer_burst_feed_span(aer_burst_t* b,
+                             aer_codec_result_t word,
+                             aer_burst_cb_t burst_cb,
+                             void* user);
+
+uint16_t aer_burst_feed_raw_span(aer_burst_t* b,
+                                 aer_raw_word_t raw,
+                                 aer_burst_cb_t burst_cb,
+                                 void* user);
+
+/* Feed n raw words in order (e.g. a span claimed straight from the raw ring).
+ * Same result as calling aer_burst_feed_raw_span() on each word, with the
+ * per-word call and NULL checks hoisted out of the loop.
+ *
+ * Returns: total number of events emitted.
+ */
+uint32_t aer_burst_feed_raw_words_span(aer_burst_t* b,
+                                       const aer_raw_word_t* words,
+                                       size_t n,
+                                       aer_burst_cb_t burst_cb,
+                                       void* user);
+
+/* Same as aer_burst_feed_raw_words_span() with each word's latch time
+ * (ts[i] belongs to words[i], e.g. the timestamp ring paired with the raw
+ * ring, see aer_rx_poll_set_timestamps()). The burst callback gets them in
+ * info: t_row / t_tail, and per column in list mode.
+ *
+ * Returns: total number of events emitted.
+ */
+uint32_t aer_burst_feed_raw_words_ts_span(aer_burst_t* b,
+                                          const aer_raw_word_t* words,
+                                          const uint32_t* ts,
+                                          size_t n,
+                                          aer_burst_cb_t burst_cb,
+                                          void* user);
+
+/* Count trailing zeros of a non-zero word. */
+static inline uint32_t aer_burst_ctz32(uint32_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(x);
+#else
+    uint32_t n = 0u;
+    while ((x & 1u) == 0u) { x >>= 1; ++n; }
+    return n;
+#endif
+}
+
+/* Expand a column bitmask (AER_BURST_COL_MASK_WORDS words) into ascending
+ * column indices; out must hold AER_COLS entries. Returns the column count.
+ */
+static inline uint16_t aer_burst_mask_to_cols(const uint32_t* mask, uint8_t* out)
+{
+    uint16_t n = 0u;
+    for (uint32_t w = 0u; w < AER_BURST_COL_MASK_WORDS; ++w) {
+        uint32_t m = mask[w];
+        while (m != 0u) {
+            out[n++] = (uint8_t)(w * 32u + aer_burst_ctz32(m));
+            m &= m - 1u;
+        }
+    }
+    return n;
+}
+
 /* Accessors */
 static inline aer_burst_state_t aer_burst_state(const aer_burst_t* b) { return b->state; }
 static inline uint32_t aer_burst_errors(const aer_burst_t* b) { return b->err_flags; }
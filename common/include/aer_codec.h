@@ -13,6 +13,7 @@
  * - Any mixed/illegal pattern (multi-hot or missing-hot in any group) is invalid.
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -24,6 +25,26 @@
 extern "C" {
 #endif
 
+/* ---------------- Decoder selection (compile time) ----------------
+ * aer_decode_word() can be backed by either:
+ *   - the per-group loop decoder (popcount/ctz per 4-wire group), or
+ *   - a precomputed table indexed by the masked raw word (one load per word).
+ *
+ * The table has (1 << AER_DATA_WIDTH) entries, so it is only available for
+ * buses of up to AER_CODEC_LUT_MAX_BITS lines. Override with
+ * -DAER_CODEC_USE_LUT=0 to force the loop decoder.
+ */
+#define AER_CODEC_LUT_MAX_BITS   12u
+#define AER_CODEC_LUT_AVAILABLE  (AER_DATA_WIDTH <= AER_CODEC_LUT_MAX_BITS)
+
+#ifndef AER_CODEC_USE_LUT
+#define AER_CODEC_USE_LUT        AER_CODEC_LUT_AVAILABLE
+#endif
+
+#if AER_CODEC_USE_LUT && !AER_CODEC_LUT_AVAILABLE
+#error "AER_CODEC_USE_LUT requires AER_DATA_WIDTH <= AER_CODEC_LUT_MAX_BITS"
+#endif
+
 /* Bitmask of decode errors/warnings.
  *
  * Notes:
@@ -65,6 +86,68 @@ typedef struct aer_codec_result_s {
  */
 aer_codec_result_t aer_decode_word(aer_raw_word_t raw);
 
+/* Explicit decoder implementations (aer_decode_word() forwards to one of these).
+ * Both produce bit-identical results; they are exposed for tests and benchmarks.
+ */
+aer_codec_result_t aer_decode_word_loop(aer_raw_word_t raw);
+#if AER_CODEC_LUT_AVAILABLE
+aer_codec_result_t aer_decode_word_lut(aer_raw_word_t raw);
+#endif
+
+/* ---------------- Batch decode ----------------
+ * Decode n raw words in one call (offline captures, host replay, ring drains).
+ * Results are identical to calling aer_decode_word() per word.
+ *
+ * On x86 hosts the batch paths validate the 1-of-4 groups of 4 (SSE2) or
+ * 8 (AVX2) words per instruction; elsewhere a portable scalar loop is used.
+ * AER_CODEC_BATCH_AUTO picks the widest path the running CPU supports for
+ * the AoS output; for SoA it picks the scalar table path when the LUT is
+ * built in (faster than the SIMD kernels there), else the widest path.
+ */
+typedef enum aer_codec_batch_impl_e {
+    AER_CODEC_BATCH_AUTO   = 0,
+    AER_CODEC_BATCH_SCALAR = 1,
+    AER_CODEC_BATCH_SSE2   = 2,
+    AER_CODEC_BATCH_AVX2   = 3,
+} aer_codec_batch_impl_t;
+
+/* Compact per-word status byte used by the SoA output:
+ *   bit 0    : ok
+ *   bit 1    : is_tail
+ *   bits 2..6: aer_codec_err_t flags
+ */
+#define AER_CODEC_ST_OK         0x01u
+#define AER_CODEC_ST_TAIL       0x02u
+#define AER_CODEC_ST_ERR_SHIFT  2u
+
+static inline uint32_t aer_codec_status_err(uint8_t status)
+{
+    return (uint32_t)status >> AER_CODEC_ST_ERR_SHIFT;
+}
+
+/* Decode into an array of results. Returns the number of ok words. */
+size_t aer_decode_words(const aer_raw_word_t* in, size_t n, aer_codec_result_t* out);
+
+/* Decode into separate payload[] and status[] byte arrays (SoA, 2 bytes/word).
+ * Returns the number of ok words.
+ */
+size_t aer_decode_words_soa(const aer_raw_word_t* in, size_t n,
+                            uint8_t* out_payload, uint8_t* out_status);
+
+/* Explicit-path variants (tests/benchmarks). An unavailable impl falls back to scalar. */
+size_t aer_decode_words_impl(aer_codec_batch_impl_t impl,
+                             const aer_raw_word_t* in, size_t n, aer_codec_result_t* out);
+size_t aer_decode_words_soa_impl(aer_codec_batch_impl_t impl,
+                                 const aer_raw_word_t* in, size_t n,
+                                 uint8_t* out_payload, uint8_t* out_status);
+
+/* True if impl can run on this build + CPU (AUTO and SCALAR always can). */
+bool aer_codec_batch_impl_available(aer_codec_batch_impl_t impl);
+
+/* The concrete path AER_CODEC_BATCH_AUTO resolves to (AoS and SoA output). */
+aer_codec_batch_impl_t aer_codec_batch_impl_active(void);
+aer_codec_batch_impl_t aer_codec_batch_soa_impl_active(void);
+
 /* Convenience form for callers that prefer out-params.
  * Returns the same value as result.ok.
  */
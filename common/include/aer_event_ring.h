@@ -0,0 +1,36 @@
+#ifndef AER_EVENT_RING_H
+#define AER_EVENT_RING_H
+
+/*
+ * SPSC ring of decoded, timestamped events.
+ *
+ * Sits between the burst parser (producer) and the USB/stream side
+ * (consumer), on one core or across two, so decode and transmit are
+ * buffered and sized independently of the raw word ring.
+ */
+
+#include <stdint.h>
+
+#include "spsc_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One ON event, stamped when the parser produced it. 8 bytes. */
+typedef struct aer_event_rec_s {
+    uint8_t  row;
+    uint8_t  col;
+    uint8_t  flags;      /* USB_EVT_FLAG_* style bits, owned by the producer */
+    uint8_t  rsvd;
+    uint32_t t_ticks;    /* cycle counter ticks */
+} aer_event_rec_t;
+
+/* aer_event_ring_t / aer_event_ring_init() / _push() / _pop() / _read_claim() ... */
+SPSC_RING_DEFINE(aer_event_ring, aer_event_rec_t)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* AER_EVENT_RING_H */
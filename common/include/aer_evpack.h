@@ -0,0 +1,97 @@
+#ifndef AER_EVPACK_H
+#define AER_EVPACK_H
+
+/*
+ * Compact event records with delta timestamps (portable reference codec).
+ *
+ * V2 "delta block" record, little-endian, byte aligned:
+ *
+ *   u8   rec_type   = AER_EVPACK_REC_DELTA
+ *   u8   count      events in this block (1..255)
+ *   u32  t_anchor   absolute tick time the first delta is relative to
+ *   count x varint  (dt << AER_EVPACK_ADDR_BITS) | (row << AER_INDEX_BITS) | col
+ *
+ * - row/col are packed to AER_INDEX_BITS each (ON events only, no flags byte).
+ * - dt is the tick delta to the previous event in the block (to t_anchor for
+ *   the first one), so events inside one burst cost only their address bits.
+ * - varint is LEB128: 7 value bits per byte, bit 7 = continuation.
+ * - Every block restarts from an absolute anchor. The encoder opens a new
+ *   block when a delta would exceed AER_EVPACK_MAX_DELTA (or goes backwards),
+ *   when a block reaches its event limit, and at every packet start, so the
+ *   host never needs state from earlier packets to rebuild full timestamps.
+ *
+ * For the 32x32 geometry an event costs 2 bytes (dt < 64), 3 bytes
+ * (dt < 8192) or 4 bytes (dt < 2^18), plus 6 bytes per anchor; compare
+ * 8 bytes per USB_EVT_REC_V1_TICKS record.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "aer_cfg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AER_EVPACK_REC_DELTA      4u     /* record type byte (shares the usb_stream numbering) */
+#define AER_EVPACK_BLOCK_HDR      6u     /* rec_type + count + t_anchor */
+#define AER_EVPACK_BLOCK_MAX      255u   /* events per block (count is one byte) */
+
+#define AER_EVPACK_ADDR_BITS      (2u * AER_INDEX_BITS)
+#define AER_EVPACK_MAX_VARINT     4u     /* longest varint the encoder emits */
+#define AER_EVPACK_MAX_DELTA      ((1u << (7u * AER_EVPACK_MAX_VARINT - AER_EVPACK_ADDR_BITS)) - 1u)
+
+/* One decoded (or to-be-encoded) ON event. */
+typedef struct aer_evpack_event_s {
+    uint8_t  row;
+    uint8_t  col;
+    uint32_t t_ticks;
+} aer_evpack_event_t;
+
+/* Encoder writing delta blocks into a caller-provided packet buffer. */
+typedef struct aer_evpack_enc_s {
+    uint8_t* buf;
+    size_t   cap;
+    size_t   len;              /* bytes used in buf */
+
+    size_t   blk_hdr;          /* offset of the open block header (valid if blk_open) */
+    bool     blk_open;
+    uint8_t  blk_count;
+    uint8_t  blk_limit;        /* events per block before a fresh anchor (1..255) */
+    uint32_t t_prev;           /* time of the last event in the open block */
+
+    uint32_t events;           /* events in buf */
+    uint32_t anchors;          /* blocks (anchors) in buf */
+} aer_evpack_enc_t;
+
+/* Initialize an encoder on buf[cap]. anchor_every bounds events per block
+ * (0 or > AER_EVPACK_BLOCK_MAX => AER_EVPACK_BLOCK_MAX).
+ */
+void aer_evpack_enc_init(aer_evpack_enc_t* enc, uint8_t* buf, size_t cap, uint32_t anchor_every);
+
+/* Start a new packet: drops buffered bytes, the next event opens a new anchor. */
+void aer_evpack_enc_reset(aer_evpack_enc_t* enc);
+
+/* Append one event. Returns false (nothing written) if the buffer is full;
+ * the caller sends the packet, calls aer_evpack_enc_reset() and retries.
+ */
+bool aer_evpack_enc_put(aer_evpack_enc_t* enc, uint8_t row, uint8_t col, uint32_t t_ticks);
+
+/* Encoded bytes ready to send. */
+static inline size_t aer_evpack_enc_len(const aer_evpack_enc_t* enc) { return enc->len; }
+
+/* Decode all delta blocks in buf[len].
+ * Writes up to max_out events to out and the total event count to *n_out.
+ * Returns false on a malformed/truncated block or a record type other than
+ * AER_EVPACK_REC_DELTA (events decoded before the error are kept).
+ */
+bool aer_evpack_decode(const uint8_t* buf, size_t len,
+                       aer_evpack_event_t* out, size_t max_out, size_t* n_out);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* AER_EVPACK_H */
@@ -17,6 +17,29 @@
 extern "C" {
 #endif
 
+/* Occupancy instrumentation (compile-time).
+ *   0 (default): no stats, no extra work on push.
+ *   1          : producer-side stats in every ring (ringbuf_u32_stats()).
+ * One sample is taken per producer publish (push, push_n, write_commit):
+ * the fill level right after it. The cost is a count-leading-zeros and two
+ * increments, cheap enough for production builds.
+ */
+#ifndef RINGBUF_STATS
+#define RINGBUF_STATS 0
+#endif
+
+/* Histogram buckets: bucket 0 = empty, bucket b = fill level in
+ * [2^(b-1), 2^b); the last bucket also takes everything above.
+ */
+#define RINGBUF_STATS_BUCKETS 16u
+
+typedef struct ringbuf_u32_stats_s {
+    uint32_t high_water;                     /* max fill level after a publish */
+    uint32_t push_full;                      /* items rejected because the ring was full */
+    uint32_t publishes;                      /* samples in hist[] */
+    uint32_t hist[RINGBUF_STATS_BUCKETS];    /* fill level at publish, power-of-two buckets */
+} ringbuf_u32_stats_t;
+
 typedef struct ringbuf_u32_s {
     uint32_t* buf;       /* storage provided by caller */
     uint32_t  capacity;  /* number of elements in buf (must be >= 2) */
@@ -24,8 +47,25 @@ typedef struct ringbuf_u32_s {
     /* head: next write index, tail: next read index */
     volatile uint32_t head;
     volatile uint32_t tail;
+
+#if RINGBUF_STATS
+    ringbuf_u32_stats_t stats;  /* written by the producer only */
+#endif
 } ringbuf_u32_t;
 
+/* Contiguous region of the storage exposed by the claim functions: up to two
+ * pieces, the second one non-empty only when the region wraps past the end.
+ */
+typedef struct ringbuf_u32_span_s {
+    uint32_t* ptr[2];
+    uint32_t  len[2];
+} ringbuf_u32_span_t;
+
+static inline uint32_t ringbuf_u32_span_total(const ringbuf_u32_span_t* s)
+{
+    return s->len[0] + s->len[1];
+}
+
 /* Initialize with caller-provided storage.
  * Returns false if parameters invalid.
  */
@@ -53,6 +93,52 @@ bool ringbuf_u32_pop(ringbuf_u32_t* rb, uint32_t* out);
 /* Peek (read without removing) the next item. Returns false if empty. */
 bool ringbuf_u32_peek(const ringbuf_u32_t* rb, uint32_t* out);
 
+/* ---------------- Bulk ----------------
+ * Copy up to n items in/out with one head/tail read and one publish.
+ * Return the number of items actually moved (partial when full/empty).
+ */
+uint32_t ringbuf_u32_push_n(ringbuf_u32_t* rb, const uint32_t* src, uint32_t n);
+uint32_t ringbuf_u32_pop_n(ringbuf_u32_t* rb, uint32_t* dst, uint32_t max);
+
+/* ---------------- Zero-copy claim/commit ----------------
+ * Producer: ringbuf_u32_write_claim() exposes the free slots as a span, the
+ *   caller fills some prefix of it (ptr[0] first, then ptr[1]) and publishes
+ *   that many items with ringbuf_u32_write_commit().
+ * Consumer: ringbuf_u32_read_claim() exposes the stored items as a span, the
+ *   caller processes them in place and releases a prefix with
+ *   ringbuf_u32_read_commit().
+ * Claims return the span total (0 => nothing available). Committing more than
+ * was claimed is clamped. Each side may hold at most one claim at a time; the
+ * regular push/pop calls of the same side must not run in between.
+ */
+uint32_t ringbuf_u32_write_claim(ringbuf_u32_t* rb, ringbuf_u32_span_t* span);
+void     ringbuf_u32_write_commit(ringbuf_u32_t* rb, uint32_t n);
+uint32_t ringbuf_u32_read_claim(ringbuf_u32_t* rb, ringbuf_u32_span_t* span);
+void     ringbuf_u32_read_commit(ringbuf_u32_t* rb, uint32_t n);
+
+/* ---------------- Instrumentation ----------------
+ * ringbuf_u32_stats() returns NULL when built with RINGBUF_STATS=0. The
+ * producer updates the counters without locking, so a reader on another
+ * context sees a best-effort snapshot. reset clears them (not the ring).
+ */
+const ringbuf_u32_stats_t* ringbuf_u32_stats(const ringbuf_u32_t* rb);
+void ringbuf_u32_stats_reset(ringbuf_u32_t* rb);
+
+/* Histogram bucket for a fill level. */
+static inline uint32_t ringbuf_stats_bucket(uint32_t level)
+{
+    uint32_t b = 0u;
+#if defined(__GNUC__) || defined(__clang__)
+    b = (level == 0u) ? 0u : 32u - (uint32_t)__builtin_clz(level);
+#else
+    while (level != 0u) {
+        level >>= 1;
+        ++b;
+    }
+#endif
+    return (b < RINGBUF_STATS_BUCKETS) ? b : RINGBUF_STATS_BUCKETS - 1u;
+}
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
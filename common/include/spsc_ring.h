@@ -0,0 +1,238 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+/*
+ * Lock-free single-producer / single-consumer rings, generated per element type.
+ *
+ * SPSC_RING_DEFINE(name, type) emits name##_t plus static inline functions
+ * name##_init/_reset/_capacity/_push/_pop/_peek/_count/_free/_is_full/_write_slot
+ * and the span interface name##_write_claim/_write_commit/_read_claim/_read_commit.
+ * spsc_ring_u32 (32-bit items) is instantiated below; see aer_event_ring.h
+ * for a struct element type.
+ *
+ * Safe across cores (RP2350 core0/core1, host threads), unlike ringbuf_u32_t
+ * whose volatile indices give no ordering guarantees:
+ *  - capacity is a power of two; head/tail are free-running counters and
+ *    slots are addressed with (index & mask), so all capacity slots are
+ *    usable and there is no wrap compare per operation.
+ *  - the producer publishes head with a release store after writing the
+ *    slot; the consumer reads it with an acquire load (and vice versa for
+ *    tail), so item data is visible before the index that covers it.
+ *  - each side keeps a private cached copy of the other side's index and
+ *    only re-reads the shared one when the cache says full/empty, so the
+ *    shared cache lines are touched once per batch instead of per item.
+ *  - producer and consumer fields sit on separate SPSC_RING_CACHE_LINE
+ *    aligned lines to avoid false sharing.
+ *
+ * Exactly one thread may call the producer functions (push, free, is_full, write_slot,
+ * write_claim/commit) and one the consumer functions (pop, peek, count,
+ * read_claim/commit). init/reset need both idle.
+ *
+ * Platform-agnostic C11 (<stdatomic.h>); no Pico SDK includes. C only: the
+ * struct uses _Atomic and is not meant to be included from C++.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Alignment used to keep producer and consumer state apart. 64 matches
+ * common host CPUs; the RP2350 has no data cache so any value works there.
+ */
+#ifndef SPSC_RING_CACHE_LINE
+#define SPSC_RING_CACHE_LINE 64
+#endif
+
+/* ---------------- Generator ----------------
+ * Claims expose up to two contiguous pieces (ptr[1] only used on wrap), like
+ * ringbuf_u32_span_t. Fill/consume a prefix (ptr[0] first), then commit that
+ * many items; commits larger than the claim are clamped.
+ */
+#define SPSC_RING_DEFINE(name, type)                                                    \
+                                                                                        \
+typedef struct name##_s {                                                               \
+    /* Shared read-only after init. */                                                  \
+    type*    buf;                 /* storage provided by caller */                      \
+    uint32_t mask;                /* capacity - 1 (capacity is a power of two) */       \
+                                                                                        \
+    /* Producer side: head is written here, tail_cache is producer-private. */          \
+    _Alignas(SPSC_RING_CACHE_LINE) _Atomic uint32_t head; /* items ever pushed */       \
+    uint32_t tail_cache;                                                                \
+                                                                                        \
+    /* Consumer side: tail is written here, head_cache is consumer-private. */          \
+    _Alignas(SPSC_RING_CACHE_LINE) _Atomic uint32_t tail; /* items ever popped */       \
+    uint32_t head_cache;                                                                \
+} name##_t;                                                                             \
+                                                                                        \
+typedef struct name##_span_s {                                                          \
+    type*    ptr[2];                                                                    \
+    uint32_t len[2];                                                                    \
+} name##_span_t;                                                                        \
+                                                                                        \
+/* Reset to empty state (does not clear memory). Neither side may be active. */         \
+static inline void name##_reset(name##_t* rb)                                           \
+{                                                                                       \
+    if (!rb) return;                                                                    \
+    atomic_store_explicit(&rb->head, 0u, memory_order_relaxed);                         \
+    atomic_store_explicit(&rb->tail, 0u, memory_order_relaxed);                         \
+    rb->tail_cache = 0u;                                                                \
+    rb->head_cache = 0u;                                                                \
+    /* Publish the reset to whichever core starts using the ring next. */               \
+    atomic_thread_fence(memory_order_seq_cst);                                          \
+}                                                                                       \
+                                                                                        \
+/* Initialize with caller-provided storage. Returns false if parameters are             \
+ * invalid (capacity must be a power of two >= 2).                                      \
+ */                                                                                     \
+static inline bool name##_init(name##_t* rb, type* storage, uint32_t capacity)          \
+{                                                                                       \
+    if (!rb || !storage) return false;                                                  \
+    /* Masked indexing needs a power of two. */                                         \
+    if (capacity < 2u || (capacity & (capacity - 1u)) != 0u) return false;              \
+    rb->buf = storage;                                                                  \
+    rb->mask = capacity - 1u;                                                           \
+    name##_reset(rb);                                                                   \
+    return true;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* Number of slots (all usable). */                                                     \
+static inline uint32_t name##_capacity(const name##_t* rb)                              \
+{                                                                                       \
+    return rb->mask + 1u;                                                               \
+}                                                                                       \
+                                                                                        \
+/* Slot index the next push / write_claim fills (producer). Lets a caller keep   \
+ * side data in a parallel array and write it before publishing the item. */    \
+static inline uint32_t name##_write_slot(const name##_t* rb)                            \
+{                                                                                       \
+    return atomic_load_explicit(&rb->head, memory_order_relaxed) & rb->mask;            \
+}                                                                                       \
+                                                                                        \
+/* Push one item (producer). Returns false if full. */                                  \
+static inline bool name##_push(name##_t* rb, type v)                                    \
+{                                                                                       \
+    const uint32_t h = atomic_load_explicit(&rb->head, memory_order_relaxed);           \
+    if (h - rb->tail_cache > rb->mask) {                                                \
+        rb->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);         \
+        if (h - rb->tail_cache > rb->mask) {                                            \
+            return false; /* full */                                                    \
+        }                                                                               \
+    }                                                                                   \
+    rb->buf[h & rb->mask] = v;                                                          \
+    /* Publish the slot. */                                                             \
+    atomic_store_explicit(&rb->head, h + 1u, memory_order_release);                     \
+    return true;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* Peek the next item without removing it (consumer). Returns false if empty. */       \
+static inline bool name##_peek(name##_t* rb, type* out)                                 \
+{                                                                                       \
+    const uint32_t t = atomic_load_explicit(&rb->tail, memory_order_relaxed);           \
+    if (t == rb->head_cache) {                                                          \
+        rb->head_cache = atomic_load_explicit(&rb->head, memory_order_acquire);         \
+        if (t == rb->head_cache) {                                                      \
+            return false; /* empty */                                                   \
+        }                                                                               \
+    }                                                                                   \
+    *out = rb->buf[t & rb->mask];                                                       \
+    return true;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* Pop one item into *out (consumer). Returns false if empty. */                        \
+static inline bool name##_pop(name##_t* rb, type* out)                                  \
+{                                                                                       \
+    if (!name##_peek(rb, out)) return false;                                            \
+    /* Hand the slot back to the producer. */                                           \
+    const uint32_t t = atomic_load_explicit(&rb->tail, memory_order_relaxed);           \
+    atomic_store_explicit(&rb->tail, t + 1u, memory_order_release);                     \
+    return true;                                                                        \
+}                                                                                       \
+                                                                                        \
+/* Items ready to pop (consumer view; a lower bound while the producer pushes). */      \
+static inline uint32_t name##_count(name##_t* rb)                                       \
+{                                                                                       \
+    const uint32_t t = atomic_load_explicit(&rb->tail, memory_order_relaxed);           \
+    rb->head_cache = atomic_load_explicit(&rb->head, memory_order_acquire);             \
+    return rb->head_cache - t;                                                          \
+}                                                                                       \
+                                                                                        \
+/* Free slots (producer view; a lower bound while the consumer pops). */                \
+static inline uint32_t name##_free(name##_t* rb)                                        \
+{                                                                                       \
+    const uint32_t h = atomic_load_explicit(&rb->head, memory_order_relaxed);           \
+    rb->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);             \
+    return (rb->mask + 1u) - (h - rb->tail_cache);                                      \
+}                                                                                       \
+                                                                                        \
+/* True if a push would fail now (producer). Only re-reads tail when the cached         \
+ * copy says full, so it is as cheap as push on the common path.                        \
+ */                                                                                     \
+static inline bool name##_is_full(name##_t* rb)                                         \
+{                                                                                       \
+    const uint32_t h = atomic_load_explicit(&rb->head, memory_order_relaxed);           \
+    if (h - rb->tail_cache <= rb->mask) return false;                                   \
+    rb->tail_cache = atomic_load_explicit(&rb->tail, memory_order_acquire);             \
+    return h - rb->tail_cache > rb->mask;                                               \
+}                                                                                       \
+                                                                                        \
+/* Split n slots starting at counter idx into the piece up to the end of the           \
+ * storage and the piece wrapped to index 0.                                            \
+ */                                                                                     \
+static inline void name##_span_fill(const name##_t* rb, uint32_t idx, uint32_t n,       \
+                                    name##_span_t* span)                                \
+{                                                                                       \
+    const uint32_t i0 = idx & rb->mask;                                                 \
+    const uint32_t to_end = (rb->mask + 1u) - i0;                                       \
+    span->ptr[0] = &rb->buf[i0];                                                        \
+    span->len[0] = (n < to_end) ? n : to_end;                                           \
+    span->ptr[1] = rb->buf;                                                             \
+    span->len[1] = n - span->len[0];                                                    \
+}                                                                                       \
+                                                                                        \
+/* Expose the free slots (producer). Returns the span total. */                         \
+static inline uint32_t name##_write_claim(name##_t* rb, name##_span_t* span)            \
+{                                                                                       \
+    const uint32_t n = name##_free(rb);                                                 \
+    name##_span_fill(rb, atomic_load_explicit(&rb->head, memory_order_relaxed), n, span); \
+    return n;                                                                           \
+}                                                                                       \
+                                                                                        \
+/* Publish the first n claimed slots (producer). */                                     \
+static inline void name##_write_commit(name##_t* rb, uint32_t n)                        \
+{                                                                                       \
+    const uint32_t h = atomic_load_explicit(&rb->head, memory_order_relaxed);           \
+    const uint32_t room = (rb->mask + 1u) - (h - rb->tail_cache);                       \
+    if (n > room) n = room;                                                             \
+    atomic_store_explicit(&rb->head, h + n, memory_order_release);                      \
+}                                                                                       \
+                                                                                        \
+/* Expose the stored items (consumer). Returns the span total. */                       \
+static inline uint32_t name##_read_claim(name##_t* rb, name##_span_t* span)             \
+{                                                                                       \
+    const uint32_t n = name##_count(rb);                                                \
+    name##_span_fill(rb, atomic_load_explicit(&rb->tail, memory_order_relaxed), n, span); \
+    return n;                                                                           \
+}                                                                                       \
+                                                                                        \
+/* Release the first n claimed items (consumer). */                                     \
+static inline void name##_read_commit(name##_t* rb, uint32_t n)                         \
+{                                                                                       \
+    const uint32_t t = atomic_load_explicit(&rb->tail, memory_order_relaxed);           \
+    const uint32_t avail = rb->head_cache - t;                                          \
+    if (n > avail) n = avail;                                                           \
+    atomic_store_explicit(&rb->tail, t + n, memory_order_release);                      \
+}
+
+/* 32-bit items (raw words between cores). */
+SPSC_RING_DEFINE(spsc_ring_u32, uint32_t)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SPSC_RING_H */
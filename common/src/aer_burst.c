@@ -1,4 +1,5 @@
 #include "aer_burst.h"
+#include "aer_codec_lut.h"
 
 static inline uint8_t aer_payload_to_index(uint8_t payload)
 {
@@ -7,15 +8,31 @@ static inline uint8_t aer_payload_to_index(uint8_t payload)
     return (uint8_t)(payload & mask);
 }
 
+/* Drop buffered columns of the current burst. */
+static inline void aer_burst_clear_cols(aer_burst_t* b)
+{
+#if AER_BURST_COL_BITMASK
+    for (uint32_t w = 0u; w < AER_BURST_COL_MASK_WORDS; ++w) {
+        b->col_mask[w] = 0u;
+    }
+#endif
+    b->col_count = 0u;
+    b->cols_dropped = 0u;
+}
+
 void aer_burst_init(aer_burst_t* b)
 {
     if (!b) return;
     b->state = AER_BURST_EXPECT_ROW;
     b->row = 0u;
-    b->col_count = 0u;
+    b->timed = false;
+    b->t_row = 0u;
+    aer_burst_clear_cols(b);
     b->err_flags = AER_BURST_ERR_NONE;
     b->bursts_completed = 0u;
     b->events_emitted = 0u;
+    b->words_ignored = 0u;
+    b->cols_dropped_total = 0u;
 }
 
 void aer_burst_reset(aer_burst_t* b, bool clear_counters)
@@ -23,82 +40,127 @@ void aer_burst_reset(aer_burst_t* b, bool clear_counters)
     if (!b) return;
     b->state = AER_BURST_EXPECT_ROW;
     b->row = 0u;
-    b->col_count = 0u;
+    b->timed = false;
+    b->t_row = 0u;
+    aer_burst_clear_cols(b);
     b->err_flags = AER_BURST_ERR_NONE;
 
     if (clear_counters) {
         b->bursts_completed = 0u;
         b->events_emitted = 0u;
+        b->words_ignored = 0u;
+        b->cols_dropped_total = 0u;
+    }
+}
+
+void aer_burst_span_to_events(uint8_t row,
+                              const uint8_t* cols,
+                              uint16_t count,
+                              const aer_burst_info_t* info,
+                              void* user)
+{
+    (void)info;
+    const aer_burst_event_adapter_t* a = (const aer_burst_event_adapter_t*)user;
+    if (!a || !a->cb) return;
+
+    for (uint16_t i = 0u; i < count; ++i) {
+        a->cb(row, cols[i], a->user);
     }
 }
 
-/* Emit buffered events, then clear buffer for next burst. */
-static uint16_t aer_emit_and_clear(aer_burst_t* b, aer_event_cb_t cb, void* user)
+/* Emit buffered burst, then clear buffer for next burst. */
+static uint16_t aer_emit_and_clear(aer_burst_t* b, uint32_t t_tail, aer_burst_cb_t cb, void* user)
 {
-    uint16_t emitted = 0u;
+    /* If no callback provided, we still "emit" conceptually (count them). */
+    const uint16_t emitted = b->col_count;
+
     if (cb) {
-        for (uint16_t i = 0u; i < b->col_count; ++i) {
-            cb(b->row, b->cols[i], user);
-            ++emitted;
-        }
-    } else {
-        /* If no callback provided, we still "emit" conceptually (count them). */
-        emitted = b->col_count;
+        aer_burst_info_t info = {
+            .seq          = b->bursts_completed,
+            .err_flags    = b->err_flags,
+            .cols_dropped = b->cols_dropped,
+            .col_mask     = NULL,
+            .timed        = b->timed,
+            .t_row        = b->timed ? b->t_row : 0u,
+            .t_tail       = b->timed ? t_tail : 0u,
+            .col_t        = NULL,
+        };
+#if AER_BURST_COL_BITMASK
+        uint8_t cols[AER_COLS];
+        (void)aer_burst_mask_to_cols(b->col_mask, cols);
+        info.col_mask = b->col_mask;
+        cb(b->row, cols, emitted, &info, user);
+#else
+        if (b->timed) info.col_t = b->col_t;
+        cb(b->row, b->cols, emitted, &info, user);
+#endif
     }
 
     b->events_emitted += emitted;
-    b->col_count = 0u;
+    aer_burst_clear_cols(b);
     return emitted;
 }
 
-uint16_t aer_burst_feed(aer_burst_t* b,
-                        aer_codec_result_t word,
-                        aer_event_cb_t emit_cb,
-                        void* user)
+/* Tailword: ends the current burst (if any). t is its latch time (timed feeds). */
+static inline uint16_t aer_burst_on_tail(aer_burst_t* b, uint32_t t, aer_burst_cb_t emit_cb, void* user)
 {
-    if (!b) return 0u;
-
-    /* Ignore invalid/neutral/malformed words (codec layer decides ok). */
-    if (!word.ok) {
+    if (b->state == AER_BURST_EXPECT_ROW) {
+        /* Only parser error we can detect per spec. */
+        b->err_flags |= AER_BURST_ERR_TAIL_WITHOUT_ROW;
+        /* Stay in EXPECT_ROW; nothing to emit. */
         return 0u;
     }
 
-    /* Tailword ends the current burst (if any). */
-    if (word.is_tail) {
-        if (b->state == AER_BURST_EXPECT_ROW) {
-            /* Only parser error we can detect per spec. */
-            b->err_flags |= AER_BURST_ERR_TAIL_WITHOUT_ROW;
-            /* Stay in EXPECT_ROW; nothing to emit. */
-            return 0u;
-        }
-
-        /* End burst: emit buffered (row,col) events. */
-        const uint16_t emitted = aer_emit_and_clear(b, emit_cb, user);
-        b->bursts_completed += 1u;
-
-        /* Return to expecting the next row. */
-        b->state = AER_BURST_EXPECT_ROW;
-        return emitted;
-    }
+    /* End burst: emit buffered (row,col) events. */
+    const uint16_t emitted = aer_emit_and_clear(b, t, emit_cb, user);
+    b->bursts_completed += 1u;
 
-    /* Non-tail payload: interpret as row or col depending on state. */
-    const uint8_t idx = aer_payload_to_index(word.payload);
+    /* Return to expecting the next row. */
+    b->state = AER_BURST_EXPECT_ROW;
+    return emitted;
+}
 
+/* Non-tail payload index: interpret as row or col depending on state.
+ * t is the word's latch time; timed says whether the feed carries one. */
+static inline void aer_burst_on_index(aer_burst_t* b, uint8_t idx, bool timed, uint32_t t)
+{
     if (b->state == AER_BURST_EXPECT_ROW) {
         b->row = idx;
+        b->timed = timed;
+        b->t_row = t;
 
         /* Optional range warning (useful in debug). */
         if ((uint32_t)b->row >= (uint32_t)AER_ROWS) {
             b->err_flags |= AER_BURST_WARN_ROW_OOR;
         }
 
-        b->col_count = 0u;
+        aer_burst_clear_cols(b);
         b->state = AER_BURST_EXPECT_COL_OR_TAIL;
-        return 0u;
+        return;
     }
 
+#if AER_BURST_COL_BITMASK
+    /* EXPECT_COL_OR_TAIL: set column bit (repeats merge, no overflow possible) */
+    if ((uint32_t)idx >= (uint32_t)AER_COLS) {
+        /* No bit to record it in. */
+        b->err_flags |= AER_BURST_WARN_COL_OOR;
+        b->cols_dropped += 1u;
+        b->cols_dropped_total += 1u;
+        return;
+    }
+
+    uint32_t* w = &b->col_mask[idx >> 5];
+    const uint32_t bit = 1u << (idx & 31u);
+    if ((*w & bit) != 0u) {
+        b->err_flags |= AER_BURST_WARN_COL_DUP;
+        return;
+    }
+    *w |= bit;
+    b->col_count += 1u;
+#else
     /* EXPECT_COL_OR_TAIL: buffer column */
     if (b->col_count < (uint16_t)AER_COLS) {
+        if (timed) b->col_t[b->col_count] = t;
         b->cols[b->col_count++] = idx;
 
         if ((uint32_t)idx >= (uint32_t)AER_COLS) {
@@ -107,7 +169,129 @@ uint16_t aer_burst_feed(aer_burst_t* b,
     } else {
         /* Buffer overflow: keep collecting protocol state, but drop extra cols. */
         b->err_flags |= AER_BURST_WARN_COL_OVERFLOW;
+        b->cols_dropped += 1u;
+        b->cols_dropped_total += 1u;
     }
+#endif
+}
 
+uint16_t aer_burst_feed_span(aer_burst_t* b,
+                             aer_codec_result_t word,
+                             aer_burst_cb_t burst_cb,
+                             void* user)
+{
+    if (!b) return 0u;
+
+    /* Ignore invalid/neutral/malformed words (codec layer decides ok). */
+    if (!word.ok) {
+        b->words_ignored += 1u;
+        return 0u;
+    }
+
+    if (word.is_tail) {
+        return aer_burst_on_tail(b, 0u, burst_cb, user);
+    }
+
+    aer_burst_on_index(b, aer_payload_to_index(word.payload), false, 0u);
     return 0u;
 }
+
+/* One raw word through the fused path (b already checked). timed/t as for
+ * aer_burst_on_index(); constant false on the untimed paths. */
+static inline uint16_t aer_burst_step_raw(aer_burst_t* b,
+                                          aer_raw_word_t raw,
+                                          bool timed,
+                                          uint32_t t,
+                                          aer_burst_cb_t burst_cb,
+                                          void* user)
+{
+#if AER_CODEC_USE_LUT
+    /* The table entry already encodes the action: !ok => INVALID, tail bit =>
+     * TAIL, otherwise the low payload bits are the row/col index. Bits above
+     * AER_RAW_MASK only raise OUT_OF_RANGE, which never affects ok.
+     */
+    const uint32_t e = aer_codec_lut_entry(raw);
+
+    if ((e & AER_LUT_F_OK) == 0u) {
+        b->words_ignored += 1u;
+        return 0u;
+    }
+    if ((e & AER_LUT_F_TAIL) != 0u) {
+        return aer_burst_on_tail(b, t, burst_cb, user);
+    }
+
+    aer_burst_on_index(b, aer_payload_to_index((uint8_t)(e & AER_LUT_PAYLOAD_MASK)), timed, t);
+    return 0u;
+#else
+    const aer_codec_result_t word = aer_decode_word(raw);
+    if (!word.ok) {
+        b->words_ignored += 1u;
+        return 0u;
+    }
+    if (word.is_tail) {
+        return aer_burst_on_tail(b, t, burst_cb, user);
+    }
+    aer_burst_on_index(b, aer_payload_to_index(word.payload), timed, t);
+    return 0u;
+#endif
+}
+
+uint16_t aer_burst_feed_raw_span(aer_burst_t* b,
+                                 aer_raw_word_t raw,
+                                 aer_burst_cb_t burst_cb,
+                                 void* user)
+{
+    if (!b) return 0u;
+    return aer_burst_step_raw(b, raw, false, 0u, burst_cb, user);
+}
+
+uint32_t aer_burst_feed_raw_words_span(aer_burst_t* b,
+                                       const aer_raw_word_t* words,
+                                       size_t n,
+                                       aer_burst_cb_t burst_cb,
+                                       void* user)
+{
+    if (!b || !words) return 0u;
+
+    uint32_t emitted = 0u;
+    for (size_t i = 0u; i < n; ++i) {
+        emitted += aer_burst_step_raw(b, words[i], false, 0u, burst_cb, user);
+    }
+    return emitted;
+}
+
+uint32_t aer_burst_feed_raw_words_ts_span(aer_burst_t* b,
+                                          const aer_raw_word_t* words,
+                                          const uint32_t* ts,
+                                          size_t n,
+                                          aer_burst_cb_t burst_cb,
+                                          void* user)
+{
+    if (!ts) return aer_burst_feed_raw_words_span(b, words, n, burst_cb, user);
+    if (!b || !words) return 0u;
+
+    uint32_t emitted = 0u;
+    for (size_t i = 0u; i < n; ++i) {
+        emitted += aer_burst_step_raw(b, words[i], true, ts[i], burst_cb, user);
+    }
+    return emitted;
+}
+
+/* Per-event entry points: the span path with the fan-out adapter on top. */
+uint16_t aer_burst_feed(aer_burst_t* b,
+                        aer_codec_result_t word,
+                        aer_event_cb_t emit_cb,
+                        void* user)
+{
+    aer_burst_event_adapter_t a = { emit_cb, user };
+    return aer_burst_feed_span(b, word, emit_cb ? aer_burst_span_to_events : NULL, &a);
+}
+
+uint16_t aer_burst_feed_raw(aer_burst_t* b,
+                            aer_raw_word_t raw,
+                            aer_event_cb_t emit_cb,
+                            void* user)
+{
+    aer_burst_event_adapter_t a = { emit_cb, user };
+    return aer_burst_feed_raw_span(b, raw, emit_cb ? aer_burst_span_to_events : NULL, &a);
+}
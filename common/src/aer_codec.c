@@ -1,4 +1,5 @@
 #include "aer_codec.h"
+#include "aer_codec_lut.h"
 
 /* --------- internal helpers --------- */
 
@@ -30,9 +31,43 @@ static inline uint32_t ctz4(uint32_t x)
     return 3u; /* assumes x & 0x8 */
 }
 
+/* --------- lookup table --------- */
+
+#if AER_CODEC_LUT_AVAILABLE
+const uint16_t aer_codec_lut[AER_LUT_SIZE] = AER_LUT_INITIALIZER;
+#endif
+
 /* --------- public API --------- */
 
 aer_codec_result_t aer_decode_word(aer_raw_word_t raw)
+{
+#if AER_CODEC_USE_LUT
+    return aer_decode_word_lut(raw);
+#else
+    return aer_decode_word_loop(raw);
+#endif
+}
+
+#if AER_CODEC_LUT_AVAILABLE
+aer_codec_result_t aer_decode_word_lut(aer_raw_word_t raw)
+{
+    const uint32_t e = aer_codec_lut_entry(raw);
+
+    aer_codec_result_t r;
+    r.ok        = (e & AER_LUT_F_OK) != 0u;
+    r.payload   = (uint8_t)(e & AER_LUT_PAYLOAD_MASK);
+    r.is_tail   = (e & AER_LUT_F_TAIL) != 0u;
+    r.err_flags = e >> AER_LUT_ERR_SHIFT;
+
+    /* Out-of-range bits are not part of the table index. */
+    if ((raw & ~(aer_raw_word_t)AER_RAW_MASK) != 0u) {
+        r.err_flags |= AER_CODEC_ERR_OUT_OF_RANGE;
+    }
+    return r;
+}
+#endif
+
+aer_codec_result_t aer_decode_word_loop(aer_raw_word_t raw)
 {
     aer_codec_result_t r;
     r.ok = false;
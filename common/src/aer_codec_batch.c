@@ -0,0 +1,472 @@
+#include "aer_codec.h"
+#include "aer_codec_lut.h"
+
+#include <stddef.h>
+
+/*
+ * Batch decode paths.
+ *
+ * Scalar: one aer_decode_word() (or table entry) per word.
+ *
+ * SIMD (x86 hosts): every 32-bit lane runs the same SWAR validation over its
+ * nibbles, so 4 (SSE2) or 8 (AVX2) words are checked per instruction:
+ *   L  = 0x...111 (one bit per group), H = 8*L (group MSBs), M7 = 7*L
+ *   nz(v)   = (((v & M7) + M7) | v) & H     MSB set per non-zero group
+ *   zero    = ~nz(x) & H                    zero-hot groups
+ *   y       = x | (zero >> 3)               make zero groups one-hot (no borrows below)
+ *   multi   = nz(y & (y - L))               multi-hot groups
+ *   v       = x with bad groups cleared     one-hot groups only
+ *   symbol  = ((v >> 1) & M7) - ((v >> 3) & L)   maps 1,2,4,8 -> 0,1,2,3 per group
+ *   payload = symbols compacted from 4-bit to 2-bit spacing (log2(groups) steps)
+ * This reproduces aer_decode_word_loop() exactly, including the partial
+ * payload reported for invalid words.
+ */
+
+#define AER_SWAR_L        ((uint32_t)AER_RAW_MASK / 0xFu)
+#define AER_SWAR_H        (AER_SWAR_L * 0x8u)
+#define AER_SWAR_M7       (AER_SWAR_L * 0x7u)
+#define AER_SWAR_PAD_MASK (((1u << AER_PAYLOAD_BITS) - 1u) & ~((1u << AER_INDEX_BITS) - 1u))
+
+#if !defined(AER_CODEC_BATCH_NO_SIMD) && defined(__GNUC__) && \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define AER_CODEC_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define AER_CODEC_BATCH_X86 0
+#endif
+
+/* The SIMD AoS store writes whole 8-byte results; only valid for this layout. */
+#define AER_CODEC_RESULT_PACKED8 \
+    (sizeof(aer_codec_result_t) == 8u && sizeof(bool) == 1u && \
+     offsetof(aer_codec_result_t, ok) == 0u && \
+     offsetof(aer_codec_result_t, payload) == 1u && \
+     offsetof(aer_codec_result_t, is_tail) == 2u && \
+     offsetof(aer_codec_result_t, err_flags) == 4u)
+
+#if AER_CODEC_USE_LUT
+_Static_assert(AER_LUT_ERR_SHIFT == 8u + AER_CODEC_ST_ERR_SHIFT,
+               "SoA status byte must mirror table entry bits 8..14");
+#endif
+
+/* ---------------- scalar ---------------- */
+
+#if !AER_CODEC_USE_LUT
+static inline uint8_t status_from_result(aer_codec_result_t r)
+{
+    return (uint8_t)((r.ok ? AER_CODEC_ST_OK : 0u) |
+                     (r.is_tail ? AER_CODEC_ST_TAIL : 0u) |
+                     (r.err_flags << AER_CODEC_ST_ERR_SHIFT));
+}
+#endif
+
+static size_t decode_scalar(const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    size_t ok = 0u;
+    for (size_t i = 0u; i < n; ++i) {
+        out[i] = aer_decode_word(in[i]);
+        ok += out[i].ok ? 1u : 0u;
+    }
+    return ok;
+}
+
+static size_t decode_soa_scalar(const aer_raw_word_t* in, size_t n,
+                                uint8_t* out_payload, uint8_t* out_status)
+{
+    size_t ok = 0u;
+    for (size_t i = 0u; i < n; ++i) {
+#if AER_CODEC_USE_LUT
+        /* Entry bits 8..14 are exactly the status byte layout (ok, tail, err << 2). */
+        const uint32_t e = aer_codec_lut_entry(in[i]);
+        uint32_t st = e >> 8;
+        if ((in[i] & ~(aer_raw_word_t)AER_RAW_MASK) != 0u) {
+            st |= (uint32_t)AER_CODEC_ERR_OUT_OF_RANGE << AER_CODEC_ST_ERR_SHIFT;
+        }
+        out_payload[i] = (uint8_t)(e & AER_LUT_PAYLOAD_MASK);
+        out_status[i]  = (uint8_t)st;
+#else
+        const aer_codec_result_t r = aer_decode_word(in[i]);
+        out_payload[i] = r.payload;
+        out_status[i]  = status_from_result(r);
+#endif
+        ok += (out_status[i] & AER_CODEC_ST_OK) ? 1u : 0u;
+    }
+    return ok;
+}
+
+/* ---------------- x86 SIMD ---------------- */
+
+#if AER_CODEC_BATCH_X86
+
+/* SSE2: decode 4 words. out_p = payload lanes, out_err = err lanes, out_ok/out_tail = lane masks. */
+static inline void sse2_decode4(__m128i w,
+                                __m128i* out_p, __m128i* out_err,
+                                __m128i* out_ok, __m128i* out_tail)
+{
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i ones  = _mm_set1_epi32(-1);
+    const __m128i mask  = _mm_set1_epi32((int)AER_RAW_MASK);
+    const __m128i L     = _mm_set1_epi32((int)AER_SWAR_L);
+    const __m128i H     = _mm_set1_epi32((int)AER_SWAR_H);
+    const __m128i M7    = _mm_set1_epi32((int)AER_SWAR_M7);
+
+#define AER_SSE2_NZ(v) _mm_and_si128(_mm_or_si128(_mm_add_epi32(_mm_and_si128((v), M7), M7), (v)), H)
+
+    const __m128i x       = _mm_and_si128(w, mask);
+    const __m128i neutral = _mm_cmpeq_epi32(x, zero);
+
+    const __m128i zg    = _mm_andnot_si128(AER_SSE2_NZ(x), H);
+    const __m128i y     = _mm_or_si128(x, _mm_srli_epi32(zg, 3));
+    const __m128i multi = AER_SSE2_NZ(_mm_and_si128(y, _mm_sub_epi32(y, L)));
+    const __m128i bad   = _mm_or_si128(zg, multi);
+    /* 8 -> 0xF per bad group (8 - 1 = 7 never borrows into the next group). */
+    const __m128i badf  = _mm_or_si128(bad, _mm_sub_epi32(bad, _mm_srli_epi32(bad, 3)));
+    const __m128i v     = _mm_andnot_si128(badf, x);
+
+#undef AER_SSE2_NZ
+
+    __m128i p = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(v, 1), M7),
+                              _mm_and_si128(_mm_srli_epi32(v, 3), L));
+    if (AER_NUM_GROUPS > 1u) {
+        p = _mm_and_si128(_mm_or_si128(p, _mm_srli_epi32(p, 2)), _mm_set1_epi32(0x0F0F0F0F));
+    }
+    if (AER_NUM_GROUPS > 2u) {
+        p = _mm_and_si128(_mm_or_si128(p, _mm_srli_epi32(p, 4)), _mm_set1_epi32(0x00FF00FF));
+    }
+    if (AER_NUM_GROUPS > 4u) {
+        p = _mm_and_si128(_mm_or_si128(p, _mm_srli_epi32(p, 8)), _mm_set1_epi32(0x0000FFFF));
+    }
+
+    const __m128i okv   = _mm_andnot_si128(neutral, _mm_cmpeq_epi32(bad, zero));
+    const __m128i tailv = _mm_and_si128(okv, _mm_cmpeq_epi32(p, _mm_set1_epi32((int)AER_TAIL_PAYLOAD)));
+    const __m128i padv  = _mm_andnot_si128(tailv, _mm_andnot_si128(
+        _mm_cmpeq_epi32(_mm_and_si128(p, _mm_set1_epi32((int)AER_SWAR_PAD_MASK)), zero), okv));
+
+    const __m128i oor   = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_andnot_si128(mask, w), zero), ones);
+
+    __m128i err = _mm_and_si128(neutral, _mm_set1_epi32((int)AER_CODEC_ERR_NEUTRAL));
+    err = _mm_or_si128(err, _mm_and_si128(oor, _mm_set1_epi32((int)AER_CODEC_ERR_OUT_OF_RANGE)));
+    err = _mm_or_si128(err, _mm_andnot_si128(_mm_or_si128(neutral, _mm_cmpeq_epi32(zg, zero)),
+                                             _mm_set1_epi32((int)AER_CODEC_ERR_ZERO_HOT)));
+    err = _mm_or_si128(err, _mm_andnot_si128(_mm_cmpeq_epi32(multi, zero),
+                                             _mm_set1_epi32((int)AER_CODEC_ERR_MULTI_HOT)));
+    err = _mm_or_si128(err, _mm_and_si128(padv, _mm_set1_epi32((int)AER_CODEC_WARN_PAD_BIT_SET)));
+
+    *out_p    = p;
+    *out_err  = err;
+    *out_ok   = okv;
+    *out_tail = tailv;
+}
+
+static inline __m128i sse2_status(__m128i err, __m128i okv, __m128i tailv)
+{
+    const __m128i one = _mm_set1_epi32(1);
+    return _mm_or_si128(_mm_slli_epi32(err, (int)AER_CODEC_ST_ERR_SHIFT),
+                        _mm_or_si128(_mm_and_si128(okv, one),
+                                     _mm_slli_epi32(_mm_and_si128(tailv, one), 1)));
+}
+
+/* okv lanes are all-ones when ok: subtracting them counts ok words per lane. */
+static inline size_t sse2_hsum(__m128i acc)
+{
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)(void*)lanes, acc);
+    return (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+static size_t decode_sse2(const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    if (!AER_CODEC_RESULT_PACKED8) return decode_scalar(in, n, out);
+
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i okacc = _mm_setzero_si128();
+    size_t i = 0u;
+
+    for (; i + 4u <= n; i += 4u) {
+        __m128i p, err, okv, tailv;
+        sse2_decode4(_mm_loadu_si128((const __m128i*)(const void*)&in[i]), &p, &err, &okv, &tailv);
+
+        /* lo = ok | payload << 8 | is_tail << 16; hi = err_flags */
+        const __m128i lo = _mm_or_si128(_mm_and_si128(okv, one),
+                           _mm_or_si128(_mm_slli_epi32(p, 8),
+                                        _mm_slli_epi32(_mm_and_si128(tailv, one), 16)));
+        _mm_storeu_si128((__m128i*)(void*)&out[i],      _mm_unpacklo_epi32(lo, err));
+        _mm_storeu_si128((__m128i*)(void*)&out[i + 2u], _mm_unpackhi_epi32(lo, err));
+        okacc = _mm_sub_epi32(okacc, okv);
+    }
+
+    return sse2_hsum(okacc) + decode_scalar(&in[i], n - i, &out[i]);
+}
+
+static size_t decode_soa_sse2(const aer_raw_word_t* in, size_t n,
+                              uint8_t* out_payload, uint8_t* out_status)
+{
+    __m128i okacc = _mm_setzero_si128();
+    size_t i = 0u;
+
+    for (; i + 16u <= n; i += 16u) {
+        __m128i p[4], st[4];
+        for (uint32_t k = 0u; k < 4u; ++k) {
+            __m128i err, okv, tailv;
+            sse2_decode4(_mm_loadu_si128((const __m128i*)(const void*)&in[i + 4u * k]),
+                         &p[k], &err, &okv, &tailv);
+            st[k] = sse2_status(err, okv, tailv);
+            okacc = _mm_sub_epi32(okacc, okv);
+        }
+        /* Values are < 128, so signed/unsigned saturating packs are lossless. */
+        _mm_storeu_si128((__m128i*)(void*)&out_payload[i],
+                         _mm_packus_epi16(_mm_packs_epi32(p[0], p[1]), _mm_packs_epi32(p[2], p[3])));
+        _mm_storeu_si128((__m128i*)(void*)&out_status[i],
+                         _mm_packus_epi16(_mm_packs_epi32(st[0], st[1]), _mm_packs_epi32(st[2], st[3])));
+    }
+
+    return sse2_hsum(okacc) + decode_soa_scalar(&in[i], n - i, &out_payload[i], &out_status[i]);
+}
+
+/* AVX2: same kernel on 8 lanes; compiled for avx2 and only called after a CPU check. */
+#define AER_AVX2 __attribute__((target("avx2")))
+
+AER_AVX2 static inline void avx2_decode8(__m256i w,
+                                         __m256i* out_p, __m256i* out_err,
+                                         __m256i* out_ok, __m256i* out_tail)
+{
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i ones  = _mm256_set1_epi32(-1);
+    const __m256i mask  = _mm256_set1_epi32((int)AER_RAW_MASK);
+    const __m256i L     = _mm256_set1_epi32((int)AER_SWAR_L);
+    const __m256i H     = _mm256_set1_epi32((int)AER_SWAR_H);
+    const __m256i M7    = _mm256_set1_epi32((int)AER_SWAR_M7);
+
+#define AER_AVX2_NZ(v) _mm256_and_si256(_mm256_or_si256(_mm256_add_epi32(_mm256_and_si256((v), M7), M7), (v)), H)
+
+    const __m256i x       = _mm256_and_si256(w, mask);
+    const __m256i neutral = _mm256_cmpeq_epi32(x, zero);
+
+    const __m256i zg    = _mm256_andnot_si256(AER_AVX2_NZ(x), H);
+    const __m256i y     = _mm256_or_si256(x, _mm256_srli_epi32(zg, 3));
+    const __m256i multi = AER_AVX2_NZ(_mm256_and_si256(y, _mm256_sub_epi32(y, L)));
+    const __m256i bad   = _mm256_or_si256(zg, multi);
+    const __m256i badf  = _mm256_or_si256(bad, _mm256_sub_epi32(bad, _mm256_srli_epi32(bad, 3)));
+    const __m256i v     = _mm256_andnot_si256(badf, x);
+
+#undef AER_AVX2_NZ
+
+    __m256i p = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(v, 1), M7),
+                                 _mm256_and_si256(_mm256_srli_epi32(v, 3), L));
+    if (AER_NUM_GROUPS > 1u) {
+        p = _mm256_and_si256(_mm256_or_si256(p, _mm256_srli_epi32(p, 2)), _mm256_set1_epi32(0x0F0F0F0F));
+    }
+    if (AER_NUM_GROUPS > 2u) {
+        p = _mm256_and_si256(_mm256_or_si256(p, _mm256_srli_epi32(p, 4)), _mm256_set1_epi32(0x00FF00FF));
+    }
+    if (AER_NUM_GROUPS > 4u) {
+        p = _mm256_and_si256(_mm256_or_si256(p, _mm256_srli_epi32(p, 8)), _mm256_set1_epi32(0x0000FFFF));
+    }
+
+    const __m256i okv   = _mm256_andnot_si256(neutral, _mm256_cmpeq_epi32(bad, zero));
+    const __m256i tailv = _mm256_and_si256(okv, _mm256_cmpeq_epi32(p, _mm256_set1_epi32((int)AER_TAIL_PAYLOAD)));
+    const __m256i padv  = _mm256_andnot_si256(tailv, _mm256_andnot_si256(
+        _mm256_cmpeq_epi32(_mm256_and_si256(p, _mm256_set1_epi32((int)AER_SWAR_PAD_MASK)), zero), okv));
+
+    const __m256i oor   = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_andnot_si256(mask, w), zero), ones);
+
+    __m256i err = _mm256_and_si256(neutral, _mm256_set1_epi32((int)AER_CODEC_ERR_NEUTRAL));
+    err = _mm256_or_si256(err, _mm256_and_si256(oor, _mm256_set1_epi32((int)AER_CODEC_ERR_OUT_OF_RANGE)));
+    err = _mm256_or_si256(err, _mm256_andnot_si256(_mm256_or_si256(neutral, _mm256_cmpeq_epi32(zg, zero)),
+                                                   _mm256_set1_epi32((int)AER_CODEC_ERR_ZERO_HOT)));
+    err = _mm256_or_si256(err, _mm256_andnot_si256(_mm256_cmpeq_epi32(multi, zero),
+                                                   _mm256_set1_epi32((int)AER_CODEC_ERR_MULTI_HOT)));
+    err = _mm256_or_si256(err, _mm256_and_si256(padv, _mm256_set1_epi32((int)AER_CODEC_WARN_PAD_BIT_SET)));
+
+    *out_p    = p;
+    *out_err  = err;
+    *out_ok   = okv;
+    *out_tail = tailv;
+}
+
+AER_AVX2 static inline size_t avx2_hsum(__m256i acc)
+{
+    return sse2_hsum(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+}
+
+AER_AVX2 static size_t decode_avx2(const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    if (!AER_CODEC_RESULT_PACKED8) return decode_scalar(in, n, out);
+
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i okacc = _mm256_setzero_si256();
+    size_t i = 0u;
+
+    for (; i + 8u <= n; i += 8u) {
+        __m256i p, err, okv, tailv;
+        avx2_decode8(_mm256_loadu_si256((const __m256i*)(const void*)&in[i]), &p, &err, &okv, &tailv);
+
+        const __m256i lo = _mm256_or_si256(_mm256_and_si256(okv, one),
+                           _mm256_or_si256(_mm256_slli_epi32(p, 8),
+                                           _mm256_slli_epi32(_mm256_and_si256(tailv, one), 16)));
+        /* unpack works per 128-bit lane: a = {r0 r1 | r4 r5}, b = {r2 r3 | r6 r7} */
+        const __m256i a = _mm256_unpacklo_epi32(lo, err);
+        const __m256i b = _mm256_unpackhi_epi32(lo, err);
+        _mm256_storeu_si256((__m256i*)(void*)&out[i],      _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i*)(void*)&out[i + 4u], _mm256_permute2x128_si256(a, b, 0x31));
+        okacc = _mm256_sub_epi32(okacc, okv);
+    }
+
+    return avx2_hsum(okacc) + decode_sse2(&in[i], n - i, &out[i]);
+}
+
+AER_AVX2 static inline __m256i avx2_pack_bytes(const __m256i v[4])
+{
+    /* packs/packus interleave per 128-bit lane; the permute restores word order. */
+    const __m256i ab = _mm256_packs_epi32(v[0], v[1]);
+    const __m256i cd = _mm256_packs_epi32(v[2], v[3]);
+    const __m256i bytes = _mm256_packus_epi16(ab, cd);
+    return _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+AER_AVX2 static size_t decode_soa_avx2(const aer_raw_word_t* in, size_t n,
+                                       uint8_t* out_payload, uint8_t* out_status)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i okacc = _mm256_setzero_si256();
+    size_t i = 0u;
+
+    for (; i + 32u <= n; i += 32u) {
+        __m256i p[4], st[4];
+        for (uint32_t k = 0u; k < 4u; ++k) {
+            __m256i err, okv, tailv;
+            avx2_decode8(_mm256_loadu_si256((const __m256i*)(const void*)&in[i + 8u * k]),
+                         &p[k], &err, &okv, &tailv);
+            st[k] = _mm256_or_si256(_mm256_slli_epi32(err, (int)AER_CODEC_ST_ERR_SHIFT),
+                                    _mm256_or_si256(_mm256_and_si256(okv, one),
+                                                    _mm256_slli_epi32(_mm256_and_si256(tailv, one), 1)));
+            okacc = _mm256_sub_epi32(okacc, okv);
+        }
+        _mm256_storeu_si256((__m256i*)(void*)&out_payload[i], avx2_pack_bytes(p));
+        _mm256_storeu_si256((__m256i*)(void*)&out_status[i],  avx2_pack_bytes(st));
+    }
+
+    return avx2_hsum(okacc) + decode_soa_sse2(&in[i], n - i, &out_payload[i], &out_status[i]);
+}
+
+static bool cpu_has_avx2(void)
+{
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return cached != 0;
+}
+
+#endif /* AER_CODEC_BATCH_X86 */
+
+/* ---------------- dispatch ---------------- */
+
+bool aer_codec_batch_impl_available(aer_codec_batch_impl_t impl)
+{
+    switch (impl) {
+        case AER_CODEC_BATCH_AUTO:
+        case AER_CODEC_BATCH_SCALAR:
+            return true;
+#if AER_CODEC_BATCH_X86
+        case AER_CODEC_BATCH_SSE2:
+            return true;
+        case AER_CODEC_BATCH_AVX2:
+            return cpu_has_avx2();
+#endif
+        default:
+            return false;
+    }
+}
+
+aer_codec_batch_impl_t aer_codec_batch_impl_active(void)
+{
+    if (aer_codec_batch_impl_available(AER_CODEC_BATCH_AVX2)) return AER_CODEC_BATCH_AVX2;
+    if (aer_codec_batch_impl_available(AER_CODEC_BATCH_SSE2)) return AER_CODEC_BATCH_SSE2;
+    return AER_CODEC_BATCH_SCALAR;
+}
+
+aer_codec_batch_impl_t aer_codec_batch_soa_impl_active(void)
+{
+    /* The scalar SoA path is one table load and two byte stores per word; the
+     * SIMD kernels spend their gain narrowing lanes to bytes (bench_codec). */
+#if AER_CODEC_USE_LUT
+    return AER_CODEC_BATCH_SCALAR;
+#else
+    return aer_codec_batch_impl_active();
+#endif
+}
+
+static aer_codec_batch_impl_t resolve_impl(aer_codec_batch_impl_t impl, aer_codec_batch_impl_t auto_impl)
+{
+    if (impl == AER_CODEC_BATCH_AUTO) return auto_impl;
+    return aer_codec_batch_impl_available(impl) ? impl : AER_CODEC_BATCH_SCALAR;
+}
+
+/* Per-lane ok counters are 32-bit; chunking keeps them far from wrapping. */
+#define AER_BATCH_CHUNK  ((size_t)1u << 24)
+
+static size_t decode_chunk(aer_codec_batch_impl_t impl,
+                           const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    switch (impl) {
+#if AER_CODEC_BATCH_X86
+        case AER_CODEC_BATCH_AVX2: return decode_avx2(in, n, out);
+        case AER_CODEC_BATCH_SSE2: return decode_sse2(in, n, out);
+#endif
+        default:                   return decode_scalar(in, n, out);
+    }
+}
+
+static size_t decode_soa_chunk(aer_codec_batch_impl_t impl,
+                               const aer_raw_word_t* in, size_t n,
+                               uint8_t* out_payload, uint8_t* out_status)
+{
+    switch (impl) {
+#if AER_CODEC_BATCH_X86
+        case AER_CODEC_BATCH_AVX2: return decode_soa_avx2(in, n, out_payload, out_status);
+        case AER_CODEC_BATCH_SSE2: return decode_soa_sse2(in, n, out_payload, out_status);
+#endif
+        default:                   return decode_soa_scalar(in, n, out_payload, out_status);
+    }
+}
+
+size_t aer_decode_words_impl(aer_codec_batch_impl_t impl,
+                             const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    if (!in || !out) return 0u;
+
+    const aer_codec_batch_impl_t use = resolve_impl(impl, aer_codec_batch_impl_active());
+    size_t ok = 0u;
+    for (size_t i = 0u; i < n; i += AER_BATCH_CHUNK) {
+        const size_t len = (n - i < AER_BATCH_CHUNK) ? (n - i) : AER_BATCH_CHUNK;
+        ok += decode_chunk(use, &in[i], len, &out[i]);
+    }
+    return ok;
+}
+
+size_t aer_decode_words_soa_impl(aer_codec_batch_impl_t impl,
+                                 const aer_raw_word_t* in, size_t n,
+                                 uint8_t* out_payload, uint8_t* out_status)
+{
+    if (!in || !out_payload || !out_status) return 0u;
+
+    const aer_codec_batch_impl_t use = resolve_impl(impl, aer_codec_batch_soa_impl_active());
+    size_t ok = 0u;
+    for (size_t i = 0u; i < n; i += AER_BATCH_CHUNK) {
+        const size_t len = (n - i < AER_BATCH_CHUNK) ? (n - i) : AER_BATCH_CHUNK;
+        ok += decode_soa_chunk(use, &in[i], len, &out_payload[i], &out_status[i]);
+    }
+    return ok;
+}
+
+size_t aer_decode_words(const aer_raw_word_t* in, size_t n, aer_codec_result_t* out)
+{
+    return aer_decode_words_impl(AER_CODEC_BATCH_AUTO, in, n, out);
+}
+
+size_t aer_decode_words_soa(const aer_raw_word_t* in, size_t n,
+                            uint8_t* out_payload, uint8_t* out_status)
+{
+    return aer_decode_words_soa_impl(AER_CODEC_BATCH_AUTO, in, n, out_payload, out_status);
+}
@@ -0,0 +1,110 @@
+#ifndef AER_CODEC_LUT_H
+#define AER_CODEC_LUT_H
+
+/*
+ * AER codec lookup table (private to common/src).
+ *
+ * One uint16_t entry per masked raw word, generated by the preprocessor from
+ * aer_cfg.h so it always matches the active bus geometry:
+ *
+ *   bits  0..7  : payload (same value aer_decode_word_loop() reports, even when !ok)
+ *   bit   8     : ok
+ *   bit   9     : is_tail
+ *   bits 10..14 : aer_codec_err_t flags (OUT_OF_RANGE is never stored; it depends
+ *                 on bits above the mask and is added at lookup time)
+ *
+ * The table has (1 << AER_DATA_WIDTH) entries, so it is only built for buses of
+ * up to AER_CODEC_LUT_MAX_BITS lines (4096 entries / 8 KiB for the 12-line bus).
+ */
+
+#include <stdint.h>
+
+#include "aer_cfg.h"
+#include "aer_codec.h"
+
+#if AER_CODEC_LUT_AVAILABLE
+
+#define AER_LUT_PAYLOAD_MASK  0x00FFu
+#define AER_LUT_F_OK          (1u << 8)
+#define AER_LUT_F_TAIL        (1u << 9)
+#define AER_LUT_ERR_SHIFT     10u
+
+#define AER_LUT_SIZE          (1u << AER_DATA_WIDTH)
+
+extern const uint16_t aer_codec_lut[AER_LUT_SIZE];
+
+/* Table entry for a raw word (bits above AER_RAW_MASK are ignored). */
+static inline uint16_t aer_codec_lut_entry(aer_raw_word_t raw)
+{
+    return aer_codec_lut[raw & (aer_raw_word_t)AER_RAW_MASK];
+}
+
+/* ---------------- compile-time entry generation ----------------
+ * Mirrors aer_decode_word_loop() group by group:
+ * - zero-hot / multi-hot groups set their error flag and contribute no symbol
+ * - valid groups contribute ctz(nibble) at symbol position g
+ * Entries are generated from literal nibbles (n2, n1, n0) to keep the
+ * expansion small; groups at or above AER_NUM_GROUPS are never inspected.
+ */
+#define AER_LUT_GERR(n)        ((n) == 0u ? (uint32_t)AER_CODEC_ERR_ZERO_HOT : \
+                                (((n) & ((n) - 1u)) != 0u ? (uint32_t)AER_CODEC_ERR_MULTI_HOT : 0u))
+#define AER_LUT_GSYM(n)        (((n) & 0x1u) ? 0u : ((n) & 0x2u) ? 1u : ((n) & 0x4u) ? 2u : 3u)
+
+#define AER_LUT_GERR_AT(n, g)  ((g) < AER_NUM_GROUPS ? AER_LUT_GERR(n) : 0u)
+#define AER_LUT_GPAY_AT(n, g)  ((g) < AER_NUM_GROUPS && AER_LUT_GERR(n) == 0u \
+                                ? (AER_LUT_GSYM(n) << (AER_SYMBOL_BITS * (g))) : 0u)
+
+#define AER_LUT_ERRS(n2, n1, n0)    (AER_LUT_GERR_AT(n0, 0u) | AER_LUT_GERR_AT(n1, 1u) | AER_LUT_GERR_AT(n2, 2u))
+#define AER_LUT_PAY(n2, n1, n0)     ((AER_LUT_GPAY_AT(n0, 0u) | AER_LUT_GPAY_AT(n1, 1u) | AER_LUT_GPAY_AT(n2, 2u)) \
+                                     & ((1u << AER_PAYLOAD_BITS) - 1u))
+#define AER_LUT_OK(n2, n1, n0)      (AER_LUT_ERRS(n2, n1, n0) == 0u)
+#define AER_LUT_TAIL(n2, n1, n0)    (AER_LUT_OK(n2, n1, n0) && AER_LUT_PAY(n2, n1, n0) == AER_TAIL_PAYLOAD)
+#define AER_LUT_PAD_MASK            (((1u << AER_PAYLOAD_BITS) - 1u) & ~((1u << AER_INDEX_BITS) - 1u))
+#define AER_LUT_PADW(n2, n1, n0)    (AER_LUT_OK(n2, n1, n0) && !AER_LUT_TAIL(n2, n1, n0) \
+                                     && (AER_LUT_PAY(n2, n1, n0) & AER_LUT_PAD_MASK) != 0u)
+
+/* A neutral word is all-zero in every *active* group; inactive nibbles are
+ * always passed as 0 by the row generators below.
+ */
+#define AER_LUT_ENTRY(n2, n1, n0) (uint16_t)(((n2) | (n1) | (n0)) == 0u \
+    ? ((uint32_t)AER_CODEC_ERR_NEUTRAL << AER_LUT_ERR_SHIFT) \
+    : (AER_LUT_PAY(n2, n1, n0) \
+       | (AER_LUT_OK(n2, n1, n0)   ? AER_LUT_F_OK   : 0u) \
+       | (AER_LUT_TAIL(n2, n1, n0) ? AER_LUT_F_TAIL : 0u) \
+       | ((AER_LUT_ERRS(n2, n1, n0) \
+           | (AER_LUT_PADW(n2, n1, n0) ? (uint32_t)AER_CODEC_WARN_PAD_BIT_SET : 0u)) << AER_LUT_ERR_SHIFT)))
+
+/* 16 entries: n0 = 0..15 */
+#define AER_LUT_ROW16(n2, n1) \
+    AER_LUT_ENTRY(n2, n1, 0u),  AER_LUT_ENTRY(n2, n1, 1u),  AER_LUT_ENTRY(n2, n1, 2u),  AER_LUT_ENTRY(n2, n1, 3u), \
+    AER_LUT_ENTRY(n2, n1, 4u),  AER_LUT_ENTRY(n2, n1, 5u),  AER_LUT_ENTRY(n2, n1, 6u),  AER_LUT_ENTRY(n2, n1, 7u), \
+    AER_LUT_ENTRY(n2, n1, 8u),  AER_LUT_ENTRY(n2, n1, 9u),  AER_LUT_ENTRY(n2, n1, 10u), AER_LUT_ENTRY(n2, n1, 11u), \
+    AER_LUT_ENTRY(n2, n1, 12u), AER_LUT_ENTRY(n2, n1, 13u), AER_LUT_ENTRY(n2, n1, 14u), AER_LUT_ENTRY(n2, n1, 15u)
+
+/* 256 entries: n1 = 0..15 */
+#define AER_LUT_BLK256(n2) \
+    AER_LUT_ROW16(n2, 0u),  AER_LUT_ROW16(n2, 1u),  AER_LUT_ROW16(n2, 2u),  AER_LUT_ROW16(n2, 3u), \
+    AER_LUT_ROW16(n2, 4u),  AER_LUT_ROW16(n2, 5u),  AER_LUT_ROW16(n2, 6u),  AER_LUT_ROW16(n2, 7u), \
+    AER_LUT_ROW16(n2, 8u),  AER_LUT_ROW16(n2, 9u),  AER_LUT_ROW16(n2, 10u), AER_LUT_ROW16(n2, 11u), \
+    AER_LUT_ROW16(n2, 12u), AER_LUT_ROW16(n2, 13u), AER_LUT_ROW16(n2, 14u), AER_LUT_ROW16(n2, 15u)
+
+/* 4096 entries: n2 = 0..15 */
+#define AER_LUT_BLK4096 \
+    AER_LUT_BLK256(0u),  AER_LUT_BLK256(1u),  AER_LUT_BLK256(2u),  AER_LUT_BLK256(3u), \
+    AER_LUT_BLK256(4u),  AER_LUT_BLK256(5u),  AER_LUT_BLK256(6u),  AER_LUT_BLK256(7u), \
+    AER_LUT_BLK256(8u),  AER_LUT_BLK256(9u),  AER_LUT_BLK256(10u), AER_LUT_BLK256(11u), \
+    AER_LUT_BLK256(12u), AER_LUT_BLK256(13u), AER_LUT_BLK256(14u), AER_LUT_BLK256(15u)
+
+#if AER_DATA_WIDTH == 12
+#define AER_LUT_INITIALIZER { AER_LUT_BLK4096 }
+#elif AER_DATA_WIDTH == 8
+#define AER_LUT_INITIALIZER { AER_LUT_BLK256(0u) }
+#elif AER_DATA_WIDTH == 4
+#define AER_LUT_INITIALIZER { AER_LUT_ROW16(0u, 0u) }
+#else
+#error "aer_codec_lut: unsupported AER_DATA_WIDTH for the lookup table"
+#endif
+
+#endif /* AER_CODEC_LUT_AVAILABLE */
+
+#endif /* AER_CODEC_LUT_H */
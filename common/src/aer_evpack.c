@@ -0,0 +1,151 @@
+#include "aer_evpack.h"
+
+#define AER_EVPACK_INDEX_MASK ((1u << AER_INDEX_BITS) - 1u)
+
+static inline size_t varint_len(uint32_t v)
+{
+    size_t n = 1u;
+    while (v >= 0x80u) {
+        v >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+static inline size_t varint_put(uint8_t* p, uint32_t v)
+{
+    size_t n = 0u;
+    while (v >= 0x80u) {
+        p[n++] = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline void put_u32le(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t get_u32le(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void aer_evpack_enc_init(aer_evpack_enc_t* enc, uint8_t* buf, size_t cap, uint32_t anchor_every)
+{
+    if (!enc) return;
+    enc->buf = buf;
+    enc->cap = buf ? cap : 0u;
+    enc->blk_limit = (anchor_every == 0u || anchor_every > AER_EVPACK_BLOCK_MAX)
+                   ? (uint8_t)AER_EVPACK_BLOCK_MAX : (uint8_t)anchor_every;
+    aer_evpack_enc_reset(enc);
+}
+
+void aer_evpack_enc_reset(aer_evpack_enc_t* enc)
+{
+    if (!enc) return;
+    enc->len = 0u;
+    enc->blk_hdr = 0u;
+    enc->blk_open = false;
+    enc->blk_count = 0u;
+    enc->t_prev = 0u;
+    enc->events = 0u;
+    enc->anchors = 0u;
+}
+
+bool aer_evpack_enc_put(aer_evpack_enc_t* enc, uint8_t row, uint8_t col, uint32_t t_ticks)
+{
+    if (!enc || !enc->buf) return false;
+
+    const uint32_t addr = (((uint32_t)row & AER_EVPACK_INDEX_MASK) << AER_INDEX_BITS)
+                        | ((uint32_t)col & AER_EVPACK_INDEX_MASK);
+
+    /* Wrap-safe delta; a timestamp that went backwards shows up as a huge dt. */
+    const uint32_t dt = t_ticks - enc->t_prev;
+    const bool reuse = enc->blk_open
+                    && enc->blk_count < enc->blk_limit
+                    && dt <= AER_EVPACK_MAX_DELTA;
+
+    if (reuse) {
+        const uint32_t v = (dt << AER_EVPACK_ADDR_BITS) | addr;
+        if (enc->len + varint_len(v) > enc->cap) return false;
+        enc->len += varint_put(&enc->buf[enc->len], v);
+        enc->buf[enc->blk_hdr + 1u] = ++enc->blk_count;
+    } else {
+        /* New anchor at this event's time: its own delta is 0. */
+        if (enc->len + AER_EVPACK_BLOCK_HDR + varint_len(addr) > enc->cap) return false;
+        uint8_t* h = &enc->buf[enc->len];
+        h[0] = (uint8_t)AER_EVPACK_REC_DELTA;
+        h[1] = 1u;
+        put_u32le(&h[2], t_ticks);
+        enc->blk_hdr = enc->len;
+        enc->blk_open = true;
+        enc->blk_count = 1u;
+        enc->anchors++;
+        enc->len += AER_EVPACK_BLOCK_HDR;
+        enc->len += varint_put(&enc->buf[enc->len], addr);
+    }
+
+    enc->t_prev = t_ticks;
+    enc->events++;
+    return true;
+}
+
+bool aer_evpack_decode(const uint8_t* buf, size_t len,
+                       aer_evpack_event_t* out, size_t max_out, size_t* n_out)
+{
+    size_t n = 0u;
+    size_t i = 0u;
+    bool ok = (buf != NULL) || (len == 0u);
+
+    while (ok && i < len) {
+        if (buf[i] != (uint8_t)AER_EVPACK_REC_DELTA || i + AER_EVPACK_BLOCK_HDR > len) {
+            ok = false;
+            break;
+        }
+        const uint32_t count = buf[i + 1u];
+        uint32_t t = get_u32le(&buf[i + 2u]);
+        i += AER_EVPACK_BLOCK_HDR;
+
+        if (count == 0u) {
+            ok = false;
+            break;
+        }
+
+        for (uint32_t k = 0u; k < count; ++k) {
+            /* LEB128, at most 5 bytes for a 32-bit value. */
+            uint32_t v = 0u;
+            uint32_t shift = 0u;
+            bool done = false;
+            while (i < len && shift < 35u) {
+                const uint8_t byte = buf[i++];
+                v |= (uint32_t)(byte & 0x7Fu) << shift;
+                shift += 7u;
+                if ((byte & 0x80u) == 0u) {
+                    done = true;
+                    break;
+                }
+            }
+            if (!done) {
+                ok = false;
+                break;
+            }
+
+            t += v >> AER_EVPACK_ADDR_BITS;
+            if (out && n < max_out) {
+                out[n].row = (uint8_t)((v >> AER_INDEX_BITS) & AER_EVPACK_INDEX_MASK);
+                out[n].col = (uint8_t)(v & AER_EVPACK_INDEX_MASK);
+                out[n].t_ticks = t;
+            }
+            ++n;
+        }
+    }
+
+    if (n_out) *n_out = n;
+    return ok;
+}
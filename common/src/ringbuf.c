@@ -1,5 +1,8 @@
 #include "ringbuf.h"
 
+#include <stddef.h>
+#include <string.h>
+
 static inline uint32_t rb_inc(uint32_t idx, uint32_t capacity)
 {
     idx += 1u;
@@ -9,6 +12,31 @@ static inline uint32_t rb_inc(uint32_t idx, uint32_t capacity)
     return idx;
 }
 
+/* ---------------- Instrumentation hooks (producer side) ---------------- */
+
+static inline void rb_stats_publish(ringbuf_u32_t* rb, uint32_t level)
+{
+#if RINGBUF_STATS
+    ringbuf_u32_stats_t* st = &rb->stats;
+    if (level > st->high_water) st->high_water = level;
+    st->hist[ringbuf_stats_bucket(level)]++;
+    st->publishes++;
+#else
+    (void)rb;
+    (void)level;
+#endif
+}
+
+static inline void rb_stats_full(ringbuf_u32_t* rb, uint32_t rejected)
+{
+#if RINGBUF_STATS
+    rb->stats.push_full += rejected;
+#else
+    (void)rb;
+    (void)rejected;
+#endif
+}
+
 bool ringbuf_u32_init(ringbuf_u32_t* rb, uint32_t* storage, uint32_t capacity)
 {
     if (!rb || !storage) {
@@ -23,6 +51,7 @@ bool ringbuf_u32_init(ringbuf_u32_t* rb, uint32_t* storage, uint32_t capacity)
     rb->capacity = capacity;
     rb->head = 0u;
     rb->tail = 0u;
+    ringbuf_u32_stats_reset(rb);
     return true;
 }
 
@@ -70,9 +99,11 @@ bool ringbuf_u32_push(ringbuf_u32_t* rb, uint32_t v)
     if (!rb || !rb->buf) return false;
 
     const uint32_t h = (uint32_t)rb->head;
+    const uint32_t t = (uint32_t)rb->tail;
     const uint32_t next = rb_inc(h, rb->capacity);
 
-    if (next == rb->tail) {
+    if (next == t) {
+        rb_stats_full(rb, 1u);
         return false; /* full */
     }
 
@@ -80,6 +111,7 @@ bool ringbuf_u32_push(ringbuf_u32_t* rb, uint32_t v)
 
     /* Publish the write by advancing head last. */
     rb->head = next;
+    rb_stats_publish(rb, (next >= t) ? (next - t) : (rb->capacity - t + next));
     return true;
 }
 
@@ -111,3 +143,153 @@ bool ringbuf_u32_peek(const ringbuf_u32_t* rb, uint32_t* out)
     *out = rb->buf[t];
     return true;
 }
+
+/* ---------------- Bulk / claim-commit ---------------- */
+
+static inline uint32_t rb_add(uint32_t idx, uint32_t n, uint32_t capacity)
+{
+    idx += n;
+    if (idx >= capacity) {
+        idx -= capacity;
+    }
+    return idx;
+}
+
+static inline void rb_span_empty(ringbuf_u32_span_t* span)
+{
+    span->ptr[0] = NULL;
+    span->ptr[1] = NULL;
+    span->len[0] = 0u;
+    span->len[1] = 0u;
+}
+
+/* Split the n slots starting at idx into the piece up to the end of the
+ * storage and the piece wrapped to index 0.
+ */
+static inline void rb_span_fill(const ringbuf_u32_t* rb, uint32_t idx, uint32_t n,
+                                ringbuf_u32_span_t* span)
+{
+    const uint32_t to_end = rb->capacity - idx;
+    span->ptr[0] = &rb->buf[idx];
+    span->len[0] = (n < to_end) ? n : to_end;
+    span->ptr[1] = rb->buf;
+    span->len[1] = n - span->len[0];
+}
+
+uint32_t ringbuf_u32_write_claim(ringbuf_u32_t* rb, ringbuf_u32_span_t* span)
+{
+    if (!span) return 0u;
+    rb_span_empty(span);
+    if (!rb || !rb->buf) return 0u;
+
+    const uint32_t h = (uint32_t)rb->head;
+    const uint32_t t = (uint32_t)rb->tail;
+    /* One slot is always left empty. */
+    const uint32_t used = (h >= t) ? (h - t) : (rb->capacity - t + h);
+    const uint32_t n = (rb->capacity - 1u) - used;
+
+    if (n != 0u) {
+        rb_span_fill(rb, h, n, span);
+    }
+    return n;
+}
+
+void ringbuf_u32_write_commit(ringbuf_u32_t* rb, uint32_t n)
+{
+    if (!rb || n == 0u) return;
+    const uint32_t room = ringbuf_u32_free(rb);
+    if (n > room) n = room;
+
+    /* Publish the writes by advancing head last. */
+    rb->head = rb_add((uint32_t)rb->head, n, rb->capacity);
+    rb_stats_publish(rb, (rb->capacity - 1u) - room + n);
+}
+
+uint32_t ringbuf_u32_read_claim(ringbuf_u32_t* rb, ringbuf_u32_span_t* span)
+{
+    if (!span) return 0u;
+    rb_span_empty(span);
+    if (!rb || !rb->buf) return 0u;
+
+    const uint32_t t = (uint32_t)rb->tail;
+    const uint32_t h = (uint32_t)rb->head;
+    const uint32_t n = (h >= t) ? (h - t) : (rb->capacity - t + h);
+
+    if (n != 0u) {
+        rb_span_fill(rb, t, n, span);
+    }
+    return n;
+}
+
+void ringbuf_u32_read_commit(ringbuf_u32_t* rb, uint32_t n)
+{
+    if (!rb || n == 0u) return;
+    const uint32_t avail = ringbuf_u32_count(rb);
+    if (n > avail) n = avail;
+
+    /* Consume by advancing tail last. */
+    rb->tail = rb_add((uint32_t)rb->tail, n, rb->capacity);
+}
+
+uint32_t ringbuf_u32_push_n(ringbuf_u32_t* rb, const uint32_t* src, uint32_t n)
+{
+    if (!rb || !src) return 0u;
+
+    ringbuf_u32_span_t span;
+    const uint32_t room = ringbuf_u32_write_claim(rb, &span);
+    if (n > room) {
+        rb_stats_full(rb, n - room);
+        n = room;
+    }
+    if (n == 0u) return 0u;
+
+    const uint32_t n0 = (n < span.len[0]) ? n : span.len[0];
+    memcpy(span.ptr[0], src, n0 * sizeof(uint32_t));
+    if (n > n0) {
+        memcpy(span.ptr[1], &src[n0], (n - n0) * sizeof(uint32_t));
+    }
+
+    ringbuf_u32_write_commit(rb, n);
+    return n;
+}
+
+uint32_t ringbuf_u32_pop_n(ringbuf_u32_t* rb, uint32_t* dst, uint32_t max)
+{
+    if (!dst) return 0u;
+
+    ringbuf_u32_span_t span;
+    const uint32_t avail = ringbuf_u32_read_claim(rb, &span);
+    const uint32_t n = (max < avail) ? max : avail;
+    if (n == 0u) return 0u;
+
+    const uint32_t n0 = (n < span.len[0]) ? n : span.len[0];
+    memcpy(dst, span.ptr[0], n0 * sizeof(uint32_t));
+    if (n > n0) {
+        memcpy(&dst[n0], span.ptr[1], (n - n0) * sizeof(uint32_t));
+    }
+
+    ringbuf_u32_read_commit(rb, n);
+    return n;
+}
+
+/* ---------------- Instrumentation ---------------- */
+
+const ringbuf_u32_stats_t* ringbuf_u32_stats(const ringbuf_u32_t* rb)
+{
+#if RINGBUF_STATS
+    return rb ? &rb->stats : NULL;
+#else
+    (void)rb;
+    return NULL;
+#endif
+}
+
+void ringbuf_u32_stats_reset(ringbuf_u32_t* rb)
+{
+#if RINGBUF_STATS
+    if (!rb) return;
+    memset(&rb->stats, 0, sizeof(rb->stats));
+#else
+    (void)rb;
+#endif
+}
@@ -0,0 +1,229 @@
+/*
+ * host/aer_ctrl_client.c
+ *
+ * usb_ctrl.h command frames and responses, see aer_ctrl_client.h.
+ */
+
+#include "aer_ctrl_client.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const k_param_names[USB_CTRL_P_COUNT] = {
+    [USB_CTRL_P_TIMESTAMPS]            = "timestamps",
+    [USB_CTRL_P_ROWMASK]               = "rowmask",
+    [USB_CTRL_P_RAW_WORDS]             = "raw_words",
+    [USB_CTRL_P_BATCH_MAX_BYTES]       = "batch_max_bytes",
+    [USB_CTRL_P_BATCH_LATENCY_US]      = "batch_latency_us",
+    [USB_CTRL_P_SINK_ENABLED]          = "sink_enabled",
+    [USB_CTRL_P_RX_OVERFLOW]           = "rx_overflow",
+    [USB_CTRL_P_RX_BP_TIMEOUT_US]      = "rx_bp_timeout_us",
+    [USB_CTRL_P_RX_VALID_TIMEOUT_US]   = "rx_valid_timeout_us",
+    [USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US] = "rx_neutral_timeout_us",
+};
+
+static const char *const k_stat_names[USB_CTRL_STATS_COUNTERS] = {
+    [USB_CTRL_STAT_RX_WORDS_OK]         = "rx_words_ok",
+    [USB_CTRL_STAT_RX_DROPPED_FULL]     = "rx_dropped_full",
+    [USB_CTRL_STAT_RX_DROPPED_OLDEST]   = "rx_dropped_oldest",
+    [USB_CTRL_STAT_RX_BP_STALLS]        = "rx_bp_stalls",
+    [USB_CTRL_STAT_RX_BP_TIMEOUTS]      = "rx_bp_timeouts",
+    [USB_CTRL_STAT_RX_TIMEOUTS_VALID]   = "rx_timeouts_valid",
+    [USB_CTRL_STAT_RX_TIMEOUTS_NEUTRAL] = "rx_timeouts_neutral",
+    [USB_CTRL_STAT_BURSTS]              = "bursts",
+    [USB_CTRL_STAT_WORDS_INVALID]       = "words_invalid",
+    [USB_CTRL_STAT_COLS_DROPPED]        = "cols_dropped",
+    [USB_CTRL_STAT_EVENTS_EMITTED]      = "events_emitted",
+    [USB_CTRL_STAT_EVENTS_SEND_FAILED]  = "events_send_failed",
+    [USB_CTRL_STAT_MODE_SWITCHES]       = "mode_switches",
+    [USB_CTRL_STAT_EVENTS_SENT]         = "events_sent",
+    [USB_CTRL_STAT_RAW_WORDS_SENT]      = "raw_words_sent",
+    [USB_CTRL_STAT_RAW_WORDS_DROPPED]   = "raw_words_dropped",
+    [USB_CTRL_STAT_FRAMES_WRITTEN]      = "frames_written",
+    [USB_CTRL_STAT_FRAMES_FAILED]       = "frames_failed",
+    [USB_CTRL_STAT_BYTES_SENT]          = "bytes_sent",
+};
+
+/* Stats body v1: u8 ver, u8 rsvd[3], u64 t_us, u64 t_us_reset, u32 counters[].
+ * v2: u8 ver, u8 n_counters, u8 n_tasks, u8 rsvd, u64 t_us, u64 t_us_reset,
+ *     u32 cycles_hz, u32 counters[n_counters], task[n_tasks]. */
+#define STATS_HDR_LEN_V1 20u
+#define STATS_HDR_LEN    24u
+#define STATS_TASK_LEN   (USB_CTRL_TASK_NAME_LEN + 16u)
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t rd64(const uint8_t *p)
+{
+    return (uint64_t)rd32(p) | ((uint64_t)rd32(p + 4) << 32);
+}
+
+static inline void wr16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void wr32(uint8_t *p, uint32_t v)
+{
+    wr16(p, (uint16_t)v);
+    wr16(p + 2, (uint16_t)(v >> 16));
+}
+
+size_t aer_ctrl_encode(uint8_t *out, uint8_t cmd, uint16_t tag, const void *payload, uint16_t len)
+{
+    if (len > USB_CTRL_MAX_PAYLOAD || (!payload && len != 0u)) return 0u;
+    memcpy(out, "AERC", 4u);
+    out[4] = (uint8_t)USB_CTRL_VER;
+    out[5] = cmd;
+    wr16(&out[6], len);
+    wr16(&out[8], tag);
+    if (len != 0u) memcpy(&out[USB_CTRL_HDR_LEN], payload, len);
+    return USB_CTRL_HDR_LEN + (size_t)len;
+}
+
+size_t aer_ctrl_encode_set(uint8_t *out, uint16_t tag, const aer_ctrl_kv_t *kv, uint32_t n)
+{
+    uint8_t p[USB_CTRL_MAX_PAYLOAD];
+    if (n == 0u || n > USB_CTRL_MAX_PAYLOAD / USB_CTRL_KV_LEN) return 0u;
+    for (uint32_t i = 0u; i < n; ++i) {
+        p[i * USB_CTRL_KV_LEN] = kv[i].key;
+        wr32(&p[i * USB_CTRL_KV_LEN + 1u], kv[i].value);
+    }
+    return aer_ctrl_encode(out, (uint8_t)USB_CTRL_CMD_SET_PARAMS, tag, p, (uint16_t)(n * USB_CTRL_KV_LEN));
+}
+
+bool aer_ctrl_parse_rsp(const uint8_t *payload, uint16_t len, aer_ctrl_rsp_t *rsp)
+{
+    if (len < USB_CTRL_RSP_HDR_LEN || payload[0] != (uint8_t)USB_CTRL_VER) return false;
+    rsp->cmd      = payload[1];
+    rsp->tag      = rd16(&payload[2]);
+    rsp->status   = payload[4];
+    rsp->body     = &payload[USB_CTRL_RSP_HDR_LEN];
+    rsp->body_len = (uint16_t)(len - USB_CTRL_RSP_HDR_LEN);
+    return true;
+}
+
+uint32_t aer_ctrl_rsp_kv(const aer_ctrl_rsp_t *rsp, aer_ctrl_kv_t *kv, uint32_t max)
+{
+    uint32_t n = 0u;
+    for (uint32_t i = 0u; i + USB_CTRL_KV_LEN <= rsp->body_len && n < max; i += USB_CTRL_KV_LEN) {
+        kv[n].key   = rsp->body[i];
+        kv[n].value = rd32(&rsp->body[i + 1u]);
+        n++;
+    }
+    return n;
+}
+
+bool aer_ctrl_rsp_stats(const aer_ctrl_rsp_t *rsp, aer_ctrl_stats_t *st)
+{
+    if (rsp->cmd != (uint8_t)USB_CTRL_CMD_GET_STATS || rsp->status != (uint8_t)USB_CTRL_ST_OK ||
+        rsp->body_len < STATS_HDR_LEN_V1 || (rsp->body[0] != 1u && rsp->body[0] != (uint8_t)USB_CTRL_STATS_VER)) {
+        return false;
+    }
+    const uint8_t *b = rsp->body;
+    memset(st, 0, sizeof(*st));
+    st->ver        = b[0];
+    st->t_us       = rd64(&b[4]);
+    st->t_us_reset = rd64(&b[12]);
+
+    uint32_t hdr = STATS_HDR_LEN_V1;
+    uint32_t n = (uint32_t)(rsp->body_len - STATS_HDR_LEN_V1) / 4u;   /* v1: counters to the end */
+    uint32_t n_tasks = 0u;
+    if (st->ver >= 2u) {
+        hdr = STATS_HDR_LEN;
+        n = b[1];
+        n_tasks = b[2];
+        if (rsp->body_len < hdr + 4u * n + STATS_TASK_LEN * n_tasks) return false;
+        st->cycles_hz = rd32(&b[20]);
+    }
+    /* A newer device may have more counters or tasks; missing ones read 0. */
+    for (uint32_t i = 0u; i < n && i < USB_CTRL_STATS_COUNTERS; ++i) {
+        st->counters[i] = rd32(&b[hdr + 4u * i]);
+    }
+    const uint8_t *t = &b[hdr + 4u * n];
+    for (uint32_t i = 0u; i < n_tasks && i < USB_CTRL_STATS_TASKS_MAX; ++i, t += STATS_TASK_LEN) {
+        aer_ctrl_task_stats_t *o = &st->tasks[i];
+        memcpy(o->name, t, USB_CTRL_TASK_NAME_LEN);
+        o->name[USB_CTRL_TASK_NAME_LEN] = '\0';
+        o->runs         = rd32(&t[USB_CTRL_TASK_NAME_LEN + 0u]);
+        o->overruns     = rd32(&t[USB_CTRL_TASK_NAME_LEN + 4u]);
+        o->cycles_max   = rd32(&t[USB_CTRL_TASK_NAME_LEN + 8u]);
+        o->interval_max = rd32(&t[USB_CTRL_TASK_NAME_LEN + 12u]);
+        st->n_tasks++;
+    }
+    return true;
+}
+
+const char *aer_ctrl_param_name(uint8_t key)
+{
+    return (key < (uint8_t)USB_CTRL_P_COUNT) ? k_param_names[key] : NULL;
+}
+
+int aer_ctrl_param_key(const char *name)
+{
+    for (int k = 0; k < (int)USB_CTRL_P_COUNT; ++k) {
+        if (strcmp(name, k_param_names[k]) == 0) return k;
+    }
+    return -1;
+}
+
+const char *aer_ctrl_status_name(uint8_t status)
+{
+    switch (status) {
+    case USB_CTRL_ST_OK:            return "ok";
+    case USB_CTRL_ST_BAD_FRAME:     return "bad_frame";
+    case USB_CTRL_ST_UNKNOWN_CMD:   return "unknown_cmd";
+    case USB_CTRL_ST_UNKNOWN_PARAM: return "unknown_param";
+    case USB_CTRL_ST_BAD_VALUE:     return "bad_value";
+    case USB_CTRL_ST_UNAVAILABLE:   return "unavailable";
+    default:                        return NULL;
+    }
+}
+
+const char *aer_ctrl_cmd_name(uint8_t cmd)
+{
+    switch (cmd) {
+    case USB_CTRL_CMD_PING:        return "ping";
+    case USB_CTRL_CMD_GET_PARAMS:  return "get";
+    case USB_CTRL_CMD_SET_PARAMS:  return "set";
+    case USB_CTRL_CMD_GET_STATS:   return "stats";
+    case USB_CTRL_CMD_RESET_STATS: return "reset-stats";
+    default:                       return NULL;
+    }
+}
+
+const char *aer_ctrl_stat_name(uint32_t index)
+{
+    return (index < USB_CTRL_STATS_COUNTERS) ? k_stat_names[index] : NULL;
+}
+
+int aer_ctrl_parse_assignments(const char *s, aer_ctrl_kv_t *kv, uint32_t max)
+{
+    uint32_t n = 0u;
+    while (*s != '\0') {
+        const char *eq = strchr(s, '=');
+        if (!eq || n >= max) return -1;
+        char name[32];
+        const size_t nl = (size_t)(eq - s);
+        if (nl == 0u || nl >= sizeof(name)) return -1;
+        memcpy(name, s, nl);
+        name[nl] = '\0';
+        const int key = aer_ctrl_param_key(name);
+        if (key < 0) return -1;
+
+        char *end = NULL;
+        const unsigned long v = strtoul(eq + 1, &end, 0);
+        if (end == eq + 1 || (*end != ',' && *end != '\0') || v > 0xFFFFFFFFul) return -1;
+        kv[n].key = (uint8_t)key;
+        kv[n].value = (uint32_t)v;
+        n++;
+        s = (*end == ',') ? end + 1 : end;
+    }
+    return (int)n;
+}
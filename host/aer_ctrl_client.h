@@ -0,0 +1,96 @@
+#ifndef AER_CTRL_CLIENT_H
+#define AER_CTRL_CLIENT_H
+
+/*
+ * host/aer_ctrl_client.h
+ *
+ * Host side of the runtime control channel (pico_aer_rx/usb_ctrl.h): builds
+ * "AERC" command frames for CDC TX and reads the HAL_STREAM_CTRL_RSP frames
+ * that come back. Names for parameters, statuses and GET_STATS counters are
+ * kept here so the tools and tests agree on them (scripts/aer_ctrl.py has
+ * the same tables).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "usb_ctrl.h"       /* USB_CTRL_* protocol */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Largest command frame. */
+#define AER_CTRL_FRAME_MAX (USB_CTRL_HDR_LEN + USB_CTRL_MAX_PAYLOAD)
+
+typedef struct aer_ctrl_kv_s {
+    uint8_t  key;                /* USB_CTRL_P_* */
+    uint32_t value;
+} aer_ctrl_kv_t;
+
+/* One decoded CTRL_RSP payload; body points into the frame. */
+typedef struct aer_ctrl_rsp_s {
+    uint8_t        cmd;
+    uint16_t       tag;
+    uint8_t        status;       /* USB_CTRL_ST_* */
+    const uint8_t *body;
+    uint16_t       body_len;
+} aer_ctrl_rsp_t;
+
+/* One main loop task in a GET_STATS body (aer_sched.h); cycles at cycles_hz. */
+typedef struct aer_ctrl_task_stats_s {
+    char     name[USB_CTRL_TASK_NAME_LEN + 1u];
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t cycles_max;
+    uint32_t interval_max;
+} aer_ctrl_task_stats_t;
+
+/* GET_STATS body (version 1 bodies leave cycles_hz and the tasks at 0). */
+typedef struct aer_ctrl_stats_s {
+    uint8_t  ver;
+    uint64_t t_us;
+    uint64_t t_us_reset;
+    uint32_t cycles_hz;
+    uint32_t counters[USB_CTRL_STATS_COUNTERS];
+    uint32_t n_tasks;
+    aer_ctrl_task_stats_t tasks[USB_CTRL_STATS_TASKS_MAX];
+} aer_ctrl_stats_t;
+
+/*
+ * Command frame -> out (at least AER_CTRL_FRAME_MAX bytes). Returns the frame
+ * length, or 0 if len exceeds USB_CTRL_MAX_PAYLOAD.
+ */
+size_t aer_ctrl_encode(uint8_t *out, uint8_t cmd, uint16_t tag, const void *payload, uint16_t len);
+
+/* SET_PARAMS with n kv pairs; 0 if they do not fit. */
+size_t aer_ctrl_encode_set(uint8_t *out, uint16_t tag, const aer_ctrl_kv_t *kv, uint32_t n);
+
+/* CTRL_RSP payload -> rsp. False for a short frame or another version. */
+bool aer_ctrl_parse_rsp(const uint8_t *payload, uint16_t len, aer_ctrl_rsp_t *rsp);
+
+/* kv[] body (GET_PARAMS, SET_PARAMS) -> kv, at most max. Returns the count. */
+uint32_t aer_ctrl_rsp_kv(const aer_ctrl_rsp_t *rsp, aer_ctrl_kv_t *kv, uint32_t max);
+
+/* GET_STATS body -> st. False if it is not a stats body this client knows. */
+bool aer_ctrl_rsp_stats(const aer_ctrl_rsp_t *rsp, aer_ctrl_stats_t *st);
+
+/* Names ("timestamps", "raw_words", ...); NULL / -1 when unknown. */
+const char *aer_ctrl_param_name(uint8_t key);
+int         aer_ctrl_param_key(const char *name);
+const char *aer_ctrl_status_name(uint8_t status);
+const char *aer_ctrl_cmd_name(uint8_t cmd);
+const char *aer_ctrl_stat_name(uint32_t index);
+
+/*
+ * "name=value[,name=value...]" (values as strtoul base 0) -> kv, at most max.
+ * Returns the count, or -1 on an unknown name or a malformed value.
+ */
+int aer_ctrl_parse_assignments(const char *s, aer_ctrl_kv_t *kv, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AER_CTRL_CLIENT_H */
@@ -0,0 +1,156 @@
+/*
+ * host/aer_raw_decode.c
+ *
+ * RAW_BIN frames -> aer_decode_words() / aer_burst_feed_raw_words_*span(),
+ * see aer_raw_decode.h.
+ */
+
+#include "aer_raw_decode.h"
+
+#include <string.h>
+
+static const uint8_t k_magic[4] = { 'A', 'E', 'R', 'S' };
+
+void aer_raw_decoder_init(aer_raw_decoder_t *d, const aer_raw_decoder_cfg_t *cfg)
+{
+    memset(d, 0, sizeof(*d));
+    if (cfg) d->cfg = *cfg;
+    aer_burst_init(&d->burst);
+}
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void on_hello(aer_raw_decoder_t *d, const uint8_t *p, uint16_t len)
+{
+    /* usb_stream.h HELLO v1: tick_hz at 14, flags at 18. */
+    if (len < 19u) return;
+    d->stats.hello++;
+    d->stats.tick_hz = rd32(&p[14]);
+    d->stats.hello_flags = p[18];
+}
+
+static bool on_raw(aer_raw_decoder_t *d, const uint8_t *p, uint16_t len)
+{
+    if (len < USB_STREAM_RAW_HDR_BYTES || p[0] != USB_STREAM_RAW_VER) {
+        d->stats.frames_bad++;
+        return false;
+    }
+    const bool timed = (p[1] & USB_STREAM_RAW_F_TICKS) != 0u;
+    const uint32_t n = rd16(&p[2]);
+    const uint32_t index = rd32(&p[4]);
+    if (n > USB_STREAM_RAW_MAX_WORDS || len != USB_STREAM_RAW_HDR_BYTES + n * (timed ? 6u : 2u)) {
+        d->stats.frames_bad++;
+        return false;
+    }
+
+    if (d->have_index ? (index != d->next_index) : (index != 0u)) {
+        if (d->have_index) d->stats.words_lost += (uint32_t)(index - d->next_index);
+        d->resync_cut = d->resync_cut || (d->burst.state != AER_BURST_EXPECT_ROW);
+        d->resync = true;
+        aer_burst_reset(&d->burst, false);
+    }
+    d->have_index = true;
+    d->next_index = index + n;
+
+    aer_raw_word_t words[USB_STREAM_RAW_MAX_WORDS];
+    uint32_t ts[USB_STREAM_RAW_MAX_WORDS];
+    const uint8_t *pw = &p[USB_STREAM_RAW_HDR_BYTES];
+    const uint8_t *pt = pw + 2u * n;
+    for (uint32_t i = 0u; i < n; ++i) {
+        words[i] = rd16(&pw[2u * i]);
+        ts[i] = timed ? rd32(&pt[4u * i]) : 0u;
+    }
+
+    if (d->cfg.word_cb) {
+        aer_codec_result_t dec[USB_STREAM_RAW_MAX_WORDS];
+        (void)aer_decode_words(words, n, dec);
+        for (uint32_t i = 0u; i < n; ++i) {
+            d->cfg.word_cb(index + i, words[i], &dec[i], timed, ts[i], d->cfg.user);
+        }
+    }
+
+    /* After a gap, the burst boundary is the word after the next TAIL. */
+    uint32_t skip = 0u;
+    while (d->resync && skip < n) {
+        const aer_codec_result_t r = aer_decode_word(words[skip++]);
+        if (r.ok && r.is_tail) {
+            if (d->resync_cut || skip > 1u) d->stats.bursts_discarded++;
+            d->resync = false;
+            d->resync_cut = false;
+        }
+    }
+    d->stats.words_skipped += skip;
+
+    if (timed) {
+        (void)aer_burst_feed_raw_words_ts_span(&d->burst, &words[skip], &ts[skip], n - skip,
+                                               d->cfg.burst_cb, d->cfg.user);
+    } else {
+        (void)aer_burst_feed_raw_words_span(&d->burst, &words[skip], n - skip, d->cfg.burst_cb, d->cfg.user);
+    }
+    d->stats.frames++;
+    d->stats.words += n;
+    return true;
+}
+
+static bool dispatch(aer_raw_decoder_t *d, uint8_t type, const uint8_t *payload, uint16_t len)
+{
+    switch (type) {
+    case HAL_STREAM_RAW_BIN:
+        return on_raw(d, payload, len);
+    case HAL_STREAM_HELLO:
+        on_hello(d, payload, len);
+        return true;
+    default:
+        d->stats.frames_other++;
+        return true;
+    }
+}
+
+bool aer_raw_decoder_frame(aer_raw_decoder_t *d, uint8_t type, uint16_t seq,
+                           const uint8_t *payload, uint16_t len)
+{
+    if (d->have_seq) d->stats.seq_lost += (uint16_t)(seq - d->next_seq);
+    d->have_seq = true;
+    d->next_seq = (uint16_t)(seq + 1u);
+    return dispatch(d, type, payload, len);
+}
+
+void aer_raw_decoder_bytes(aer_raw_decoder_t *d, const uint8_t *data, size_t len)
+{
+    while (len != 0u) {
+        size_t k = sizeof(d->buf) - d->buf_len;
+        if (k > len) k = len;
+        memcpy(&d->buf[d->buf_len], data, k);
+        d->buf_len += k;
+        data += k;
+        len -= k;
+
+        /* Consume every complete frame in buf; keep the partial tail. */
+        size_t pos = 0u;
+        for (;;) {
+            while (pos < d->buf_len && d->buf_len - pos >= 4u && memcmp(&d->buf[pos], k_magic, 4u) != 0) {
+                pos++;
+            }
+            const size_t avail = d->buf_len - pos;
+            if (avail < 8u) break;
+            const uint8_t *h = &d->buf[pos];
+            const uint8_t ver = h[4];
+            const size_t hdr = (ver < 2u) ? 8u : HAL_STREAM_HDR_LEN;
+            const uint16_t plen = rd16(&h[6]);
+            if (avail < hdr + plen) break;
+            if (ver >= 2u) {
+                (void)aer_raw_decoder_frame(d, h[5], rd16(&h[8]), &h[hdr], plen);
+            } else {
+                (void)dispatch(d, h[5], &h[hdr], plen);
+            }
+            pos += hdr + plen;
+        }
+        memmove(d->buf, &d->buf[pos], d->buf_len - pos);
+        d->buf_len -= pos;
+    }
+}
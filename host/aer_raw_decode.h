@@ -0,0 +1,94 @@
+#ifndef AER_RAW_DECODE_H
+#define AER_RAW_DECODE_H
+
+/*
+ * host/aer_raw_decode.h
+ *
+ * Host side of the raw word passthrough (usb_stream.h, HAL_STREAM_RAW_BIN):
+ * the device ships latched DATA words and their latch times, and this runs
+ * the same codec and burst assembler the firmware would have (common/),
+ * so its bursts match the device's EVENT_BIN output for the same words.
+ *
+ * Input is either whole frames (type, seq, payload: the hal_sim frame
+ * callback) or the raw AERS byte stream (a capture file or the CDC port),
+ * which is reframed here with resync on the magic.
+ *
+ * Loss: a jump in word_index means RAW_BIN frames were refused or lost on
+ * the way; the words are counted and the burst in progress is discarded.
+ * Words after the gap are skipped up to and including the next TAIL, since
+ * the first of them may be the columns of a burst whose row was lost and
+ * would otherwise be read as a row. The same applies to a capture that
+ * starts mid-stream (first word_index not 0).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "aer_codec.h"
+#include "aer_burst.h"
+#include "hal_stdio.h"      /* HAL_STREAM_* framing */
+#include "usb_stream.h"     /* USB_STREAM_RAW_* payload */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Every word as received, with its decode result (aer_decode_words()). */
+typedef void (*aer_raw_word_cb_t)(uint32_t index, aer_raw_word_t raw, const aer_codec_result_t *dec,
+                                  bool timed, uint32_t t_ticks, void *user);
+
+typedef struct aer_raw_decoder_cfg_s {
+    aer_burst_cb_t    burst_cb;  /* completed bursts; info->timed for RAW_F_TICKS frames (may be NULL) */
+    aer_raw_word_cb_t word_cb;   /* per-word dump (NULL = off) */
+    void             *user;
+} aer_raw_decoder_cfg_t;
+
+typedef struct aer_raw_decoder_stats_s {
+    uint32_t frames;             /* RAW_BIN frames decoded */
+    uint32_t frames_bad;         /* RAW_BIN frames with an unknown version or a bad length */
+    uint32_t frames_other;       /* other frame types (skipped) */
+    uint32_t seq_lost;           /* frames missing according to the AERS seq (any type) */
+    uint64_t words;              /* words received */
+    uint64_t words_lost;         /* words missing according to word_index */
+    uint32_t bursts_discarded;   /* bursts cut by a word_index jump */
+    uint64_t words_skipped;      /* received words dropped while resyncing to a TAIL */
+    uint32_t hello;              /* HELLO frames seen */
+    uint8_t  hello_flags;        /* USB_STREAM_HELLO_F_* from the last HELLO */
+    uint32_t tick_hz;            /* from the last HELLO */
+} aer_raw_decoder_stats_t;
+
+typedef struct aer_raw_decoder_s {
+    aer_raw_decoder_cfg_t   cfg;
+    aer_burst_t             burst;
+    aer_raw_decoder_stats_t stats;
+
+    bool     have_index;
+    uint32_t next_index;         /* word_index expected in the next RAW_BIN frame */
+    bool     resync;             /* skipping to the next TAIL */
+    bool     resync_cut;         /* ...and the gap cut a burst in progress */
+    bool     have_seq;
+    uint16_t next_seq;
+
+    /* aer_raw_decoder_bytes(): one partial frame at most. */
+    uint8_t  buf[HAL_STREAM_HDR_LEN + 0xFFFFu];
+    size_t   buf_len;
+} aer_raw_decoder_t;
+
+void aer_raw_decoder_init(aer_raw_decoder_t *d, const aer_raw_decoder_cfg_t *cfg);
+
+/*
+ * One deframed packet. RAW_BIN frames are decoded, HELLO is noted, other
+ * types are skipped. Returns false for a malformed RAW_BIN payload.
+ */
+bool aer_raw_decoder_frame(aer_raw_decoder_t *d, uint8_t type, uint16_t seq,
+                           const uint8_t *payload, uint16_t len);
+
+/* Raw AERS byte stream, any chunking. Bytes before a magic are skipped. */
+void aer_raw_decoder_bytes(aer_raw_decoder_t *d, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AER_RAW_DECODE_H */
@@ -4,7 +4,7 @@
  * Virtual receiver replay:
  * - Replays a time-ordered waveform of (DATA, ACK) transitions.
  * - Extracts "latched" raw words on ACK rising edges.
- * - Feeds those words through aer_decode_word() and aer_burst_feed().
+ * - Feeds those words through aer_burst_feed_raw() (fused decode + burst).
  *
  * Fault injection:
  * - Optional callback can mutate (data, ack) before processing each sample.
@@ -79,7 +79,7 @@ static aer_rx_replay_cfg_t aer_rx_replay_cfg_default(void)
  * - wf: waveform transitions (monotonic time order)
  * - cfg: optional, pass NULL to use defaults
  * - burst: burst assembler instance (caller may inspect errors/counters after)
- * - emit_cb/user: event sink callback used by aer_burst_feed()
+ * - emit_cb/user: event sink callback used by aer_burst_feed_raw()
  * - out_stats: optional stats output
  */
 bool aer_rx_replay_run(const aer_waveform_t* wf,
@@ -135,20 +135,22 @@ bool aer_rx_replay_run(const aer_waveform_t* wf,
             const aer_raw_word_t latched = s.data;
             st.words_latched++;
 
-            const aer_codec_result_t cr = aer_decode_word(latched);
-            if (cr.ok) st.codec_ok++;
-            else       st.codec_invalid++;
+            /* Fused decode + burst step; the assembler counts the words it
+             * rejects, which gives the ok/invalid split without a separate
+             * aer_decode_word() pass. Invalid words never change burst state,
+             * so ignore_invalid_words needs no special handling here.
+             */
+            const uint32_t ignored_before = burst->words_ignored;
+            (void)aer_burst_feed_raw(burst, latched, emit_cb, emit_user);
+            if (burst->words_ignored == ignored_before) st.codec_ok++;
+            else                                         st.codec_invalid++;
 
-            if (cr.err_flags & AER_CODEC_ERR_NEUTRAL) {
+            if ((latched & (aer_raw_word_t)AER_RAW_MASK) == 0u) {
                 st.codec_neutral++;
                 if (cfg.count_neutral_as_error) {
                     st.protocol_issues++;
                 }
             }
-
-            if (!(cfg.ignore_invalid_words && !cr.ok)) {
-                (void)aer_burst_feed(burst, cr, emit_cb, emit_user);
-            }
         }
 
         last_data = s.data;
@@ -0,0 +1,901 @@
+/*
+ * host/aer_sim.c
+ *
+ * Runs the pico_aer_rx receive pipeline on the host against the simulated
+ * bus in host/sim/hal_sim.c:
+ *
+ *   aer_tx_model waveform -> simulated sender -> aer_rx_poll (4-phase, real code)
+ *     -> raw ringbuf (+ latch times) -> aer_burst_feed_raw_words_ts_span -> aer_event_sink
+ *     -> usb_stream -> TX buffers -> CDC link model (-b bytes/s) -> framed bytes
+ *        (counted, optionally captured to a file)
+ *
+ * The main loop mirrors pico_aer_rx.c. Two knobs let the ring fill up so the
+ * overflow policies can be compared: -r handshakes up to N words per loop
+ * before draining, -d drains at most N words per loop.
+ *
+ * -m selects the core layout (pico_aer_rx.c AER_RX_DUAL_CORE):
+ *   single   one loop does handshake, drain and USB (default)
+ *   split    core1 handshakes into an spsc_ring, core0 drains/streams; both
+ *            cores are stepped from this thread, always the one whose virtual
+ *            clock is behind, so the result is deterministic and the virtual
+ *            throughput is comparable with "single"
+ *   threads  the same split on two host threads (core1 = a pthread); shows
+ *            the SPSC ring under real concurrency, virtual time is not
+ *            meaningful there (cross-core waits are not simulated)
+ *   pio      AER_RX_USE_PIO: aer_rx.pio in the PIO model does the handshake
+ *            and a DMA model fills the ring (host/sim/hal_pio_rx_sim.c); the
+ *            loop only publishes and drains. Always backpressure (-p, -t and
+ *            -r do not apply)
+ *
+ * -x selects what core0 streams (pico_aer_rx.c AER_STREAM_RAW_WORDS):
+ *   events   decode + burst assembly on the device, EVENT_BIN records (default)
+ *   raw      raw word passthrough: the drained words and latch times go out
+ *            as RAW_BIN frames and host/aer_raw_decode.c decodes them on the
+ *            "host" side of the link; -c (device decode cost) does not apply
+ *
+ * -l selects the core0 loop shape:
+ *   plain    tud_task, one handshake (-r), drain everything (-d), as before
+ *            aer_sched (default off for comparison)
+ *   sched    pico_aer_rx.c's loop: aer_sched.h tasks acquire, decode, usb,
+ *            host, loss with per-run budgets (-B us for acquire and decode,
+ *            -d words per decode chunk); per-task cycle accounting is
+ *            reported
+ * Both report the longest USB service interval (time between
+ * tud_task()/usb_stream_poll() passes, bus dead time excluded) next to the
+ * worst valid->ack handshake latency.
+ *
+ * -k at_us:name=value[,name=value...] sends a SET_PARAMS command
+ * (pico_aer_rx/usb_ctrl.h, names as in host/aer_ctrl_client.c) into the
+ * device's CDC RX at virtual time at_us; repeatable. E.g. -k 20000:raw_words=1
+ * switches to raw passthrough mid-run. Responses are listed in the report;
+ * events decoded on either side are counted.
+ *
+ * Reports host throughput (wall clock through the real code), simulated bus
+ * throughput (virtual time) and where words/events were lost.
+ *
+ * Usage: aer_sim [-n bursts] [-g gap_ns] [-p newest|backpressure|oldest]
+ *                [-t bp_timeout_us] [-r rx_words] [-d drain_max]
+ *                [-c consumer_ns_per_word] [-u usb_ns_per_byte] [-b link_bytes_per_s]
+ *                [-m single|split|threads|pio] [-x events|raw] [-l plain|sched] [-B budget_us]
+ *                [-k at_us:name=value,...] [-s seed] [-o capture.bin]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "aer_cfg.h"
+#include "aer_codec.h"
+#include "aer_burst.h"
+#include "ringbuf.h"
+#include "spsc_ring.h"
+
+#include "aer_tx_model.h"
+#include "aer_raw_decode.h"
+#include "aer_ctrl_client.h"
+#include "hal_sim.h"
+#include "pico.h"   // tight_loop_contents()
+#include "tusb.h"
+
+#include "hal_gpio.h"
+#include "hal_time.h"
+#include "hal_stdio.h"
+#include "aer_rx_poll.h"
+#include "aer_rx_pio.h"
+#include "usb_stream.h"
+#include "usb_ctrl.h"
+#include "aer_event_sink.h"
+#include "aer_sched.h"
+
+/* Same values as pico_aer_rx.c */
+#define RAW_RB_CAPACITY          2048u
+#define HOST_POLL_INTERVAL_US    10000u
+#define HOST_RX_BYTES_PER_POLL   64u
+#define LOSS_SUMMARY_INTERVAL_US 1000000u
+#define SCHED_BUDGET_US          20u    /* SCHED_ACQ_BUDGET_US, SCHED_DECODE_BUDGET_US */
+#define SCHED_ACQ_MAX_WORDS      256u
+#define SCHED_DECODE_CHUNK_WORDS 32u
+#define SCHED_TASKS_MAX          5u
+
+#define SIM_CTRL_MAX             8u     /* -k commands */
+#define SIM_CTRL_LOG_MAX         16u    /* responses kept for the report */
+
+/* -k: a SET_PARAMS the host sends at a virtual time. */
+typedef struct sim_ctrl_cmd_s {
+    uint64_t      at_us;
+    aer_ctrl_kv_t kv[USB_CTRL_P_COUNT];
+    uint32_t      n;
+} sim_ctrl_cmd_t;
+
+typedef enum sim_mode_e {
+    SIM_SINGLE = 0,
+    SIM_SPLIT,
+    SIM_THREADS,
+    SIM_PIO
+} sim_mode_t;
+
+typedef struct sim_opts_s {
+    uint32_t bursts;
+    uint32_t gap_ns;            /* mean idle time between bursts */
+    aer_rx_overflow_t policy;
+    uint32_t bp_timeout_us;
+    uint32_t rx_words;          /* handshakes per loop iteration */
+    uint32_t drain_max;         /* 0 = drain everything each iteration */
+    uint32_t consumer_ns;       /* virtual decode cost per drained word */
+    uint32_t usb_ns_per_byte;
+    uint32_t link_bps;          /* USB link throughput (0 = unlimited) */
+    sim_mode_t mode;
+    bool raw;                   /* -x raw: stream raw words, decode on the host */
+    bool sched;                 /* -l sched: aer_sched task loop */
+    uint32_t budget_us;         /* -B: acquire / decode budget per run */
+    uint32_t seed;
+    const char *capture;
+    sim_ctrl_cmd_t ctrl[SIM_CTRL_MAX];
+    uint32_t ctrl_count;
+} sim_opts_t;
+
+/* What reaches the host: raw words for its decoder, control responses. */
+typedef struct sim_host_s {
+    aer_raw_decoder_t dec;
+    struct {
+        uint64_t       t_us;     /* arrival, virtual */
+        aer_ctrl_rsp_t rsp;
+        aer_ctrl_kv_t  kv[USB_CTRL_P_COUNT];
+        uint32_t       n;
+    } log[SIM_CTRL_LOG_MAX];
+    uint32_t log_count;
+    uint32_t ctrl_rsp;
+} sim_host_t;
+
+/* Everything the core0 side of the loop owns. */
+typedef struct sim_core0_s {
+    const sim_opts_t *o;
+    aer_rx_poll_t    *rx;       /* NULL with -m pio */
+    aer_rx_pio_t     *pio_rx;   /* -m pio only */
+    ringbuf_u32_t    *ring;     /* single, pio */
+    spsc_ring_u32_t  *spsc;     /* split, threads */
+    const ringbuf_u32_t *raw_rb;
+    const uint32_t   *raw_storage;
+    const uint32_t   *raw_ts;   /* latch times, paired with raw_storage */
+    aer_burst_t       burst;
+    aer_event_sink_t  sink;
+    uint32_t host_poll_last;
+    uint32_t host_poll_cycles;
+    uint32_t loss_last;
+    uint32_t loss_cycles;
+    uint32_t ctrl_next;         /* next -k command to send */
+
+    aer_sched_t      sched;     /* -l sched */
+    aer_sched_task_t tasks[SCHED_TASKS_MAX];
+    uint32_t decode_word_cycles;  /* last decode chunk's cycles per word */
+
+    /* USB service interval (virtual, bus dead time excluded). */
+    uint32_t usb_runs;
+    uint64_t usb_last_ns;
+    uint64_t usb_last_idle_ns;
+    uint64_t usb_gap_max_ns;
+    uint64_t usb_gap_sum_ns;
+    uint64_t idle_ns;           /* split: core0 waiting for core1 */
+} sim_core0_t;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t *s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+static aer_raw_word_t encode(uint32_t payload)
+{
+    aer_raw_word_t raw = 0u;
+    (void)aer_encode_payload((uint8_t)payload, &raw, NULL);
+    return raw;
+}
+
+static const char *mode_name(sim_mode_t m)
+{
+    switch (m) {
+    case SIM_SPLIT:   return "split";
+    case SIM_THREADS: return "threads";
+    case SIM_PIO:     return "pio";
+    default:          return "single";
+    }
+}
+
+static const char *policy_name(aer_rx_overflow_t p)
+{
+    switch (p) {
+    case AER_RX_OVERFLOW_BACKPRESSURE: return "backpressure";
+    case AER_RX_OVERFLOW_DROP_OLDEST:  return "drop-oldest";
+    default:                           return "drop-newest";
+    }
+}
+
+/*
+ * Sender traffic: bursts of 1..8 distinct ascending columns on a random row,
+ * words back to back inside a burst, random idle gaps between bursts.
+ * Returns the number of events encoded.
+ */
+static uint32_t build_traffic(aer_waveform_t *wf, const sim_opts_t *o, uint32_t tick_ns)
+{
+    aer_tx_model_t m;
+    aer_tx_model_init(&m, NULL, wf, 0u);
+
+    uint32_t seed = o->seed ? o->seed : 1u;
+    uint32_t events = 0u;
+    for (uint32_t b = 0u; b < o->bursts; ++b) {
+        const uint32_t r = xorshift32(&seed);
+        const uint32_t row = r % AER_ROWS;
+        const uint32_t ncols = 1u + ((r >> 8) % 8u);
+        uint32_t col = (r >> 16) % (AER_COLS / 2u);
+
+        (void)aer_tx_model_emit_word(&m, encode(row));
+        for (uint32_t c = 0u; c < ncols && col < AER_COLS; ++c) {
+            (void)aer_tx_model_emit_word(&m, encode(col));
+            events++;
+            col += 1u + (xorshift32(&seed) % 3u);
+        }
+        (void)aer_tx_model_emit_word(&m, encode(AER_TAIL_PAYLOAD));
+
+        if (o->gap_ns != 0u) {
+            m.t += (xorshift32(&seed) % (2u * o->gap_ns + 1u)) / tick_ns;
+        }
+    }
+    return events;
+}
+
+static void send_loss_summary(const sim_core0_t *c0)
+{
+    const usb_stream_loss_src_t src = {
+        .ring_dropped       = c0->rx ? aer_rx_poll_dropped(c0->rx) : 0u,
+        .burst_cols_dropped = c0->burst.cols_dropped_total,
+        .words_invalid      = c0->burst.words_ignored,
+    };
+    (void)usb_stream_send_loss_summary(&src);
+    (void)usb_stream_send_ring_stats((uint8_t)USB_STREAM_RING_RAW, c0->raw_rb);
+}
+
+/* -k: the host writes each command once its time has come. */
+static void host_send_ctrl(sim_core0_t *c0)
+{
+    const sim_opts_t *o = c0->o;
+    while (c0->ctrl_next < o->ctrl_count && hal_sim_now_ns() >= o->ctrl[c0->ctrl_next].at_us * 1000u) {
+        const sim_ctrl_cmd_t *k = &o->ctrl[c0->ctrl_next];
+        uint8_t frame[AER_CTRL_FRAME_MAX];
+        const size_t len = aer_ctrl_encode_set(frame, (uint16_t)c0->ctrl_next, k->kv, k->n);
+        (void)hal_sim_host_write(frame, len);
+        c0->ctrl_next++;
+    }
+}
+
+/* Dead time core0 spent waiting on the bus, which needs no USB service. */
+static uint64_t core0_idle_ns(const sim_core0_t *c0)
+{
+    return (c0->o->mode == SIM_SPLIT) ? c0->idle_ns : hal_sim_tx_stats()->skipped_ns;
+}
+
+/* tud_task() + usb_stream_poll(), timing the interval since the last pass. */
+static void core0_usb(sim_core0_t *c0)
+{
+    if (c0->o->mode != SIM_THREADS) {   /* no meaningful virtual time there */
+        const uint64_t now = hal_sim_now_ns();
+        const uint64_t idle = core0_idle_ns(c0);
+        if (c0->usb_runs != 0u) {
+            const uint64_t gap = (now - c0->usb_last_ns) - (idle - c0->usb_last_idle_ns);
+            c0->usb_gap_sum_ns += gap;
+            if (gap > c0->usb_gap_max_ns) c0->usb_gap_max_ns = gap;
+        }
+        c0->usb_last_ns = now;
+        c0->usb_last_idle_ns = idle;
+    }
+    c0->usb_runs++;
+
+    tud_task();
+    usb_stream_poll();
+    host_send_ctrl(c0);
+}
+
+static uint32_t core0_host(void)
+{
+    int c;
+    uint32_t i = 0u;
+    for (; i < HOST_RX_BYTES_PER_POLL && (c = hal_stdio_getc_nonblocking()) >= 0; ++i) {
+        (void)usb_ctrl_on_host_byte((uint8_t)c);
+    }
+    return i;
+}
+
+/* Core0 housekeeping at the top of every loop pass (USB, host bytes, loss). */
+static void core0_service(sim_core0_t *c0)
+{
+    core0_usb(c0);
+
+    if (hal_cycles_diff(hal_cycles_now(), c0->host_poll_last) >= c0->host_poll_cycles) {
+        c0->host_poll_last = hal_cycles_now();
+        (void)core0_host();
+    }
+
+    if (hal_cycles_diff(hal_cycles_now(), c0->loss_last) >= c0->loss_cycles) {
+        c0->loss_last = hal_cycles_now();
+        send_loss_summary(c0);
+    }
+}
+
+/*
+ * Feed a claimed span (either ring's) to the parser, at most max words
+ * (0 = all). Returns how many words to commit.
+ */
+static uint32_t core0_consume(sim_core0_t *c0, uint32_t *const ptr[2], uint32_t len[2], uint32_t n,
+                              uint32_t max)
+{
+    if (max != 0u && n > max) {
+        n = max;
+        if (len[0] > n) len[0] = n;
+        len[1] = n - len[0];
+    }
+    uint32_t decoded = 0u;
+    for (uint32_t p = 0u; p < 2u && n != 0u; ++p) {
+        decoded += aer_event_sink_on_words(&c0->sink, &c0->burst, ptr[p],
+                                           c0->raw_ts + (ptr[p] - c0->raw_storage), len[p]);
+    }
+    hal_sim_advance_ns((uint64_t)decoded * c0->o->consumer_ns);
+    return n;
+}
+
+/* One core0 pass in split mode: service, then drain what core1 published. */
+static uint32_t core0_drain_spsc(sim_core0_t *c0, spsc_ring_u32_t *ring)
+{
+    core0_service(c0);
+    spsc_ring_u32_span_t rd;
+    const uint32_t n = core0_consume(c0, rd.ptr, rd.len, spsc_ring_u32_read_claim(ring, &rd), c0->o->drain_max);
+    spsc_ring_u32_read_commit(ring, n);
+    return n;
+}
+
+/* ---- -l sched: pico_aer_rx.c's tasks ---- */
+
+static uint32_t task_acquire(aer_sched_task_t *t)
+{
+    sim_core0_t *c0 = (sim_core0_t *)t->ctx;
+    if (c0->pio_rx) return aer_rx_pio_poll(c0->pio_rx);
+    if (hal_gpio_read_data_raw() == 0u) return 0u;
+    return aer_rx_poll_service(c0->rx, (c0->o->rx_words > 1u) ? c0->o->rx_words : SCHED_ACQ_MAX_WORDS,
+                               t->budget_us);
+}
+
+static uint32_t task_decode(aer_sched_task_t *t)
+{
+    sim_core0_t *c0 = (sim_core0_t *)t->ctx;
+    const uint32_t chunk = c0->o->drain_max ? c0->o->drain_max : SCHED_DECODE_CHUNK_WORDS;
+    uint32_t done = 0u;
+    for (;;) {
+        uint32_t max = aer_sched_fit_count(t, c0->decode_word_cycles, chunk);
+        if (max == 0u) {
+            if (done != 0u) return done;
+            max = 1u;
+        }
+        const uint32_t t_chunk = hal_cycles_now();
+        uint32_t n;
+        if (c0->spsc) {
+            spsc_ring_u32_span_t rd;
+            n = core0_consume(c0, rd.ptr, rd.len, spsc_ring_u32_read_claim(c0->spsc, &rd), max);
+            spsc_ring_u32_read_commit(c0->spsc, n);
+        } else {
+            ringbuf_u32_span_t rd;
+            n = core0_consume(c0, rd.ptr, rd.len, ringbuf_u32_read_claim(c0->ring, &rd), max);
+            ringbuf_u32_read_commit(c0->ring, n);
+        }
+        if (n == 0u) return done;
+        done += n;
+        c0->decode_word_cycles = (aer_sched_step(t, t_chunk) + n - 1u) / n;
+    }
+}
+
+static uint32_t task_usb(aer_sched_task_t *t)
+{
+    core0_usb((sim_core0_t *)t->ctx);
+    return 0u;
+}
+
+static uint32_t task_host(aer_sched_task_t *t)
+{
+    (void)t;
+    return core0_host();
+}
+
+static uint32_t task_loss(aer_sched_task_t *t)
+{
+    send_loss_summary((const sim_core0_t *)t->ctx);
+    return 1u;
+}
+
+static void core0_sched_init(sim_core0_t *c0)
+{
+    const uint32_t b = c0->o->budget_us;
+    const bool acquire = (c0->o->mode == SIM_SINGLE || c0->o->mode == SIM_PIO);
+    uint32_t n = 0u;
+    if (acquire) c0->tasks[n++] = (aer_sched_task_t){ .name = "acquire", .fn = task_acquire, .budget_us = b };
+    c0->tasks[n++] = (aer_sched_task_t){ .name = "decode", .fn = task_decode, .budget_us = b };
+    c0->tasks[n++] = (aer_sched_task_t){ .name = "usb",    .fn = task_usb };
+    c0->tasks[n++] = (aer_sched_task_t){ .name = "host",   .fn = task_host, .period_us = HOST_POLL_INTERVAL_US };
+    c0->tasks[n++] = (aer_sched_task_t){ .name = "loss",   .fn = task_loss, .period_us = LOSS_SUMMARY_INTERVAL_US };
+    for (uint32_t i = 0u; i < n; ++i) {
+        c0->tasks[i].ctx = c0;
+    }
+    aer_sched_init(&c0->sched, c0->tasks, n);
+}
+
+/* One core0 pass of either loop shape in split/threads mode; returns the work done. */
+static uint32_t core0_pass_spsc(sim_core0_t *c0)
+{
+    return c0->o->sched ? aer_sched_run_once(&c0->sched) : core0_drain_spsc(c0, c0->spsc);
+}
+
+/* One core1 pass (pico_aer_rx.c core1_main): handshake if a word is up, else idle. */
+static aer_rx_poll_status_t core1_pass(aer_rx_poll_t *rx)
+{
+    if (hal_gpio_read_data_raw() == 0u) {
+        tight_loop_contents();
+        return AER_RX_POLL_TIMEOUT_WAIT_VALID;
+    }
+    return aer_rx_poll_step(rx);
+}
+
+/* -m threads: core1 runs until the sender is done, then raises core1_done. */
+typedef struct core1_thread_arg_s {
+    aer_rx_poll_t *rx;
+    atomic_bool    core1_done;
+} core1_thread_arg_t;
+
+static void *core1_thread(void *p)
+{
+    core1_thread_arg_t *a = (core1_thread_arg_t *)p;
+    hal_sim_set_core(1u);
+    while (!hal_sim_tx_done()) {
+        if (core1_pass(a->rx) == AER_RX_POLL_NO_SPACE) {
+            sched_yield();      /* let core0 drain */
+        }
+    }
+    atomic_store_explicit(&a->core1_done, true, memory_order_release);
+    return NULL;
+}
+
+/* Frames reaching the host: raw words to the host-side decoder, responses to the log. */
+static void on_host_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    sim_host_t *h = (sim_host_t *)user;
+    (void)aer_raw_decoder_frame(&h->dec, type, seq, payload, len);
+
+    aer_ctrl_rsp_t rsp;
+    if (type != HAL_STREAM_CTRL_RSP || !aer_ctrl_parse_rsp(payload, len, &rsp)) return;
+    h->ctrl_rsp++;
+    if (h->log_count == SIM_CTRL_LOG_MAX) return;
+    h->log[h->log_count].t_us = hal_sim_now_ns() / 1000u;
+    h->log[h->log_count].rsp = rsp;
+    h->log[h->log_count].n = aer_ctrl_rsp_kv(&rsp, h->log[h->log_count].kv, USB_CTRL_P_COUNT);
+    h->log_count++;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: aer_sim [-n bursts] [-g gap_ns] [-p newest|backpressure|oldest]\n"
+            "               [-t bp_timeout_us] [-r rx_words] [-d drain_max]\n"
+            "               [-c consumer_ns_per_word] [-u usb_ns_per_byte] [-b link_bytes_per_s]\n"
+            "               [-m single|split|threads|pio] [-x events|raw] [-l plain|sched] [-B budget_us]\n"
+            "               [-k at_us:name=value,...] [-s seed] [-o capture.bin]\n");
+}
+
+/* -k at_us:name=value[,...] */
+static bool parse_ctrl(const char *v, sim_opts_t *o)
+{
+    char *end = NULL;
+    const unsigned long long at = strtoull(v, &end, 0);
+    if (end == v || *end != ':' || o->ctrl_count == SIM_CTRL_MAX) return false;
+    sim_ctrl_cmd_t *k = &o->ctrl[o->ctrl_count];
+    const int n = aer_ctrl_parse_assignments(end + 1, k->kv, USB_CTRL_P_COUNT);
+    if (n <= 0) return false;
+    if (o->ctrl_count != 0u && at < o->ctrl[o->ctrl_count - 1u].at_us) return false;
+    k->at_us = at;
+    k->n = (uint32_t)n;
+    o->ctrl_count++;
+    return true;
+}
+
+static bool parse_args(int argc, char **argv, sim_opts_t *o)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        if (a[0] != '-' || a[1] == '\0' || a[2] != '\0' || i + 1 >= argc) return false;
+        const char *v = argv[++i];
+        const uint32_t n = (uint32_t)strtoul(v, NULL, 0);
+        switch (a[1]) {
+        case 'n': o->bursts = n; break;
+        case 'g': o->gap_ns = n; break;
+        case 't': o->bp_timeout_us = n; break;
+        case 'r': o->rx_words = n; break;
+        case 'd': o->drain_max = n; break;
+        case 'c': o->consumer_ns = n; break;
+        case 'u': o->usb_ns_per_byte = n; break;
+        case 'b': o->link_bps = n; break;
+        case 's': o->seed = n; break;
+        case 'o': o->capture = v; break;
+        case 'B': o->budget_us = n; break;
+        case 'l':
+            if (strcmp(v, "plain") == 0)      o->sched = false;
+            else if (strcmp(v, "sched") == 0) o->sched = true;
+            else return false;
+            break;
+        case 'k':
+            if (!parse_ctrl(v, o)) return false;
+            break;
+        case 'm':
+            if (strcmp(v, "single") == 0)       o->mode = SIM_SINGLE;
+            else if (strcmp(v, "split") == 0)   o->mode = SIM_SPLIT;
+            else if (strcmp(v, "threads") == 0) o->mode = SIM_THREADS;
+            else if (strcmp(v, "pio") == 0)     o->mode = SIM_PIO;
+            else return false;
+            break;
+        case 'x':
+            if (strcmp(v, "events") == 0)   o->raw = false;
+            else if (strcmp(v, "raw") == 0) o->raw = true;
+            else return false;
+            break;
+        case 'p':
+            if (strcmp(v, "newest") == 0)            o->policy = AER_RX_OVERFLOW_DROP_NEWEST;
+            else if (strcmp(v, "backpressure") == 0) o->policy = AER_RX_OVERFLOW_BACKPRESSURE;
+            else if (strcmp(v, "oldest") == 0)       o->policy = AER_RX_OVERFLOW_DROP_OLDEST;
+            else return false;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    sim_opts_t o = {
+        .bursts = 100000u, .gap_ns = 2000u, .policy = AER_RX_OVERFLOW_DROP_NEWEST,
+        .bp_timeout_us = 2000u, .rx_words = 1u, .drain_max = 0u,
+        .consumer_ns = 0u, .usb_ns_per_byte = 0u, .mode = SIM_SINGLE, .seed = 0x9E3779B9u, .capture = NULL,
+        .budget_us = SCHED_BUDGET_US,
+    };
+    if (!parse_args(argc, argv, &o)) {
+        usage();
+        return 2;
+    }
+    if (o.mode == SIM_PIO) {
+        o.policy = AER_RX_OVERFLOW_BACKPRESSURE;   /* the only PIO behaviour */
+    }
+
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.cost.usb_ns_per_byte = o.usb_ns_per_byte;
+    cfg.cdc.bytes_per_s = o.link_bps;
+    hal_sim_init(&cfg);
+
+    aer_waveform_t wf;
+    aer_waveform_init(&wf);
+    const uint32_t events_offered = build_traffic(&wf, &o, cfg.tx.tick_ns);
+    if (!hal_sim_load_waveform(&wf)) {
+        fprintf(stderr, "aer_sim: out of memory\n");
+        return 1;
+    }
+    aer_waveform_free(&wf);
+
+    FILE *cap = NULL;
+    if (o.capture) {
+        cap = fopen(o.capture, "wb");
+        if (!cap) {
+            perror(o.capture);
+            return 1;
+        }
+        hal_sim_set_capture(cap);
+    }
+    static sim_host_t host;
+    aer_raw_decoder_init(&host.dec, NULL);   /* the assembler counts the events */
+    hal_sim_set_frame_sink(on_host_frame, &host);
+
+    /* ---- firmware bring-up, as in pico_aer_rx.c ---- */
+    hal_stdio_init(false, 0);
+    hal_stdio_set_packetized(true);
+    hal_time_init();
+    hal_gpio_init(&(hal_gpio_cfg_t){
+        .data_base = 2u, .data_width = (uint8_t)AER_DATA_WIDTH, .ack_pin = 14u,
+        .ack_active_high = true, .data_pull_down = true,
+    });
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled   = true,
+        .data_width_bits      = (uint8_t)AER_DATA_WIDTH,
+        .rowmask_enabled      = true,
+        .latch_timestamps     = true,
+        .batch_max_bytes      = 256u,
+        .batch_max_latency_us = 1000u,
+        .time_anchor_interval_us = 1000000u,
+        .raw_passthrough      = o.raw,
+    });
+    (void)usb_stream_send_hello();
+
+    sim_core0_t c0 = { .o = &o };
+    aer_event_sink_init(&c0.sink, &(aer_event_sink_cfg_t){ .enabled = true });
+    aer_burst_init(&c0.burst);
+
+    /* Aligned to its size for the -m pio DMA write ring. */
+    static uint32_t raw_storage[RAW_RB_CAPACITY]
+        __attribute__((aligned(RAW_RB_CAPACITY * sizeof(uint32_t))));
+    static uint32_t raw_ts[RAW_RB_CAPACITY];
+    ringbuf_u32_t raw_rb;
+    static spsc_ring_u32_t raw_spsc;
+    c0.raw_storage = raw_storage;
+    c0.raw_ts = raw_ts;
+
+    /* A 1 us valid timeout lets multi-word service calls return when the bus idles. */
+    aer_rx_poll_t rx;
+    aer_rx_pio_t pio_rx;
+    memset(&rx, 0, sizeof(rx));
+    if (o.mode == SIM_SINGLE) {
+        (void)ringbuf_u32_init(&raw_rb, raw_storage, RAW_RB_CAPACITY);
+        aer_rx_poll_init(&rx, &raw_rb, (o.rx_words > 1u) ? 1u : 0u, 0u);
+    } else if (o.mode == SIM_PIO) {
+        (void)ringbuf_u32_init(&raw_rb, raw_storage, RAW_RB_CAPACITY);
+        if (!aer_rx_pio_init(&pio_rx, &raw_rb)) {
+            fprintf(stderr, "aer_sim: aer_rx_pio_init failed\n");
+            return 1;
+        }
+        aer_rx_pio_set_timestamps(&pio_rx, raw_ts);
+        c0.pio_rx = &pio_rx;
+    } else {
+        (void)spsc_ring_u32_init(&raw_spsc, raw_storage, RAW_RB_CAPACITY);
+        aer_rx_poll_init_spsc(&rx, &raw_spsc, 0u, 0u);
+        hal_sim_set_bus_core(1u);
+    }
+    if (o.mode != SIM_PIO) {
+        aer_rx_poll_set_overflow(&rx, o.policy, o.bp_timeout_us);
+        aer_rx_poll_set_timestamps(&rx, raw_ts);
+        c0.rx = &rx;
+        c0.raw_rb = rx.rb;
+    } else {
+        c0.raw_rb = &raw_rb;
+    }
+    if (o.mode == SIM_SINGLE || o.mode == SIM_PIO) {
+        c0.ring = &raw_rb;
+    } else {
+        c0.spsc = &raw_spsc;
+    }
+
+    /* The receiver's parameters are core0's only when it runs the handshake. */
+    usb_ctrl_init(&(usb_ctrl_cfg_t){
+        .rx       = (o.mode == SIM_SINGLE) ? &rx : NULL,
+        .rx_stats = (o.mode == SIM_PIO) ? aer_rx_pio_stats(&pio_rx) : aer_rx_poll_stats(&rx),
+        .sink     = &c0.sink,
+        .burst    = &c0.burst,
+        .sched    = &c0.sched,   /* no tasks unless -l sched */
+    });
+
+    c0.host_poll_last = hal_cycles_now();
+    c0.host_poll_cycles = hal_us_to_cycles(HOST_POLL_INTERVAL_US);
+    c0.loss_last = hal_cycles_now();
+    c0.loss_cycles = hal_us_to_cycles(LOSS_SUMMARY_INTERVAL_US);
+    if (o.sched) {
+        core0_sched_init(&c0);
+    }
+
+    /* ---- main loop ---- */
+    const double t0 = now_s();
+    if (o.sched && (o.mode == SIM_SINGLE || o.mode == SIM_PIO)) {
+        /* pico_aer_rx.c's loop: one aer_sched pass after another. */
+        while (!hal_sim_tx_done() || !ringbuf_u32_is_empty(&raw_rb) ||
+               (o.mode == SIM_PIO && aer_rx_pio_backlog(&pio_rx) != 0u)) {
+            if (aer_sched_run_once(&c0.sched) == 0u) {
+                tight_loop_contents();
+            }
+        }
+    } else if (o.mode == SIM_SINGLE) {
+        while (!hal_sim_tx_done() || !ringbuf_u32_is_empty(&raw_rb)) {
+            core0_service(&c0);
+
+            if (hal_gpio_read_data_raw() != 0u) {
+                if (o.rx_words <= 1u) {
+                    (void)aer_rx_poll_step(&rx);
+                } else {
+                    (void)aer_rx_poll_service(&rx, o.rx_words, 0u);
+                }
+            } else if (ringbuf_u32_is_empty(&raw_rb)) {
+                tight_loop_contents();
+                continue;
+            }
+
+            ringbuf_u32_span_t rd;
+            const uint32_t n = core0_consume(&c0, rd.ptr, rd.len, ringbuf_u32_read_claim(&raw_rb, &rd), o.drain_max);
+            ringbuf_u32_read_commit(&raw_rb, n);
+        }
+    } else if (o.mode == SIM_PIO) {
+        /* pico_aer_rx.c with AER_RX_USE_PIO: the bus runs on its own. */
+        while (!hal_sim_tx_done() || aer_rx_pio_backlog(&pio_rx) != 0u || !ringbuf_u32_is_empty(&raw_rb)) {
+            core0_service(&c0);
+            (void)aer_rx_pio_poll(&pio_rx);
+
+            ringbuf_u32_span_t rd;
+            const uint32_t n = core0_consume(&c0, rd.ptr, rd.len, ringbuf_u32_read_claim(&raw_rb, &rd), o.drain_max);
+            ringbuf_u32_read_commit(&raw_rb, n);
+            if (n == 0u) {
+                tight_loop_contents();
+            }
+        }
+    } else if (o.mode == SIM_SPLIT) {
+        /* Step whichever core is behind in virtual time. */
+        while (!hal_sim_tx_done() || spsc_ring_u32_count(&raw_spsc) != 0u) {
+            if (hal_sim_core_now_ns(1u) <= hal_sim_core_now_ns(0u)) {
+                hal_sim_set_core(1u);
+                (void)core1_pass(&rx);
+            } else {
+                hal_sim_set_core(0u);
+                if (core0_pass_spsc(&c0) == 0u) {
+                    /* Idle: nothing can show up before core1's present. */
+                    const uint64_t idle = hal_sim_core_now_ns(1u) - hal_sim_core_now_ns(0u);
+                    c0.idle_ns += idle;
+                    hal_sim_advance_ns(idle);
+                    tight_loop_contents();
+                }
+            }
+        }
+        hal_sim_set_core(0u);
+    } else {
+        core1_thread_arg_t arg = { .rx = &rx };
+        atomic_init(&arg.core1_done, false);
+        pthread_t th;
+        if (pthread_create(&th, NULL, core1_thread, &arg) != 0) {
+            fprintf(stderr, "aer_sim: pthread_create failed\n");
+            return 1;
+        }
+        for (;;) {
+            const bool done = atomic_load_explicit(&arg.core1_done, memory_order_acquire);
+            if (core0_pass_spsc(&c0) == 0u) {
+                if (done) break;
+                sched_yield();
+            }
+        }
+        pthread_join(th, NULL);
+    }
+    (void)usb_stream_flush();
+    send_loss_summary(&c0);
+    const double wall = now_s() - t0;
+    if (o.mode == SIM_PIO) {
+        rx.stats = *aer_rx_pio_stats(&pio_rx);
+        aer_rx_pio_stop(&pio_rx);
+    }
+
+    /* ---- report ---- */
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    const aer_rx_poll_stats_t *rs = aer_rx_poll_stats(&rx);
+    const aer_event_sink_stats_t *ss = aer_event_sink_stats(&c0.sink);
+    const usb_stream_stats_t *us = usb_stream_stats();
+    const hal_sim_stream_stats_t *fs = hal_sim_stream_stats();
+    const hal_stream_stats_t *hs = hal_stream_stats();
+    const uint64_t core_ns[2] = { hal_sim_core_now_ns(0u), hal_sim_core_now_ns(1u) };
+    const double virt_s = (double)((core_ns[0] > core_ns[1]) ? core_ns[0] : core_ns[1]) * 1e-9;
+    const uint32_t lost = aer_rx_poll_dropped(&rx);
+    const bool drained = hal_sim_stream_drain(10000000000ull);   /* let the link catch up (10 s virtual) */
+
+    printf("aer_sim: %u bursts, %u words, %u events, %s%s, policy %s (rx %u/loop, drain %u/loop)\n",
+           (unsigned)o.bursts, (unsigned)tx->words_total, (unsigned)events_offered,
+           mode_name(o.mode), o.raw ? " raw" : "", policy_name(o.policy), (unsigned)o.rx_words,
+           (unsigned)o.drain_max);
+    printf("  host   %7.2f Mwords/s through the firmware path (%.3f s wall)\n",
+           (double)tx->words_acked / wall * 1e-6, wall);
+    printf("  bus    %7.2f Mwords/s simulated (%.3f ms virtual), valid->ack avg %.0f ns max %llu ns, "
+           "sender behind max %llu ns, protocol errors %u\n",
+           (double)tx->words_acked / virt_s * 1e-6, virt_s * 1e3,
+           tx->words_acked ? (double)tx->wait_ack_ns / tx->words_acked : 0.0,
+           (unsigned long long)tx->wait_ack_max_ns, (unsigned long long)tx->behind_max_ns,
+           (unsigned)tx->protocol_errors);
+    if (o.mode == SIM_SPLIT || o.mode == SIM_THREADS) {
+        printf("  cores  core0 %.3f ms  core1 %.3f ms virtual%s\n", (double)core_ns[0] * 1e-6,
+               (double)core_ns[1] * 1e-6, (o.mode == SIM_THREADS) ? " (not synchronized)" : "");
+    }
+    printf("  rx     words_ok %u  dropped_newest %u  dropped_oldest %u  bp_stalls %u  bp_timeouts %u\n",
+           (unsigned)rs->words_ok, (unsigned)rs->dropped_full, (unsigned)rs->dropped_oldest,
+           (unsigned)rs->bp_stalls, (unsigned)rs->bp_timeouts);
+    if (o.mode != SIM_THREADS) {
+        printf("  loop   %s: usb service interval max %.1f us avg %.1f us (%u passes), "
+               "valid->ack max %llu ns\n", o.sched ? "sched" : "plain",
+               (double)c0.usb_gap_max_ns * 1e-3,
+               (c0.usb_runs > 1u) ? (double)c0.usb_gap_sum_ns * 1e-3 / (c0.usb_runs - 1u) : 0.0,
+               (unsigned)c0.usb_runs, (unsigned long long)tx->wait_ack_max_ns);
+    }
+    for (uint32_t i = 0u; o.sched && i < c0.sched.n_tasks; ++i) {
+        const aer_sched_task_t *t = &c0.sched.tasks[i];
+        const aer_sched_task_stats_t *ts = &t->stats;
+        printf("  task   %-8s runs %7u  idle %7u  work %9llu  avg %6.2f us  max %7.2f us  "
+               "overruns %5u  interval max %8.2f us\n", t->name, (unsigned)ts->runs,
+               (unsigned)ts->idle_runs, (unsigned long long)ts->work,
+               ts->runs ? (double)ts->cycles_total / ts->runs / (double)hal_us_to_cycles(1u) : 0.0,
+               (double)ts->cycles_max / (double)hal_us_to_cycles(1u), (unsigned)ts->overruns,
+               (double)ts->interval_max / (double)hal_us_to_cycles(1u));
+    }
+    const ringbuf_u32_stats_t *rbs = (o.mode == SIM_SINGLE || o.mode == SIM_PIO) ? ringbuf_u32_stats(&raw_rb) : NULL;
+    if (rbs) {
+        printf("  ring   high_water %u/%u  push_full %u\n", (unsigned)rbs->high_water,
+               (unsigned)(RAW_RB_CAPACITY - 1u), (unsigned)rbs->push_full);
+    }
+    /* With -k both sides may have decoded part of the run. */
+    const aer_raw_decoder_stats_t *ds = &host.dec.stats;
+    const bool dev_decode = !o.raw || ss->mode_switches != 0u;
+    const bool host_decode = o.raw || ds->words != 0u;
+    if (dev_decode) {
+        printf("  parser events %u of %u  bursts %u  words_ignored %u  cols_dropped %u\n",
+               (unsigned)ss->events_emitted, (unsigned)events_offered, (unsigned)c0.burst.bursts_completed,
+               (unsigned)c0.burst.words_ignored, (unsigned)c0.burst.cols_dropped_total);
+        printf("  usb    frames %u (%llu bytes)  events_sent %u  packets %u  failed %u\n",
+               (unsigned)fs->frames, (unsigned long long)fs->bytes, (unsigned)us->events_sent,
+               (unsigned)us->packets_sent, (unsigned)ss->usb_send_failed);
+    }
+    if (host_decode) {
+        printf("  host   events %u of %u  bursts %u  words_ignored %u  cols_dropped %u  "
+               "(words %llu, lost %llu, bursts_discarded %u, skipped %llu)\n",
+               (unsigned)host.dec.burst.events_emitted, (unsigned)events_offered,
+               (unsigned)host.dec.burst.bursts_completed, (unsigned)host.dec.burst.words_ignored,
+               (unsigned)host.dec.burst.cols_dropped_total, (unsigned long long)ds->words,
+               (unsigned long long)ds->words_lost, (unsigned)ds->bursts_discarded,
+               (unsigned long long)ds->words_skipped);
+        if (!dev_decode) {
+            printf("  usb    frames %u (%llu bytes)  ", (unsigned)fs->frames, (unsigned long long)fs->bytes);
+        } else {
+            printf("  usb    ");
+        }
+        printf("raw_words_sent %u  packets %u  failed %u\n", (unsigned)us->raw_words_sent,
+               (unsigned)us->raw_packets_sent, (unsigned)us->raw_words_dropped_write_failed);
+    }
+    if (dev_decode && host_decode) {
+        printf("  total  events %u of %u  (mode switches %u)\n",
+               (unsigned)(ss->events_emitted + host.dec.burst.events_emitted), (unsigned)events_offered,
+               (unsigned)ss->mode_switches);
+    }
+    for (uint32_t i = 0u; i < host.log_count; ++i) {
+        const aer_ctrl_rsp_t *r = &host.log[i].rsp;
+        const char *cmd = aer_ctrl_cmd_name(r->cmd);
+        const char *st = aer_ctrl_status_name(r->status);
+        printf("  ctrl   %8llu us  %s #%u -> %s", (unsigned long long)host.log[i].t_us,
+               cmd ? cmd : "?", (unsigned)r->tag, st ? st : "?");
+        for (uint32_t k = 0u; k < host.log[i].n; ++k) {
+            const char *name = aer_ctrl_param_name(host.log[i].kv[k].key);
+            printf("%s%s=%u", k ? "," : " ", name ? name : "?", (unsigned)host.log[i].kv[k].value);
+        }
+        printf("\n");
+    }
+    if (o.ctrl_count != 0u && (host.ctrl_rsp != o.ctrl_count || usb_ctrl_counters()->cmds_failed != 0u)) {
+        printf("  ctrl   %u of %u commands answered, %u failed\n", (unsigned)host.ctrl_rsp,
+               (unsigned)o.ctrl_count, (unsigned)usb_ctrl_counters()->cmds_failed);
+    }
+    if (o.link_bps) {
+        printf("  link   %u bytes/s  latency avg %.1f us max %.1f us  frames_failed %u%s\n",
+               (unsigned)o.link_bps, fs->frames ? (double)fs->latency_sum_ns / fs->frames * 1e-3 : 0.0,
+               (double)fs->latency_max_ns * 1e-3, (unsigned)hs->frames_failed,
+               drained ? "" : "  (not drained)");
+    }
+    printf("  loss   %u of %u words (%.2f%%)\n", (unsigned)lost, (unsigned)tx->words_total,
+           tx->words_total ? 100.0 * (double)lost / (double)tx->words_total : 0.0);
+
+    if (cap) fclose(cap);
+    hal_sim_shutdown();
+    return (tx->protocol_errors == 0u) ? 0 : 1;
+}
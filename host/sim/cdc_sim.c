@@ -0,0 +1,104 @@
+/*
+ * host/sim/cdc_sim.c
+ *
+ * CDC TX FIFO + fixed-rate link model (see cdc_sim.h).
+ */
+
+#include "cdc_sim.h"
+
+#include <string.h>
+
+#include "hal_stdio.h"   /* HAL_STREAM_HDR_LEN */
+
+/* Largest frame reassembled (header + uint16 payload). */
+#define CDC_SIM_FRAME_MAX (HAL_STREAM_HDR_LEN + 0xFFFFu)
+
+static struct {
+    cdc_sim_cfg_t      cfg;
+    cdc_sim_frame_fn_t fn;
+    void              *user;
+    uint64_t           ps_per_byte;   /* 0 = unlimited */
+    uint64_t           busy_until_ps; /* arrival of the last accepted byte */
+    cdc_sim_stats_t    stats;
+
+    /* Host side reassembly */
+    uint8_t  frame[CDC_SIM_FRAME_MAX];
+    uint32_t have;
+} c;
+
+static inline uint64_t max_u64(uint64_t a, uint64_t b) { return (a > b) ? a : b; }
+
+void cdc_sim_init(const cdc_sim_cfg_t *cfg, cdc_sim_frame_fn_t fn, void *user)
+{
+    memset(&c, 0, sizeof(c));
+    if (cfg) c.cfg = *cfg;
+    if (c.cfg.fifo_bytes == 0u) c.cfg.fifo_bytes = 256u;
+    c.ps_per_byte = c.cfg.bytes_per_s ? (1000000000000ull / c.cfg.bytes_per_s) : 0u;
+    if (c.cfg.bytes_per_s && c.ps_per_byte == 0u) c.ps_per_byte = 1u;
+    c.fn = fn;
+    c.user = user;
+}
+
+uint32_t cdc_sim_fifo_level(uint64_t now_ns)
+{
+    const uint64_t now_ps = now_ns * 1000u;
+    if (c.ps_per_byte == 0u || c.busy_until_ps <= now_ps) return 0u;
+    /* Bytes arrive back to back while the link is busy: the ones left are
+     * the ones that still fit before busy_until. */
+    const uint64_t left = (c.busy_until_ps - now_ps + c.ps_per_byte - 1u) / c.ps_per_byte;
+    return (left > c.cfg.fifo_bytes) ? c.cfg.fifo_bytes : (uint32_t)left;
+}
+
+uint64_t cdc_sim_next_room_ns(uint64_t now_ns)
+{
+    const uint32_t level = cdc_sim_fifo_level(now_ns);
+    if (level < c.cfg.fifo_bytes) return now_ns;
+    /* The oldest queued byte arrives (fifo_bytes - 1) byte times before the last. */
+    const uint64_t t_ps = c.busy_until_ps - (uint64_t)(c.cfg.fifo_bytes - 1u) * c.ps_per_byte;
+    return (t_ps + 999u) / 1000u;
+}
+
+/* One byte reaches the host at t_ps: feed the AERS reassembler. */
+static void host_rx_byte(uint8_t byte, uint64_t t_ps)
+{
+    static const uint8_t magic[4] = { 'A', 'E', 'R', 'S' };
+
+    if (c.have < 4u && byte != magic[c.have]) {
+        /* Resync on magic like the host tools do. */
+        c.have = (byte == magic[0]) ? 1u : 0u;
+        return;
+    }
+    c.frame[c.have++] = byte;
+    if (c.have < HAL_STREAM_HDR_LEN) return;
+
+    const uint32_t len = (uint32_t)c.frame[6] | ((uint32_t)c.frame[7] << 8);
+    if (c.have < HAL_STREAM_HDR_LEN + len) return;
+
+    if (c.fn) c.fn(c.frame, c.have, (t_ps + 999u) / 1000u, c.user);
+    c.have = 0u;
+}
+
+uint32_t cdc_sim_write(const uint8_t *buf, uint32_t len, uint64_t now_ns)
+{
+    c.stats.writes++;
+    uint32_t n = len;
+    if (c.ps_per_byte) {
+        const uint32_t room = c.cfg.fifo_bytes - cdc_sim_fifo_level(now_ns);
+        if (n > room) n = room;
+    }
+    if (n < len) c.stats.writes_short++;
+
+    const uint64_t now_ps = now_ns * 1000u;
+    uint64_t t = max_u64(c.busy_until_ps, now_ps);
+    for (uint32_t i = 0u; i < n; ++i) {
+        t += c.ps_per_byte;
+        host_rx_byte(buf[i], t);
+    }
+    if (n) c.busy_until_ps = t;
+
+    c.stats.bytes += n;
+    c.stats.busy_until_ns = (c.busy_until_ps + 999u) / 1000u;
+    return n;
+}
+
+const cdc_sim_stats_t *cdc_sim_stats(void) { return &c.stats; }
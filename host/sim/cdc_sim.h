@@ -0,0 +1,60 @@
+#ifndef CDC_SIM_H
+#define CDC_SIM_H
+
+/*
+ * host/sim/cdc_sim.h
+ *
+ * Host stand-in for the device side of the USB CDC endpoint: the TX FIFO
+ * TinyUSB exposes (tud_cdc_write()) and the link draining it to the host at
+ * a fixed byte rate, in the simulator's virtual time.
+ *
+ * Every accepted byte gets the time it reaches the host when it is
+ * accepted: max(now, previous byte's arrival) + 1/rate. The FIFO level at
+ * time t is the number of bytes not yet arrived, so a write only takes what
+ * fits. The byte stream is split back into AERS frames, reported with the
+ * arrival time of their last byte (hal_sim uses that for latency).
+ *
+ * bytes_per_s == 0 models an unlimited link: bytes arrive when written and
+ * the FIFO never fills.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cdc_sim_cfg_s {
+    uint32_t bytes_per_s;   /* link throughput to the host (0 = unlimited) */
+    uint32_t fifo_bytes;    /* device TX FIFO (TinyUSB CFG_TUD_CDC_TX_BUFSIZE) */
+} cdc_sim_cfg_t;
+
+typedef struct cdc_sim_stats_s {
+    uint64_t bytes;          /* accepted into the FIFO */
+    uint32_t writes;         /* write calls */
+    uint32_t writes_short;   /* write calls that could not take everything */
+    uint64_t busy_until_ns;  /* arrival time of the last accepted byte */
+} cdc_sim_stats_t;
+
+/* Called for every complete frame (header included) as it reaches the host. */
+typedef void (*cdc_sim_frame_fn_t)(const uint8_t *frame, uint32_t len, uint64_t t_arrive_ns, void *user);
+
+void cdc_sim_init(const cdc_sim_cfg_t *cfg, cdc_sim_frame_fn_t fn, void *user);
+
+/* Accept up to len bytes at now_ns; returns how many fit in the FIFO. */
+uint32_t cdc_sim_write(const uint8_t *buf, uint32_t len, uint64_t now_ns);
+
+/* Bytes still in the FIFO at now_ns. */
+uint32_t cdc_sim_fifo_level(uint64_t now_ns);
+
+/* When the FIFO level next drops (now_ns if it has room already). */
+uint64_t cdc_sim_next_room_ns(uint64_t now_ns);
+
+const cdc_sim_stats_t *cdc_sim_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CDC_SIM_H */
@@ -0,0 +1,143 @@
+/*
+ * host/sim/hal_pio_rx_sim.c
+ *
+ * Host hal_pio_rx.h: assembles pico_aer_rx/aer_rx.pio (embedded by the
+ * Makefile as aer_rx_pio_src.h), runs it in the PIO model one state machine
+ * clock at a time on the bus core's virtual clock (hal_sim bus agent), and
+ * models the DMA channel: one word per clock from the RX FIFO into the ring
+ * while armed, wrapping like the hardware write ring.
+ */
+
+#include "hal_pio_rx.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hal_gpio.h"
+#include "hal_sim.h"
+#include "hal_time.h"
+#include "pio_sim.h"
+
+#include "aer_rx_pio_src.h"   /* static const char aer_rx_pio_src[] */
+
+static struct {
+    bool              running;
+    pio_sim_program_t prog;
+    pio_sim_t         sm;
+    uint64_t          t0_ns;        /* time of clock 0 */
+    uint64_t          t_ns;         /* time of the clock being executed */
+    uint32_t          clk_hz;
+    uint8_t           data_base;
+    uint8_t           ack_pin;
+
+    /* DMA */
+    uint32_t *ring;
+    uint32_t  mask;
+    uint32_t  widx;
+    uint32_t  remaining;
+} p;
+
+static uint32_t sim_read_pins(void *user)
+{
+    (void)user;
+    return hal_sim_bus_data(p.t_ns) << p.data_base;
+}
+
+static void sim_write_pins(uint32_t values, uint32_t mask, void *user)
+{
+    (void)user;
+    if ((mask >> p.ack_pin) & 1u) {
+        hal_sim_bus_ack(p.t_ns, ((values >> p.ack_pin) & 1u) != 0u);
+    }
+}
+
+static inline uint64_t clock_time_ns(uint64_t cycle)
+{
+    return p.t0_ns + (cycle * 1000000000ull) / p.clk_hz;
+}
+
+/* Bus agent: run every PIO clock (and DMA beat) up to until_ns. */
+static void pio_agent(uint64_t until_ns, void *user)
+{
+    (void)user;
+    for (;;) {
+        const uint64_t t = clock_time_ns(p.sm.stats.cycles);
+        if (t > until_ns) break;
+        p.t_ns = t;
+        pio_sim_step(&p.sm);
+
+        if (p.remaining != 0u) {
+            uint32_t w;
+            if (pio_sim_rx_get(&p.sm, &w)) {
+                p.ring[p.widx] = w;
+                p.widx = (p.widx + 1u) & p.mask;
+                p.remaining--;
+            }
+        }
+    }
+}
+
+bool hal_pio_rx_init(uint32_t *ring, uint32_t ring_words, uint32_t start_idx)
+{
+    if (!ring || ring_words < 2u || (ring_words & (ring_words - 1u)) != 0u) return false;
+
+    char err[128];
+    if (!pio_sim_assemble(aer_rx_pio_src, "aer_rx", &p.prog, err, sizeof(err))) {
+        fprintf(stderr, "hal_pio_rx_sim: aer_rx.pio: %s\n", err);
+        return false;
+    }
+    int32_t data_bits = 0;
+    if (!pio_sim_symbol(&p.prog, "DATA_BITS", &data_bits) || data_bits != (int32_t)hal_gpio_data_width()) {
+        return false;
+    }
+
+    p.data_base = hal_gpio_data_base();
+    p.ack_pin = hal_gpio_ack_pin();
+    if (p.ack_pin >= 32u || p.data_base + hal_gpio_data_width() > 32u) return false;
+
+    /* aer_rx_program_init() */
+    pio_sim_sm_cfg_t cfg = pio_sim_sm_cfg_default();
+    cfg.in_base = p.data_base;
+    cfg.in_count = (uint8_t)data_bits;
+    cfg.sideset_base = p.ack_pin;
+    cfg.fifo_join_rx = true;
+    pio_sim_init(&p.sm, &p.prog, &cfg, sim_read_pins, sim_write_pins, NULL);
+
+    p.ring = ring;
+    p.mask = ring_words - 1u;
+    p.widx = start_idx & p.mask;
+    p.remaining = 0u;
+    p.clk_hz = hal_cycles_hz();
+    p.t0_ns = hal_sim_now_ns();
+    p.t_ns = p.t0_ns;
+    p.running = true;
+    hal_sim_set_bus_agent(pio_agent, NULL);
+    return true;
+}
+
+void hal_pio_rx_deinit(void)
+{
+    if (!p.running) return;
+    hal_sim_set_bus_agent(NULL, NULL);
+    p.running = false;
+    p.remaining = 0u;
+    hal_sim_bus_ack(hal_sim_now_ns(), false);
+}
+
+bool hal_pio_rx_dma_busy(void) { return p.remaining != 0u; }
+
+uint32_t hal_pio_rx_dma_write_index(void) { return p.widx; }
+
+void hal_pio_rx_dma_arm(uint32_t n) { p.remaining = n; }
+
+bool hal_pio_rx_take_stall(void)
+{
+    const bool s = p.sm.rxstall;
+    p.sm.rxstall = false;
+    return s;
+}
+
+uint32_t hal_pio_rx_fifo_level(void) { return pio_sim_rx_level(&p.sm); }
+
+/* Model state for tests/tools (cycle counts). */
+const pio_sim_t *hal_pio_rx_sim_sm(void) { return p.running ? &p.sm : NULL; }
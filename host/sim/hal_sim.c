@@ -0,0 +1,602 @@
+/*
+ * host/sim/hal_sim.c
+ *
+ * Host HAL: virtual clock, simulated DI transmitter, framed stream sink.
+ * Implements hal_gpio.h, hal_time.h and hal_stdio.h on top of hal_sim.h.
+ */
+
+#include "hal_sim.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_gpio.h"
+#include "hal_time.h"
+#include "hal_stdio.h"
+#include "cdc_sim.h"
+#include "hal_dlog.h"
+
+/* ---------------- State ---------------- */
+
+typedef enum tx_state_e {
+    TX_IDLE = 0,    /* DATA neutral, waiting for the next word's time (and ACK low) */
+    TX_VALID,       /* word on DATA, waiting for ACK high */
+    TX_CLEARING,    /* ACK seen, DATA still valid for data_clear_ns */
+    TX_NEUTRAL      /* DATA neutral, waiting for ACK low */
+} tx_state_t;
+
+#define HOST_RX_QUEUE_LEN 256u
+
+static struct {
+    hal_sim_cfg_t cfg;
+    uint64_t      now_ns[HAL_SIM_CORES];
+    uint8_t       bus_core;
+
+    /* Bus */
+    uint32_t data;
+    bool     ack;
+    hal_gpio_cfg_t gpio;
+    uint32_t data_mask;
+
+    /* Transmitter */
+    aer_raw_word_t *words;
+    uint64_t       *sched_ns;
+    uint32_t        n_words;
+    uint32_t        next;
+    tx_state_t      st;
+    uint64_t        t_ready;   /* earliest time the next word may be driven */
+    uint64_t        t_valid;   /* when the current word was driven */
+    uint64_t        t_clear;   /* when DATA goes neutral (TX_CLEARING) */
+    hal_sim_tx_stats_t tx_stats;
+
+    /* Another bus master (PIO model) run along with the bus core's clock */
+    hal_sim_agent_fn_t agent_fn;
+    void              *agent_user;
+
+    /* Stream */
+    bool               connected;
+    hal_stream_tx_t    tx;
+    uint64_t           t_write[65536]; /* write time by frame seq */
+    hal_stream_stats_t stream_stats;
+    hal_sim_stream_stats_t sim_stream;
+    hal_sim_frame_fn_t frame_fn;
+    void              *frame_user;
+    FILE              *capture;
+    hal_log_level_t    log_level;
+    bool               packetized;
+
+    /* Host -> device bytes */
+    uint8_t  host_q[HOST_RX_QUEUE_LEN];
+    uint32_t host_head;
+    uint32_t host_tail;
+} g;
+
+/* Core the calling thread runs as. */
+static _Thread_local uint8_t t_core = 0u;
+
+/* Stream TX port and host-side frame sink (see "Stream" below). */
+static bool     sim_port_connected(void *ctx);
+static uint32_t sim_port_write(void *ctx, const uint8_t *buf, uint32_t len);
+static void     on_host_frame(const uint8_t *frame, uint32_t len, uint64_t t_arrive_ns, void *user);
+
+/* ---------------- Transmitter ---------------- */
+
+static inline uint64_t max_u64(uint64_t a, uint64_t b) { return (a > b) ? a : b; }
+
+/* When the next word goes on the bus (only meaningful in TX_IDLE with words left). */
+static inline uint64_t tx_drive_time(void)
+{
+    return max_u64(g.sched_ns[g.next], g.t_ready);
+}
+
+/* Advance the sender to time now given the current ACK level. */
+static void bus_update(uint64_t now)
+{
+    for (;;) {
+        switch (g.st) {
+        case TX_IDLE:
+            if (g.next >= g.n_words || g.ack) return;
+            {
+                const uint64_t t = tx_drive_time();
+                if (now < t) return;
+                g.data = (uint32_t)g.words[g.next] & g.data_mask;
+                g.t_valid = t;
+                g.st = TX_VALID;
+                g.tx_stats.words_driven++;
+                const uint64_t behind = t - g.sched_ns[g.next];
+                if (behind > g.tx_stats.behind_max_ns) g.tx_stats.behind_max_ns = behind;
+            }
+            break;
+
+        case TX_VALID:
+            if (!g.ack) return;
+            {
+                const uint64_t w = now - g.t_valid;
+                g.tx_stats.wait_ack_ns += w;
+                if (w > g.tx_stats.wait_ack_max_ns) g.tx_stats.wait_ack_max_ns = w;
+            }
+            g.t_clear = now + g.cfg.tx.data_clear_ns;
+            g.st = TX_CLEARING;
+            break;
+
+        case TX_CLEARING:
+            if (!g.ack) {
+                /* ACK dropped before DATA went neutral: the word stays up. */
+                g.tx_stats.protocol_errors++;
+                g.st = TX_VALID;
+                return;
+            }
+            if (now < g.t_clear) return;
+            g.data = 0u;
+            g.st = TX_NEUTRAL;
+            break;
+
+        case TX_NEUTRAL:
+            if (g.ack) return;
+            g.tx_stats.words_acked++;
+            g.next++;
+            g.t_ready = now + g.cfg.tx.setup_ns;
+            g.st = TX_IDLE;
+            break;
+        }
+    }
+}
+
+/* ---------------- Simulator control ---------------- */
+
+hal_sim_cfg_t hal_sim_cfg_default(void)
+{
+    hal_sim_cfg_t cfg;
+    cfg.clk_hz = 150000000u;
+    cfg.cost.gpio_read_ns    = 20u;
+    cfg.cost.gpio_write_ns   = 20u;
+    cfg.cost.spin_ns         = 10u;
+    cfg.cost.usb_ns_per_byte = 0u;
+    cfg.tx.tick_ns       = 50u;
+    cfg.tx.data_clear_ns = 20u;
+    cfg.tx.setup_ns      = 20u;
+    cfg.cdc.bytes_per_s = 0u;
+    cfg.cdc.fifo_bytes  = 256u;
+    cfg.connected = true;
+    return cfg;
+}
+
+void hal_sim_init(const hal_sim_cfg_t *cfg)
+{
+    hal_sim_shutdown();
+    memset(&g, 0, sizeof(g));
+    g.cfg = cfg ? *cfg : hal_sim_cfg_default();
+    if (g.cfg.clk_hz < 1000000u) g.cfg.clk_hz = 1000000u;
+
+    g.gpio = (hal_gpio_cfg_t){
+        .data_base = 2u, .data_width = 12u, .ack_pin = 14u, .ack_active_high = true,
+    };
+    g.data_mask = (1u << g.gpio.data_width) - 1u;
+
+    t_core = 0u;
+    atomic_store_explicit(&hal_cycles_epoch, 0u, memory_order_relaxed);  /* virtual time restarts at 0 */
+    g.connected  = g.cfg.connected;
+    cdc_sim_init(&g.cfg.cdc, on_host_frame, NULL);
+    const hal_stream_port_t port = {
+        .connected = sim_port_connected,
+        .write     = sim_port_write,
+        .flush     = NULL,
+        .ctx       = NULL,
+    };
+    hal_stream_tx_init(&g.tx, &port);
+    hal_dlog_init();
+    g.log_level  = HAL_LOG_INFO;
+    g.packetized = true;
+}
+
+void hal_sim_shutdown(void)
+{
+    free(g.words);
+    free(g.sched_ns);
+    g.words = NULL;
+    g.sched_ns = NULL;
+    g.n_words = 0u;
+    g.next = 0u;
+}
+
+bool hal_sim_load_waveform(const aer_waveform_t *wf)
+{
+    free(g.words);
+    free(g.sched_ns);
+    g.words = NULL;
+    g.sched_ns = NULL;
+    g.n_words = 0u;
+    g.next = 0u;
+    g.st = TX_IDLE;
+    g.tx_stats = (hal_sim_tx_stats_t){0};
+    if (!wf || wf->len == 0u) return true;
+
+    /* Upper bound: one word per sample. */
+    g.words = (aer_raw_word_t *)malloc(wf->len * sizeof(*g.words));
+    g.sched_ns = (uint64_t *)malloc(wf->len * sizeof(*g.sched_ns));
+    if (!g.words || !g.sched_ns) {
+        hal_sim_shutdown();
+        return false;
+    }
+
+    aer_raw_word_t prev = 0u;
+    for (size_t i = 0; i < wf->len; ++i) {
+        const aer_raw_word_t d = wf->samples[i].data;
+        if (d != 0u && prev == 0u) {
+            g.words[g.n_words] = d;
+            g.sched_ns[g.n_words] = wf->samples[i].t * (uint64_t)g.cfg.tx.tick_ns;
+            g.n_words++;
+        }
+        prev = d;
+    }
+    g.tx_stats.words_total = g.n_words;
+    return true;
+}
+
+bool hal_sim_tx_done(void)
+{
+    return g.next >= g.n_words && g.st == TX_IDLE;
+}
+
+const hal_sim_tx_stats_t *hal_sim_tx_stats(void) { return &g.tx_stats; }
+const hal_sim_stream_stats_t *hal_sim_stream_stats(void) { return &g.sim_stream; }
+
+void hal_sim_set_core(uint8_t core) { t_core = (core < HAL_SIM_CORES) ? core : 0u; }
+uint8_t hal_sim_core(void) { return t_core; }
+
+void hal_sim_set_bus_core(uint8_t core) { g.bus_core = (core < HAL_SIM_CORES) ? core : 0u; }
+
+uint64_t hal_sim_now_ns(void) { return g.now_ns[t_core]; }
+
+uint64_t hal_sim_core_now_ns(uint8_t core)
+{
+    return (core < HAL_SIM_CORES) ? g.now_ns[core] : 0u;
+}
+
+void hal_sim_advance_ns(uint64_t ns)
+{
+    const uint64_t t = g.now_ns[t_core] + ns;
+    if (t_core != g.bus_core) {
+        g.now_ns[t_core] = t;
+        return;
+    }
+    if (g.agent_fn) g.agent_fn(t, g.agent_user);
+    g.now_ns[t_core] = t;
+    bus_update(t);
+}
+
+void hal_sim_set_bus_agent(hal_sim_agent_fn_t fn, void *user)
+{
+    g.agent_fn = fn;
+    g.agent_user = user;
+}
+
+uint32_t hal_sim_bus_data(uint64_t t_ns)
+{
+    bus_update(t_ns);
+    return g.data & g.data_mask;
+}
+
+void hal_sim_bus_ack(uint64_t t_ns, bool asserted)
+{
+    bus_update(t_ns);
+    if (asserted && !g.ack && g.st == TX_IDLE) {
+        g.tx_stats.protocol_errors++;   /* ACK without a word on the bus */
+    }
+    g.ack = asserted;
+    bus_update(t_ns);
+}
+
+void hal_sim_spin(void)
+{
+    hal_sim_advance_ns(g.cfg.cost.spin_ns);
+    if (t_core != g.bus_core) return;
+
+    /* Skip dead time: nothing changes on the bus until the sender's next step. */
+    const uint64_t now = g.now_ns[t_core];
+    uint64_t t = now;
+    if (g.st == TX_IDLE && g.next < g.n_words && !g.ack) {
+        t = tx_drive_time();
+    } else if (g.st == TX_CLEARING) {
+        t = g.t_clear;
+    }
+    if (t > now) {
+        g.tx_stats.skipped_ns += t - now;
+        hal_sim_advance_ns(t - now);
+    }
+}
+
+void hal_sim_set_connected(bool connected) { g.connected = connected; }
+bool hal_sim_connected(void) { return g.connected; }
+
+void hal_sim_set_frame_sink(hal_sim_frame_fn_t fn, void *user)
+{
+    g.frame_fn = fn;
+    g.frame_user = user;
+}
+
+void hal_sim_set_capture(FILE *f) { g.capture = f; }
+
+bool hal_sim_host_write(const uint8_t *data, size_t len)
+{
+    if (!data && len != 0u) return false;
+    for (size_t i = 0; i < len; ++i) {
+        const uint32_t nh = (g.host_head + 1u) % HOST_RX_QUEUE_LEN;
+        if (nh == g.host_tail) return false;
+        g.host_q[g.host_head] = data[i];
+        g.host_head = nh;
+    }
+    return true;
+}
+
+/* ---------------- hal_gpio.h ---------------- */
+
+void hal_gpio_init(const hal_gpio_cfg_t *cfg)
+{
+    if (cfg) g.gpio = *cfg;
+    if (g.gpio.data_width == 0u || g.gpio.data_width > 32u) g.gpio.data_width = 32u;
+    g.data_mask = (g.gpio.data_width >= 32u) ? 0xFFFFFFFFu : ((1u << g.gpio.data_width) - 1u);
+    g.ack = false;
+}
+
+void hal_gpio_idle(void)
+{
+    hal_gpio_ack_write(false);
+}
+
+uint64_t hal_gpio_read_all(void)
+{
+    hal_sim_advance_ns(g.cfg.cost.gpio_read_ns);
+    const bool ack_level = g.gpio.ack_active_high ? g.ack : !g.ack;
+    return ((uint64_t)(g.data & g.data_mask) << g.gpio.data_base)
+         | ((uint64_t)(ack_level ? 1u : 0u) << g.gpio.ack_pin);
+}
+
+uint32_t hal_gpio_read_data_raw(void)
+{
+    hal_sim_advance_ns(g.cfg.cost.gpio_read_ns);
+    return g.data & g.data_mask;
+}
+
+void hal_gpio_ack_write(bool asserted)
+{
+    hal_sim_advance_ns(g.cfg.cost.gpio_write_ns);
+    hal_sim_bus_ack(g.now_ns[g.bus_core], asserted);
+}
+
+bool hal_gpio_ack_is_asserted(void) { return g.ack; }
+
+uint8_t hal_gpio_data_base(void)  { return g.gpio.data_base; }
+uint8_t hal_gpio_data_width(void) { return g.gpio.data_width; }
+uint8_t hal_gpio_ack_pin(void)    { return g.gpio.ack_pin; }
+
+uint64_t hal_gpio_data_mask64(void)
+{
+    return (uint64_t)g.data_mask << g.gpio.data_base;
+}
+
+/* ---------------- hal_time.h ---------------- */
+
+_Atomic uint32_t hal_cycles_epoch = 0u;
+
+void hal_time_init(void) {}
+void hal_time_init_core(void) {}
+uint32_t hal_time_core_num(void) { return t_core; }
+
+uint64_t hal_time_us_now(void)
+{
+    return g.now_ns[t_core] / 1000u;
+}
+
+bool hal_time_expired(uint64_t deadline_us)
+{
+    const int64_t diff = (int64_t)(deadline_us - hal_time_us_now());
+    return (diff <= 0);
+}
+
+uint32_t hal_time_remaining_us(uint64_t deadline_us)
+{
+    const uint64_t now = hal_time_us_now();
+    if (deadline_us <= now) return 0;
+    const uint64_t rem = deadline_us - now;
+    return (rem > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)rem;
+}
+
+void hal_time_wait_until(uint64_t deadline_us)
+{
+    const uint64_t t = deadline_us * 1000u;
+    if (t > g.now_ns[t_core]) hal_sim_advance_ns(t - g.now_ns[t_core]);
+}
+
+void hal_time_sleep_us(uint32_t us) { hal_sim_advance_ns((uint64_t)us * 1000u); }
+void hal_time_spin_us(uint32_t us)  { hal_sim_advance_ns((uint64_t)us * 1000u); }
+
+uint32_t hal_cycles_now(void)
+{
+    /* Split to keep ns * Hz inside 64 bits for long runs. */
+    const uint64_t per_us = g.cfg.clk_hz / 1000000u;
+    const uint64_t ns = g.now_ns[t_core];
+    return (uint32_t)((ns / 1000u) * per_us + ((ns % 1000u) * per_us) / 1000u);
+}
+
+uint32_t hal_cycles_hz(void) { return g.cfg.clk_hz; }
+
+bool hal_cycles_is_exact(void) { return true; }
+
+uint32_t hal_cycles_to_us(uint32_t cycles)
+{
+    return cycles / (g.cfg.clk_hz / 1000000u);
+}
+
+uint32_t hal_us_to_cycles(uint32_t us)
+{
+    const uint64_t c = (uint64_t)us * (uint64_t)(g.cfg.clk_hz / 1000000u);
+    return (c > 0xFFFFFFFFu) ? 0xFFFFFFFFu : (uint32_t)c;
+}
+
+void hal_time_spin_cycles(uint32_t cycles)
+{
+    hal_sim_advance_ns(((uint64_t)cycles * 1000u) / (g.cfg.clk_hz / 1000000u));
+}
+
+/* ---------------- hal_stdio.h ---------------- */
+
+void hal_stdio_init(bool wait_for_usb, uint32_t timeout_ms)
+{
+    (void)wait_for_usb;
+    (void)timeout_ms;
+}
+
+bool hal_stdio_is_connected(void) { return g.connected; }
+
+bool hal_stdio_wait_connected(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    return g.connected;
+}
+
+void hal_log_set_level(hal_log_level_t level) { g.log_level = level; }
+hal_log_level_t hal_log_get_level(void) { return g.log_level; }
+
+void hal_stdio_set_packetized(bool enabled) { g.packetized = enabled; }
+bool hal_stdio_get_packetized(void) { return g.packetized; }
+
+void hal_stdio_flush(void)
+{
+    hal_stream_poll();
+    if (g.capture) fflush(g.capture);
+}
+
+int hal_stdio_getc_nonblocking(void)
+{
+    if (g.host_tail == g.host_head) return -1;
+    const uint8_t c = g.host_q[g.host_tail];
+    g.host_tail = (g.host_tail + 1u) % HOST_RX_QUEUE_LEN;
+    return c;
+}
+
+/* Stream TX: the firmware's buffers (hal_stream_tx.c) drained into the
+ * CDC model; frames reach the sinks when their last byte reaches the host. */
+static bool sim_port_connected(void *ctx)
+{
+    (void)ctx;
+    return g.connected;
+}
+
+static uint32_t sim_port_write(void *ctx, const uint8_t *buf, uint32_t len)
+{
+    (void)ctx;
+    return cdc_sim_write(buf, len, g.now_ns[t_core]);
+}
+
+static void on_host_frame(const uint8_t *frame, uint32_t len, uint64_t t_arrive_ns, void *user)
+{
+    (void)user;
+    const uint8_t  type = frame[5];
+    const uint16_t seq  = (uint16_t)(frame[8] | (frame[9] << 8));
+    const uint16_t plen = (uint16_t)(len - HAL_STREAM_HDR_LEN);
+
+    if (g.capture) (void)fwrite(frame, 1, len, g.capture);
+    if (g.frame_fn) g.frame_fn(type, seq, frame + HAL_STREAM_HDR_LEN, plen, g.frame_user);
+
+    g.sim_stream.frames++;
+    g.sim_stream.frames_by_type[type < 16u ? type : 0u]++;
+    g.sim_stream.bytes += len;
+
+    const uint64_t t_w = g.t_write[seq];
+    const uint64_t lat = (t_arrive_ns > t_w) ? t_arrive_ns - t_w : 0u;
+    g.sim_stream.latency_sum_ns += lat;
+    if (lat > g.sim_stream.latency_max_ns) g.sim_stream.latency_max_ns = lat;
+}
+
+bool hal_stream_writev(hal_stream_type_t type, const hal_iovec_t *iov, uint32_t iovcnt)
+{
+    /* One stream writer at a time in the simulator, so the seq is known up front. */
+    g.t_write[hal_stream_tx_next_seq(&g.tx)] = g.now_ns[t_core];
+
+    const bool ok = hal_stream_tx_writev(&g.tx, (uint8_t)type, iov, iovcnt, NULL);
+    if (ok) {
+        /* The CPU is busy copying the frame meanwhile. */
+        uint32_t len = HAL_STREAM_HDR_LEN;
+        for (uint32_t i = 0u; i < iovcnt; ++i) {
+            if (iov[i].base) len += iov[i].len;
+        }
+        hal_sim_advance_ns((uint64_t)len * g.cfg.cost.usb_ns_per_byte);
+    }
+    return ok;
+}
+
+void hal_stream_poll(void)
+{
+    hal_stream_tx_kick(&g.tx);
+}
+
+const hal_stream_stats_t *hal_stream_stats(void)
+{
+    g.stream_stats.frames_written       = atomic_load_explicit(&g.tx.stats.frames_written, memory_order_relaxed);
+    g.stream_stats.frames_failed        = atomic_load_explicit(&g.tx.stats.frames_failed, memory_order_relaxed);
+    g.stream_stats.frames_not_connected = atomic_load_explicit(&g.tx.stats.frames_not_connected, memory_order_relaxed);
+    g.stream_stats.bytes_sent           = atomic_load_explicit(&g.tx.stats.bytes_sent, memory_order_relaxed);
+    g.stream_stats.bytes_dropped        = atomic_load_explicit(&g.tx.stats.bytes_dropped, memory_order_relaxed);
+    return &g.stream_stats;
+}
+
+bool hal_sim_stream_drain(uint64_t timeout_ns)
+{
+    const uint64_t t_end = g.now_ns[t_core] + timeout_ns;
+    for (;;) {
+        hal_stream_tx_kick(&g.tx);
+        if (hal_stream_tx_pending(&g.tx) == 0u) return true;
+
+        const uint64_t now = g.now_ns[t_core];
+        const uint64_t t = cdc_sim_next_room_ns(now);
+        if (t >= t_end) return false;
+        hal_sim_advance_ns((t > now) ? t - now : 1u);
+    }
+}
+
+bool hal_stream_write_event_u16(uint16_t row, uint16_t col, uint32_t t_us, uint8_t flags)
+{
+    struct __attribute__((packed)) evt_s {
+        uint16_t row;
+        uint16_t col;
+        uint32_t t_us;
+        uint8_t  flags;
+        uint8_t  rsvd[3];
+    } e = { row, col, t_us, flags, {0u, 0u, 0u} };
+
+    return hal_stream_write(HAL_STREAM_EVENT_BIN, &e, (uint16_t)sizeof(e));
+}
+
+bool hal_stream_marker(const char *text)
+{
+    if (!text) return false;
+    size_t n = 0u;
+    while (n < 240u && text[n] != '\0') n++;
+    return hal_stream_write(HAL_STREAM_MARKER, text, (uint16_t)n);
+}
+
+void hal_vlogf(hal_log_level_t level, const char *fmt, va_list ap)
+{
+    if (level > g.log_level) return;
+
+    char msg[256];
+    int n = vsnprintf(msg, sizeof(msg), fmt, ap);
+    if (n < 0) return;
+    if ((size_t)n >= sizeof(msg)) n = (int)sizeof(msg) - 1;
+
+    if (g.packetized) {
+        (void)hal_stream_write(HAL_STREAM_LOG_TEXT, msg, (uint16_t)n);
+    } else {
+        fprintf(stderr, "[%lu] %s\n", (unsigned long)(hal_time_us_now() / 1000u), msg);
+    }
+}
+
+void hal_logf(hal_log_level_t level, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    hal_vlogf(level, fmt, ap);
+    va_end(ap);
+}
@@ -0,0 +1,183 @@
+#ifndef HAL_SIM_H
+#define HAL_SIM_H
+
+/*
+ * host/sim/hal_sim.h
+ *
+ * Host implementation of the pico_aer_rx HAL (hal_gpio.h, hal_time.h,
+ * hal_stdio.h) so the real firmware sources (aer_rx_poll.c, usb_stream.c,
+ * aer_event_sink.c) build and run on Linux.
+ *
+ * Model:
+ * - One virtual clock in nanoseconds per simulated core. Every HAL call
+ *   costs virtual time (hal_sim_cost_t) on the calling core's clock, and
+ *   hal_time_* / hal_cycles_* read that clock. Host wall-clock time is never
+ *   consulted, so single-threaded runs are deterministic.
+ * - A simulated DI 4-phase transmitter owns DATA. Its words and their
+ *   earliest send times come from an aer_waveform_t (host/aer_tx_model.c);
+ *   the ACK levels recorded in the waveform are ignored because the real
+ *   receiver drives ACK here:
+ *     DATA=word (at max(scheduled, previous word done + setup))
+ *     wait ACK high -> DATA=neutral after data_clear_ns
+ *     wait ACK low  -> next word
+ *   A receiver that does not ACK stalls the sender (backpressure).
+ * - hal_stream_writev() runs the firmware's TX buffers (hal_stream_tx.c)
+ *   into a model of the CDC endpoint (host/sim/cdc_sim.c): a TX FIFO drained
+ *   at cdc.bytes_per_s. Frames reach the optional frame callback / capture
+ *   file when their last byte reaches the host, so a slow link shows up as
+ *   latency and, once both buffers are full, refused frames. The CPU time
+ *   spent copying a frame is usb_ns_per_byte of virtual time.
+ * - tight_loop_contents() (host/sim/pico.h) and the TinyUSB DTR calls
+ *   (host/sim/tusb.h) are routed here too.
+ *
+ * Cores (RP2350 core0/core1): a thread picks its core with
+ * hal_sim_set_core(). The bus moves with the clock of the bus core
+ * (hal_sim_set_bus_core(), the one running the handshake). Two host threads
+ * may run as two cores if only the bus core touches GPIO and only the other
+ * core writes the stream; cross-core waits are then not reflected in the
+ * virtual clocks, so use wall-clock time for throughput in that mode.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "aer_tx_model.h"   /* aer_waveform_t */
+#include "cdc_sim.h"        /* cdc_sim_cfg_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Virtual cost of each receiver-side HAL operation. */
+typedef struct hal_sim_cost_s {
+    uint32_t gpio_read_ns;      /* hal_gpio_read_data_raw() / hal_gpio_read_all() */
+    uint32_t gpio_write_ns;     /* hal_gpio_ack_write() */
+    uint32_t spin_ns;           /* tight_loop_contents() */
+    uint32_t usb_ns_per_byte;   /* hal_stream_writev(), header + payload (0 = free) */
+} hal_sim_cost_t;
+
+/* Simulated transmitter timing. */
+typedef struct hal_sim_tx_cfg_s {
+    uint32_t tick_ns;           /* length of one aer_waveform_t tick */
+    uint32_t data_clear_ns;     /* ACK rise -> DATA neutral */
+    uint32_t setup_ns;          /* ACK fall -> next word may be driven */
+} hal_sim_tx_cfg_t;
+
+typedef struct hal_sim_cfg_s {
+    uint32_t         clk_hz;    /* hal_cycles_hz(); RP2350 default 150 MHz */
+    hal_sim_cost_t   cost;
+    hal_sim_tx_cfg_t tx;
+    cdc_sim_cfg_t    cdc;       /* USB link (default: unlimited, 256-byte FIFO) */
+    bool             connected; /* initial CDC DTR state */
+} hal_sim_cfg_t;
+
+typedef struct hal_sim_tx_stats_s {
+    uint32_t words_total;       /* words loaded from the waveform */
+    uint32_t words_driven;      /* words put on DATA */
+    uint32_t words_acked;       /* full 4-phase cycles completed */
+    uint64_t wait_ack_ns;       /* sum over words of (ACK rise - DATA valid) */
+    uint64_t wait_ack_max_ns;
+    uint64_t behind_max_ns;     /* worst (driven - scheduled): how far the sender fell behind */
+    uint32_t protocol_errors;   /* ACK raised on neutral DATA or dropped while DATA valid */
+    uint64_t skipped_ns;        /* bus dead time hal_sim_spin() jumped over */
+} hal_sim_tx_stats_t;
+
+typedef struct hal_sim_stream_stats_s {
+    uint32_t frames;            /* frames received by the host */
+    uint32_t frames_by_type[16]; /* indexed by hal_stream_type_t (0 = other) */
+    uint64_t bytes;             /* header + payload bytes */
+    uint64_t latency_sum_ns;    /* sum over frames of (arrival - hal_stream_writev() call) */
+    uint64_t latency_max_ns;
+} hal_sim_stream_stats_t;
+
+/* Called for every framed packet the host receives; payload excludes the AERS header. */
+typedef void (*hal_sim_frame_fn_t)(uint8_t type, uint16_t seq,
+                                   const uint8_t *payload, uint16_t len, void *user);
+
+hal_sim_cfg_t hal_sim_cfg_default(void);
+
+/* Reset all simulator state (clock, bus, stream, host input) and apply cfg. */
+void hal_sim_init(const hal_sim_cfg_t *cfg);
+
+/* Release memory held by the simulator (loaded words). */
+void hal_sim_shutdown(void);
+
+/*
+ * Load the transmitter's words: every neutral -> non-neutral DATA transition
+ * in wf is one word, scheduled at its sample time * tick_ns. Replaces any
+ * previously loaded words. Returns false on allocation failure.
+ */
+bool hal_sim_load_waveform(const aer_waveform_t *wf);
+
+/* True once every loaded word completed its handshake and the bus is idle. */
+bool hal_sim_tx_done(void);
+
+const hal_sim_tx_stats_t     *hal_sim_tx_stats(void);
+const hal_sim_stream_stats_t *hal_sim_stream_stats(void);
+
+#define HAL_SIM_CORES 2u
+
+/* Simulated core the calling thread runs as (default 0). */
+void    hal_sim_set_core(uint8_t core);
+uint8_t hal_sim_core(void);
+
+/* Core whose clock drives the bus (default 0). Set before starting threads. */
+void hal_sim_set_bus_core(uint8_t core);
+
+/* Virtual clock of the calling thread's core / of a given core. */
+uint64_t hal_sim_now_ns(void);
+uint64_t hal_sim_core_now_ns(uint8_t core);
+void     hal_sim_advance_ns(uint64_t ns);
+
+/*
+ * Bus agent: another master on the bus (host/sim/pio_sim.c running the PIO
+ * receiver). Called from hal_sim_advance_ns() on the bus core before its
+ * clock moves to until_ns; it must step itself up to until_ns using only
+ * hal_sim_bus_data()/hal_sim_bus_ack() with non-decreasing times in
+ * [previous until_ns, until_ns]. NULL removes it.
+ */
+typedef void (*hal_sim_agent_fn_t)(uint64_t until_ns, void *user);
+void hal_sim_set_bus_agent(hal_sim_agent_fn_t fn, void *user);
+
+/* Pin-level bus access at time t_ns (no HAL cost): DATA as seen by the
+ * receiver, and the ACK line. */
+uint32_t hal_sim_bus_data(uint64_t t_ns);
+void     hal_sim_bus_ack(uint64_t t_ns, bool asserted);
+
+/*
+ * tight_loop_contents(): costs spin_ns; on the bus core, if the bus is idle
+ * and the next word is scheduled later, jumps straight to it (nothing
+ * observable happens in between, and this keeps sparse traffic cheap).
+ */
+void hal_sim_spin(void);
+
+/* CDC DTR (hal_stdio_is_connected(), tud_cdc_connected()). */
+void hal_sim_set_connected(bool connected);
+bool hal_sim_connected(void);
+
+/* Frame output: callback and/or raw byte capture (NULL to disable). */
+void hal_sim_set_frame_sink(hal_sim_frame_fn_t fn, void *user);
+void hal_sim_set_capture(FILE *f);
+
+/*
+ * Run the calling core's clock until every queued frame is in the host's
+ * hands (or timeout_ns passes; returns false then). Call at the end of a
+ * run before reading the stream stats.
+ */
+bool hal_sim_stream_drain(uint64_t timeout_ns);
+
+/* Queue bytes "sent by the host" for hal_stdio_getc_nonblocking(). */
+bool hal_sim_host_write(const uint8_t *data, size_t len);
+
+/* PIO receiver model behind hal_pio_rx.h (host/sim/hal_pio_rx_sim.c):
+ * its state machine, for cycle counts; NULL when not running. */
+struct pio_sim_s;
+const struct pio_sim_s *hal_pio_rx_sim_sm(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* HAL_SIM_H */
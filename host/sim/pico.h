@@ -0,0 +1,12 @@
+/*
+ * host/sim/pico.h
+ *
+ * Host stand-in for the Pico SDK's pico.h: only what the firmware sources
+ * built by the simulator use.
+ */
+#pragma once
+
+#include "hal_sim.h"
+
+/* Busy-wait hint; in the simulator it lets virtual time (and the bus) move. */
+static inline void tight_loop_contents(void) { hal_sim_spin(); }
@@ -0,0 +1,744 @@
+/*
+ * host/sim/pio_sim.c
+ *
+ * pioasm-subset assembler and single state machine interpreter.
+ */
+
+#include "pio_sim.h"
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------- Encoding ---------------- */
+
+enum {
+    OP_JMP = 0, OP_WAIT, OP_IN, OP_OUT, OP_PUSH_PULL, OP_MOV, OP_IRQ, OP_SET
+};
+
+#define ENC(op, arg) ((uint16_t)(((unsigned)(op) << 13) | ((unsigned)(arg) & 0xFFu)))
+
+/* Source/destination names by encoding; NULL = not accepted. */
+static const char *const k_jmp_cond[8] = { "", "!x", "x--", "!y", "y--", "x!=y", "pin", "!osre" };
+static const char *const k_in_src[8]   = { "pins", "x", "y", "null", NULL, NULL, "isr", "osr" };
+static const char *const k_out_dst[8]  = { "pins", "x", "y", "null", "pindirs", "pc", "isr", "exec" };
+static const char *const k_mov_dst[8]  = { "pins", "x", "y", "pindirs", "exec", "pc", "isr", "osr" };
+static const char *const k_mov_src[8]  = { "pins", "x", "y", "null", NULL, "status", "isr", "osr" };
+static const char *const k_set_dst[8]  = { "pins", "x", "y", NULL, "pindirs", NULL, NULL, NULL };
+
+/* ---------------- Assembler ---------------- */
+
+#define LINE_MAX_LEN 256u
+
+typedef struct asm_s {
+    pio_sim_program_t *prog;
+    char  *err;
+    size_t err_len;
+    int    line;
+    bool   failed;
+
+    /* Instruction text kept for the second pass (labels may be forward). */
+    char   text[PIO_SIM_MAX_INSTR][LINE_MAX_LEN];
+    int    text_line[PIO_SIM_MAX_INSTR];
+} asm_t;
+
+static bool asm_fail(asm_t *a, const char *fmt, ...)
+{
+    if (a->failed) return false;
+    a->failed = true;
+    if (a->err && a->err_len) {
+        int n = snprintf(a->err, a->err_len, "line %d: ", a->line);
+        if (n < 0) n = 0;
+        if ((size_t)n < a->err_len) {
+            va_list ap;
+            va_start(ap, fmt);
+            vsnprintf(a->err + n, a->err_len - (size_t)n, fmt, ap);
+            va_end(ap);
+        }
+    }
+    return false;
+}
+
+static char *skip_ws(char *s)
+{
+    while (*s && isspace((unsigned char)*s)) s++;
+    return s;
+}
+
+static void rtrim(char *s)
+{
+    size_t n = strlen(s);
+    while (n && isspace((unsigned char)s[n - 1u])) s[--n] = '\0';
+}
+
+/* Cut the next whitespace/comma separated token; returns NULL at the end. */
+static char *next_tok(char **s)
+{
+    char *p = *s;
+    while (*p && (isspace((unsigned char)*p) || *p == ',')) p++;
+    if (!*p) {
+        *s = p;
+        return NULL;
+    }
+    char *start = p;
+    while (*p && !isspace((unsigned char)*p) && *p != ',') p++;
+    if (*p) *p++ = '\0';
+    *s = p;
+    return start;
+}
+
+static bool tok_eq(const char *a, const char *b)
+{
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+static int lookup(const char *const names[8], const char *tok)
+{
+    for (int i = 0; i < 8; ++i) {
+        if (names[i] && tok_eq(names[i], tok)) return i;
+    }
+    return -1;
+}
+
+static bool add_symbol(asm_t *a, const char *name, int32_t value, bool is_public)
+{
+    pio_sim_program_t *p = a->prog;
+    for (uint8_t i = 0; i < p->n_sym; ++i) {
+        if (strcmp(p->sym[i].name, name) == 0) return asm_fail(a, "'%s' redefined", name);
+    }
+    if (p->n_sym >= PIO_SIM_MAX_SYMBOLS) return asm_fail(a, "too many symbols");
+    if (strlen(name) >= sizeof(p->sym[0].name)) return asm_fail(a, "name too long: %s", name);
+    pio_sim_symbol_t *s = &p->sym[p->n_sym++];
+    strcpy(s->name, name);
+    s->value = value;
+    s->is_public = is_public;
+    return true;
+}
+
+bool pio_sim_symbol(const pio_sim_program_t *prog, const char *name, int32_t *value)
+{
+    if (!prog || !name) return false;
+    for (uint8_t i = 0; i < prog->n_sym; ++i) {
+        if (strcmp(prog->sym[i].name, name) == 0) {
+            if (value) *value = prog->sym[i].value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parse_value(asm_t *a, const char *tok, int32_t *out)
+{
+    if (!tok || !*tok) return asm_fail(a, "missing value");
+    if (isdigit((unsigned char)tok[0])) {
+        char *end = NULL;
+        long v;
+        if (tok[0] == '0' && (tok[1] == 'b' || tok[1] == 'B')) {
+            v = strtol(tok + 2, &end, 2);
+        } else {
+            v = strtol(tok, &end, 0);
+        }
+        if (!end || *end) return asm_fail(a, "bad number '%s'", tok);
+        *out = (int32_t)v;
+        return true;
+    }
+    if (pio_sim_symbol(a->prog, tok, out)) return true;
+    return asm_fail(a, "unknown symbol '%s'", tok);
+}
+
+static bool parse_range(asm_t *a, const char *tok, int32_t lo, int32_t hi, int32_t *out)
+{
+    if (!parse_value(a, tok, out)) return false;
+    if (*out < lo || *out > hi) return asm_fail(a, "value %d out of range %d..%d", *out, lo, hi);
+    return true;
+}
+
+/*
+ * Strip "side N" and "[D]" from an instruction line and encode them into
+ * the 5-bit delay/side-set field.
+ */
+static bool parse_modifiers(asm_t *a, char *s, uint32_t *field)
+{
+    const pio_sim_program_t *p = a->prog;
+    int32_t delay = 0, side = -1;
+
+    char *lb = strchr(s, '[');
+    if (lb) {
+        char *rb = strchr(lb, ']');
+        if (!rb) return asm_fail(a, "missing ']'");
+        *rb = '\0';
+        char *d = skip_ws(lb + 1);
+        rtrim(d);
+        if (!parse_value(a, d, &delay)) return false;
+        memmove(lb, rb + 1, strlen(rb + 1) + 1u);
+    }
+
+    /* "side" must be a whole word */
+    for (char *q = s; (q = strstr(q, "side")) != NULL; q += 4) {
+        const bool start_ok = (q == s) || isspace((unsigned char)q[-1]) || q[-1] == ',';
+        const char *after = q + 4;
+        if (strncmp(after, "set", 3) == 0) after += 3;   /* "sideset" */
+        if (!start_ok || !isspace((unsigned char)*after)) continue;
+        char *rest = (char *)after;
+        char *v = next_tok(&rest);
+        if (!parse_value(a, v, &side)) return false;
+        memmove(q, rest, strlen(rest) + 1u);
+        break;
+    }
+
+    const uint32_t ss_bits = p->sideset_bits;
+    const uint32_t data_bits = ss_bits - (p->sideset_opt ? 1u : 0u);
+    const uint32_t delay_bits = 5u - ss_bits;
+    if (delay < 0 || delay >= (1 << delay_bits)) {
+        return asm_fail(a, "delay %d does not fit in %u bits", delay, delay_bits);
+    }
+
+    uint32_t ss = 0u;
+    if (side >= 0) {
+        if (ss_bits == 0u) return asm_fail(a, "side-set without .side_set");
+        if ((uint32_t)side >= (1u << data_bits)) return asm_fail(a, "side value %d too wide", side);
+        ss = (uint32_t)side;
+        if (p->sideset_opt) ss |= 1u << data_bits;
+    } else if (ss_bits != 0u && !p->sideset_opt) {
+        return asm_fail(a, "side-set required (.side_set is not opt)");
+    }
+    *field = (ss << delay_bits) | (uint32_t)delay;
+    return true;
+}
+
+static bool encode_instr(asm_t *a, char *s, uint16_t *out)
+{
+    uint32_t field = 0u;
+    if (!parse_modifiers(a, s, &field)) return false;
+
+    char *rest = s;
+    const char *op = next_tok(&rest);
+    if (!op) return asm_fail(a, "empty instruction");
+    const char *t1 = next_tok(&rest);
+    const char *t2 = next_tok(&rest);
+    const char *t3 = next_tok(&rest);
+    const char *t4 = next_tok(&rest);
+    uint16_t ins = 0u;
+    int32_t v = 0;
+
+    if (tok_eq(op, "nop")) {
+        if (t1) return asm_fail(a, "nop takes no operands");
+        ins = ENC(OP_MOV, (2u << 5) | 2u);              /* mov y, y */
+
+    } else if (tok_eq(op, "jmp")) {
+        int cond = 0;
+        const char *target = t1;
+        if (t2) {
+            cond = lookup(k_jmp_cond, t1);
+            if (cond <= 0) return asm_fail(a, "bad jmp condition '%s'", t1);
+            target = t2;
+        }
+        if (t3) return asm_fail(a, "too many jmp operands");
+        if (!parse_range(a, target, 0, (int32_t)PIO_SIM_MAX_INSTR - 1, &v)) return false;
+        ins = ENC(OP_JMP, ((unsigned)cond << 5) | (unsigned)v);
+
+    } else if (tok_eq(op, "wait")) {
+        int32_t pol = 0, idx = 0;
+        if (!parse_range(a, t1, 0, 1, &pol)) return false;
+        unsigned src;
+        if (t2 && tok_eq(t2, "gpio"))     src = 0u;
+        else if (t2 && tok_eq(t2, "pin")) src = 1u;
+        else return asm_fail(a, "wait source must be gpio or pin");
+        if (!parse_range(a, t3, 0, 31, &idx)) return false;
+        if (t4) return asm_fail(a, "too many wait operands");
+        ins = ENC(OP_WAIT, ((unsigned)pol << 7) | (src << 5) | (unsigned)idx);
+
+    } else if (tok_eq(op, "in") || tok_eq(op, "out")) {
+        const bool is_in = tok_eq(op, "in");
+        const int r = t1 ? lookup(is_in ? k_in_src : k_out_dst, t1) : -1;
+        if (r < 0) return asm_fail(a, "bad %s operand '%s'", op, t1 ? t1 : "");
+        if (!parse_range(a, t2, 1, 32, &v)) return false;
+        if (t3) return asm_fail(a, "too many %s operands", op);
+        ins = ENC(is_in ? OP_IN : OP_OUT, ((unsigned)r << 5) | ((unsigned)v & 31u));
+
+    } else if (tok_eq(op, "push") || tok_eq(op, "pull")) {
+        const bool is_pull = tok_eq(op, "pull");
+        bool if_flag = false, block = true;
+        const char *ts[2] = { t1, t2 };
+        for (int i = 0; i < 2; ++i) {
+            if (!ts[i]) continue;
+            if (tok_eq(ts[i], is_pull ? "ifempty" : "iffull")) if_flag = true;
+            else if (tok_eq(ts[i], "block"))                  block = true;
+            else if (tok_eq(ts[i], "noblock"))                block = false;
+            else return asm_fail(a, "bad %s operand '%s'", op, ts[i]);
+        }
+        if (t3) return asm_fail(a, "too many %s operands", op);
+        ins = ENC(OP_PUSH_PULL, (is_pull ? 0x80u : 0u) | (if_flag ? 0x40u : 0u) | (block ? 0x20u : 0u));
+
+    } else if (tok_eq(op, "mov")) {
+        const int d = t1 ? lookup(k_mov_dst, t1) : -1;
+        if (d < 0) return asm_fail(a, "bad mov destination '%s'", t1 ? t1 : "");
+        if (!t2) return asm_fail(a, "mov needs a source");
+        unsigned mop = 0u;
+        const char *src = t2;
+        if (src[0] == '!' || src[0] == '~') { mop = 1u; src++; }
+        else if (src[0] == ':' && src[1] == ':') { mop = 2u; src += 2; }
+        if (!*src && t3) { src = t3; t3 = t4; }    /* "mov x, ~ y" */
+        const int r = lookup(k_mov_src, src);
+        if (r < 0) return asm_fail(a, "bad mov source '%s'", src);
+        if (t3) return asm_fail(a, "too many mov operands");
+        ins = ENC(OP_MOV, ((unsigned)d << 5) | (mop << 3) | (unsigned)r);
+
+    } else if (tok_eq(op, "set")) {
+        const int d = t1 ? lookup(k_set_dst, t1) : -1;
+        if (d < 0) return asm_fail(a, "bad set destination '%s'", t1 ? t1 : "");
+        if (!parse_range(a, t2, 0, 31, &v)) return false;
+        if (t3) return asm_fail(a, "too many set operands");
+        ins = ENC(OP_SET, ((unsigned)d << 5) | (unsigned)v);
+
+    } else {
+        return asm_fail(a, "unsupported instruction '%s'", op);
+    }
+
+    *out = (uint16_t)(ins | (field << 8));
+    return true;
+}
+
+/* Is "name:" (optionally "PUBLIC name:") at the start of s? Returns the text after it. */
+static char *take_label(asm_t *a, char *s, bool *ok)
+{
+    *ok = true;
+    char *p = s;
+    bool is_public = false;
+    if (strncmp(p, "PUBLIC", 6) == 0 && isspace((unsigned char)p[6])) {
+        is_public = true;
+        p = skip_ws(p + 6);
+    }
+    char *q = p;
+    while (*q && (isalnum((unsigned char)*q) || *q == '_')) q++;
+    if (q == p || *q != ':') return s;
+    *q = '\0';
+    *ok = add_symbol(a, p, a->prog->len, is_public);
+    return skip_ws(q + 1);
+}
+
+bool pio_sim_assemble(const char *src, const char *name, pio_sim_program_t *prog,
+                      char *err, size_t err_len)
+{
+    if (!src || !prog) return false;
+    asm_t *a = (asm_t *)calloc(1u, sizeof(*a));
+    if (!a) return false;
+    memset(prog, 0, sizeof(*prog));
+    a->prog = prog;
+    a->err = err;
+    a->err_len = err_len;
+    if (err && err_len) err[0] = '\0';
+
+    bool in_prog = false, found = false, in_block = false, have_wrap = false;
+    const char *p = src;
+    while (*p && !a->failed) {
+        a->line++;
+        const char *eol = strchr(p, '\n');
+        const size_t n = eol ? (size_t)(eol - p) : strlen(p);
+        char buf[LINE_MAX_LEN];
+        if (n >= sizeof(buf)) {
+            asm_fail(a, "line too long");
+            break;
+        }
+        memcpy(buf, p, n);
+        buf[n] = '\0';
+        p = eol ? eol + 1 : p + n;
+
+        char *s = skip_ws(buf);
+        if (in_block) {
+            if (strncmp(s, "%}", 2) == 0) in_block = false;
+            continue;
+        }
+        if (s[0] == '%') {
+            in_block = true;
+            continue;
+        }
+        char *c = strchr(s, ';');
+        if (c) *c = '\0';
+        c = strstr(s, "//");
+        if (c) *c = '\0';
+        rtrim(s);
+        if (!*s) continue;
+
+        if (s[0] == '.') {
+            char *rest = s;
+            const char *dir = next_tok(&rest);
+            if (strcmp(dir, ".program") == 0) {
+                if (found) break;
+                const char *pname = next_tok(&rest);
+                if (!pname) {
+                    asm_fail(a, ".program needs a name");
+                    break;
+                }
+                in_prog = (name == NULL) || (strcmp(name, pname) == 0);
+                if (in_prog) {
+                    found = true;
+                    snprintf(prog->name, sizeof(prog->name), "%s", pname);
+                }
+                continue;
+            }
+            if (!in_prog) continue;
+
+            if (strcmp(dir, ".define") == 0) {
+                const char *t = next_tok(&rest);
+                bool is_public = false;
+                if (t && strcmp(t, "PUBLIC") == 0) {
+                    is_public = true;
+                    t = next_tok(&rest);
+                }
+                int32_t v = 0;
+                if (!t) asm_fail(a, ".define needs a name");
+                else if (parse_value(a, next_tok(&rest), &v)) (void)add_symbol(a, t, v, is_public);
+            } else if (strcmp(dir, ".side_set") == 0) {
+                int32_t bits = 0;
+                if (!parse_range(a, next_tok(&rest), 0, 5, &bits)) break;
+                const char *t;
+                while ((t = next_tok(&rest)) != NULL) {
+                    if (strcmp(t, "opt") == 0)          prog->sideset_opt = true;
+                    else if (strcmp(t, "pindirs") == 0) prog->sideset_pindirs = true;
+                    else asm_fail(a, "bad .side_set option '%s'", t);
+                }
+                prog->sideset_bits = (uint8_t)(bits + (prog->sideset_opt ? 1 : 0));
+                if (prog->sideset_bits > 5u) asm_fail(a, "side-set too wide");
+            } else if (strcmp(dir, ".wrap_target") == 0) {
+                prog->wrap_target = prog->len;
+            } else if (strcmp(dir, ".wrap") == 0) {
+                if (prog->len == 0u) asm_fail(a, ".wrap before any instruction");
+                prog->wrap = (uint8_t)(prog->len - 1u);
+                have_wrap = true;
+            } else if (strcmp(dir, ".origin") == 0 || strcmp(dir, ".lang_opt") == 0 ||
+                       strcmp(dir, ".pio_version") == 0) {
+                /* no effect on the model */
+            } else {
+                asm_fail(a, "unsupported directive '%s'", dir);
+            }
+            continue;
+        }
+        if (!in_prog) continue;
+
+        bool ok = true;
+        s = take_label(a, s, &ok);
+        if (!ok || !*s) continue;
+        if (prog->len >= PIO_SIM_MAX_INSTR) {
+            asm_fail(a, "program longer than %u instructions", PIO_SIM_MAX_INSTR);
+            break;
+        }
+        snprintf(a->text[prog->len], LINE_MAX_LEN, "%s", s);
+        a->text_line[prog->len] = a->line;
+        prog->len++;
+    }
+
+    if (!a->failed && !found) asm_fail(a, "program '%s' not found", name ? name : "(any)");
+    if (!a->failed && prog->len == 0u) asm_fail(a, "empty program");
+    if (!a->failed && !have_wrap) prog->wrap = (uint8_t)(prog->len - 1u);
+
+    for (uint8_t i = 0; i < prog->len && !a->failed; ++i) {
+        a->line = a->text_line[i];
+        (void)encode_instr(a, a->text[i], &prog->instr[i]);
+    }
+
+    const bool ok = !a->failed;
+    free(a);
+    return ok;
+}
+
+/* ---------------- State machine ---------------- */
+
+pio_sim_sm_cfg_t pio_sim_sm_cfg_default(void)
+{
+    pio_sim_sm_cfg_t c;
+    memset(&c, 0, sizeof(c));
+    c.in_shift_right = true;
+    c.out_shift_right = true;
+    return c;
+}
+
+void pio_sim_init(pio_sim_t *sm, const pio_sim_program_t *prog, const pio_sim_sm_cfg_t *cfg,
+                  pio_sim_read_pins_fn read_pins, pio_sim_write_pins_fn write_pins, void *user)
+{
+    memset(sm, 0, sizeof(*sm));
+    sm->prog = prog;
+    sm->cfg = cfg ? *cfg : pio_sim_sm_cfg_default();
+    sm->read_pins = read_pins;
+    sm->write_pins = write_pins;
+    sm->user = user;
+}
+
+static inline uint32_t rotr(uint32_t v, uint32_t n)
+{
+    n &= 31u;
+    return n ? ((v >> n) | (v << (32u - n))) : v;
+}
+
+static inline uint32_t low_mask(uint32_t n)
+{
+    return (n >= 32u) ? 0xFFFFFFFFu : ((1u << n) - 1u);
+}
+
+static uint32_t bitrev(uint32_t v)
+{
+    uint32_t r = 0u;
+    for (int i = 0; i < 32; ++i) {
+        r = (r << 1) | (v & 1u);
+        v >>= 1;
+    }
+    return r;
+}
+
+static uint32_t read_pins(pio_sim_t *sm)
+{
+    return sm->read_pins ? sm->read_pins(sm->user) : 0u;
+}
+
+/* Drive count pins starting at base with the low bits of v. */
+static void write_pin_range(pio_sim_t *sm, uint32_t base, uint32_t count, uint32_t v)
+{
+    if (!sm->write_pins || count == 0u) return;
+    const uint32_t mask = low_mask(count);
+    sm->write_pins(rotr(v & mask, 32u - base), rotr(mask, 32u - base), sm->user);
+}
+
+static inline uint32_t rx_cap(const pio_sim_t *sm)
+{
+    return sm->cfg.fifo_join_rx ? 2u * PIO_SIM_FIFO_DEPTH : PIO_SIM_FIFO_DEPTH;
+}
+
+static void shift_in(pio_sim_t *sm, uint32_t data, uint32_t n)
+{
+    data &= low_mask(n);
+    if (n >= 32u) {
+        sm->isr = data;
+    } else if (sm->cfg.in_shift_right) {
+        sm->isr = (sm->isr >> n) | (data << (32u - n));
+    } else {
+        sm->isr = (sm->isr << n) | data;
+    }
+    const uint32_t c = sm->isr_count + n;
+    sm->isr_count = (uint8_t)((c > 32u) ? 32u : c);
+}
+
+static uint32_t shift_out(pio_sim_t *sm, uint32_t n)
+{
+    uint32_t data;
+    if (n >= 32u) {
+        data = sm->osr;
+        sm->osr = 0u;
+    } else if (sm->cfg.out_shift_right) {
+        data = sm->osr & low_mask(n);
+        sm->osr >>= n;
+    } else {
+        data = sm->osr >> (32u - n);
+        sm->osr <<= n;
+    }
+    const uint32_t c = sm->osr_count + n;
+    sm->osr_count = (uint8_t)((c > 32u) ? 32u : c);
+    return data;
+}
+
+static uint32_t mov_source(pio_sim_t *sm, uint32_t src)
+{
+    switch (src) {
+    case 0: {
+        const uint32_t v = rotr(read_pins(sm), sm->cfg.in_base);
+        return sm->cfg.in_count ? (v & low_mask(sm->cfg.in_count)) : v;
+    }
+    case 1: return sm->x;
+    case 2: return sm->y;
+    case 6: return sm->isr;
+    case 7: return sm->osr;
+    default: return 0u;     /* null, status (not modelled) */
+    }
+}
+
+void pio_sim_step(pio_sim_t *sm)
+{
+    const pio_sim_program_t *p = sm->prog;
+    sm->stats.cycles++;
+    if (sm->delay) {
+        sm->delay--;
+        sm->stats.delay_cycles++;
+        return;
+    }
+
+    const uint16_t ins = p->instr[sm->pc];
+    const uint32_t field = (ins >> 8) & 0x1Fu;
+    const uint32_t delay_bits = 5u - p->sideset_bits;
+    const uint32_t delay = field & low_mask(delay_bits);
+
+    if (p->sideset_bits) {
+        const uint32_t data_bits = p->sideset_bits - (p->sideset_opt ? 1u : 0u);
+        const uint32_t ss = field >> delay_bits;
+        const bool enabled = !p->sideset_opt || ((ss >> data_bits) & 1u);
+        if (enabled) {
+            const uint32_t v = ss & low_mask(data_bits);
+            if (p->sideset_pindirs) {
+                sm->pindirs = (sm->pindirs & ~rotr(low_mask(data_bits), 32u - sm->cfg.sideset_base))
+                            | rotr(v, 32u - sm->cfg.sideset_base);
+            } else {
+                write_pin_range(sm, sm->cfg.sideset_base, data_bits, v);
+            }
+        }
+    }
+
+    const uint32_t op  = ins >> 13;
+    const uint32_t arg = ins & 0xFFu;
+    bool stalled = false, jumped = false;
+
+    switch (op) {
+    case OP_JMP: {
+        bool take;
+        switch (arg >> 5) {
+        case 0:  take = true; break;
+        case 1:  take = (sm->x == 0u); break;
+        case 2:  take = (sm->x != 0u); sm->x--; break;
+        case 3:  take = (sm->y == 0u); break;
+        case 4:  take = (sm->y != 0u); sm->y--; break;
+        case 5:  take = (sm->x != sm->y); break;
+        case 6:  take = ((read_pins(sm) >> sm->cfg.jmp_pin) & 1u) != 0u; break;
+        default: take = (sm->osr_count < 32u); break;
+        }
+        if (take) {
+            sm->pc = (uint8_t)(arg & 0x1Fu);
+            jumped = true;
+        }
+        break;
+    }
+
+    case OP_WAIT: {
+        const uint32_t pol = (arg >> 7) & 1u;
+        const uint32_t src = (arg >> 5) & 3u;
+        const uint32_t idx = arg & 0x1Fu;
+        const uint32_t pin = (src == 0u) ? idx : ((sm->cfg.in_base + idx) & 31u);
+        if (src > 1u || ((read_pins(sm) >> pin) & 1u) != pol) stalled = true;
+        break;
+    }
+
+    case OP_IN: {
+        const uint32_t n = (arg & 0x1Fu) ? (arg & 0x1Fu) : 32u;
+        const uint32_t src = arg >> 5;
+        const uint32_t v = (src == 0u) ? rotr(read_pins(sm), sm->cfg.in_base) : mov_source(sm, src);
+        shift_in(sm, v, n);
+        break;
+    }
+
+    case OP_OUT: {
+        const uint32_t n = (arg & 0x1Fu) ? (arg & 0x1Fu) : 32u;
+        const uint32_t v = shift_out(sm, n);
+        switch (arg >> 5) {
+        case 0: write_pin_range(sm, sm->cfg.out_base, (n < sm->cfg.out_count) ? n : sm->cfg.out_count, v); break;
+        case 1: sm->x = v; break;
+        case 2: sm->y = v; break;
+        case 4: sm->pindirs = v; break;
+        case 5: sm->pc = (uint8_t)(v & 0x1Fu); jumped = true; break;
+        case 6: sm->isr = v; sm->isr_count = (uint8_t)n; break;
+        default: break;     /* null; exec not modelled */
+        }
+        break;
+    }
+
+    case OP_PUSH_PULL:
+        if ((arg & 0x80u) == 0u) {
+            const bool iffull = (arg & 0x40u) != 0u, block = (arg & 0x20u) != 0u;
+            if (iffull && sm->isr_count < 32u) break;
+            if (sm->rx_n >= rx_cap(sm)) {
+                if (block) {
+                    stalled = true;
+                    sm->rxstall = true;
+                    break;
+                }
+                sm->stats.rx_dropped++;
+            } else {
+                sm->rx[(sm->rx_head + sm->rx_n) % rx_cap(sm)] = sm->isr;
+                sm->rx_n++;
+            }
+            sm->isr = 0u;
+            sm->isr_count = 0u;
+        } else {
+            const bool ifempty = (arg & 0x40u) != 0u, block = (arg & 0x20u) != 0u;
+            if (ifempty && sm->osr_count < 32u) break;
+            if (sm->cfg.fifo_join_rx || sm->tx_n == 0u) {
+                if (block) {
+                    stalled = true;
+                    break;
+                }
+                sm->osr = sm->x;
+            } else {
+                sm->osr = sm->tx[sm->tx_head];
+                sm->tx_head = (uint8_t)((sm->tx_head + 1u) % PIO_SIM_FIFO_DEPTH);
+                sm->tx_n--;
+            }
+            sm->osr_count = 0u;
+        }
+        break;
+
+    case OP_MOV: {
+        uint32_t v = mov_source(sm, arg & 7u);
+        const uint32_t mop = (arg >> 3) & 3u;
+        if (mop == 1u) v = ~v;
+        else if (mop == 2u) v = bitrev(v);
+        switch (arg >> 5) {
+        case 0: write_pin_range(sm, sm->cfg.out_base, sm->cfg.out_count, v); break;
+        case 1: sm->x = v; break;
+        case 2: sm->y = v; break;
+        case 3: sm->pindirs = v; break;
+        case 5: sm->pc = (uint8_t)(v & 0x1Fu); jumped = true; break;
+        case 6: sm->isr = v; sm->isr_count = 0u; break;
+        case 7: sm->osr = v; sm->osr_count = 0u; break;
+        default: break;     /* exec not modelled */
+        }
+        break;
+    }
+
+    case OP_SET: {
+        const uint32_t v = arg & 0x1Fu;
+        switch (arg >> 5) {
+        case 0: write_pin_range(sm, sm->cfg.set_base, sm->cfg.set_count, v); break;
+        case 1: sm->x = v; break;
+        case 2: sm->y = v; break;
+        case 4: sm->pindirs = v; break;
+        default: break;
+        }
+        break;
+    }
+
+    default:
+        break;              /* irq not modelled: behaves as nop */
+    }
+
+    if (stalled) {
+        sm->stats.stall_cycles++;
+        return;
+    }
+    sm->stats.instructions++;
+    if (!jumped) sm->pc = (sm->pc == p->wrap) ? p->wrap_target : (uint8_t)(sm->pc + 1u);
+    sm->delay = delay;
+}
+
+bool pio_sim_rx_get(pio_sim_t *sm, uint32_t *word)
+{
+    if (sm->rx_n == 0u) return false;
+    if (word) *word = sm->rx[sm->rx_head];
+    sm->rx_head = (uint8_t)((sm->rx_head + 1u) % rx_cap(sm));
+    sm->rx_n--;
+    return true;
+}
+
+uint32_t pio_sim_rx_level(const pio_sim_t *sm)
+{
+    return sm->rx_n;
+}
+
+bool pio_sim_tx_put(pio_sim_t *sm, uint32_t word)
+{
+    if (sm->cfg.fifo_join_rx || sm->tx_n >= PIO_SIM_FIFO_DEPTH) return false;
+    sm->tx[(sm->tx_head + sm->tx_n) % PIO_SIM_FIFO_DEPTH] = word;
+    sm->tx_n++;
+    return true;
+}
@@ -0,0 +1,134 @@
+#ifndef PIO_SIM_H
+#define PIO_SIM_H
+
+/*
+ * host/sim/pio_sim.h
+ *
+ * Instruction-level model of one RP2040/RP2350 PIO state machine, plus an
+ * assembler for the pioasm subset the firmware's .pio programs use, so a
+ * program's bus behaviour and cycle counts can be checked on Linux.
+ *
+ * Assembler: .program, .define [PUBLIC], .side_set N [opt] [pindirs],
+ * .wrap_target, .wrap, labels ([PUBLIC] name:), "% c-sdk { ... %}" blocks
+ * (skipped); jmp, wait (gpio/pin), in, out, push, pull, mov, set, nop, each
+ * with optional "side N" and "[delay]". Values are decimal, 0x.., 0b.. or a
+ * .define/label name. Encodings are the hardware's, bit for bit.
+ *
+ * Execution, one pio_sim_step() per state machine clock (clkdiv 1):
+ * - side-set is applied when an instruction issues, also if it then stalls;
+ * - a stalled instruction (push/pull block on a full/empty FIFO, wait)
+ *   issues again next cycle, and its delay only runs once it completes;
+ * - after the instruction at .wrap (if it did not jump) execution continues
+ *   at .wrap_target.
+ * Not modelled: irq, autopush/autopull, mov status, exec, pindirs (tracked
+ * but not driven).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PIO_SIM_MAX_INSTR   32u
+#define PIO_SIM_FIFO_DEPTH  4u     /* 8 when joined */
+#define PIO_SIM_MAX_SYMBOLS 32u
+
+typedef struct pio_sim_symbol_s {
+    char     name[32];
+    int32_t  value;
+    bool     is_public;
+} pio_sim_symbol_t;
+
+typedef struct pio_sim_program_s {
+    char     name[32];
+    uint16_t instr[PIO_SIM_MAX_INSTR];
+    uint8_t  len;
+    uint8_t  wrap_target;
+    uint8_t  wrap;
+    uint8_t  sideset_bits;      /* as sm_config_set_sideset(): includes the opt bit */
+    bool     sideset_opt;
+    bool     sideset_pindirs;
+    pio_sim_symbol_t sym[PIO_SIM_MAX_SYMBOLS];   /* .defines and labels */
+    uint8_t  n_sym;
+} pio_sim_program_t;
+
+/*
+ * Assemble the .program called name (NULL: the first one) from src.
+ * On failure returns false and writes "line N: reason" to err.
+ */
+bool pio_sim_assemble(const char *src, const char *name, pio_sim_program_t *prog,
+                      char *err, size_t err_len);
+
+/* Value of a .define or label of an assembled program. */
+bool pio_sim_symbol(const pio_sim_program_t *prog, const char *name, int32_t *value);
+
+/* Pin access: read all 32 GPIO input levels; drive the pins set in mask. */
+typedef uint32_t (*pio_sim_read_pins_fn)(void *user);
+typedef void     (*pio_sim_write_pins_fn)(uint32_t values, uint32_t mask, void *user);
+
+/* State machine configuration (the subset of pio_sm_config that matters here). */
+typedef struct pio_sim_sm_cfg_s {
+    uint8_t in_base;
+    uint8_t in_count;           /* RP2350 IN_COUNT: mov x, pins sees this many (0 = 32) */
+    uint8_t out_base, out_count;
+    uint8_t set_base, set_count;
+    uint8_t sideset_base;
+    uint8_t jmp_pin;
+    bool    in_shift_right;
+    bool    out_shift_right;
+    bool    fifo_join_rx;       /* 8-deep RX FIFO, no TX FIFO */
+} pio_sim_sm_cfg_t;
+
+/* SDK defaults: shift right, nothing joined, all bases 0. */
+pio_sim_sm_cfg_t pio_sim_sm_cfg_default(void);
+
+typedef struct pio_sim_stats_s {
+    uint64_t cycles;            /* pio_sim_step() calls */
+    uint64_t instructions;      /* completed instructions */
+    uint64_t stall_cycles;      /* cycles spent stalled (push/pull/wait) */
+    uint64_t delay_cycles;      /* cycles spent in [delay] */
+    uint32_t rx_dropped;        /* push noblock on a full RX FIFO */
+} pio_sim_stats_t;
+
+typedef struct pio_sim_s {
+    const pio_sim_program_t *prog;
+    pio_sim_sm_cfg_t      cfg;
+    pio_sim_read_pins_fn  read_pins;
+    pio_sim_write_pins_fn write_pins;
+    void                 *user;
+
+    uint8_t  pc;
+    uint32_t x, y, isr, osr;
+    uint8_t  isr_count, osr_count;
+    uint32_t delay;
+    uint32_t pindirs;
+
+    uint32_t rx[2u * PIO_SIM_FIFO_DEPTH];
+    uint8_t  rx_head, rx_n;
+    uint32_t tx[PIO_SIM_FIFO_DEPTH];
+    uint8_t  tx_head, tx_n;
+
+    bool rxstall;               /* sticky, like FDEBUG.RXSTALL: a push block stalled */
+    pio_sim_stats_t stats;
+} pio_sim_t;
+
+/* Reset the state machine to the program start (address 0; programs load at offset 0). */
+void pio_sim_init(pio_sim_t *sm, const pio_sim_program_t *prog, const pio_sim_sm_cfg_t *cfg,
+                  pio_sim_read_pins_fn read_pins, pio_sim_write_pins_fn write_pins, void *user);
+
+/* Run one clock. */
+void pio_sim_step(pio_sim_t *sm);
+
+/* FIFO access from the "CPU/DMA" side. */
+bool     pio_sim_rx_get(pio_sim_t *sm, uint32_t *word);
+uint32_t pio_sim_rx_level(const pio_sim_t *sm);
+bool     pio_sim_tx_put(pio_sim_t *sm, uint32_t word);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PIO_SIM_H */
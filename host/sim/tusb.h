@@ -0,0 +1,19 @@
+/*
+ * host/sim/tusb.h
+ *
+ * Host stand-in for the TinyUSB CDC calls pico_aer_rx uses to detect an open
+ * terminal (DTR); the line state follows hal_sim_set_connected().
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_sim.h"
+
+static inline void tud_task(void) {}
+
+static inline bool tud_cdc_connected(void) { return hal_sim_connected(); }
+
+/* bit0 = DTR, bit1 = RTS */
+static inline uint8_t tud_cdc_get_line_state(void) { return hal_sim_connected() ? 0x03u : 0x00u; }
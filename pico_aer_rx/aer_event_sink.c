@@ -3,7 +3,8 @@
 
 #include "pico.h"   // tight_loop_contents()
 
-#include "usb_stream.h" // usb_stream_send_on_event()
+#include "aer_codec.h"  // aer_decode_word() (burst boundaries)
+#include "usb_stream.h" // usb_stream_send_on_event(), usb_stream_send_on_burst()
 
 static inline void hard_fault_spin(void) {
     while (1) { tight_loop_contents(); }
@@ -19,6 +20,8 @@ void aer_event_sink_init(aer_event_sink_t *sink, const aer_event_sink_cfg_t *cfg
     }
 
     sink->stats = (aer_event_sink_stats_t){0};
+    sink->raw_active = usb_stream_raw_passthrough();
+    sink->raw_at_boundary = true;
 }
 
 void aer_event_sink_reset(aer_event_sink_t *sink)
@@ -54,3 +57,84 @@ void aer_event_sink_on_event(uint8_t row, uint8_t col, void *user)
     if (ok) sink->stats.usb_sent_ok++;
     else    sink->stats.usb_send_failed++;
 }
+
+void aer_event_sink_on_burst(uint8_t row, const uint8_t *cols, uint16_t count,
+                             const aer_burst_info_t *info, void *user)
+{
+    aer_event_sink_t *sink = (aer_event_sink_t *)user;
+    if (!sink || count == 0u) return;
+
+    sink->stats.events_emitted += count;
+
+    if (!sink->cfg.enabled) {
+        sink->stats.usb_send_failed += count;
+        return;
+    }
+
+    /* Bitmask assembler: hand the dense mask over directly. Latch times,
+     * when the burst carries them, replace the emission-time stamp. */
+    bool ok;
+    if (info && info->timed) {
+        ok = info->col_mask
+            ? usb_stream_send_on_burst_mask_at(row, info->col_mask, info->t_row)
+            : usb_stream_send_on_burst_at(row, cols, count, info->t_row, info->col_t);
+    } else {
+        ok = (info && info->col_mask)
+            ? usb_stream_send_on_burst_mask(row, info->col_mask)
+            : usb_stream_send_on_burst(row, cols, count);
+    }
+    if (ok) sink->stats.usb_sent_ok += count;
+    else    sink->stats.usb_send_failed += count;
+}
+
+static inline bool is_tail(uint32_t word)
+{
+    const aer_codec_result_t r = aer_decode_word((aer_raw_word_t)word);
+    return r.ok && r.is_tail;
+}
+
+/* n words to the active side; returns how many were decoded here. */
+static uint32_t route_words(aer_event_sink_t *sink, aer_burst_t *burst,
+                            const uint32_t *words, const uint32_t *ts, uint32_t n)
+{
+    if (n == 0u) return 0u;
+    if (!sink->raw_active) {
+        (void)aer_burst_feed_raw_words_ts_span(burst, words, ts, n, aer_event_sink_on_burst, sink);
+        return n;
+    }
+    if (sink->cfg.enabled) {
+        (void)usb_stream_send_raw_words(words, ts, n);
+        sink->stats.raw_words += n;
+    }
+    sink->raw_at_boundary = is_tail(words[n - 1u]);
+    return 0u;
+}
+
+uint32_t aer_event_sink_on_words(aer_event_sink_t *sink, aer_burst_t *burst,
+                                 const uint32_t *words, const uint32_t *ts, uint32_t n)
+{
+    if (!sink || !burst || !words || n == 0u) return 0u;
+
+    uint32_t decoded = 0u;
+    if (usb_stream_raw_passthrough() != sink->raw_active) {
+        /* Finish the burst in progress on the side it started on. */
+        bool boundary = sink->raw_active ? sink->raw_at_boundary
+                                         : (aer_burst_state(burst) == AER_BURST_EXPECT_ROW);
+        uint32_t k = 0u;
+        while (!boundary && k < n) {
+            boundary = is_tail(words[k++]);
+        }
+        decoded = route_words(sink, burst, words, ts, k);
+        if (!boundary) return decoded;
+
+        /* Everything of the old format leaves before the first of the new. */
+        (void)usb_stream_flush();
+        sink->raw_active = !sink->raw_active;
+        sink->raw_at_boundary = true;
+        sink->stats.mode_switches++;
+        words += k;
+        if (ts) ts += k;
+        n -= k;
+    }
+    return decoded + route_words(sink, burst, words, ts, n);
+}
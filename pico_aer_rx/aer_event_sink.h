@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "aer_burst.h"  // aer_burst_info_t
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,7 +17,11 @@ extern "C" {
  * produces a decoded ON event (row, col).
  *
  * What it does:
- *  - forwards events to usb_stream (which timestamps at emission if enabled)
+ *  - forwards events to usb_stream: bursts fed with latch times
+ *    (aer_burst_feed_raw_words_ts_span) keep them, anything else is
+ *    timestamped by usb_stream at emission
+ *  - routes drained raw words to the burst parser or, in raw passthrough,
+ *    straight to usb_stream (aer_event_sink_on_words())
  *  - keeps simple counters (emitted/sent/dropped)
  *
  * What it does NOT do:
@@ -27,6 +33,8 @@ typedef struct aer_event_sink_stats_s {
     uint32_t events_emitted;     // callback invoked (events produced by parser)
     uint32_t usb_sent_ok;        // forwarded to usb_stream successfully
     uint32_t usb_send_failed;    // usb_stream returned false (e.g., not connected)
+    uint32_t raw_words;          // words passed through undecoded (aer_event_sink_on_words())
+    uint32_t mode_switches;      // decode <-> raw passthrough switches completed
 } aer_event_sink_stats_t;
 
 typedef struct aer_event_sink_cfg_s {
@@ -36,9 +44,14 @@ typedef struct aer_event_sink_cfg_s {
 typedef struct aer_event_sink_s {
     aer_event_sink_cfg_t   cfg;
     aer_event_sink_stats_t stats;
+
+    // aer_event_sink_on_words(): where words go now, and whether the last
+    // word passed through was a TAIL (the host's parser is between bursts).
+    bool raw_active;
+    bool raw_at_boundary;
 } aer_event_sink_t;
 
-/** Initialize sink. Call after hal_stdio_init() + usb_stream_init(). */
+/** Initialize sink. Call after hal_stdio_init() + usb_stream_init() (takes its raw passthrough mode). */
 void aer_event_sink_init(aer_event_sink_t *sink, const aer_event_sink_cfg_t *cfg);
 
 /** Reset counters. */
@@ -62,6 +75,29 @@ const aer_event_sink_stats_t *aer_event_sink_stats(const aer_event_sink_t *sink)
  */
 void aer_event_sink_on_event(uint8_t row, uint8_t col, void *user);
 
+/**
+ * Span callback for the burst parser (aer_burst_cb_t): forwards a whole row
+ * burst to usb_stream in one framed packet instead of one packet per pixel.
+ * Counters are updated per event, same as aer_event_sink_on_event().
+ */
+void aer_event_sink_on_burst(uint8_t row, const uint8_t *cols, uint16_t count,
+                             const aer_burst_info_t *info, void *user);
+
+/**
+ * Drained raw words (and their latch times, or NULL) -> burst parser -> this
+ * sink, or, while usb_stream_raw_passthrough(), -> usb_stream_send_raw_words()
+ * for the host to decode.
+ *
+ * A mode change takes effect at the next burst boundary of the side being
+ * left: the burst in progress is finished (device parser, or words up to and
+ * including the TAIL still sent raw), so no burst is split between device
+ * and host decode; the stream is flushed at the switch, so records arrive
+ * in order. Words passed through while the sink is disabled are
+ * dropped. Returns the number of words decoded here.
+ */
+uint32_t aer_event_sink_on_words(aer_event_sink_t *sink, aer_burst_t *burst,
+                                 const uint32_t *words, const uint32_t *ts, uint32_t n);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,87 @@
+// aer_rx_pio.c
+#include "aer_rx_pio.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "hal_pio_rx.h"
+#include "hal_time.h"
+
+// Grant the DMA all free space (it is idle: everything it wrote is published).
+static void dma_rearm(aer_rx_pio_t *rx)
+{
+    const uint32_t room = ringbuf_u32_free(rx->rb);
+    rx->inflight = room;
+    if (room != 0u) {
+        hal_pio_rx_dma_arm(room);
+    }
+}
+
+bool aer_rx_pio_init(aer_rx_pio_t *rx, ringbuf_u32_t *rb)
+{
+    if (!rx || !rb || !rb->buf) return false;
+
+    const uint32_t cap = rb->capacity;
+    if (cap < 2u || cap > AER_RX_PIO_MAX_SLOTS || (cap & (cap - 1u)) != 0u) return false;
+    if (((uintptr_t)rb->buf & ((uintptr_t)cap * sizeof(uint32_t) - 1u)) != 0u) return false;
+
+    memset(rx, 0, sizeof(*rx));
+    rx->rb = rb;
+    rx->widx = (uint32_t)rb->head;
+    if (!hal_pio_rx_init(rb->buf, cap, rx->widx)) return false;
+
+    dma_rearm(rx);
+    return true;
+}
+
+void aer_rx_pio_set_timestamps(aer_rx_pio_t *rx, uint32_t *ts)
+{
+    if (!rx) return;
+    rx->ts = ts;
+}
+
+void aer_rx_pio_stop(aer_rx_pio_t *rx)
+{
+    if (!rx || !rx->rb) return;
+    hal_pio_rx_deinit();
+    rx->inflight = 0u;
+}
+
+uint32_t aer_rx_pio_poll(aer_rx_pio_t *rx)
+{
+    // Read busy first: if the DMA is idle, its write pointer below is final.
+    const bool busy = hal_pio_rx_dma_busy();
+    const uint32_t w = hal_pio_rx_dma_write_index();
+
+    // The DMA never has more than capacity - 1 words granted, so the wrapped
+    // distance is unambiguous.
+    const uint32_t n = (w - rx->widx) & (rx->rb->capacity - 1u);
+    if (n != 0u) {
+        if (rx->ts) {
+            const uint32_t t = hal_cycles_now();
+            const uint32_t mask = rx->rb->capacity - 1u;
+            for (uint32_t i = 0u; i < n; ++i) {
+                rx->ts[(rx->widx + i) & mask] = t;
+            }
+        }
+        ringbuf_u32_write_commit(rx->rb, n);
+        rx->widx = w;
+        rx->inflight -= n;
+        rx->stats.words_ok += n;
+    }
+
+    if (hal_pio_rx_take_stall()) {
+        rx->stats.bp_stalls++;
+    }
+
+    if (!busy) {
+        dma_rearm(rx);
+    }
+    return n;
+}
+
+uint32_t aer_rx_pio_backlog(const aer_rx_pio_t *rx)
+{
+    const uint32_t unpublished = (hal_pio_rx_dma_write_index() - rx->widx) & (rx->rb->capacity - 1u);
+    return hal_pio_rx_fifo_level() + unpublished;
+}
@@ -0,0 +1,86 @@
+// aer_rx_pio.h
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ringbuf.h"       // ringbuf_u32_t
+#include "aer_rx_poll.h"   // aer_rx_poll_stats_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PIO + DMA receiver (AER_RX_USE_PIO).
+ *
+ * aer_rx.pio runs the DI 4-phase handshake on a PIO state machine; a DMA
+ * channel moves each latched word from the RX FIFO straight into the raw
+ * ring's storage (hal_pio_rx.h). The CPU only calls aer_rx_pio_poll() to
+ * publish what the DMA wrote (ringbuf_u32_write_commit) and to hand it the
+ * free space again; the consumer side of the ring is used exactly as with
+ * aer_rx_poll.
+ *
+ * Ring requirements: capacity a power of two (DMA write ring), storage
+ * aligned to capacity * 4 bytes, at most 8192 slots.
+ *
+ * Ring-full behavior is always backpressure: the DMA never writes past the
+ * free space it was given, the RX FIFO fills, "push block" stalls and the
+ * word stays un-ACKed on the bus until the consumer catches up.
+ * The DMA is re-armed only once its grant is used up, so if that happens
+ * while the CPU is busy elsewhere the state machine also waits for the next
+ * poll; bp_stalls counts both.
+ *
+ * On the host, host/sim/hal_pio_rx_sim.c runs aer_rx.pio in the PIO model
+ * (host/sim/pio_sim.c) against the simulated bus, so this file is tested as is.
+ */
+
+#define AER_RX_PIO_MAX_SLOTS 8192u   // DMA ring wrap: 32 KiB
+
+typedef struct aer_rx_pio_s {
+    ringbuf_u32_t *rb;
+    uint32_t  widx;       // DMA write index already published to rb
+    uint32_t  inflight;   // words the DMA may still write without a re-arm
+    uint32_t *ts;         // timestamps paired with the ring storage (NULL => off)
+
+    // words_ok = words published; bp_stalls = polls that found the state
+    // machine had stalled on a full RX FIFO since the previous poll.
+    aer_rx_poll_stats_t stats;
+} aer_rx_pio_t;
+
+/**
+ * Claim a state machine and DMA channel, load aer_rx.pio and start it on
+ * the pins hal_gpio_init() set up (DATA width aer_rx_DATA_BITS, ACK active
+ * high); the PIO takes over the ACK pin. rb should be empty.
+ * Returns false if the ring or the pins do not fit, or nothing is free.
+ */
+bool aer_rx_pio_init(aer_rx_pio_t *rx, ringbuf_u32_t *rb);
+
+/** Stop the state machine and DMA and release them (ACK is left low). */
+void aer_rx_pio_stop(aer_rx_pio_t *rx);
+
+/**
+ * Publish DMA progress into the ring and re-arm the DMA with the ring's
+ * free space once the previous grant is used up. Returns words published.
+ * Call it from the main loop as often as aer_rx_poll_step() was.
+ */
+uint32_t aer_rx_pio_poll(aer_rx_pio_t *rx);
+
+/**
+ * Timestamps paired with the ring storage, as aer_rx_poll_set_timestamps().
+ * The state machine has no clock to sample, so words get the time
+ * aer_rx_pio_poll() published them: latest latch + at most one poll period.
+ * Call after aer_rx_pio_init().
+ */
+void aer_rx_pio_set_timestamps(aer_rx_pio_t *rx, uint32_t *ts);
+
+/** Words latched by the state machine but not yet published (RX FIFO + DMA). */
+uint32_t aer_rx_pio_backlog(const aer_rx_pio_t *rx);
+
+static inline const aer_rx_poll_stats_t *aer_rx_pio_stats(const aer_rx_pio_t *rx) {
+    return &rx->stats;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
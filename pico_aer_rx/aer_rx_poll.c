@@ -3,12 +3,53 @@
 
 #include "hal_gpio.h"
 #include "hal_time.h"
+#include "hal_dlog.h"
 
 #include "pico.h" // tight_loop_contents()
 
 static inline bool data_is_valid(uint32_t raw)  { return raw != 0u; }
 static inline bool data_is_neutral(uint32_t raw){ return raw == 0u; }
 
+// Producer-side ring access; exactly one of rx->rb / rx->spsc is set.
+static inline bool ring_is_full(aer_rx_poll_t *rx)
+{
+    return rx->spsc ? spsc_ring_u32_is_full(rx->spsc) : ringbuf_u32_is_full(rx->rb);
+}
+
+// The timestamp goes into the word's slot of the paired array before the
+// word is published. ringbuf's head slot is always free (one reserved slot);
+// a full SPSC ring's head slot is still the consumer's, so check first.
+static inline bool ring_push(aer_rx_poll_t *rx, uint32_t w, uint32_t t)
+{
+    if (rx->spsc) {
+        if (rx->ts) {
+            if (spsc_ring_u32_is_full(rx->spsc)) return false;
+            rx->ts[spsc_ring_u32_write_slot(rx->spsc)] = t;
+        }
+        return spsc_ring_u32_push(rx->spsc, w);
+    }
+    if (rx->ts) rx->ts[rx->rb->head] = t;
+    return ringbuf_u32_push(rx->rb, w);
+}
+
+static void rx_init_common(aer_rx_poll_t *rx,
+                           uint32_t wait_valid_timeout_us,
+                           uint32_t wait_neutral_timeout_us)
+{
+    rx->wait_valid_timeout_us   = wait_valid_timeout_us;
+    rx->wait_neutral_timeout_us = wait_neutral_timeout_us;
+    rx->overflow = AER_RX_OVERFLOW_DROP_NEWEST;
+    rx->backpressure_timeout_us = 0u;
+    rx->bp_stalled = false;
+    rx->bp_deadline_us = 0u;
+    rx->bp_t_latch = 0u;
+    rx->ts = NULL;
+    rx->stats = (aer_rx_poll_stats_t){0};
+
+    // Safe start state.
+    hal_gpio_ack_deassert();
+}
+
 void aer_rx_poll_init(aer_rx_poll_t *rx,
                       ringbuf_u32_t *rb,
                       uint32_t wait_valid_timeout_us,
@@ -19,26 +60,112 @@ void aer_rx_poll_init(aer_rx_poll_t *rx,
     }
 
     rx->rb = rb;
-    rx->wait_valid_timeout_us   = wait_valid_timeout_us;
-    rx->wait_neutral_timeout_us = wait_neutral_timeout_us;
-    rx->stats = (aer_rx_poll_stats_t){0};
+    rx->spsc = NULL;
+    rx_init_common(rx, wait_valid_timeout_us, wait_neutral_timeout_us);
+}
 
-    // Safe start state.
-    hal_gpio_ack_deassert();
+void aer_rx_poll_init_spsc(aer_rx_poll_t *rx,
+                           spsc_ring_u32_t *ring,
+                           uint32_t wait_valid_timeout_us,
+                           uint32_t wait_neutral_timeout_us)
+{
+    if (!rx || !ring) {
+        while (1) { tight_loop_contents(); }
+    }
+
+    rx->rb = NULL;
+    rx->spsc = ring;
+    rx_init_common(rx, wait_valid_timeout_us, wait_neutral_timeout_us);
 }
 
 void aer_rx_poll_reset(aer_rx_poll_t *rx)
 {
     if (!rx) return;
     rx->stats = (aer_rx_poll_stats_t){0};
+    rx->bp_stalled = false;
     hal_gpio_ack_deassert();
 }
 
+void aer_rx_poll_set_overflow(aer_rx_poll_t *rx,
+                              aer_rx_overflow_t overflow,
+                              uint32_t backpressure_timeout_us)
+{
+    if (!rx) return;
+    rx->overflow = overflow;
+    rx->backpressure_timeout_us = backpressure_timeout_us;
+    rx->bp_stalled = false;
+}
+
+void aer_rx_poll_set_timeouts(aer_rx_poll_t *rx,
+                              uint32_t wait_valid_timeout_us,
+                              uint32_t wait_neutral_timeout_us)
+{
+    if (!rx) return;
+    rx->wait_valid_timeout_us = wait_valid_timeout_us;
+    rx->wait_neutral_timeout_us = wait_neutral_timeout_us;
+}
+
+void aer_rx_poll_set_timestamps(aer_rx_poll_t *rx, uint32_t *ts)
+{
+    if (!rx) return;
+    rx->ts = ts;
+}
+
+/*
+ * Ring-full handling for a latched (not yet ACKed) word.
+ * Returns true if the word should be handshaked now; *push says whether it
+ * still goes into the ring. Returns false to leave it on the bus (NO_SPACE).
+ */
+static bool overflow_admit(aer_rx_poll_t *rx, bool *push)
+{
+    *push = true;
+    if (!ring_is_full(rx)) {
+        rx->bp_stalled = false;
+        return true;
+    }
+
+    switch (rx->overflow) {
+    case AER_RX_OVERFLOW_BACKPRESSURE:
+        if (!rx->bp_stalled) {
+            // New stall episode; retries while it lasts are not counted.
+            rx->bp_stalled = true;
+            rx->bp_deadline_us = hal_time_deadline_us(rx->backpressure_timeout_us);
+            rx->stats.bp_stalls++;
+        }
+        if (rx->backpressure_timeout_us == 0u || !hal_time_expired(rx->bp_deadline_us)) {
+            return false;
+        }
+        // Consumer did not catch up in time: give the bus back, lose this word.
+        rx->stats.bp_timeouts++;
+        HAL_DLOG2(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, "rx: ring full for %lu us, word dropped (%lu so far)",
+                  (unsigned long)rx->backpressure_timeout_us, (unsigned long)rx->stats.bp_timeouts);
+        rx->bp_stalled = false;
+        *push = false;
+        return true;
+
+    case AER_RX_OVERFLOW_DROP_OLDEST:
+        if (rx->rb) {
+            uint32_t evicted;
+            if (ringbuf_u32_pop(rx->rb, &evicted)) {
+                rx->stats.dropped_oldest++;
+            }
+        }
+        // SPSC: the tail belongs to the other core; drop the newest instead.
+        return true;
+
+    case AER_RX_OVERFLOW_DROP_NEWEST:
+    default:
+        // Let the push below fail so the ring's push_full stat sees it.
+        return true;
+    }
+}
+
 /**
  * One handshake.
  *
  * Important ordering choice:
- * - We ACK immediately after latching the word (per DI timing).
+ * - We ACK immediately after latching the word (per DI timing), unless the
+ *   ring is full and the BACKPRESSURE policy leaves it on the bus.
  * - We push the word to the ring buffer immediately after ACK (still fast),
  *   so even if waiting for neutral times out, you still captured something.
  */
@@ -67,17 +194,29 @@ aer_rx_poll_status_t aer_rx_poll_step(aer_rx_poll_t *rx)
 
     const aer_raw_word_t word = (aer_raw_word_t)raw;
 
-    // 2) assert ACK immediately after latch
+    // Latch time: first time this word was seen (a held word keeps its own).
+    uint32_t t_latch = 0u;
+    if (rx->ts) {
+        t_latch = rx->bp_stalled ? rx->bp_t_latch : hal_cycles_now();
+    }
+
+    // 2) ring full: apply the overflow policy (may leave the word un-ACKed)
+    bool push = true;
+    if (!overflow_admit(rx, &push)) {
+        rx->bp_t_latch = t_latch;
+        return AER_RX_POLL_NO_SPACE;
+    }
+
+    // 3) assert ACK immediately after latch
     hal_gpio_ack_assert();
 
-    // 3) push OR drop (but always continue handshake)
-    if (ringbuf_u32_is_full(rx->rb)) {
+    // 4) push OR drop (but always continue handshake); a rejected push is
+    //    also what the ring's push_full instrumentation counts.
+    if (!push || !ring_push(rx, (uint32_t)word, t_latch)) {
         rx->stats.dropped_full++;
-    } else {
-        (void)ringbuf_u32_push(rx->rb, (uint32_t)word);
     }
 
-    // 4) wait for neutral (optional timeout; disabled if 0)
+    // 5) wait for neutral (optional timeout; disabled if 0)
     if (rx->wait_neutral_timeout_us != 0u) {
         deadline = hal_time_deadline_us(rx->wait_neutral_timeout_us);
     }
@@ -88,6 +227,8 @@ aer_rx_poll_status_t aer_rx_poll_step(aer_rx_poll_t *rx)
 
         if (rx->wait_neutral_timeout_us != 0u && hal_time_expired(deadline)) {
             rx->stats.timeouts_neutral++;
+            HAL_DLOG2(HAL_LOG_WARN, DLOG_RX_NEUTRAL_TIMEOUT, "rx: DATA stuck at 0x%03lx for %lu us after ACK",
+                      (unsigned long)raw, (unsigned long)rx->wait_neutral_timeout_us);
             // recovery: drop ACK and return
             hal_gpio_ack_deassert();
             return AER_RX_POLL_TIMEOUT_WAIT_NEUTRAL;
@@ -95,7 +236,7 @@ aer_rx_poll_status_t aer_rx_poll_step(aer_rx_poll_t *rx)
         tight_loop_contents();
     }
 
-    // 5) deassert ACK
+    // 6) deassert ACK
     hal_gpio_ack_deassert();
 
     rx->stats.words_ok++;
@@ -112,8 +253,13 @@ uint32_t aer_rx_poll_service(aer_rx_poll_t *rx, uint32_t max_words, uint32_t tim
         : hal_time_deadline_us(time_budget_us);
 
     for (uint32_t i = 0; i < max_words; ++i) {
-        if (time_budget_us != 0u && hal_time_expired(budget_deadline)) {
-            break;
+        if (time_budget_us != 0u) {
+            // Wait for the next word on our own clock, not wait_valid_timeout_us.
+            while (data_is_neutral(hal_gpio_read_data_raw())) {
+                if (hal_time_expired(budget_deadline)) return ok;
+                tight_loop_contents();
+            }
+            if (hal_time_expired(budget_deadline)) break;
         }
 
         const aer_rx_poll_status_t st = aer_rx_poll_step(rx);
@@ -122,7 +268,8 @@ uint32_t aer_rx_poll_service(aer_rx_poll_t *rx, uint32_t max_words, uint32_t tim
             continue;
         }
 
-        // On timeouts, return control to main so you can log / attempt recovery.
+        // On NO_SPACE return so the caller can drain; on timeouts so it can
+        // log / attempt recovery.
         break;
     }
 
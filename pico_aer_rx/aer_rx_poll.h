@@ -6,6 +6,7 @@
 
 #include "aer_types.h"   // aer_raw_word_t
 #include "ringbuf.h"     // ringbuf_u32_t
+#include "spsc_ring.h"   // spsc_ring_u32_t (dual-core split)
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,11 +23,40 @@ extern "C" {
  *   deassert ACK
  *   push raw word into ring buffer (producer side)
  *
- * Backpressure behavior:
- *  - If the ring buffer is full, this receiver will NOT acknowledge an outstanding word.
- *    The transmitter will stall with DATA held valid until space is available.
+ * Ring-full behavior is selected with aer_rx_poll_set_overflow():
+ *  - AER_RX_OVERFLOW_DROP_NEWEST (default): handshake the word and discard it.
+ *    The bus never stalls; the newest data is lost (real-time viewing).
+ *  - AER_RX_OVERFLOW_BACKPRESSURE: do NOT acknowledge the outstanding word and
+ *    return AER_RX_POLL_NO_SPACE. The transmitter stalls with DATA held valid
+ *    until the consumer frees space (lossless capture of short bursts). If the
+ *    ring stays full for backpressure_timeout_us the word is handshaked and
+ *    dropped as with DROP_NEWEST, so a dead consumer cannot wedge the bus
+ *    (0 => hold forever).
+ *  - AER_RX_OVERFLOW_DROP_OLDEST: discard the oldest queued word to make room.
+ *    The ring keeps the most recent history. This advances the ring's tail
+ *    from the producer, so it is only valid when producer and consumer run on
+ *    the same core (as in pico_aer_rx.c's main loop).
+ *
+ * Rings:
+ *  - aer_rx_poll_init(): ringbuf_u32_t, producer and consumer on one core.
+ *  - aer_rx_poll_init_spsc(): spsc_ring_u32_t, for running the handshake
+ *    alone on core1 while core0 drains (AER_RX_DUAL_CORE). The consumer is
+ *    never touched from here, so DROP_OLDEST behaves as DROP_NEWEST.
+ *
+ * Latch timestamps (aer_rx_poll_set_timestamps()): the hal_cycles_now() value
+ * read right after DATA was seen valid is stored in a caller array paired
+ * with the ring's storage (same capacity, same slot index as the word), and
+ * written before the word is published. The consumer finds a word's time at
+ * the same offset: ts + (span.ptr[p] - storage). A word held by BACKPRESSURE
+ * keeps the time it was first seen.
  */
 
+typedef enum aer_rx_overflow_e {
+    AER_RX_OVERFLOW_DROP_NEWEST = 0,
+    AER_RX_OVERFLOW_BACKPRESSURE,
+    AER_RX_OVERFLOW_DROP_OLDEST
+} aer_rx_overflow_t;
+
 typedef enum aer_rx_poll_status_e {
     AER_RX_POLL_OK = 0,
     AER_RX_POLL_NO_SPACE,           // ring buffer full; did not ACK
@@ -36,14 +66,18 @@ typedef enum aer_rx_poll_status_e {
 
 typedef struct aer_rx_poll_stats_s {
     uint32_t words_ok;         // completed handshake (ACK cycle completed)
-    uint32_t dropped_full;     // ring buffer full drops (still handshaked)
+    uint32_t dropped_full;     // newest word dropped on a full ring (still handshaked)
+    uint32_t dropped_oldest;   // queued words evicted (DROP_OLDEST)
+    uint32_t bp_stalls;        // stall episodes: a word left un-ACKed on a full ring (BACKPRESSURE)
+    uint32_t bp_timeouts;      // stalls that hit backpressure_timeout_us (also in dropped_full)
     uint32_t timeouts_valid;   // only if enabled (see below)
     uint32_t timeouts_neutral; // only if enabled (see below)
 } aer_rx_poll_stats_t;
 
 
 typedef struct aer_rx_poll_s {
-    ringbuf_u32_t *rb;
+    ringbuf_u32_t   *rb;     // single-core ring (NULL when spsc is used)
+    spsc_ring_u32_t *spsc;   // cross-core ring (NULL when rb is used)
 
     // Timeouts (us)
     // wait_valid_timeout_us == 0   => wait forever (idle is not an error)
@@ -52,6 +86,16 @@ typedef struct aer_rx_poll_s {
     // wait_neutral_timeout_us == 0 => disabled (debug-only)
     uint32_t wait_neutral_timeout_us;
 
+    // Ring-full policy (see above). backpressure_timeout_us == 0 => stall forever.
+    aer_rx_overflow_t overflow;
+    uint32_t backpressure_timeout_us;
+    bool     bp_stalled;       // a word is being held un-ACKed
+    uint64_t bp_deadline_us;   // when the current stall gives up
+    uint32_t bp_t_latch;       // latch time of the held word
+
+    // Latch timestamps paired with the ring storage (NULL => off).
+    uint32_t *ts;
+
     aer_rx_poll_stats_t stats;
 } aer_rx_poll_t;
 
@@ -64,9 +108,40 @@ void aer_rx_poll_init(aer_rx_poll_t *rx,
                       uint32_t wait_valid_timeout_us,
                       uint32_t wait_neutral_timeout_us);
 
+/**
+ * Initialize a receiver that pushes into a cross-core SPSC ring. The caller
+ * of aer_rx_poll_step() is that ring's only producer.
+ */
+void aer_rx_poll_init_spsc(aer_rx_poll_t *rx,
+                           spsc_ring_u32_t *ring,
+                           uint32_t wait_valid_timeout_us,
+                           uint32_t wait_neutral_timeout_us);
+
 /** Reset stats and force ACK deasserted. */
 void aer_rx_poll_reset(aer_rx_poll_t *rx);
 
+/** Select the ring-full policy (init default: DROP_NEWEST). */
+void aer_rx_poll_set_overflow(aer_rx_poll_t *rx,
+                              aer_rx_overflow_t overflow,
+                              uint32_t backpressure_timeout_us);
+
+/** Change the handshake timeouts set by init (same meaning, 0 => off). */
+void aer_rx_poll_set_timeouts(aer_rx_poll_t *rx,
+                              uint32_t wait_valid_timeout_us,
+                              uint32_t wait_neutral_timeout_us);
+
+/**
+ * Record latch timestamps into ts (NULL => off), an array with one entry per
+ * ring slot: ring capacity entries, indexed like the ring's storage.
+ * Call after init (init turns them off).
+ */
+void aer_rx_poll_set_timestamps(aer_rx_poll_t *rx, uint32_t *ts);
+
+/** Words lost to the overflow policy (newest dropped + oldest evicted). */
+static inline uint32_t aer_rx_poll_dropped(const aer_rx_poll_t *rx) {
+    return rx->stats.dropped_full + rx->stats.dropped_oldest;
+}
+
 /**
  * Attempt to receive exactly one raw word.
  * This function may busy-wait (poll) up to the configured timeouts.
@@ -76,12 +151,19 @@ aer_rx_poll_status_t aer_rx_poll_step(aer_rx_poll_t *rx);
 /**
  * Service loop helper:
  * - tries up to max_words handshakes
- * - optionally stops after time_budget_us (0 => no budget)
- * Returns number of words successfully pushed.
+ * - optionally stops after time_budget_us (0 => no budget); with a budget,
+ *   an idle bus is waited on only until it runs out (not counted as a
+ *   timeouts_valid), so the call is bounded even with wait_valid_timeout_us 0
+ * - returns early on NO_SPACE so the caller can drain the ring
+ * Returns number of completed handshakes.
  */
 uint32_t aer_rx_poll_service(aer_rx_poll_t *rx, uint32_t max_words, uint32_t time_budget_us);
 
-/** Read-only stats accessor. */
+/**
+ * Read-only stats accessor. With the receiver on another core the counters
+ * are read while being updated; each one is a single aligned word, so values
+ * are consistent individually but not with each other.
+ */
 static inline const aer_rx_poll_stats_t *aer_rx_poll_stats(const aer_rx_poll_t *rx) {
     return &rx->stats;
 }
@@ -0,0 +1,65 @@
+// aer_sched.c
+#include "aer_sched.h"
+
+#include <stddef.h>
+
+void aer_sched_init(aer_sched_t *s, aer_sched_task_t *tasks, uint32_t n_tasks)
+{
+    if (!s) return;
+    s->tasks = tasks;
+    s->n_tasks = tasks ? n_tasks : 0u;
+    for (uint32_t i = 0u; i < s->n_tasks; ++i) {
+        aer_sched_task_t *t = &tasks[i];
+        t->budget_cycles = (t->budget_us != 0u) ? hal_us_to_cycles(t->budget_us) : 0u;
+        t->period_cycles = (t->period_us != 0u) ? hal_us_to_cycles(t->period_us) : 0u;
+        t->started = false;
+    }
+    aer_sched_reset_stats(s);
+}
+
+void aer_sched_reset_stats(aer_sched_t *s)
+{
+    if (!s) return;
+    s->stats = (aer_sched_stats_t){0};
+    for (uint32_t i = 0u; i < s->n_tasks; ++i) {
+        s->tasks[i].stats = (aer_sched_task_stats_t){0};
+    }
+}
+
+uint32_t aer_sched_run_once(aer_sched_t *s)
+{
+    const uint32_t t_pass = hal_cycles_now();
+    uint32_t work = 0u;
+
+    for (uint32_t i = 0u; i < s->n_tasks; ++i) {
+        aer_sched_task_t *t = &s->tasks[i];
+        const uint32_t now = hal_cycles_now();
+        if (t->started) {
+            const uint32_t since = hal_cycles_diff(now, t->t_start);
+            if (since < t->period_cycles) continue;
+            if (since > t->stats.interval_max) t->stats.interval_max = since;
+        }
+        t->started = true;
+        t->t_start = now;
+        t->run_step_max = 0u;
+
+        const uint32_t w = t->fn(t);
+
+        const uint32_t used = hal_cycles_diff(hal_cycles_now(), now);
+        t->stats.runs++;
+        t->stats.work += w;
+        t->stats.cycles_total += used;
+        if (w == 0u) t->stats.idle_runs++;
+        if (used > t->stats.cycles_max) t->stats.cycles_max = used;
+        if (t->run_step_max > t->stats.step_cycles_max) t->stats.step_cycles_max = t->run_step_max;
+        const uint32_t over = (t->run_step_max != 0u) ? t->run_step_max : used;
+        if (t->budget_cycles != 0u && over > t->budget_cycles) t->stats.overruns++;
+        work += w;
+    }
+
+    const uint32_t pass = hal_cycles_diff(hal_cycles_now(), t_pass);
+    s->stats.passes++;
+    if (work == 0u) s->stats.idle_passes++;
+    if (pass > s->stats.pass_cycles_max) s->stats.pass_cycles_max = pass;
+    return work;
+}
@@ -0,0 +1,120 @@
+// aer_sched.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal/hal_time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cooperative main-loop scheduler with per-task budgets and cycle accounting.
+ *
+ * The main loop is a fixed list of tasks (acquisition, decode, USB, host,
+ * housekeeping) run in order, one pass after another. Each task gets a
+ * budget per run and is expected to return once it is used up
+ * (aer_sched_expired()), or better sizes its work to what is left of it
+ * (aer_sched_fit_count()), so the longest any task waits for its next turn is
+ * bounded by the budgets of the others instead of by how much work happened
+ * to pile up (e.g. a full ring drained in one go). Tasks with a period run
+ * at most that often.
+ *
+ * Accounting is in hal_cycles_now() cycles: time spent per task (total,
+ * max, runs over budget) and the longest interval between the starts of
+ * two consecutive runs, i.e. the worst service latency that task saw.
+ * A task that works in indivisible steps (decode chunks) reports each one
+ * (aer_sched_step()); its run is then only an overrun when one step alone
+ * took longer than the budget, which no amount of stopping early can fix.
+ *
+ * Main-loop context only; no allocation, no locking.
+ */
+
+typedef struct aer_sched_task_s aer_sched_task_t;
+
+/** One run of a task. Returns units of work done (0 = nothing to do). */
+typedef uint32_t (*aer_sched_fn_t)(aer_sched_task_t *task);
+
+typedef struct aer_sched_task_stats_s {
+    uint32_t runs;
+    uint32_t idle_runs;          // returned 0
+    uint32_t overruns;           // took longer than the budget (one step alone, if steps are reported)
+    uint32_t cycles_max;         // longest run
+    uint32_t interval_max;       // longest start-to-start interval (cycles)
+    uint32_t step_cycles_max;    // longest step reported with aer_sched_step()
+    uint64_t cycles_total;
+    uint64_t work;               // sum of return values
+} aer_sched_task_stats_t;
+
+struct aer_sched_task_s {
+    // Configuration (set before aer_sched_init()).
+    const char     *name;
+    aer_sched_fn_t  fn;
+    void           *ctx;
+    uint32_t        budget_us;   // per run; 0 = unbounded (accounted only)
+    uint32_t        period_us;   // minimum start-to-start interval; 0 = every pass
+
+    // Derived / runtime.
+    uint32_t budget_cycles;
+    uint32_t period_cycles;
+    uint32_t t_start;            // hal_cycles_now() at the start of the current/last run
+    uint32_t run_step_max;       // longest step of the current/last run (0 = none reported)
+    bool     started;
+    aer_sched_task_stats_t stats;
+};
+
+typedef struct aer_sched_stats_s {
+    uint32_t passes;
+    uint32_t idle_passes;        // no task did any work
+    uint32_t pass_cycles_max;
+} aer_sched_stats_t;
+
+typedef struct aer_sched_s {
+    aer_sched_task_t *tasks;
+    uint32_t          n_tasks;
+    aer_sched_stats_t stats;
+} aer_sched_t;
+
+/** Bind the task table (kept by reference) and convert budgets to cycles. Call after hal_time_init(). */
+void aer_sched_init(aer_sched_t *s, aer_sched_task_t *tasks, uint32_t n_tasks);
+
+/** One pass: run every due task once, in table order. Returns the work done. */
+uint32_t aer_sched_run_once(aer_sched_t *s);
+
+/** Reset all counters (task and scheduler). */
+void aer_sched_reset_stats(aer_sched_t *s);
+
+/** Cycles the running task has used so far. */
+static inline uint32_t aer_sched_elapsed(const aer_sched_task_t *t) {
+    return hal_cycles_diff(hal_cycles_now(), t->t_start);
+}
+
+/** True once the running task has used its budget (never for budget 0). */
+static inline bool aer_sched_expired(const aer_sched_task_t *t) {
+    return t->budget_cycles != 0u && aer_sched_elapsed(t) >= t->budget_cycles;
+}
+
+/**
+ * Units of about unit_cycles each that still fit in the running task's
+ * budget, at most max (max for budget 0 or an unknown cost of 0).
+ */
+static inline uint32_t aer_sched_fit_count(const aer_sched_task_t *t, uint32_t unit_cycles, uint32_t max) {
+    if (t->budget_cycles == 0u || unit_cycles == 0u) return max;
+    const uint32_t used = aer_sched_elapsed(t);
+    if (used >= t->budget_cycles) return 0u;
+    const uint32_t k = (t->budget_cycles - used) / unit_cycles;
+    return (k < max) ? k : max;
+}
+
+/** Account one step of the running task that started at t_step (hal_cycles_now()). Returns its cycles. */
+static inline uint32_t aer_sched_step(aer_sched_task_t *t, uint32_t t_step) {
+    const uint32_t c = hal_cycles_diff(hal_cycles_now(), t_step);
+    if (c > t->run_step_max) t->run_step_max = c;
+    return c;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
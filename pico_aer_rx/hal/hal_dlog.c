@@ -0,0 +1,179 @@
+// pico/hal/hal_dlog.c
+#include "hal_dlog.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "hal_time.h"
+
+_Static_assert((HAL_DLOG_RING_LEN & (HAL_DLOG_RING_LEN - 1u)) == 0u, "HAL_DLOG_RING_LEN must be a power of two");
+
+/*
+ * Bounded multi-producer ring (one consumer). Each slot carries a sequence
+ * number: pos when free for the producer claiming position pos, pos + 1 once
+ * that producer filled it, pos + HAL_DLOG_RING_LEN after the consumer is done
+ * with it. Producers claim a position with one CAS on head and never wait
+ * for each other; a slot claimed but not yet filled only holds the consumer
+ * back.
+ */
+typedef struct dlog_slot_s {
+    _Atomic uint32_t seq;
+    uint16_t id;
+    uint8_t  level;
+    uint8_t  nargs;
+    uint32_t t_ticks;
+    uint32_t args[HAL_DLOG_MAX_ARGS];
+} dlog_slot_t;
+
+static dlog_slot_t g_ring[HAL_DLOG_RING_LEN];
+static _Atomic uint32_t g_head;     // next position producers claim
+static uint32_t g_tail;             // next position the consumer reads (consumer only)
+static _Atomic uint32_t g_dropped;  // ring full (producers, any core)
+static _Atomic uint32_t g_filtered;
+static _Atomic uint32_t g_records;
+static hal_dlog_stats_t g_stats;    // consumer-side counters + snapshot
+
+#define DLOG_HDR_BYTES 12u
+#define DLOG_REC_BYTES(nargs) (8u + 4u * (uint32_t)(nargs))
+
+void hal_dlog_init(void)
+{
+    for (uint32_t i = 0u; i < HAL_DLOG_RING_LEN; ++i) {
+        atomic_store_explicit(&g_ring[i].seq, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_head, 0u, memory_order_relaxed);
+    g_tail = 0u;
+    atomic_store_explicit(&g_dropped, 0u, memory_order_relaxed);
+    atomic_store_explicit(&g_filtered, 0u, memory_order_relaxed);
+    atomic_store_explicit(&g_records, 0u, memory_order_release);
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+
+bool hal_dlog_write(hal_log_level_t level, uint16_t id, uint32_t nargs, const uint32_t *args)
+{
+    if (level > hal_log_get_level()) {
+        atomic_fetch_add_explicit(&g_filtered, 1u, memory_order_relaxed);
+        return false;
+    }
+    if (nargs > HAL_DLOG_MAX_ARGS) nargs = HAL_DLOG_MAX_ARGS;
+    const uint32_t t = hal_cycles_now();
+
+    uint32_t pos = atomic_load_explicit(&g_head, memory_order_relaxed);
+    dlog_slot_t *s;
+    for (;;) {
+        s = &g_ring[pos & (HAL_DLOG_RING_LEN - 1u)];
+        const int32_t dif = (int32_t)(atomic_load_explicit(&s->seq, memory_order_acquire) - pos);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&g_head, &pos, pos + 1u,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (dif < 0) {
+            atomic_fetch_add_explicit(&g_dropped, 1u, memory_order_relaxed);
+            return false;   // ring full (the consumer has not released this slot yet)
+        } else {
+            pos = atomic_load_explicit(&g_head, memory_order_relaxed);
+        }
+    }
+
+    s->id = id;
+    s->level = (uint8_t)level;
+    s->nargs = (uint8_t)nargs;
+    s->t_ticks = t;
+    for (uint32_t i = 0u; i < nargs; ++i) s->args[i] = args[i];
+    atomic_store_explicit(&s->seq, pos + 1u, memory_order_release);
+    atomic_fetch_add_explicit(&g_records, 1u, memory_order_relaxed);
+    return true;
+}
+
+/* Slot at the consumer position pos + k, or NULL if not filled yet. */
+static inline dlog_slot_t *ready_slot(uint32_t k)
+{
+    const uint32_t pos = g_tail + k;
+    dlog_slot_t *s = &g_ring[pos & (HAL_DLOG_RING_LEN - 1u)];
+    return (atomic_load_explicit(&s->seq, memory_order_acquire) == pos + 1u) ? s : NULL;
+}
+
+static void release_slots(uint32_t n)
+{
+    for (uint32_t k = 0u; k < n; ++k) {
+        const uint32_t pos = g_tail + k;
+        atomic_store_explicit(&g_ring[pos & (HAL_DLOG_RING_LEN - 1u)].seq, pos + HAL_DLOG_RING_LEN,
+                              memory_order_release);
+    }
+    g_tail += n;
+}
+
+uint32_t hal_dlog_flush(void)
+{
+    uint32_t sent = 0u;
+    for (;;) {
+        uint8_t frame[HAL_DLOG_FRAME_BYTES];
+        uint32_t len = DLOG_HDR_BYTES;
+        uint32_t n = 0u;
+        dlog_slot_t *s;
+        while (n < 255u && (s = ready_slot(n)) != NULL && len + DLOG_REC_BYTES(s->nargs) <= sizeof(frame)) {
+            frame[len + 0u] = (uint8_t)s->id;
+            frame[len + 1u] = (uint8_t)(s->id >> 8);
+            frame[len + 2u] = s->level;
+            frame[len + 3u] = s->nargs;
+            memcpy(&frame[len + 4u], &s->t_ticks, 4u);
+            memcpy(&frame[len + 8u], s->args, 4u * s->nargs);
+            len += DLOG_REC_BYTES(s->nargs);
+            n++;
+        }
+        if (n == 0u) break;
+
+        if (!hal_stdio_is_connected()) {
+            release_slots(n);   // nobody to tell; the ring must not stay full for the next host
+            continue;
+        }
+        if (!hal_stdio_get_packetized()) {
+            /* Plain text console: no binary frames, print the raw records. */
+            for (uint32_t k = 0u; k < n; ++k) {
+                s = ready_slot(k);
+                uint32_t a[HAL_DLOG_MAX_ARGS] = {0};
+                memcpy(a, s->args, 4u * s->nargs);
+                hal_logf((hal_log_level_t)s->level, "dlog#%u t=%lu %lx %lx %lx %lx", (unsigned)s->id,
+                         (unsigned long)s->t_ticks, (unsigned long)a[0], (unsigned long)a[1],
+                         (unsigned long)a[2], (unsigned long)a[3]);
+            }
+            release_slots(n);
+            g_stats.sent += n;
+            sent += n;
+            continue;
+        }
+
+        const uint32_t table_id = (uint32_t)HAL_DLOG_TABLE_ID;
+        const uint32_t dropped = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+        frame[0] = (uint8_t)HAL_DLOG_VER;
+        frame[1] = (uint8_t)n;
+        frame[2] = 0u;
+        frame[3] = 0u;
+        memcpy(&frame[4], &table_id, 4u);
+        memcpy(&frame[8], &dropped, 4u);
+
+        if (!hal_stream_write(HAL_STREAM_LOG_BIN, frame, (uint16_t)len)) {
+            g_stats.frames_deferred++;   // keep them; the stream drains and we retry
+            break;
+        }
+        release_slots(n);
+        g_stats.frames++;
+        g_stats.sent += n;
+        sent += n;
+    }
+    return sent;
+}
+
+uint32_t hal_dlog_pending(void)
+{
+    return atomic_load_explicit(&g_head, memory_order_relaxed) - g_tail;
+}
+
+const hal_dlog_stats_t *hal_dlog_stats(void)
+{
+    g_stats.records  = atomic_load_explicit(&g_records, memory_order_relaxed);
+    g_stats.dropped  = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+    g_stats.filtered = atomic_load_explicit(&g_filtered, memory_order_relaxed);
+    return &g_stats;
+}
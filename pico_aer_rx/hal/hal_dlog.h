@@ -0,0 +1,128 @@
+// pico/hal/hal_dlog.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hal_stdio.h"      // hal_log_level_t
+#include "hal_dlog_ids.h"   // generated: DLOG_* ids, HAL_DLOG_TABLE_ID
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Deferred binary logging.
+ *
+ * A log site stores a fixed-size record (message id, level, up to
+ * HAL_DLOG_MAX_ARGS raw 32-bit arguments, hal_cycles_now()) in a lock-free
+ * ring and returns: no formatting, no USB, no interrupts disabled. The main
+ * loop packs queued records into HAL_STREAM_LOG_BIN frames
+ * (hal_dlog_flush(), called by usb_stream_poll()), and the host expands them
+ * with the table generated from the sources at build time.
+ *
+ * Sites (aer_rx_poll.c):
+ *   HAL_DLOG2(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, "rx: ring full for %lu us, word dropped (%lu so far)",
+ *             (unsigned long)rx->backpressure_timeout_us, (unsigned long)rx->stats.bp_timeouts);
+ * The id is a name; scripts/gen_dlog_table.py scans the sources for
+ * HAL_DLOG<n>() calls and generates hal_dlog_ids.h (the DLOG_* values and
+ * HAL_DLOG_TABLE_ID) and dlog_table.json (id -> level, format, site) for
+ * scripts/dlog_expand.py. A name must keep one format everywhere it is used.
+ * The format string is only seen by the compiler (which checks it against
+ * the arguments) and the generator; it is not stored on the device.
+ *
+ * Arguments are integers (or char) up to 32 bits: %d %i %u %x %X %o %c with
+ * the usual flags/width, the length modifiers hh, h and l (%lu, %03lx), and
+ * %%. No strings, pointers, floating point, ll/j/z/t lengths or * widths
+ * (the generator rejects them).
+ *
+ * Producers: any core or IRQ handler. A full ring drops the new record and
+ * counts it; the count travels in every frame so the host sees the loss.
+ * hal_dlog_flush() has a single caller (the main loop).
+ *
+ * LOG_BIN payload (little-endian, packed), version HAL_DLOG_VER:
+ *   u8  log_ver       HAL_DLOG_VER
+ *   u8  nrec          records that follow
+ *   u16 rsvd          0
+ *   u32 table_id      HAL_DLOG_TABLE_ID of the running image
+ *   u32 dropped       records lost to a full ring since boot
+ *   records, each:
+ *     u16 id, u8 level, u8 nargs, u32 t_ticks (hal_cycles_now()), u32 args[nargs]
+ */
+
+#define HAL_DLOG_VER       1u
+#define HAL_DLOG_MAX_ARGS  4u
+
+/* Ring slots (power of two). */
+#ifndef HAL_DLOG_RING_LEN
+#define HAL_DLOG_RING_LEN  64u
+#endif
+
+/* Largest LOG_BIN frame payload hal_dlog_flush() builds. */
+#define HAL_DLOG_FRAME_BYTES 512u
+
+typedef struct hal_dlog_stats_s {
+    uint32_t records;          // stored in the ring
+    uint32_t dropped;          // ring full
+    uint32_t filtered;         // below the hal_log_set_level() threshold
+    uint32_t sent;             // handed to the stream in accepted frames
+    uint32_t frames;           // LOG_BIN frames accepted by the stream
+    uint32_t frames_deferred;  // flushes that found the stream busy (records kept)
+} hal_dlog_stats_t;
+
+/** Reset the ring and counters (no producers may be active). */
+void hal_dlog_init(void);
+
+/** Store one record; false if filtered out or the ring is full. */
+bool hal_dlog_write(hal_log_level_t level, uint16_t id, uint32_t nargs, const uint32_t *args);
+
+/**
+ * Move queued records into LOG_BIN frames. Records stay queued if the
+ * stream refuses the frame (retried on the next call) and are discarded
+ * while no host is connected. Returns the number of records sent.
+ */
+uint32_t hal_dlog_flush(void);
+
+/** Records waiting in the ring. */
+uint32_t hal_dlog_pending(void);
+
+/** Counters (each a single word; read from any core). */
+const hal_dlog_stats_t *hal_dlog_stats(void);
+
+/* printf format checking only; never called. */
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+static inline void hal_dlog_fmt_check(const char *fmt, ...) { (void)fmt; }
+
+#define HAL_DLOG_PUT_(level, id, ...) do { \
+    const uint32_t hal_dlog_args_[] = { __VA_ARGS__ }; \
+    (void)hal_dlog_write((level), (uint16_t)(id), \
+                         (uint32_t)(sizeof(hal_dlog_args_) / sizeof(hal_dlog_args_[0])), hal_dlog_args_); \
+} while (0)
+
+/* HAL_DLOG<n>(level, id, "format", n arguments). */
+#define HAL_DLOG0(level, id, fmt) do { \
+    if (0) hal_dlog_fmt_check(fmt); \
+    (void)hal_dlog_write((level), (uint16_t)(id), 0u, (const uint32_t *)0); \
+} while (0)
+#define HAL_DLOG1(level, id, fmt, a) do { \
+    if (0) hal_dlog_fmt_check(fmt, a); \
+    HAL_DLOG_PUT_(level, id, (uint32_t)(a)); \
+} while (0)
+#define HAL_DLOG2(level, id, fmt, a, b) do { \
+    if (0) hal_dlog_fmt_check(fmt, a, b); \
+    HAL_DLOG_PUT_(level, id, (uint32_t)(a), (uint32_t)(b)); \
+} while (0)
+#define HAL_DLOG3(level, id, fmt, a, b, c) do { \
+    if (0) hal_dlog_fmt_check(fmt, a, b, c); \
+    HAL_DLOG_PUT_(level, id, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c)); \
+} while (0)
+#define HAL_DLOG4(level, id, fmt, a, b, c, d) do { \
+    if (0) hal_dlog_fmt_check(fmt, a, b, c, d); \
+    HAL_DLOG_PUT_(level, id, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)); \
+} while (0)
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,93 @@
+// pico/hal/hal_pio_rx.c
+#include "hal_pio_rx.h"
+#include "hal_gpio.h"
+
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+
+#include "aer_rx.pio.h"
+
+static PIO       g_pio;
+static uint      g_sm;
+static uint      g_offset;
+static int       g_dma = -1;
+static uint32_t *g_ring;
+static uint8_t   g_ack_pin;
+
+bool hal_pio_rx_init(uint32_t *ring, uint32_t ring_words, uint32_t start_idx)
+{
+    if (!ring || ring_words < 2u || (ring_words & (ring_words - 1u)) != 0u) return false;
+    if (hal_gpio_data_width() != aer_rx_DATA_BITS) return false;
+
+    // DMA write ring: 2^ring_bits bytes, at most 32 KiB.
+    const uint32_t ring_bits = (uint32_t)__builtin_ctz(ring_words * 4u);
+    if (ring_bits > 15u || ((uintptr_t)ring & ((ring_words * 4u) - 1u)) != 0u) return false;
+
+    if (!pio_claim_free_sm_and_add_program(&aer_rx_program, &g_pio, &g_sm, &g_offset)) {
+        return false;
+    }
+    g_dma = dma_claim_unused_channel(false);
+    if (g_dma < 0) {
+        pio_remove_program_and_unclaim_sm(&aer_rx_program, g_pio, g_sm, g_offset);
+        return false;
+    }
+
+    g_ring = ring;
+    g_ack_pin = hal_gpio_ack_pin();
+    aer_rx_program_init(g_pio, g_sm, g_offset, hal_gpio_data_base(), g_ack_pin);
+
+    // RX FIFO -> ring, paced by the state machine's RX DREQ.
+    dma_channel_config c = dma_channel_get_default_config((uint)g_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, ring_bits);
+    channel_config_set_dreq(&c, pio_get_dreq(g_pio, g_sm, false));
+    dma_channel_configure((uint)g_dma, &c, ring + start_idx, &g_pio->rxf[g_sm], 0u, false);
+
+    pio_sm_set_enabled(g_pio, g_sm, true);
+    return true;
+}
+
+void hal_pio_rx_deinit(void)
+{
+    if (g_dma < 0) return;
+    pio_sm_set_enabled(g_pio, g_sm, false);
+    dma_channel_abort((uint)g_dma);
+    dma_channel_unclaim((uint)g_dma);
+    g_dma = -1;
+    pio_remove_program_and_unclaim_sm(&aer_rx_program, g_pio, g_sm, g_offset);
+
+    gpio_set_function(g_ack_pin, GPIO_FUNC_SIO);
+    hal_gpio_ack_deassert();
+}
+
+bool hal_pio_rx_dma_busy(void)
+{
+    return dma_channel_is_busy((uint)g_dma);
+}
+
+uint32_t hal_pio_rx_dma_write_index(void)
+{
+    const uintptr_t w = (uintptr_t)dma_channel_hw_addr((uint)g_dma)->write_addr;
+    return (uint32_t)((w - (uintptr_t)g_ring) / sizeof(uint32_t));
+}
+
+void hal_pio_rx_dma_arm(uint32_t n)
+{
+    dma_channel_set_trans_count((uint)g_dma, n, true);
+}
+
+bool hal_pio_rx_take_stall(void)
+{
+    const uint32_t bit = 1u << (PIO_FDEBUG_RXSTALL_LSB + g_sm);
+    if ((g_pio->fdebug & bit) == 0u) return false;
+    g_pio->fdebug = bit;    // write 1 to clear
+    return true;
+}
+
+uint32_t hal_pio_rx_fifo_level(void)
+{
+    return pio_sm_get_rx_fifo_level(g_pio, g_sm);
+}
@@ -0,0 +1,49 @@
+// pico/hal/hal_pio_rx.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PIO + DMA plumbing for the aer_rx.pio handshake receiver.
+ *
+ * One instance: a state machine running aer_rx.pio on the pins configured by
+ * hal_gpio_init() (DATA in, ACK taken over by the PIO, active high), and a
+ * DMA channel copying its RX FIFO into a caller-owned power-of-two ring of
+ * 32-bit slots, wrapping by hardware. The DMA only runs while armed with a
+ * word count; the ring bookkeeping on top (what is published, how much may
+ * be written) lives in aer_rx_pio.c.
+ */
+
+/**
+ * Claim and start everything. ring must be aligned to ring_words * 4 bytes;
+ * the DMA writes its first word at ring[start_idx]. Not armed yet.
+ * Returns false if DATA width does not match the program or nothing is free.
+ */
+bool hal_pio_rx_init(uint32_t *ring, uint32_t ring_words, uint32_t start_idx);
+
+/** Stop and release the state machine and DMA channel; ACK goes back to the CPU, low. */
+void hal_pio_rx_deinit(void);
+
+/** True while an armed transfer still has words left to write. */
+bool hal_pio_rx_dma_busy(void);
+
+/** Ring index the DMA writes next (every write before it has completed). */
+uint32_t hal_pio_rx_dma_write_index(void);
+
+/** Allow n more words (only while not busy). */
+void hal_pio_rx_dma_arm(uint32_t n);
+
+/** True if a "push block" stalled on a full RX FIFO since the last call. */
+bool hal_pio_rx_take_stall(void);
+
+/** Words waiting in the RX FIFO. */
+uint32_t hal_pio_rx_fifo_level(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -8,6 +8,9 @@
 #include "pico/time.h"
 #include "pico/stdio_usb.h"
 #include "hardware/sync.h"
+#include "tusb.h"
+
+#include "hal_dlog.h"
 
 /* -------- Config / state -------- */
 
@@ -15,28 +18,37 @@ static volatile hal_log_level_t g_log_level = HAL_LOG_INFO;
 /* Default ON so logs don't corrupt binary streams. */
 static volatile bool g_packetized = true;
 
-/* Packet framing:
- *   magic[4] = 'A' 'E' 'R' 'S'
- *   ver      = 1
- *   type     = hal_stream_type_t
- *   len_le   = uint16 payload length
- *   payload  = len bytes
- *
- * No CRC (USB CDC is reliable enough; host can resync using magic).
+/* Framed stream: TX buffers (framing, seq, counters) drained into TinyUSB's
+ * CDC FIFO, bypassing newlib stdio. Writers only fill the buffers; the FIFO
+ * is written in hal_stream_poll() alone, from the core0 main loop, which is
+ * also the only place tud_task() runs (the stdio_usb background task is
+ * disabled in CMakeLists.txt), so TinyUSB is never entered concurrently.
+ * Frames the FIFO cannot take wait in the buffers; when both are full new
+ * frames are refused and their seq is skipped, which is what lets the host
+ * count frames that never arrived. Plain (non-packetized) logs still go
+ * through printf and must not be mixed with the binary stream.
  */
-#define HAL_STREAM_MAGIC_0 'A'
-#define HAL_STREAM_MAGIC_1 'E'
-#define HAL_STREAM_MAGIC_2 'R'
-#define HAL_STREAM_MAGIC_3 'S'
-#define HAL_STREAM_VER     1u
-
-typedef struct __attribute__((packed)) hal_stream_hdr_s {
-    uint8_t  magic[4];
-    uint8_t  ver;
-    uint8_t  type;
-    uint16_t len_le;
-} hal_stream_hdr_t;
+static hal_stream_tx_t g_tx;
+static hal_stream_stats_t g_stream_stats = {0};
 
+/* Writers call this from any context: it only reads TinyUSB's line state. */
+static bool cdc_port_connected(void *ctx) {
+    (void)ctx;
+    return stdio_usb_connected();
+}
+
+/* hal_stream_tx_kick() only, i.e. hal_stream_poll() on the core0 main loop. */
+static uint32_t cdc_port_write(void *ctx, const uint8_t *buf, uint32_t len) {
+    (void)ctx;
+    return tud_cdc_write(buf, len);
+}
+
+static void cdc_port_flush(void *ctx) {
+    (void)ctx;
+    (void)tud_cdc_write_flush();
+}
+
+/* Plain printf logging only. */
 static inline void lock_irq(uint32_t *saved) { *saved = save_and_disable_interrupts(); }
 static inline void unlock_irq(uint32_t saved) { restore_interrupts(saved); }
 
@@ -44,6 +56,15 @@ void hal_stdio_init(bool wait_for_usb, uint32_t timeout_ms) {
     /* USB-only: do NOT call stdio_init_all() (it may bring up UART stdio). */
     stdio_usb_init();
 
+    const hal_stream_port_t port = {
+        .connected = cdc_port_connected,
+        .write     = cdc_port_write,
+        .flush     = cdc_port_flush,
+        .ctx       = NULL,
+    };
+    hal_stream_tx_init(&g_tx, &port);
+    hal_dlog_init();
+
     if (wait_for_usb) {
         (void)hal_stdio_wait_connected(timeout_ms);
     }
@@ -60,7 +81,7 @@ bool hal_stdio_wait_connected(uint32_t timeout_ms) {
         if (timeout_ms != 0u && absolute_time_diff_us(get_absolute_time(), until) <= 0) {
             return false;
         }
-        tight_loop_contents();
+        tud_task();  // no stdio_usb background task (see g_tx)
     }
     return true;
 }
@@ -72,41 +93,34 @@ void hal_stdio_set_packetized(bool enabled) { g_packetized = enabled; }
 bool hal_stdio_get_packetized(void) { return g_packetized; }
 
 void hal_stdio_flush(void) {
+    hal_stream_poll();
     stdio_flush();
 }
 
-/* -------- Framed streaming -------- */
-
-static bool write_bytes_locked(const void *buf, size_t len) {
-    /* fwrite to stdout is routed to USB CDC when pico_enable_stdio_usb is on. */
-    if (!hal_stdio_is_connected()) return false;
-    size_t n = fwrite(buf, 1, len, stdout);
-    return (n == len);
+int hal_stdio_getc_nonblocking(void) {
+    const int c = getchar_timeout_us(0);
+    return (c == PICO_ERROR_TIMEOUT || c < 0) ? -1 : c;
 }
 
-bool hal_stream_write(hal_stream_type_t type, const void *payload, uint16_t len) {
-    if (!hal_stdio_is_connected()) return false;
-
-    hal_stream_hdr_t hdr;
-    hdr.magic[0] = (uint8_t)HAL_STREAM_MAGIC_0;
-    hdr.magic[1] = (uint8_t)HAL_STREAM_MAGIC_1;
-    hdr.magic[2] = (uint8_t)HAL_STREAM_MAGIC_2;
-    hdr.magic[3] = (uint8_t)HAL_STREAM_MAGIC_3;
-    hdr.ver      = (uint8_t)HAL_STREAM_VER;
-    hdr.type     = (uint8_t)type;
-    hdr.len_le   = (uint16_t)len;
+/* -------- Framed streaming -------- */
 
-    /* Prevent interleaving headers/payloads between IRQ contexts. */
-    uint32_t irq;
-    lock_irq(&irq);
+bool hal_stream_writev(hal_stream_type_t type, const hal_iovec_t *iov, uint32_t iovcnt) {
+    return hal_stream_tx_writev(&g_tx, (uint8_t)type, iov, iovcnt, NULL);
+}
 
-    bool ok = write_bytes_locked(&hdr, sizeof(hdr));
-    if (ok && len && payload) {
-        ok = write_bytes_locked(payload, len);
-    }
+void hal_stream_poll(void) {
+    /* The only sender: TinyUSB is serviced from this context alone. */
+    hal_stream_tx_kick(&g_tx);
+}
 
-    unlock_irq(irq);
-    return ok;
+const hal_stream_stats_t *hal_stream_stats(void) {
+    /* Snapshot of the lock-free counters (the caller's context only). */
+    g_stream_stats.frames_written       = atomic_load_explicit(&g_tx.stats.frames_written, memory_order_relaxed);
+    g_stream_stats.frames_failed        = atomic_load_explicit(&g_tx.stats.frames_failed, memory_order_relaxed);
+    g_stream_stats.frames_not_connected = atomic_load_explicit(&g_tx.stats.frames_not_connected, memory_order_relaxed);
+    g_stream_stats.bytes_sent           = atomic_load_explicit(&g_tx.stats.bytes_sent, memory_order_relaxed);
+    g_stream_stats.bytes_dropped        = atomic_load_explicit(&g_tx.stats.bytes_dropped, memory_order_relaxed);
+    return &g_stream_stats;
 }
 
 bool hal_stream_write_event_u16(uint16_t row, uint16_t col, uint32_t t_us, uint8_t flags) {
@@ -166,16 +180,13 @@ void hal_vlogf(hal_log_level_t level, const char *fmt, va_list ap) {
     const uint32_t t_ms = (uint32_t)(time_us_64() / 1000ULL);
 
     if (g_packetized) {
-        /* Packetized log line: "[1234][I] message" */
-        char line[320];
-        int m = snprintf(line, sizeof(line), "[%lu][%s] %s",
-                         (unsigned long)t_ms, lvl_tag(level), msg);
+        /* Packetized log line: "[1234][I] message", prefix and message
+         * gathered into one frame (no second formatting pass). */
+        char prefix[24];
+        int m = snprintf(prefix, sizeof(prefix), "[%lu][%s] ", (unsigned long)t_ms, lvl_tag(level));
         if (m < 0) return;
-        if ((size_t)m >= sizeof(line)) {
-            line[sizeof(line) - 1] = '\0';
-            m = (int)strlen(line);
-        }
-        (void)hal_stream_write(HAL_STREAM_LOG_TEXT, line, (uint16_t)m);
+        const hal_iovec_t iov[2] = { { prefix, (uint16_t)m }, { msg, (uint16_t)n } };
+        (void)hal_stream_writev(HAL_STREAM_LOG_TEXT, iov, 2u);
     } else {
         /* Plain printf (human-friendly). WARNING: don't use with binary streaming. */
         uint32_t irq;
@@ -5,6 +5,8 @@
 #include <stdint.h>
 #include <stdarg.h>
 
+#include "hal_stream_tx.h"  // hal_iovec_t
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,8 +33,34 @@ typedef enum hal_stream_type_e {
     HAL_STREAM_EVENT_BIN  = 2,  // payload: binary event records (your choice)
     HAL_STREAM_RAW_BIN    = 3,  // payload: arbitrary binary
     HAL_STREAM_MARKER     = 4,  // payload: small markers (optional)
+    HAL_STREAM_HELLO      = 5,  // payload: stream capability descriptor (see usb_stream.h)
+    HAL_STREAM_LOSS       = 6,  // payload: loss/drop summary counters (see usb_stream.h)
+    HAL_STREAM_RING_STATS = 7,  // payload: ring buffer occupancy stats (see usb_stream.h)
+    HAL_STREAM_TIME_ANCHOR = 8, // payload: 64-bit tick reference for t_ticks unwrap (see usb_stream.h)
+    HAL_STREAM_LOG_BIN    = 9,  // payload: deferred log records, expanded on the host (see hal_dlog.h)
+    HAL_STREAM_CTRL_RSP   = 10, // payload: response to a host control command (see usb_ctrl.h)
 } hal_stream_type_t;
 
+/**
+ * Version byte written in every AERS frame header.
+ *   1: magic[4] ver type len_le                 (8 bytes)
+ *   2: magic[4] ver type len_le seq_le          (10 bytes)
+ * seq is a u16 that increments for every frame hal_stream_write() attempts
+ * while connected (whatever its type), so a gap on the host means frames the
+ * device tried to send were lost on the way.
+ */
+#define HAL_STREAM_VER      2u
+#define HAL_STREAM_HDR_LEN  10u
+
+/** Transport-level counters (all frame types). */
+typedef struct hal_stream_stats_s {
+    uint32_t frames_written;     // frame queued in a TX buffer for the host
+    uint32_t frames_failed;      // refused: TX buffers full or frame too big (seq was consumed)
+    uint32_t frames_not_connected; // hal_stream_write() called with no host (no seq consumed)
+    uint32_t bytes_sent;         // bytes handed to the CDC endpoint
+    uint32_t bytes_dropped;      // queued bytes discarded when the host went away
+} hal_stream_stats_t;
+
 /** Basic init; if wait_for_usb is true, blocks up to timeout_ms for host connection. */
 void hal_stdio_init(bool wait_for_usb, uint32_t timeout_ms);
 
@@ -48,20 +76,30 @@ hal_log_level_t hal_log_get_level(void);
 
 /**
  * Enable "packetized mode" for logs/events.
- * - When enabled, logs are sent as framed packets (type=HAL_STREAM_LOG_TEXT)
+ * - When enabled, logs are sent as framed packets (type=HAL_STREAM_LOG_TEXT,
+ *   deferred records as HAL_STREAM_LOG_BIN)
  * - When disabled, logs use plain printf (human readable) but MUST NOT be used
- *   concurrently with binary event streaming.
+ *   concurrently with binary event streaming, and only from the core0 main
+ *   loop (stdio_usb drives TinyUSB itself).
  *
  * Default: packetized = true (safe for mixed logs + events).
  */
 void hal_stdio_set_packetized(bool enabled);
 bool hal_stdio_get_packetized(void);
 
-/** Flush stdio output. */
+/** Flush stdio output (and push queued frames, as hal_stream_poll(); main loop only). */
 void hal_stdio_flush(void);
 
+/** Non-blocking read of one byte sent by the host; returns -1 if none is pending. */
+int hal_stdio_getc_nonblocking(void);
+
 /* ---------------- Logging ---------------- */
 
+/*
+ * hal_logf() formats on the calling core and writes a LOG_TEXT frame right
+ * away. Log sites in the acquisition path use the deferred HAL_DLOG*()
+ * macros instead (hal_dlog.h): a record into a ring, formatted on the host.
+ */
 void hal_logf(hal_log_level_t level, const char *fmt, ...);
 void hal_vlogf(hal_log_level_t level, const char *fmt, va_list ap);
 
@@ -75,10 +113,37 @@ void hal_vlogf(hal_log_level_t level, const char *fmt, va_list ap);
 /* ---------------- Framed streaming ---------------- */
 
 /**
- * Write a framed packet.
- * Returns false if not connected or write failed.
+ * Frames are assembled in two TX buffers without disabling interrupts or
+ * taking a lock (hal_stream_tx.h); writes never touch TinyUSB, so they are
+ * safe from IRQ handlers and either core. A write returns once the frame is
+ * queued; a full link shows up as frames_failed (and a seq gap on the host),
+ * never as a blocked caller. Queued frames reach the CDC endpoint only in
+ * hal_stream_poll(), a whole buffer at a time.
  */
-bool hal_stream_write(hal_stream_type_t type, const void *payload, uint16_t len);
+
+/**
+ * Write a framed packet whose payload is gathered from iovcnt pieces
+ * (e.g. a record header and its body) without staging them first.
+ * Returns false if not connected, the frame exceeds HAL_STREAM_TX_BUF_BYTES,
+ * or both TX buffers are still waiting for the host.
+ */
+bool hal_stream_writev(hal_stream_type_t type, const hal_iovec_t *iov, uint32_t iovcnt);
+
+/** Write a framed packet (single-piece hal_stream_writev()). */
+static inline bool hal_stream_write(hal_stream_type_t type, const void *payload, uint16_t len) {
+    const hal_iovec_t iov = { payload, len };
+    return hal_stream_writev(type, &iov, 1u);
+}
+
+/**
+ * Hand queued frames to the CDC endpoint as far as it has room. The only
+ * place the endpoint is written: call it from the core0 main loop, next to
+ * tud_task() and never from an IRQ or core1 (usb_stream_poll() does).
+ */
+void hal_stream_poll(void);
+
+/** Transport counters; frames_written + frames_failed == frames that consumed a seq. */
+const hal_stream_stats_t *hal_stream_stats(void);
 
 /**
  * Helper to stream one decoded event as a simple fixed binary record.
@@ -0,0 +1,215 @@
+// pico/hal/hal_stream_tx.c
+#include "hal_stream_tx.h"
+
+#include <string.h>
+
+#include "hal_stdio.h"  // HAL_STREAM_VER, HAL_STREAM_HDR_LEN
+
+/* Packet framing:
+ *   magic[4] = 'A' 'E' 'R' 'S'
+ *   ver      = HAL_STREAM_VER (2)
+ *   type     = hal_stream_type_t
+ *   len_le   = uint16 payload length
+ *   seq_le   = uint16 frame sequence number (wraps)
+ *   payload  = len bytes
+ *
+ * No CRC (USB CDC is reliable enough; host can resync using magic).
+ */
+typedef struct __attribute__((packed)) hal_stream_hdr_s {
+    uint8_t  magic[4];
+    uint8_t  ver;
+    uint8_t  type;
+    uint16_t len_le;
+    uint16_t seq_le;
+} hal_stream_hdr_t;
+
+_Static_assert(sizeof(hal_stream_hdr_t) == HAL_STREAM_HDR_LEN, "AERS header is part of the host protocol");
+
+/* State word layout (see hal_stream_tx.h). */
+#define ST_ACTIVE      0x80000000u
+#define ST_OTHER_BUSY  0x40000000u
+#define ST_OFF_SHIFT   16u
+#define ST_OFF_MASK    0x3FFFu
+#define ST_SEQ_MASK    0xFFFFu
+
+static inline uint32_t st_active(uint32_t s) { return s >> 31; }
+static inline uint32_t st_off(uint32_t s)    { return (s >> ST_OFF_SHIFT) & ST_OFF_MASK; }
+static inline uint32_t st_seq(uint32_t s)    { return s & ST_SEQ_MASK; }
+
+static inline uint32_t st_with(uint32_t s, uint32_t off, uint32_t seq)
+{
+    return (s & (ST_ACTIVE | ST_OTHER_BUSY)) | (off << ST_OFF_SHIFT) | (seq & ST_SEQ_MASK);
+}
+
+/* Active buffer becomes the sealed one; the other (free) one starts empty. */
+static inline uint32_t st_swapped(uint32_t s)
+{
+    return ((s & ST_ACTIVE) ^ ST_ACTIVE) | ST_OTHER_BUSY | st_seq(s);
+}
+
+static inline void stat_inc(_Atomic uint32_t *c, uint32_t n)
+{
+    atomic_fetch_add_explicit(c, n, memory_order_relaxed);
+}
+
+void hal_stream_tx_init(hal_stream_tx_t *tx, const hal_stream_port_t *port)
+{
+    atomic_store_explicit(&tx->state, 0u, memory_order_relaxed);
+    for (uint32_t b = 0u; b < 2u; ++b) {
+        atomic_store_explicit(&tx->committed[b], 0u, memory_order_relaxed);
+        atomic_store_explicit(&tx->sealed_len[b], HAL_STREAM_TX_UNSEALED, memory_order_relaxed);
+    }
+    atomic_store_explicit(&tx->sent, 0u, memory_order_relaxed);
+    tx->port = *port;
+
+    atomic_store_explicit(&tx->stats.frames_written, 0u, memory_order_relaxed);
+    atomic_store_explicit(&tx->stats.frames_failed, 0u, memory_order_relaxed);
+    atomic_store_explicit(&tx->stats.frames_not_connected, 0u, memory_order_relaxed);
+    atomic_store_explicit(&tx->stats.buffers_sent, 0u, memory_order_relaxed);
+    atomic_store_explicit(&tx->stats.bytes_sent, 0u, memory_order_relaxed);
+    atomic_store_explicit(&tx->stats.bytes_dropped, 0u, memory_order_release);
+}
+
+bool hal_stream_tx_writev(hal_stream_tx_t *tx, uint8_t type,
+                          const hal_iovec_t *iov, uint32_t iovcnt, uint16_t *seq_out)
+{
+    if (!tx->port.connected(tx->port.ctx)) {
+        stat_inc(&tx->stats.frames_not_connected, 1u);
+        return false;
+    }
+
+    uint32_t len = 0u;
+    for (uint32_t i = 0u; i < iovcnt; ++i) {
+        if (iov[i].base) len += iov[i].len;
+    }
+    const uint32_t total = (uint32_t)sizeof(hal_stream_hdr_t) + len;
+    const bool fits = (len <= 0xFFFFu) && (total <= HAL_STREAM_TX_BUF_BYTES);
+
+    /* Reserve [off, off + total) of the active buffer and a seq in one CAS. */
+    uint32_t s = atomic_load_explicit(&tx->state, memory_order_relaxed);
+    uint32_t b, off, seq;
+    for (;;) {
+        b = st_active(s);
+        off = st_off(s);
+        seq = st_seq(s);
+
+        if (fits && total <= HAL_STREAM_TX_BUF_BYTES - off) {
+            if (atomic_compare_exchange_weak_explicit(&tx->state, &s, st_with(s, off + total, seq + 1u),
+                                                      memory_order_acquire, memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+        if (fits && (s & ST_OTHER_BUSY) == 0u) {
+            /* Active buffer is full and the other one is free: seal and swap. */
+            const uint32_t ns = st_swapped(s);
+            if (atomic_compare_exchange_weak_explicit(&tx->state, &s, ns,
+                                                      memory_order_acq_rel, memory_order_relaxed)) {
+                atomic_store_explicit(&tx->sealed_len[b], off, memory_order_release);
+                s = ns;
+            }
+            continue;
+        }
+        /* Refused (other buffer still being sent, or too big): still consume a seq so the host sees a gap. */
+        if (atomic_compare_exchange_weak_explicit(&tx->state, &s, st_with(s, off, seq + 1u),
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            stat_inc(&tx->stats.frames_failed, 1u);
+            if (seq_out) *seq_out = (uint16_t)seq;
+            return false;
+        }
+    }
+
+    hal_stream_hdr_t hdr;
+    hdr.magic[0] = 'A';
+    hdr.magic[1] = 'E';
+    hdr.magic[2] = 'R';
+    hdr.magic[3] = 'S';
+    hdr.ver      = (uint8_t)HAL_STREAM_VER;
+    hdr.type     = type;
+    hdr.len_le   = (uint16_t)len;
+    hdr.seq_le   = (uint16_t)seq;
+
+    uint8_t *dst = &tx->buf[b][off];
+    memcpy(dst, &hdr, sizeof(hdr));
+    dst += sizeof(hdr);
+    for (uint32_t i = 0u; i < iovcnt; ++i) {
+        if (!iov[i].base || iov[i].len == 0u) continue;
+        memcpy(dst, iov[i].base, iov[i].len);
+        dst += iov[i].len;
+    }
+
+    /* Publish: the sender waits for committed == sealed length. */
+    atomic_fetch_add_explicit(&tx->committed[b], total, memory_order_release);
+    stat_inc(&tx->stats.frames_written, 1u);
+    if (seq_out) *seq_out = (uint16_t)seq;
+    return true;
+}
+
+void hal_stream_tx_kick(hal_stream_tx_t *tx)
+{
+    bool wrote = false;
+    for (;;) {
+        uint32_t s = atomic_load_explicit(&tx->state, memory_order_acquire);
+
+        if (s & ST_OTHER_BUSY) {
+            const uint32_t ob = st_active(s) ^ 1u;
+            const uint32_t len = atomic_load_explicit(&tx->sealed_len[ob], memory_order_acquire);
+            if (len == HAL_STREAM_TX_UNSEALED
+                || atomic_load_explicit(&tx->committed[ob], memory_order_acquire) != len) {
+                break;  // a writer is still copying into it
+            }
+
+            uint32_t sent = atomic_load_explicit(&tx->sent, memory_order_relaxed);
+            if (!tx->port.connected(tx->port.ctx)) {
+                stat_inc(&tx->stats.bytes_dropped, len - sent);
+                sent = len;
+            }
+            while (sent < len) {
+                const uint32_t n = tx->port.write(tx->port.ctx, &tx->buf[ob][sent], len - sent);
+                if (n == 0u) break;
+                sent += n;
+                stat_inc(&tx->stats.bytes_sent, n);
+                wrote = true;
+            }
+            if (sent < len) {
+                atomic_store_explicit(&tx->sent, sent, memory_order_relaxed);
+                break;  // port full; continue on the next kick
+            }
+
+            /* Sent: recycle it, then let writers swap into it. */
+            atomic_store_explicit(&tx->sent, 0u, memory_order_relaxed);
+            atomic_store_explicit(&tx->committed[ob], 0u, memory_order_relaxed);
+            atomic_store_explicit(&tx->sealed_len[ob], HAL_STREAM_TX_UNSEALED, memory_order_relaxed);
+            atomic_fetch_and_explicit(&tx->state, ~ST_OTHER_BUSY, memory_order_release);
+            stat_inc(&tx->stats.buffers_sent, 1u);
+            continue;
+        }
+
+        /* Nothing in flight: hand over the active buffer now if every frame
+         * in it is complete, rather than waiting for it to fill. */
+        const uint32_t b = st_active(s);
+        const uint32_t off = st_off(s);
+        if (off == 0u || atomic_load_explicit(&tx->committed[b], memory_order_acquire) != off) {
+            break;
+        }
+        if (atomic_compare_exchange_strong_explicit(&tx->state, &s, st_swapped(s),
+                                                    memory_order_acq_rel, memory_order_relaxed)) {
+            atomic_store_explicit(&tx->sealed_len[b], off, memory_order_release);
+        }
+    }
+
+    if (wrote && tx->port.flush) {
+        tx->port.flush(tx->port.ctx);
+    }
+}
+
+uint32_t hal_stream_tx_pending(hal_stream_tx_t *tx)
+{
+    const uint32_t s = atomic_load_explicit(&tx->state, memory_order_acquire);
+    uint32_t n = atomic_load_explicit(&tx->committed[st_active(s)], memory_order_relaxed);
+    if (s & ST_OTHER_BUSY) {
+        const uint32_t len = atomic_load_explicit(&tx->sealed_len[st_active(s) ^ 1u], memory_order_relaxed);
+        if (len != HAL_STREAM_TX_UNSEALED) n += len - atomic_load_explicit(&tx->sent, memory_order_relaxed);
+    }
+    return n;
+}
@@ -0,0 +1,123 @@
+// pico/hal/hal_stream_tx.h
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Lock-free framed transmit buffers (the engine behind hal_stream_writev()).
+ *
+ * Frames (AERS header + gathered payload pieces) are copied into one of two
+ * TX buffers; whole buffers are handed to a byte port (TinyUSB CDC on the
+ * Pico, host/sim/cdc_sim.c on Linux). Writers never touch the port, and no
+ * interrupts are disabled and no lock is taken on the write path:
+ *
+ *  - One 32-bit state word holds the active buffer, whether the other one
+ *    is still being sent, the bytes reserved in the active one and the next
+ *    frame seq. A writer reserves space and a seq with a single CAS, so the
+ *    on-wire order is the seq order, then copies and adds its length to the
+ *    buffer's committed count.
+ *  - A full active buffer is sealed by swapping to the other one (same CAS),
+ *    only once that one has been sent; until then frames are refused and
+ *    counted (frames_failed), still consuming a seq so the host sees the gap.
+ *  - Sending (hal_stream_tx_kick()) pushes the sealed buffer into the port
+ *    once every reservation in it is committed. With nothing in flight it
+ *    seals the active buffer early, so an idle link gets data without
+ *    waiting for a buffer to fill; under load buffers grow while the
+ *    previous one drains.
+ *
+ * hal_stream_tx_writev() may be called from interrupt handlers and from both
+ * cores (RP2350 has a global exclusive monitor for SRAM, so the CASes work
+ * across cores). A writer interrupted between its reservation and its commit
+ * delays the send of that buffer, never corrupts it. hal_stream_tx_kick() is
+ * the only caller of the port and must always run in the same context, the
+ * one that owns the port (the core0 main loop on the Pico).
+ *
+ * Platform-agnostic C11; the Pico and host HALs each own one instance.
+ */
+
+/* Size of each of the two TX buffers; the largest frame that can be sent. */
+#ifndef HAL_STREAM_TX_BUF_BYTES
+#define HAL_STREAM_TX_BUF_BYTES 2048u
+#endif
+
+_Static_assert(HAL_STREAM_TX_BUF_BYTES >= 64u && HAL_STREAM_TX_BUF_BYTES <= 0x3FFFu,
+               "buffer offset must fit the 14-bit field of the state word");
+
+/** One piece of a gathered payload. */
+typedef struct hal_iovec_s {
+    const void *base;
+    uint16_t    len;
+} hal_iovec_t;
+
+/** Byte sink the buffers drain into (non-blocking). connected() is called by
+ *  writers too, so it must be safe wherever they run; write() and flush()
+ *  only from hal_stream_tx_kick(). */
+typedef struct hal_stream_port_s {
+    bool     (*connected)(void *ctx);
+    /** Take up to len bytes; returns how many were accepted (0 if full). */
+    uint32_t (*write)(void *ctx, const uint8_t *buf, uint32_t len);
+    /** Push out whatever the port holds (short USB packet); may be NULL. */
+    void     (*flush)(void *ctx);
+    void     *ctx;
+} hal_stream_port_t;
+
+/** Counters; read with relaxed loads (each one is consistent on its own). */
+typedef struct hal_stream_tx_stats_s {
+    _Atomic uint32_t frames_written;       // frames copied into a TX buffer
+    _Atomic uint32_t frames_failed;        // refused: both buffers busy or frame too big (seq consumed)
+    _Atomic uint32_t frames_not_connected; // refused: no host (no seq consumed)
+    _Atomic uint32_t buffers_sent;         // buffers fully handed to the port
+    _Atomic uint32_t bytes_sent;           // bytes the port accepted
+    _Atomic uint32_t bytes_dropped;        // buffered bytes discarded because the host went away
+} hal_stream_tx_stats_t;
+
+typedef struct hal_stream_tx_s {
+    uint8_t buf[2][HAL_STREAM_TX_BUF_BYTES];
+
+    /* bit 31: active buffer, bit 30: other buffer sealed (being sent),
+     * bits 16..29: bytes reserved in the active buffer, bits 0..15: next seq. */
+    _Atomic uint32_t state;
+    _Atomic uint32_t committed[2];   // bytes written and complete, per buffer
+    _Atomic uint32_t sealed_len[2];  // length of a sealed buffer (HAL_STREAM_TX_UNSEALED until known)
+    _Atomic uint32_t sent;           // bytes of the sealed buffer already in the port (written by the sender)
+
+    hal_stream_port_t     port;
+    hal_stream_tx_stats_t stats;
+} hal_stream_tx_t;
+
+#define HAL_STREAM_TX_UNSEALED 0xFFFFFFFFu
+
+/** Reset everything (no writers may be active) and attach the port. */
+void hal_stream_tx_init(hal_stream_tx_t *tx, const hal_stream_port_t *port);
+
+/**
+ * Queue one frame: AERS header (type, seq) followed by the iov pieces.
+ * Returns false if not connected, the frame is larger than a buffer, or
+ * both buffers are busy. *seq_out (may be NULL) gets the seq it consumed.
+ */
+bool hal_stream_tx_writev(hal_stream_tx_t *tx, uint8_t type,
+                          const hal_iovec_t *iov, uint32_t iovcnt, uint16_t *seq_out);
+
+/**
+ * Move buffered frames into the port as far as it accepts. Cheap when idle.
+ * The sender: call it from the port's owning context only, never from a writer.
+ */
+void hal_stream_tx_kick(hal_stream_tx_t *tx);
+
+/** The seq the next frame will get (exact only while nobody else writes). */
+static inline uint16_t hal_stream_tx_next_seq(hal_stream_tx_t *tx) {
+    return (uint16_t)atomic_load_explicit(&tx->state, memory_order_relaxed);
+}
+
+/** Bytes queued in the TX buffers and not yet accepted by the port. */
+uint32_t hal_stream_tx_pending(hal_stream_tx_t *tx);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
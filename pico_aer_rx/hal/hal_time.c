@@ -4,6 +4,7 @@
 #include "pico/time.h"
 #include "hardware/clocks.h"
 #include "pico/platform.h"
+#include "hardware/sync.h"
 
 #if defined(PICO_RP2350)
 // Many Pico SDK setups expose CMSIS for Cortex-M33 automatically via pico/platform.h.
@@ -13,18 +14,30 @@
 
 static uint32_t g_clk_sys_hz = 0;
 static uint32_t g_cycles_per_us = 0;
-static bool     g_dwt_ok = false;
+/* Per core: each core has its own DWT and only ever writes its own slot. */
+static bool     g_dwt_ok[NUM_CORES];
 
-static void enable_dwt_cycle_counter_if_present(void) {
-    g_dwt_ok = false;
+_Atomic uint32_t hal_cycles_epoch = 0u;
+
+/* The cycle count the us timer implies: the shared timebase of every core. */
+static inline uint64_t cycles_from_us(uint64_t us) {
+    return us * (uint64_t)g_cycles_per_us;
+}
+
+static bool enable_dwt_cycle_counter_if_present(void) {
+    bool ok = false;
 
     /* DWT CYCCNT is available on Cortex-M3+ (incl. M33) if not locked down. */
 #if defined(DWT) && defined(CoreDebug) && defined(DWT_CTRL_CYCCNTENA_Msk) && defined(CoreDebug_DEMCR_TRCENA_Msk)
     /* Enable trace (required for DWT) */
     CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
 
-    /* Reset and enable CYCCNT */
-    DWT->CYCCNT = 0;
+    /* Enable CYCCNT, started on the shared timebase. Wait for a fresh us tick
+     * first so the start value is within a few cycles of the timer. */
+    const uint64_t us0 = time_us_64();
+    uint64_t us;
+    while ((us = time_us_64()) == us0) { tight_loop_contents(); }
+    DWT->CYCCNT = (uint32_t)cycles_from_us(us);
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
     /* Quick sanity check: does it count? */
@@ -32,10 +45,15 @@ static void enable_dwt_cycle_counter_if_present(void) {
     __asm volatile("nop");
     uint32_t b = DWT->CYCCNT;
 
-    if (b != a) {
-        g_dwt_ok = true;
-    }
+    ok = (b != a);
 #endif
+    return ok;
+}
+
+void hal_time_init_core(void) {
+    /* This core's DWT and flag only: the clock and epoch are core0's, and
+     * rewriting them here would race its readers. */
+    g_dwt_ok[get_core_num()] = enable_dwt_cycle_counter_if_present();
 }
 
 void hal_time_init(void) {
@@ -50,7 +68,18 @@ void hal_time_init(void) {
         g_cycles_per_us = 1u;
     }
 
-    enable_dwt_cycle_counter_if_present();
+    hal_time_init_core();
+
+    /* Epoch matching the counter's position on the timebase, so 64-bit ticks
+     * count from boot. Stored once, before any other core starts. */
+    const uint64_t now = cycles_from_us(time_us_64());
+    atomic_store_explicit(&hal_cycles_epoch,
+                          ((uint32_t)(now >> 32) & 0x7FFFFFFFu) | ((uint32_t)now & 0x80000000u),
+                          memory_order_release);
+}
+
+uint32_t hal_time_core_num(void) {
+    return get_core_num();
 }
 
 uint64_t hal_time_us_now(void) {
@@ -87,13 +116,20 @@ void hal_time_spin_us(uint32_t us) {
 
 uint32_t hal_cycles_now(void) {
 #if defined(DWT) && defined(DWT_CTRL_CYCCNTENA_Msk)
-    if (g_dwt_ok) {
+    if (g_dwt_ok[get_core_num()]) {
         return (uint32_t)DWT->CYCCNT;
     }
 #endif
     /* Fallback: derive a cycle-ish counter from microseconds. */
-    const uint64_t us = hal_time_us_now();
-    return (uint32_t)(us * (uint64_t)g_cycles_per_us);
+    return (uint32_t)cycles_from_us(hal_time_us_now());
+}
+
+uint32_t hal_cycles_hz(void) {
+    return g_clk_sys_hz;
+}
+
+bool hal_cycles_is_exact(void) {
+    return g_dwt_ok[get_core_num()];
 }
 
 uint32_t hal_cycles_to_us(uint32_t cycles) {
@@ -1,6 +1,8 @@
 // pico/hal/hal_time.h
 #pragma once
 
+#include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -19,11 +21,27 @@ extern "C" {
  *  - Microsecond timebase uses Pico SDK's monotonic timer (time_us_64()).
  *  - Cycle counter prefers ARM DWT->CYCCNT if present/enabled; otherwise falls back to a
  *    derived counter from time_us_64() and clk_sys (still useful for coarse profiling).
+ *  - Each core has its own DWT. hal_time_init() / hal_time_init_core() start it at
+ *    time_us_64() * cycles/us, the same value the fallback derives, so both cores
+ *    (and both sources) count on one timebase to within a few cycles.
+ *  - C only (the 64-bit extension below uses <stdatomic.h>).
  */
 
-/** Call once at boot (per-core if you use both cores). Enables cycle counter if available. */
+/**
+ * Call once at boot on core0, before launching another core. Sets the clock
+ * rate and the 64-bit epoch, and starts core0's cycle counter.
+ */
 void hal_time_init(void);
 
+/**
+ * Call once on each other core that reads the cycle counter, after core0's
+ * hal_time_init(). Starts this core's DWT only; touches no shared state.
+ */
+void hal_time_init_core(void);
+
+/** Index of the calling core (get_core_num() on the Pico). */
+uint32_t hal_time_core_num(void);
+
 /** Monotonic time since boot in microseconds. */
 uint64_t hal_time_us_now(void);
 
@@ -55,6 +73,46 @@ void hal_time_spin_us(uint32_t us);
  */
 uint32_t hal_cycles_now(void);
 
+/*
+ * 64-bit extended cycle counter (cnt32_to_63 scheme).
+ *
+ * hal_cycles_epoch holds the wrap count in bits 0..30 and, in bit 31, the top
+ * bit of the 32-bit counter when it was last seen. A read whose top bit
+ * differs advances the epoch by half a period.
+ *
+ * Core0 only. Each core reads its own DWT, and the two are a few cycles apart
+ * (more if one sleeps); a core whose counter lags one that just set bit 31
+ * would take it for a wrap and add 2^32 to every later value. With a single
+ * caller the plain load/store needs no lock.
+ *
+ * Cost over hal_cycles_now(): one load-acquire, an xor and a not-taken
+ * branch. The result is 63 bits (no wrap in practice).
+ *
+ * Requirement: something calls hal_cycles_now64() at least once per half
+ * period (2^31 cycles, ~14.3 s at 150 MHz), or a whole wrap goes unseen.
+ * usb_stream_poll() does when time anchors are on.
+ */
+extern _Atomic uint32_t hal_cycles_epoch;
+
+static inline uint64_t hal_cycles_now64(void) {
+    assert(hal_time_core_num() == 0u);
+    /* Epoch first: a counter read after it can only be newer. */
+    uint32_t hi = atomic_load_explicit(&hal_cycles_epoch, memory_order_acquire);
+    const uint32_t lo = hal_cycles_now();
+    if ((int32_t)(hi ^ lo) < 0) {
+        /* Top bit flipped: 0->1 just records it, 1->0 is a wrap (+1). */
+        hi = (hi ^ 0x80000000u) + (hi >> 31);
+        atomic_store_explicit(&hal_cycles_epoch, hi, memory_order_relaxed);
+    }
+    return ((uint64_t)(hi & 0x7FFFFFFFu) << 32) | lo;
+}
+
+/** Rate of hal_cycles_now() in ticks per second (clk_sys). Valid after hal_time_init(). */
+uint32_t hal_cycles_hz(void);
+
+/** True if hal_cycles_now() on the calling core is a real cycle counter (DWT), false if derived from the us timer. */
+bool hal_cycles_is_exact(void);
+
 /** Unsigned wrap-safe diff: returns (newer - older) in cycles. */
 static inline uint32_t hal_cycles_diff(uint32_t newer, uint32_t older) {
     return (uint32_t)(newer - older);
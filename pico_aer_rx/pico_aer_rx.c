@@ -12,10 +12,14 @@
 #include "hal/hal_stdio.h"
 
 #include "aer_rx_poll.h"
+#include "aer_rx_pio.h"
 #include "usb_stream.h"
+#include "usb_ctrl.h"
 #include "aer_event_sink.h"
+#include "aer_sched.h"
 
 #include "ringbuf.h"
+#include "spsc_ring.h"
 #include "aer_codec.h"
 #include "aer_burst.h"
 
@@ -25,10 +29,103 @@
 #define AER_ACK_GPIO         14u  // ACK active-high
 #define AER_RESET_GPIO       15u  // RESET active-high (held low unless commanded)
 
+// ---------------- Host servicing ----------------
+// DTR edges and host request bytes are checked at most this often.
+#define HOST_POLL_INTERVAL_US 10000u
+// Host bytes (control commands, usb_ctrl.h) taken per check; the rest wait
+// in the CDC RX FIFO for the next one, so a command burst stays a few us.
+#define HOST_RX_BYTES_PER_POLL 64u
+// Loss/drop summary (HAL_STREAM_LOSS) period.
+#define LOSS_SUMMARY_INTERVAL_US 1000000u
+// 64-bit time reference (HAL_STREAM_TIME_ANCHOR) period; hosts unwrap the
+// 32-bit t_ticks against it. Must stay well under 2^31 ticks (~14 s).
+#define TIME_ANCHOR_INTERVAL_US  1000000u
+
+// ---------------- Main loop scheduling (aer_sched.h) ----------------
+// Per-run budgets of the loop's tasks. A handshake waits at most about the
+// other tasks' budgets plus one tud_task()/usb_stream_poll() (their own
+// cost, not budgeted), however much work is queued.
+#define SCHED_ACQ_BUDGET_US       20u   // handshakes per run (aer_rx_poll_service)
+#define SCHED_ACQ_MAX_WORDS       256u
+#define SCHED_DECODE_BUDGET_US    20u   // ring drain + decode per run
+#define SCHED_DECODE_CHUNK_WORDS  32u   // most words per step (fewer when the budget is short)
+
 // ---------------- Ring buffer sizing ----------------
 // NOTE: ringbuf stores up to (capacity - 1) elements.
 #define RAW_RB_CAPACITY      2048u
 
+// What aer_rx_poll does when the raw ring is full (per deployment):
+// DROP_NEWEST for live viewing, BACKPRESSURE for lossless capture of short
+// bursts (the sender stalls, up to RAW_RB_BACKPRESSURE_TIMEOUT_US per word),
+// DROP_OLDEST to keep the most recent history.
+#ifndef RAW_RB_OVERFLOW
+#define RAW_RB_OVERFLOW      AER_RX_OVERFLOW_DROP_NEWEST
+#endif
+#ifndef RAW_RB_BACKPRESSURE_TIMEOUT_US
+#define RAW_RB_BACKPRESSURE_TIMEOUT_US 2000u
+#endif
+
+// Stamp raw words at latch (a uint32_t per ring slot in raw_ts[]) and carry
+// the times through decode: event records then hold the bus time of the row
+// (ROWMASK) or column (V1) word instead of the USB emission time.
+#ifndef RAW_RB_LATCH_TS
+#define RAW_RB_LATCH_TS 1
+#endif
+
+// ---------------- Raw word passthrough ----------------
+// AER_STREAM_RAW_WORDS=1: stream the drained raw words (with their latch
+// times when RAW_RB_LATCH_TS) as HAL_STREAM_RAW_BIN frames instead of
+// decoding them here; the host decodes (host/aer_raw_decode.h). For
+// bit-exact captures, or when decode is what limits the drain rate. Costs
+// 6 bytes of USB per word instead of 12 per burst (ROWMASK). This is the
+// boot default; the host can switch at runtime (usb_ctrl.h, raw_words).
+#ifndef AER_STREAM_RAW_WORDS
+#define AER_STREAM_RAW_WORDS 0
+#endif
+
+// ---------------- Core split ----------------
+// AER_RX_DUAL_CORE=1: core1 runs nothing but the 4-phase handshake into a
+// lock-free SPSC ring; core0 keeps USB, decode/burst assembly and the host
+// side. The handshake no longer waits behind tud_task()/usb_stream_poll().
+// RAW_RB_CAPACITY must then be a power of two (spsc_ring holds all of it).
+// DROP_OLDEST falls back to DROP_NEWEST (the tail belongs to core0).
+#ifndef AER_RX_DUAL_CORE
+#define AER_RX_DUAL_CORE 0
+#endif
+
+// ---------------- PIO receiver ----------------
+// AER_RX_USE_PIO=1: aer_rx.pio runs the handshake on a PIO state machine and
+// DMA writes the latched words straight into the raw ring (aer_rx_pio.h);
+// the CPU only publishes DMA progress and drains. Needs RP2350 (IN_COUNT).
+// Ring-full is always backpressure (RAW_RB_OVERFLOW is not used) and
+// RAW_RB_CAPACITY must be a power of two.
+#ifndef AER_RX_USE_PIO
+#define AER_RX_USE_PIO 0
+#endif
+
+#if AER_RX_USE_PIO && AER_RX_DUAL_CORE
+#error "AER_RX_USE_PIO and AER_RX_DUAL_CORE are alternatives; enable one"
+#endif
+
+#if AER_RX_DUAL_CORE
+#include "pico/multicore.h"
+
+static spsc_ring_u32_t g_raw_spsc;
+static aer_rx_poll_t   g_rx;
+
+static void core1_main(void)
+{
+    // This core's cycle counter, on the same timebase as core0's (latch stamps).
+    hal_time_init_core();
+
+    // Nothing else runs here: wait for DATA, latch, ACK, push, repeat.
+    // NO_SPACE (BACKPRESSURE) just retries until core0 frees a slot.
+    for (;;) {
+        (void)aer_rx_poll_step(&g_rx);
+    }
+}
+#endif
+
 static inline bool cdc_dtr_asserted(void)
 {
     // "Connected" is not enough; you want terminal opened (DTR asserted).
@@ -65,6 +162,148 @@ static void wait_for_usb_dtr_with_led(void)
 #endif
 }
 
+// (Re)send HELLO when the host (re)opens the port, and run host commands
+// (HELLO requests, usb_ctrl frames). Returns the host bytes taken.
+static uint32_t service_host(bool *dtr_prev)
+{
+    const bool dtr = cdc_dtr_asserted();
+    if (dtr && !*dtr_prev) {
+        (void)usb_stream_send_hello();
+    }
+    *dtr_prev = dtr;
+
+    int c;
+    uint32_t i = 0u;
+    for (; i < HOST_RX_BYTES_PER_POLL && (c = hal_stdio_getc_nonblocking()) >= 0; ++i) {
+        (void)usb_ctrl_on_host_byte((uint8_t)c);
+    }
+    return i;
+}
+
+// Receiver-side loss counters -> HAL_STREAM_LOSS frame, followed by the raw
+// ring occupancy snapshot (HAL_STREAM_RING_STATS, only with RINGBUF_STATS and
+// a ringbuf raw ring; rb NULL skips it).
+static void send_loss_summary(uint32_t ring_dropped, const ringbuf_u32_t *rb,
+                              const aer_burst_t *burst)
+{
+    const usb_stream_loss_src_t src = {
+        .ring_dropped       = ring_dropped,
+        .burst_cols_dropped = burst->cols_dropped_total,
+        .words_invalid      = burst->words_ignored,
+    };
+    (void)usb_stream_send_loss_summary(&src);
+    (void)usb_stream_send_ring_stats((uint8_t)USB_STREAM_RING_RAW, rb);
+}
+
+// ---------------- Main loop tasks ----------------
+// What the tasks share; set up in main().
+typedef struct loop_ctx_s {
+    aer_event_sink_t *sink;
+    aer_burst_t      *burst;
+    const uint32_t   *raw_storage;
+    const uint32_t   *raw_ts;      // latch times paired with raw_storage, or NULL
+#if AER_RX_DUAL_CORE
+    spsc_ring_u32_t  *ring;
+#else
+    ringbuf_u32_t    *ring;
+#endif
+#if AER_RX_USE_PIO
+    aer_rx_pio_t     *pio_rx;
+#else
+    aer_rx_poll_t    *rx;          // on core1 with AER_RX_DUAL_CORE (counters only)
+#endif
+    bool              dtr_prev;
+    uint32_t          decode_word_cycles;  // last decode chunk's cycles per word
+} loop_ctx_t;
+
+#if !AER_RX_DUAL_CORE
+// Handshakes while words keep coming, up to the budget.
+static uint32_t task_acquire(aer_sched_task_t *t)
+{
+    loop_ctx_t *const c = (loop_ctx_t *)t->ctx;
+#if AER_RX_USE_PIO
+    // Publish what the DMA wrote and hand it the free space again.
+    return aer_rx_pio_poll(c->pio_rx);
+#else
+    // Idle bus: nothing to wait for here (keeps USB serviced). On a full ring
+    // with BACKPRESSURE the held word stays on the bus until decode makes room.
+    if (hal_gpio_read_data_raw() == 0u) return 0u;
+    return aer_rx_poll_service(c->rx, SCHED_ACQ_MAX_WORDS, t->budget_us);
+#endif
+}
+#endif
+
+// A claimed span (with its latch times) -> fused decode/burst parser -> event
+// sink, or straight to the host in raw passthrough; at most max words.
+static uint32_t drain_chunk(loop_ctx_t *c, uint32_t *const ptr[2], uint32_t len[2], uint32_t n, uint32_t max)
+{
+    if (n > max) {
+        n = max;
+        if (len[0] > n) len[0] = n;
+        len[1] = n - len[0];
+    }
+    for (uint32_t p = 0u; p < 2u && n != 0u; ++p) {
+        const uint32_t *ts = c->raw_ts ? c->raw_ts + (ptr[p] - c->raw_storage) : NULL;
+        (void)aer_event_sink_on_words(c->sink, c->burst, ptr[p], ts, len[p]);
+    }
+    return n;
+}
+
+// Drain the raw ring in place, a chunk at a time (one head read and one tail
+// publish each), until it is empty or the budget is used. Chunks are cut to
+// the words that fit in what is left, at the last chunk's cycles per word, so
+// a run only goes over budget when a single word does.
+static uint32_t task_decode(aer_sched_task_t *t)
+{
+    loop_ctx_t *const c = (loop_ctx_t *)t->ctx;
+    uint32_t done = 0u;
+    for (;;) {
+        uint32_t max = aer_sched_fit_count(t, c->decode_word_cycles, SCHED_DECODE_CHUNK_WORDS);
+        if (max == 0u) {
+            if (done != 0u) return done;
+            max = 1u;   // always make progress
+        }
+        const uint32_t t_chunk = hal_cycles_now();
+#if AER_RX_DUAL_CORE
+        spsc_ring_u32_span_t rd;
+        const uint32_t n = drain_chunk(c, rd.ptr, rd.len, spsc_ring_u32_read_claim(c->ring, &rd), max);
+        spsc_ring_u32_read_commit(c->ring, n);
+#else
+        ringbuf_u32_span_t rd;
+        const uint32_t n = drain_chunk(c, rd.ptr, rd.len, ringbuf_u32_read_claim(c->ring, &rd), max);
+        ringbuf_u32_read_commit(c->ring, n);
+#endif
+        if (n == 0u) return done;
+        done += n;
+        c->decode_word_cycles = (aer_sched_step(t, t_chunk) + n - 1u) / n;
+    }
+}
+
+static uint32_t task_usb(aer_sched_task_t *t)
+{
+    (void)t;
+    tud_task();         // keep USB alive even under load
+    usb_stream_poll();  // latency-bound flush of batched event records
+    return 0u;
+}
+
+static uint32_t task_host(aer_sched_task_t *t)
+{
+    loop_ctx_t *const c = (loop_ctx_t *)t->ctx;
+    return service_host(&c->dtr_prev);
+}
+
+static uint32_t task_loss(aer_sched_task_t *t)
+{
+    loop_ctx_t *const c = (loop_ctx_t *)t->ctx;
+#if AER_RX_USE_PIO
+    send_loss_summary(0u, c->ring, c->burst);   // backpressure only: never drops
+#else
+    send_loss_summary(aer_rx_poll_dropped(c->rx), c->rx->rb, c->burst);
+#endif
+    return 1u;
+}
+
 int main(void)
 {
     // Bring up USB stdio. We will gate acquisition on CDC DTR ourselves.
@@ -94,50 +333,138 @@ int main(void)
     };
     hal_gpio_init(&gpio_cfg);
 
-    // USB stream wrapper: ON events only, timestamps enabled (cycle ticks record).
+    // USB stream wrapper: ON events only, timestamps enabled (cycle ticks record),
+    // one row-bitmask record per burst.
     usb_stream_init(&(usb_stream_cfg_t){
         .timestamps_enabled = true,  // => USB_EVT_REC_V1_TICKS
         .data_width_bits    = (uint8_t)AER_DATA_WIDTH_BITS,
+        .rowmask_enabled    = true,  // bursts => USB_EVT_REC_V2_ROWMASK
+        .latch_timestamps   = RAW_RB_LATCH_TS != 0, // t_ticks = latch time of the row word
+        .batch_max_bytes      = 256u,  // several records per frame...
+        .batch_max_latency_us = 1000u, // ...but never held longer than 1 ms
+        .time_anchor_interval_us = TIME_ANCHOR_INTERVAL_US, // host unwraps t_ticks to 64 bits
+        .raw_passthrough    = AER_STREAM_RAW_WORDS != 0, // RAW_BIN words instead of events
     });
 
+    // Tell the host what it is about to receive (port was just opened).
+    (void)usb_stream_send_hello();
+
     // Event sink (common parser callback -> usb_stream)
     aer_event_sink_t sink;
     aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
 
     // Ring buffer owned by main
+#if AER_RX_USE_PIO
+    // DMA write ring: storage aligned to its own size.
+    static uint32_t raw_storage[RAW_RB_CAPACITY]
+        __attribute__((aligned(RAW_RB_CAPACITY * sizeof(uint32_t))));
+#else
     static uint32_t raw_storage[RAW_RB_CAPACITY];
-    ringbuf_u32_t raw_rb;
-    (void)ringbuf_u32_init(&raw_rb, raw_storage, RAW_RB_CAPACITY);
-    ringbuf_u32_reset(&raw_rb);
+#endif
+#if RAW_RB_LATCH_TS
+    static uint32_t raw_ts[RAW_RB_CAPACITY];   // latch time of raw_storage[i]
+    uint32_t *const raw_ts_ptr = raw_ts;
+#else
+    uint32_t *const raw_ts_ptr = NULL;
+#endif
 
     // Polling RX:
     // - wait_valid_timeout_us = 0 => idle is not an error (wait forever)
     // - wait_neutral_timeout_us = 0 => disabled (debug-only)
-    aer_rx_poll_t rx;
-    aer_rx_poll_init(&rx, &raw_rb, 0u, 0u);
+#if AER_RX_DUAL_CORE
+    if (!spsc_ring_u32_init(&g_raw_spsc, raw_storage, RAW_RB_CAPACITY)) {
+        while (1) { tight_loop_contents(); }
+    }
+    aer_rx_poll_t *const rx = &g_rx;
+    aer_rx_poll_init_spsc(rx, &g_raw_spsc, 0u, 0u);
+    aer_rx_poll_set_overflow(rx, RAW_RB_OVERFLOW, RAW_RB_BACKPRESSURE_TIMEOUT_US);
+    aer_rx_poll_set_timestamps(rx, raw_ts_ptr);
+#else
+    ringbuf_u32_t raw_rb;
+    (void)ringbuf_u32_init(&raw_rb, raw_storage, RAW_RB_CAPACITY);
+    ringbuf_u32_reset(&raw_rb);
+
+#if AER_RX_USE_PIO
+    // PIO takes over ACK from here on (hal_gpio_init() set up the pins).
+    aer_rx_pio_t pio_rx;
+    if (!aer_rx_pio_init(&pio_rx, &raw_rb)) {
+        while (1) { tight_loop_contents(); }
+    }
+    aer_rx_pio_set_timestamps(&pio_rx, raw_ts_ptr);
+#else
+    aer_rx_poll_t rx_local;
+    aer_rx_poll_t *const rx = &rx_local;
+    aer_rx_poll_init(rx, &raw_rb, 0u, 0u);
+    aer_rx_poll_set_overflow(rx, RAW_RB_OVERFLOW, RAW_RB_BACKPRESSURE_TIMEOUT_US);
+    aer_rx_poll_set_timestamps(rx, raw_ts_ptr);
+#endif
+#endif
 
     // Burst assembler (portable)
     aer_burst_t burst;
     aer_burst_init(&burst);
 
-    while (true) {
-        tud_task(); // keep USB alive even under load
+    // Main loop scheduler, set up below; GET_STATS reports its task accounting.
+    static aer_sched_t sched;
 
-        // Avoid blocking forever inside aer_rx_poll_step() during idle
-        // (so we can keep servicing USB). Only handshake when DATA is nonzero.
-        if (hal_gpio_read_data_raw() == 0u) {
-            tight_loop_contents();
-            continue;
-        }
+    // Host control channel. The receiver's parameters are only this core's to
+    // change when it runs the handshake here; its counters are readable anyway.
+    usb_ctrl_init(&(usb_ctrl_cfg_t){
+#if AER_RX_DUAL_CORE
+        .rx_stats = aer_rx_poll_stats(rx),
+#elif AER_RX_USE_PIO
+        .rx_stats = aer_rx_pio_stats(&pio_rx),
+#else
+        .rx       = rx,
+        .rx_stats = aer_rx_poll_stats(rx),
+#endif
+        .sink     = &sink,
+        .burst    = &burst,
+        .sched    = &sched,
+    });
 
-        // Complete exactly one handshake (rx MUST be drop-and-continue, not backpressure)
-        (void)aer_rx_poll_step(&rx);
+    // Main loop: acquisition, decode, USB, then the periodic host and loss
+    // work, each within its budget (aer_sched.h). Per-task cycle accounting
+    // is in sched.tasks[i].stats; the host reads it with GET_STATS.
+    static loop_ctx_t ctx;
+    ctx = (loop_ctx_t){
+        .sink        = &sink,
+        .burst       = &burst,
+        .raw_storage = raw_storage,
+        .raw_ts      = raw_ts_ptr,
+#if AER_RX_DUAL_CORE
+        .ring        = &g_raw_spsc,
+#else
+        .ring        = &raw_rb,
+#endif
+#if AER_RX_USE_PIO
+        .pio_rx      = &pio_rx,
+#else
+        .rx          = rx,
+#endif
+        .dtr_prev    = true,
+    };
+    static aer_sched_task_t tasks[] = {
+#if !AER_RX_DUAL_CORE
+        { .name = "acquire", .fn = task_acquire, .budget_us = SCHED_ACQ_BUDGET_US },
+#endif
+        { .name = "decode",  .fn = task_decode,  .budget_us = SCHED_DECODE_BUDGET_US },
+        { .name = "usb",     .fn = task_usb },
+        { .name = "host",    .fn = task_host,    .period_us = HOST_POLL_INTERVAL_US },
+        { .name = "loss",    .fn = task_loss,    .period_us = LOSS_SUMMARY_INTERVAL_US },
+    };
+    for (uint32_t i = 0u; i < sizeof(tasks) / sizeof(tasks[0]); ++i) {
+        tasks[i].ctx = &ctx;
+    }
+    aer_sched_init(&sched, tasks, sizeof(tasks) / sizeof(tasks[0]));
 
-        // Drain raw words -> decode -> burst parser -> event sink
-        uint32_t raw_u32 = 0;
-        while (ringbuf_u32_pop(&raw_rb, &raw_u32)) {
-            const aer_codec_result_t dec = aer_decode_word((aer_raw_word_t)raw_u32);
-            (void)aer_burst_feed(&burst, dec, aer_event_sink_on_event, &sink);
-        }
+#if AER_RX_DUAL_CORE
+    // rx is fully set up; from here on only core1 touches the bus and the
+    // ring's producer side.
+    multicore_launch_core1(core1_main);
+#endif
+
+    while (true) {
+        (void)aer_sched_run_once(&sched);
     }
 }
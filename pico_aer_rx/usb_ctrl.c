@@ -0,0 +1,434 @@
+// usb_ctrl.c
+#include "usb_ctrl.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "hal/hal_stdio.h"
+#include "hal/hal_time.h"
+
+#include "usb_stream.h"
+
+/* ---------------- Internal state (main-loop context only) ---------------- */
+
+static const uint8_t k_magic[4] = { 'A', 'E', 'R', 'C' };
+
+static usb_ctrl_cfg_t      g_cfg;
+static usb_ctrl_counters_t g_counters;
+
+/* Frame being received. */
+static struct {
+    uint8_t  buf[USB_CTRL_HDR_LEN + USB_CTRL_MAX_PAYLOAD];
+    uint16_t pos;
+    uint32_t last_cycles;     // hal_cycles_now() at the previous byte
+} g_rx;
+
+static uint32_t g_rx_timeout_cycles = 0u;
+
+/* GET_STATS baseline (RESET_STATS). */
+static uint32_t g_base[USB_CTRL_STATS_COUNTERS];
+static uint64_t g_base_t_us = 0u;
+
+/* Wire layouts, see usb_ctrl.h. */
+typedef struct __attribute__((packed)) usb_ctrl_rsp_hdr_s {
+    uint8_t  ctrl_ver;
+    uint8_t  cmd;
+    uint16_t tag;
+    uint8_t  status;
+    uint8_t  rsvd[3];
+} usb_ctrl_rsp_hdr_t;
+
+typedef struct __attribute__((packed)) usb_ctrl_kv_s {
+    uint8_t  key;
+    uint32_t value;
+} usb_ctrl_kv_t;
+
+typedef struct __attribute__((packed)) usb_ctrl_task_stats_s {
+    char     name[USB_CTRL_TASK_NAME_LEN];
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t cycles_max;
+    uint32_t interval_max;
+} usb_ctrl_task_stats_t;
+
+typedef struct __attribute__((packed)) usb_ctrl_stats_s {
+    uint8_t  stats_ver;
+    uint8_t  n_counters;
+    uint8_t  n_tasks;
+    uint8_t  rsvd;
+    uint64_t t_us;
+    uint64_t t_us_reset;
+    uint32_t cycles_hz;
+    uint32_t counters[USB_CTRL_STATS_COUNTERS];
+    usb_ctrl_task_stats_t tasks[USB_CTRL_STATS_TASKS_MAX];
+} usb_ctrl_stats_t;
+
+_Static_assert(sizeof(usb_ctrl_rsp_hdr_t) == USB_CTRL_RSP_HDR_LEN, "CTRL_RSP layout is part of the host protocol");
+_Static_assert(sizeof(usb_ctrl_kv_t) == USB_CTRL_KV_LEN, "kv layout is part of the host protocol");
+_Static_assert(USB_CTRL_P_COUNT <= 32u, "PING reports parameters in a u32 mask");
+_Static_assert(USB_CTRL_P_COUNT * USB_CTRL_KV_LEN <= USB_CTRL_MAX_PAYLOAD, "SET_PARAMS must take every parameter at once");
+_Static_assert(sizeof(usb_ctrl_task_stats_t) == USB_CTRL_TASK_NAME_LEN + 16u, "task stats layout is part of the host protocol");
+_Static_assert(offsetof(usb_ctrl_stats_t, counters) == 24u, "stats layout is part of the host protocol");
+
+/* The largest body: every parameter, or the stats. */
+#define USB_CTRL_BODY_MAX \
+    ((USB_CTRL_P_COUNT * USB_CTRL_KV_LEN > sizeof(usb_ctrl_stats_t)) \
+         ? USB_CTRL_P_COUNT * USB_CTRL_KV_LEN : sizeof(usb_ctrl_stats_t))
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* ---------------- Parameters ---------------- */
+
+static bool param_available(uint8_t key)
+{
+    switch (key) {
+    case USB_CTRL_P_TIMESTAMPS:
+    case USB_CTRL_P_ROWMASK:
+    case USB_CTRL_P_RAW_WORDS:
+    case USB_CTRL_P_BATCH_MAX_BYTES:
+    case USB_CTRL_P_BATCH_LATENCY_US:
+        return true;
+    case USB_CTRL_P_SINK_ENABLED:
+        return g_cfg.sink != NULL;
+    case USB_CTRL_P_RX_OVERFLOW:
+    case USB_CTRL_P_RX_BP_TIMEOUT_US:
+    case USB_CTRL_P_RX_VALID_TIMEOUT_US:
+    case USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US:
+        return g_cfg.rx != NULL;
+    default:
+        return false;
+    }
+}
+
+/* Current value of an available parameter. */
+static uint32_t param_get(uint8_t key)
+{
+    const usb_stream_cfg_t *sc = usb_stream_config();
+    switch (key) {
+    case USB_CTRL_P_TIMESTAMPS:           return sc->timestamps_enabled;
+    case USB_CTRL_P_ROWMASK:              return sc->rowmask_enabled;
+    case USB_CTRL_P_RAW_WORDS:            return sc->raw_passthrough;
+    case USB_CTRL_P_BATCH_MAX_BYTES:      return sc->batch_max_bytes;
+    case USB_CTRL_P_BATCH_LATENCY_US:     return sc->batch_max_latency_us;
+    case USB_CTRL_P_SINK_ENABLED:         return g_cfg.sink->cfg.enabled;
+    case USB_CTRL_P_RX_OVERFLOW:          return (uint32_t)g_cfg.rx->overflow;
+    case USB_CTRL_P_RX_BP_TIMEOUT_US:     return g_cfg.rx->backpressure_timeout_us;
+    case USB_CTRL_P_RX_VALID_TIMEOUT_US:  return g_cfg.rx->wait_valid_timeout_us;
+    case USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US: return g_cfg.rx->wait_neutral_timeout_us;
+    default:                              return 0u;
+    }
+}
+
+static usb_ctrl_status_t param_lookup(uint8_t key)
+{
+    if (key >= (uint8_t)USB_CTRL_P_COUNT) return USB_CTRL_ST_UNKNOWN_PARAM;
+    return param_available(key) ? USB_CTRL_ST_OK : USB_CTRL_ST_UNAVAILABLE;
+}
+
+static usb_ctrl_status_t param_check(uint8_t key, uint32_t value)
+{
+    const usb_ctrl_status_t st = param_lookup(key);
+    if (st != USB_CTRL_ST_OK) return st;
+    switch (key) {
+    case USB_CTRL_P_TIMESTAMPS:
+    case USB_CTRL_P_ROWMASK:
+    case USB_CTRL_P_RAW_WORDS:
+    case USB_CTRL_P_SINK_ENABLED:
+        return (value <= 1u) ? USB_CTRL_ST_OK : USB_CTRL_ST_BAD_VALUE;
+    case USB_CTRL_P_BATCH_MAX_BYTES:
+        return (value <= USB_STREAM_BATCH_BUF_BYTES) ? USB_CTRL_ST_OK : USB_CTRL_ST_BAD_VALUE;
+    case USB_CTRL_P_BATCH_LATENCY_US:
+        return (value <= USB_CTRL_MAX_INTERVAL_US) ? USB_CTRL_ST_OK : USB_CTRL_ST_BAD_VALUE;
+    case USB_CTRL_P_RX_OVERFLOW:
+        return (value <= (uint32_t)AER_RX_OVERFLOW_DROP_OLDEST) ? USB_CTRL_ST_OK : USB_CTRL_ST_BAD_VALUE;
+    default:
+        return USB_CTRL_ST_OK;
+    }
+}
+
+/* Apply a checked value. Returns true if HELLO describes the parameter. */
+static bool param_set(uint8_t key, uint32_t value)
+{
+    const usb_stream_cfg_t *sc = usb_stream_config();
+    aer_rx_poll_t *rx = g_cfg.rx;
+    switch (key) {
+    case USB_CTRL_P_TIMESTAMPS:
+        usb_stream_set_timestamps_enabled(value != 0u);
+        return true;
+    case USB_CTRL_P_ROWMASK:
+        usb_stream_set_rowmask_enabled(value != 0u);
+        return true;
+    case USB_CTRL_P_RAW_WORDS:
+        usb_stream_set_raw_passthrough(value != 0u);
+        return true;
+    case USB_CTRL_P_BATCH_MAX_BYTES:
+        usb_stream_set_batching((uint16_t)value, sc->batch_max_latency_us);
+        return true;
+    case USB_CTRL_P_BATCH_LATENCY_US:
+        usb_stream_set_batching(sc->batch_max_bytes, value);
+        return true;
+    case USB_CTRL_P_SINK_ENABLED:
+        aer_event_sink_set_enabled(g_cfg.sink, value != 0u);
+        return false;
+    case USB_CTRL_P_RX_OVERFLOW:
+        aer_rx_poll_set_overflow(rx, (aer_rx_overflow_t)value, rx->backpressure_timeout_us);
+        return false;
+    case USB_CTRL_P_RX_BP_TIMEOUT_US:
+        aer_rx_poll_set_overflow(rx, rx->overflow, value);
+        return false;
+    case USB_CTRL_P_RX_VALID_TIMEOUT_US:
+        aer_rx_poll_set_timeouts(rx, value, rx->wait_neutral_timeout_us);
+        return false;
+    case USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US:
+        aer_rx_poll_set_timeouts(rx, rx->wait_valid_timeout_us, value);
+        return false;
+    default:
+        return false;
+    }
+}
+
+static uint16_t put_kv(uint8_t *out, uint8_t key, uint32_t value)
+{
+    const usb_ctrl_kv_t kv = { .key = key, .value = value };
+    memcpy(out, &kv, sizeof(kv));
+    return (uint16_t)sizeof(kv);
+}
+
+/* ---------------- Stats ---------------- */
+
+static void stats_snapshot(uint32_t c[USB_CTRL_STATS_COUNTERS])
+{
+    memset(c, 0, USB_CTRL_STATS_COUNTERS * sizeof(uint32_t));
+    const aer_rx_poll_stats_t *rs = g_cfg.rx_stats;
+    if (rs) {
+        c[USB_CTRL_STAT_RX_WORDS_OK]         = rs->words_ok;
+        c[USB_CTRL_STAT_RX_DROPPED_FULL]     = rs->dropped_full;
+        c[USB_CTRL_STAT_RX_DROPPED_OLDEST]   = rs->dropped_oldest;
+        c[USB_CTRL_STAT_RX_BP_STALLS]        = rs->bp_stalls;
+        c[USB_CTRL_STAT_RX_BP_TIMEOUTS]      = rs->bp_timeouts;
+        c[USB_CTRL_STAT_RX_TIMEOUTS_VALID]   = rs->timeouts_valid;
+        c[USB_CTRL_STAT_RX_TIMEOUTS_NEUTRAL] = rs->timeouts_neutral;
+    }
+    if (g_cfg.burst) {
+        c[USB_CTRL_STAT_BURSTS]        = g_cfg.burst->bursts_completed;
+        c[USB_CTRL_STAT_WORDS_INVALID] = g_cfg.burst->words_ignored;
+        c[USB_CTRL_STAT_COLS_DROPPED]  = g_cfg.burst->cols_dropped_total;
+    }
+    if (g_cfg.sink) {
+        const aer_event_sink_stats_t *ss = aer_event_sink_stats(g_cfg.sink);
+        c[USB_CTRL_STAT_EVENTS_EMITTED]     = ss->events_emitted;
+        c[USB_CTRL_STAT_EVENTS_SEND_FAILED] = ss->usb_send_failed;
+        c[USB_CTRL_STAT_MODE_SWITCHES]      = ss->mode_switches;
+    }
+    const usb_stream_stats_t *us = usb_stream_stats();
+    c[USB_CTRL_STAT_EVENTS_SENT]       = us->events_sent;
+    c[USB_CTRL_STAT_RAW_WORDS_SENT]    = us->raw_words_sent;
+    c[USB_CTRL_STAT_RAW_WORDS_DROPPED] = us->raw_words_dropped_not_connected + us->raw_words_dropped_write_failed;
+    const hal_stream_stats_t *hs = hal_stream_stats();
+    c[USB_CTRL_STAT_FRAMES_WRITTEN] = hs->frames_written;
+    c[USB_CTRL_STAT_FRAMES_FAILED]  = hs->frames_failed;
+    c[USB_CTRL_STAT_BYTES_SENT]     = hs->bytes_sent;
+}
+
+/* Main loop task accounting -> s->tasks; returns how many. */
+static uint8_t stats_tasks(usb_ctrl_task_stats_t *out)
+{
+    const aer_sched_t *sc = g_cfg.sched;
+    if (!sc) return 0u;
+    uint8_t n = 0u;
+    for (; n < sc->n_tasks && n < USB_CTRL_STATS_TASKS_MAX; ++n) {
+        const aer_sched_task_t *t = &sc->tasks[n];
+        usb_ctrl_task_stats_t *o = &out[n];
+        memset(o->name, 0, sizeof(o->name));
+        if (t->name) strncpy(o->name, t->name, sizeof(o->name));
+        o->runs         = t->stats.runs;
+        o->overruns     = t->stats.overruns;
+        o->cycles_max   = t->stats.cycles_max;
+        o->interval_max = t->stats.interval_max;
+    }
+    return n;
+}
+
+/* ---------------- Commands ---------------- */
+
+static void respond(uint8_t cmd, uint16_t tag, usb_ctrl_status_t status, const void *body, uint16_t len)
+{
+    if (status == USB_CTRL_ST_OK) g_counters.cmds_ok++;
+    else                          g_counters.cmds_failed++;
+
+    /* Records queued under the old settings go out first. */
+    (void)usb_stream_flush();
+
+    const usb_ctrl_rsp_hdr_t h = {
+        .ctrl_ver = (uint8_t)USB_CTRL_VER,
+        .cmd      = cmd,
+        .tag      = tag,
+        .status   = (uint8_t)status,
+    };
+    const hal_iovec_t iov[2] = { { &h, (uint16_t)sizeof(h) }, { body, len } };
+    if (!hal_stream_writev(HAL_STREAM_CTRL_RSP, iov, (len != 0u) ? 2u : 1u)) {
+        g_counters.rsp_failed++;
+    }
+}
+
+static void run_command(uint8_t cmd, uint16_t tag, const uint8_t *p, uint16_t len)
+{
+    uint8_t body[USB_CTRL_BODY_MAX];
+    uint16_t n = 0u;
+
+    switch (cmd) {
+    case USB_CTRL_CMD_PING: {
+        if (len != 0u) break;
+        uint32_t mask = 0u;
+        for (uint8_t k = 0u; k < (uint8_t)USB_CTRL_P_COUNT; ++k) {
+            if (param_available(k)) mask |= 1u << k;
+        }
+        memcpy(body, &mask, sizeof(mask));
+        respond(cmd, tag, USB_CTRL_ST_OK, body, (uint16_t)sizeof(mask));
+        return;
+    }
+
+    case USB_CTRL_CMD_GET_PARAMS:
+        if (len == 0u) {
+            for (uint8_t k = 0u; k < (uint8_t)USB_CTRL_P_COUNT; ++k) {
+                if (param_available(k)) n = (uint16_t)(n + put_kv(&body[n], k, param_get(k)));
+            }
+            respond(cmd, tag, USB_CTRL_ST_OK, body, n);
+            return;
+        }
+        if (len > USB_CTRL_P_COUNT) break;
+        for (uint16_t i = 0u; i < len; ++i) {
+            const usb_ctrl_status_t st = param_lookup(p[i]);
+            if (st != USB_CTRL_ST_OK) {
+                n = put_kv(body, p[i], 0u);
+                respond(cmd, tag, st, body, n);
+                return;
+            }
+            n = (uint16_t)(n + put_kv(&body[n], p[i], param_get(p[i])));
+        }
+        respond(cmd, tag, USB_CTRL_ST_OK, body, n);
+        return;
+
+    case USB_CTRL_CMD_SET_PARAMS: {
+        if (len == 0u || len % USB_CTRL_KV_LEN != 0u || len / USB_CTRL_KV_LEN > USB_CTRL_P_COUNT) break;
+        for (uint16_t i = 0u; i < len; i = (uint16_t)(i + USB_CTRL_KV_LEN)) {
+            const usb_ctrl_status_t st = param_check(p[i], rd32(&p[i + 1u]));
+            if (st != USB_CTRL_ST_OK) {
+                respond(cmd, tag, st, &p[i], (uint16_t)USB_CTRL_KV_LEN);
+                return;
+            }
+        }
+        bool hello = false;
+        for (uint16_t i = 0u; i < len; i = (uint16_t)(i + USB_CTRL_KV_LEN)) {
+            hello = param_set(p[i], rd32(&p[i + 1u])) || hello;
+        }
+        for (uint16_t i = 0u; i < len; i = (uint16_t)(i + USB_CTRL_KV_LEN)) {
+            n = (uint16_t)(n + put_kv(&body[n], p[i], param_get(p[i])));
+        }
+        if (hello) (void)usb_stream_send_hello();
+        respond(cmd, tag, USB_CTRL_ST_OK, body, n);
+        return;
+    }
+
+    case USB_CTRL_CMD_GET_STATS: {
+        if (len != 0u) break;
+        usb_ctrl_stats_t s;
+        memset(&s, 0, sizeof(s));
+        s.stats_ver  = (uint8_t)USB_CTRL_STATS_VER;
+        s.n_counters = (uint8_t)USB_CTRL_STATS_COUNTERS;
+        s.t_us       = hal_time_us_now();
+        s.t_us_reset = g_base_t_us;
+        s.cycles_hz  = hal_cycles_hz();
+        uint32_t c[USB_CTRL_STATS_COUNTERS];
+        stats_snapshot(c);
+        for (uint32_t i = 0u; i < USB_CTRL_STATS_COUNTERS; ++i) {
+            c[i] -= g_base[i];
+        }
+        memcpy(s.counters, c, sizeof(c));
+        s.n_tasks = stats_tasks(s.tasks);
+        const size_t len = offsetof(usb_ctrl_stats_t, tasks) + s.n_tasks * sizeof(usb_ctrl_task_stats_t);
+        respond(cmd, tag, USB_CTRL_ST_OK, &s, (uint16_t)len);
+        return;
+    }
+
+    case USB_CTRL_CMD_RESET_STATS:
+        if (len != 0u) break;
+        stats_snapshot(g_base);
+        g_base_t_us = hal_time_us_now();
+        if (g_cfg.sched) aer_sched_reset_stats(g_cfg.sched);
+        respond(cmd, tag, USB_CTRL_ST_OK, NULL, 0u);
+        return;
+
+    default:
+        respond(cmd, tag, USB_CTRL_ST_UNKNOWN_CMD, NULL, 0u);
+        return;
+    }
+    respond(cmd, tag, USB_CTRL_ST_BAD_FRAME, NULL, 0u);
+}
+
+/* ---------------- Public API ---------------- */
+
+void usb_ctrl_init(const usb_ctrl_cfg_t *cfg)
+{
+    g_cfg = cfg ? *cfg : (usb_ctrl_cfg_t){0};
+    g_counters = (usb_ctrl_counters_t){0};
+    g_rx.pos = 0u;
+    g_rx_timeout_cycles = hal_us_to_cycles(USB_CTRL_RX_TIMEOUT_US);
+    memset(g_base, 0, sizeof(g_base));
+    g_base_t_us = 0u;
+}
+
+bool usb_ctrl_on_host_byte(uint8_t byte)
+{
+    const uint32_t now = hal_cycles_now();
+    if (g_rx.pos != 0u && hal_cycles_diff(now, g_rx.last_cycles) >= g_rx_timeout_cycles) {
+        g_counters.frames_timed_out++;
+        g_rx.pos = 0u;
+    }
+    g_rx.last_cycles = now;
+
+    /* Magic: anything else outside a frame is a HELLO request or noise. */
+    if (g_rx.pos < sizeof(k_magic)) {
+        if (byte == k_magic[g_rx.pos]) {
+            g_rx.buf[g_rx.pos++] = byte;
+            return true;
+        }
+        g_counters.bytes_ignored += g_rx.pos;
+        g_rx.pos = 0u;
+        if (byte == k_magic[0]) {
+            g_rx.buf[g_rx.pos++] = byte;
+            return true;
+        }
+        if (usb_stream_on_host_byte(byte)) return true;
+        g_counters.bytes_ignored++;
+        return false;
+    }
+
+    g_rx.buf[g_rx.pos++] = byte;
+    if (g_rx.pos < USB_CTRL_HDR_LEN) return true;
+
+    const uint8_t cmd = g_rx.buf[5];
+    const uint16_t len = rd16(&g_rx.buf[6]);
+    const uint16_t tag = rd16(&g_rx.buf[8]);
+    if (g_rx.buf[4] != (uint8_t)USB_CTRL_VER || len > USB_CTRL_MAX_PAYLOAD) {
+        /* Payload left unread; whatever follows resyncs on the magic. */
+        g_rx.pos = 0u;
+        respond(cmd, tag, USB_CTRL_ST_BAD_FRAME, NULL, 0u);
+        return true;
+    }
+    if (g_rx.pos == USB_CTRL_HDR_LEN + len) {
+        g_rx.pos = 0u;
+        run_command(cmd, tag, &g_rx.buf[USB_CTRL_HDR_LEN], len);
+    }
+    return true;
+}
+
+const usb_ctrl_counters_t *usb_ctrl_counters(void)
+{
+    return &g_counters;
+}
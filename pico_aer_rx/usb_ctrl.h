@@ -0,0 +1,165 @@
+// usb_ctrl.h
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "aer_burst.h"       // aer_burst_t (counters)
+#include "aer_rx_poll.h"     // aer_rx_poll_t, aer_rx_poll_stats_t
+#include "aer_event_sink.h"  // aer_event_sink_t
+#include "aer_sched.h"       // aer_sched_t (main loop task accounting)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runtime control channel: framed commands from the host on CDC RX.
+ *
+ * Lets the host retune a running receiver (record format, raw passthrough,
+ * batching, sink, receiver timeouts and overflow policy), read counters and
+ * reset them, without reflashing. Bytes are parsed one at a time from the
+ * main loop (usb_ctrl_on_host_byte()); a command runs when its last byte
+ * arrives and costs a few field writes plus one response frame, so the
+ * receive path is never held up by a slow or half-sent command.
+ *
+ * Command frame (host -> device), the AERS v2 header with its own magic:
+ *   "AERC" u8 ver (USB_CTRL_VER) u8 cmd (USB_CTRL_CMD_*) u16 len u16 tag
+ *   u8 payload[len]                        (len <= USB_CTRL_MAX_PAYLOAD)
+ * tag is the host's choice and comes back in the response. Outside a frame
+ * the USB_STREAM_HELLO_REQUEST byte still asks for HELLO; other stray bytes
+ * are ignored. A frame left incomplete for USB_CTRL_RX_TIMEOUT_US is dropped.
+ *
+ * Response (device -> host), one HAL_STREAM_CTRL_RSP frame per command:
+ *   u8 ctrl_ver u8 cmd u16 tag u8 status (USB_CTRL_ST_*) u8 rsvd[3], body
+ * A change to anything HELLO describes is announced by a HELLO sent just
+ * before the response. Frames are self-describing, so records of the old
+ * and the new format may both follow it for a moment (raw passthrough
+ * switches at the next burst boundary, see aer_event_sink_on_words()).
+ *
+ * Commands (little-endian, packed; kv = { u8 key (USB_CTRL_P_*), u32 value }):
+ *   PING         -> u32 param_mask: bit k set => parameter k is available here
+ *   GET_PARAMS   u8 key[] (none = all available) -> kv[]
+ *   SET_PARAMS   kv[] -> kv[] as applied. All or nothing: on error nothing
+ *                changes and the body is the offending kv
+ *   GET_STATS    -> stats body below
+ *   RESET_STATS  -> empty; GET_STATS counts from here
+ *
+ * GET_STATS body, version USB_CTRL_STATS_VER. Counters are deltas since the
+ * last RESET_STATS (or boot): a reset only moves this baseline, the counters
+ * themselves (and so the loss summaries) keep running. The main loop's task
+ * accounting (aer_sched.h) holds maxima, which cannot be differenced, so a
+ * reset clears it instead.
+ *   u8  stats_ver, u8 n_counters, u8 n_tasks, u8 rsvd
+ *   u64 t_us                 hal_time_us_now()
+ *   u64 t_us_reset           when RESET_STATS last ran (0 = boot)
+ *   u32 cycles_hz            unit of the task cycle fields (hal_cycles_hz())
+ *   u32 counters[n_counters], in usb_ctrl_stat_t order
+ *   task[n_tasks], in main loop order:
+ *     char name[USB_CTRL_TASK_NAME_LEN] (NUL padded)
+ *     u32 runs, u32 overruns, u32 cycles_max, u32 interval_max
+ * Version 1 had rsvd[3] after stats_ver, no cycles_hz and no tasks.
+ */
+#define USB_CTRL_VER            1u
+#define USB_CTRL_HDR_LEN        10u
+#define USB_CTRL_MAX_PAYLOAD    64u
+#define USB_CTRL_RSP_HDR_LEN    8u
+#define USB_CTRL_KV_LEN         5u
+#define USB_CTRL_RX_TIMEOUT_US  100000u
+#define USB_CTRL_STATS_VER      2u
+#define USB_CTRL_STATS_TASKS_MAX 8u
+#define USB_CTRL_TASK_NAME_LEN  8u
+
+typedef enum usb_ctrl_cmd_e {
+    USB_CTRL_CMD_PING        = 0,
+    USB_CTRL_CMD_GET_PARAMS  = 1,
+    USB_CTRL_CMD_SET_PARAMS  = 2,
+    USB_CTRL_CMD_GET_STATS   = 3,
+    USB_CTRL_CMD_RESET_STATS = 4,
+} usb_ctrl_cmd_t;
+
+typedef enum usb_ctrl_status_e {
+    USB_CTRL_ST_OK            = 0,
+    USB_CTRL_ST_BAD_FRAME     = 1,  // unknown version, or a length the command does not take
+    USB_CTRL_ST_UNKNOWN_CMD   = 2,
+    USB_CTRL_ST_UNKNOWN_PARAM = 3,
+    USB_CTRL_ST_BAD_VALUE     = 4,  // out of the range listed below
+    USB_CTRL_ST_UNAVAILABLE   = 5,  // not settable in this build (e.g. the receiver runs on core1)
+} usb_ctrl_status_t;
+
+/* Parameters and their values. */
+typedef enum usb_ctrl_param_e {
+    USB_CTRL_P_TIMESTAMPS         = 0,  // 0/1  usb_stream_set_timestamps_enabled()
+    USB_CTRL_P_ROWMASK            = 1,  // 0/1  usb_stream_set_rowmask_enabled()
+    USB_CTRL_P_RAW_WORDS          = 2,  // 0/1  usb_stream_set_raw_passthrough()
+    USB_CTRL_P_BATCH_MAX_BYTES    = 3,  // 0..USB_STREAM_BATCH_BUF_BYTES
+    USB_CTRL_P_BATCH_LATENCY_US   = 4,  // 0..USB_CTRL_MAX_INTERVAL_US
+    USB_CTRL_P_SINK_ENABLED       = 5,  // 0/1  aer_event_sink_set_enabled()
+    USB_CTRL_P_RX_OVERFLOW        = 6,  // aer_rx_overflow_t
+    USB_CTRL_P_RX_BP_TIMEOUT_US   = 7,  // aer_rx_poll_set_overflow()
+    USB_CTRL_P_RX_VALID_TIMEOUT_US   = 8,  // aer_rx_poll_set_timeouts()
+    USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US = 9,
+    USB_CTRL_P_COUNT
+} usb_ctrl_param_t;
+
+// Longest batching latency accepted (hal_us_to_cycles() stays in 32 bits).
+#define USB_CTRL_MAX_INTERVAL_US 1000000u
+
+/* GET_STATS counters. */
+typedef enum usb_ctrl_stat_e {
+    USB_CTRL_STAT_RX_WORDS_OK = 0,        // aer_rx_poll_stats_t
+    USB_CTRL_STAT_RX_DROPPED_FULL,
+    USB_CTRL_STAT_RX_DROPPED_OLDEST,
+    USB_CTRL_STAT_RX_BP_STALLS,
+    USB_CTRL_STAT_RX_BP_TIMEOUTS,
+    USB_CTRL_STAT_RX_TIMEOUTS_VALID,
+    USB_CTRL_STAT_RX_TIMEOUTS_NEUTRAL,
+    USB_CTRL_STAT_BURSTS,                 // aer_burst_t
+    USB_CTRL_STAT_WORDS_INVALID,
+    USB_CTRL_STAT_COLS_DROPPED,
+    USB_CTRL_STAT_EVENTS_EMITTED,         // aer_event_sink_stats_t
+    USB_CTRL_STAT_EVENTS_SEND_FAILED,
+    USB_CTRL_STAT_MODE_SWITCHES,
+    USB_CTRL_STAT_EVENTS_SENT,            // usb_stream_stats_t
+    USB_CTRL_STAT_RAW_WORDS_SENT,
+    USB_CTRL_STAT_RAW_WORDS_DROPPED,      // not connected + write failed
+    USB_CTRL_STAT_FRAMES_WRITTEN,         // hal_stream_stats()
+    USB_CTRL_STAT_FRAMES_FAILED,
+    USB_CTRL_STAT_BYTES_SENT,
+    USB_CTRL_STATS_COUNTERS
+} usb_ctrl_stat_t;
+
+/* What the commands act on; NULL members make their parameters unavailable. */
+typedef struct usb_ctrl_cfg_s {
+    aer_rx_poll_t             *rx;        // RX_* parameters; NULL when the receiver is not
+                                          // this core's to change (core1, PIO)
+    const aer_rx_poll_stats_t *rx_stats;  // receiver counters (may be updated by another core)
+    aer_event_sink_t          *sink;
+    const aer_burst_t         *burst;     // burst assembler counters
+    aer_sched_t               *sched;     // main loop tasks (first USB_CTRL_STATS_TASKS_MAX); may be NULL
+} usb_ctrl_cfg_t;
+
+typedef struct usb_ctrl_counters_s {
+    uint32_t cmds_ok;
+    uint32_t cmds_failed;        // answered with a status other than OK
+    uint32_t rsp_failed;         // response frame refused by the link
+    uint32_t frames_timed_out;   // incomplete frames dropped after USB_CTRL_RX_TIMEOUT_US
+    uint32_t bytes_ignored;      // stray bytes outside frames
+} usb_ctrl_counters_t;
+
+/** Bind the control channel. Call after usb_stream_init() and once cfg's objects exist. */
+void usb_ctrl_init(const usb_ctrl_cfg_t *cfg);
+
+/**
+ * Feed one byte received from the host (replaces usb_stream_on_host_byte() in
+ * the main loop, which it still calls for HELLO requests). Runs the command
+ * once its frame is complete. Returns true if the byte was consumed.
+ */
+bool usb_ctrl_on_host_byte(uint8_t byte);
+
+/** Channel counters. */
+const usb_ctrl_counters_t *usb_ctrl_counters(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -6,17 +6,48 @@
 
 #include "hal/hal_stdio.h"
 #include "hal/hal_time.h"
+#include "hal/hal_dlog.h"
+
+#include "aer_burst.h"  // AER_BURST_COL_MASK_WORDS
 
 /* ---------------- Internal state ---------------- */
 
 static usb_stream_cfg_t g_cfg = {
     .timestamps_enabled = true,
     .data_width_bits    = 0,
+    .rowmask_enabled    = false,
+    .latch_timestamps   = false,
 };
 
 
 static usb_stream_stats_t g_stats = {0};
 
+/* Pending batch (main-loop context only). */
+static struct {
+    uint8_t  buf[USB_STREAM_BATCH_BUF_BYTES];
+    uint16_t len;
+    uint32_t events;          // events carried by the pending records
+    uint32_t t0_cycles;       // hal_cycles_now() when the first record was queued
+} g_batch;
+
+static uint32_t g_batch_latency_cycles = 0u;
+
+/* Pending raw passthrough words (main-loop context only), kept as the two
+ * arrays of the RAW_BIN payload so a flush is one gathered write. */
+static struct {
+    uint16_t words[USB_STREAM_RAW_MAX_WORDS];
+    uint32_t ticks[USB_STREAM_RAW_MAX_WORDS];
+    uint16_t n;
+    bool     timed;           // ticks[] is filled for this batch
+    uint32_t index;           // word_index of words[0]
+    uint32_t next_index;      // words handed to usb_stream_send_raw_words() so far
+    uint32_t t0_cycles;       // hal_cycles_now() when words[0] was queued
+} g_raw;
+
+/* Periodic time anchors (main-loop context only). */
+static uint32_t g_anchor_last = 0u;
+static uint32_t g_anchor_cycles = 0u;
+
 /* ---------------- Event record payloads ----------------
  * These are the payload bytes inside HAL_STREAM_EVENT_BIN.
  * We include an explicit record type so the host can resync even if it misses HELLO.
@@ -39,14 +70,346 @@ typedef struct __attribute__((packed)) usb_evt_v1_ticks_s {
     uint32_t t_ticks;  // cycle counter ticks at emission
 } usb_evt_v1_ticks_t;
 
+/* Row burst bitmask record (V2), see usb_stream.h for the byte layout. */
+typedef struct __attribute__((packed)) usb_evt_v2_rowmask_s {
+    uint8_t  rec_type;   // USB_EVT_REC_V2_ROWMASK
+    uint8_t  flags;
+    uint8_t  row;
+    uint8_t  mask_bytes; // USB_EVT_ROWMASK_BYTES
+    uint32_t t_ticks;    // cycle counter ticks at burst emission (0 if disabled)
+    uint8_t  col_mask[USB_EVT_ROWMASK_BYTES];
+} usb_evt_v2_rowmask_t;
+
+/* RAW_BIN header, see usb_stream.h; words[] and t_ticks[] follow. */
+typedef struct __attribute__((packed)) usb_stream_raw_hdr_s {
+    uint8_t  raw_ver;
+    uint8_t  flags;
+    uint16_t nwords;
+    uint32_t word_index;
+} usb_stream_raw_hdr_t;
+
+_Static_assert(sizeof(usb_stream_raw_hdr_t) == USB_STREAM_RAW_HDR_BYTES, "RAW_BIN layout is part of the host protocol");
+_Static_assert(AER_DATA_WIDTH <= 16u, "RAW_BIN carries DATA as u16 words");
+_Static_assert(HAL_STREAM_HDR_LEN + USB_STREAM_RAW_HDR_BYTES + 6u * USB_STREAM_RAW_MAX_WORDS <= HAL_STREAM_TX_BUF_BYTES,
+               "a full RAW_BIN frame must fit in a TX buffer");
+
+/* HELLO descriptor, see usb_stream.h for field meanings. */
+typedef struct __attribute__((packed)) usb_stream_hello_s {
+    uint8_t  hello_ver;
+    uint8_t  frame_ver;
+    uint16_t rows;
+    uint16_t cols;
+    uint8_t  index_bits;
+    uint8_t  data_width_bits;
+    uint8_t  event_rec_type;
+    uint8_t  burst_rec_type;
+    uint32_t rec_types_mask;
+    uint32_t tick_hz;
+    uint8_t  flags;
+    uint8_t  rsvd;
+    uint16_t batch_max_bytes;
+    uint32_t batch_max_latency_us;
+} usb_stream_hello_t;
+
+_Static_assert(sizeof(usb_stream_hello_t) == 26u, "HELLO layout is part of the host protocol");
+
+/* Time anchor, see usb_stream.h for field meanings. */
+typedef struct __attribute__((packed)) usb_stream_time_anchor_s {
+    uint8_t  anchor_ver;
+    uint8_t  rsvd[3];
+    uint32_t tick_hz;
+    uint64_t t_ticks64;
+    uint64_t t_us;
+} usb_stream_time_anchor_t;
+
+_Static_assert(sizeof(usb_stream_time_anchor_t) == 24u, "time anchor layout is part of the host protocol");
+
+/* Loss summary, see usb_stream.h for field meanings. */
+typedef struct __attribute__((packed)) usb_stream_loss_s {
+    uint8_t  loss_ver;
+    uint8_t  rsvd[3];
+    uint32_t t_ticks;
+    uint32_t frames_written;
+    uint32_t frames_failed;
+    uint32_t frames_not_connected;
+    uint32_t events_sent;
+    uint32_t events_dropped_not_connected;
+    uint32_t events_dropped_write_failed;
+    uint32_t ring_dropped;
+    uint32_t burst_cols_dropped;
+    uint32_t words_invalid;
+} usb_stream_loss_t;
+
+_Static_assert(sizeof(usb_stream_loss_t) == 44u, "loss summary layout is part of the host protocol");
+
+/* Ring stats snapshot, see usb_stream.h; hist[] follows the fixed part. */
+typedef struct __attribute__((packed)) usb_stream_ring_stats_s {
+    uint8_t  ring_ver;
+    uint8_t  ring_id;
+    uint8_t  buckets;
+    uint8_t  rsvd;
+    uint32_t slots;
+    uint32_t level;
+    uint32_t high_water;
+    uint32_t push_full;
+    uint32_t publishes;
+    uint32_t hist[RINGBUF_STATS_BUCKETS];
+} usb_stream_ring_stats_t;
+
+_Static_assert(sizeof(usb_stream_ring_stats_t) == 24u + 4u * RINGBUF_STATS_BUCKETS,
+               "ring stats layout is part of the host protocol");
+
+_Static_assert(USB_STREAM_BURST_MAX_RECS * sizeof(usb_evt_v1_ticks_t) <= USB_STREAM_BATCH_BUF_BYTES,
+               "a burst chunk must fit in the batch buffer");
+
+/* ---------------- Framing / batching ---------------- */
+
+static bool write_frame(const void *buf, size_t len, uint32_t events)
+{
+    const bool ok = hal_stream_write(HAL_STREAM_EVENT_BIN, buf, (uint16_t)len);
+    if (ok) {
+        g_stats.packets_sent++;
+        g_stats.events_sent += events;
+    } else {
+        g_stats.events_dropped_write_failed += events;
+    }
+    return ok;
+}
+
+static bool batch_flush(uint32_t *reason_counter)
+{
+    if (g_batch.len == 0u) return true;
+
+    (*reason_counter)++;
+    const bool ok = write_frame(g_batch.buf, g_batch.len, g_batch.events);
+    g_batch.len = 0u;
+    g_batch.events = 0u;
+    return ok;
+}
+
+/* Queue (or, without batching, directly write) len bytes of whole records. */
+static bool emit_records(const void *rec, size_t len, uint32_t events)
+{
+    if (g_cfg.batch_max_bytes == 0u) {
+        return write_frame(rec, len, events);
+    }
+
+    bool ok = true;
+    if (g_batch.len + len > USB_STREAM_BATCH_BUF_BYTES) {
+        ok = batch_flush(&g_stats.flush_size);
+    }
+    if (g_batch.len == 0u) {
+        g_batch.t0_cycles = hal_cycles_now();
+    }
+
+    memcpy(&g_batch.buf[g_batch.len], rec, len);
+    g_batch.len = (uint16_t)(g_batch.len + len);
+    g_batch.events += events;
+
+    if (g_batch.len >= g_cfg.batch_max_bytes) {
+        ok = batch_flush(&g_stats.flush_size) && ok;
+    }
+    return ok;
+}
+
+/* ---------------- Raw passthrough ---------------- */
+
+static bool raw_write(void)
+{
+    if (g_raw.n == 0u) return true;
+
+    const usb_stream_raw_hdr_t h = {
+        .raw_ver    = (uint8_t)USB_STREAM_RAW_VER,
+        .flags      = (uint8_t)(g_raw.timed ? USB_STREAM_RAW_F_TICKS : 0u),
+        .nwords     = g_raw.n,
+        .word_index = g_raw.index,
+    };
+    const hal_iovec_t iov[3] = {
+        { &h, (uint16_t)sizeof(h) },
+        { g_raw.words, (uint16_t)(2u * g_raw.n) },
+        { g_raw.ticks, (uint16_t)(4u * g_raw.n) },
+    };
+    const bool ok = hal_stream_writev(HAL_STREAM_RAW_BIN, iov, g_raw.timed ? 3u : 2u);
+    if (ok) {
+        g_stats.raw_packets_sent++;
+        g_stats.raw_words_sent += g_raw.n;
+    } else {
+        g_stats.raw_words_dropped_write_failed += g_raw.n;
+    }
+    g_raw.n = 0u;
+    return ok;
+}
+
+static bool raw_flush(uint32_t *reason_counter)
+{
+    if (g_raw.n == 0u) return true;
+    (*reason_counter)++;
+    return raw_write();
+}
+
+/* Words per frame: the first count whose payload reaches batch_max_bytes. */
+static inline uint32_t raw_batch_words(bool timed)
+{
+    if (g_cfg.batch_max_bytes <= USB_STREAM_RAW_HDR_BYTES) return USB_STREAM_RAW_MAX_WORDS;
+    const uint32_t per = timed ? 6u : 2u;
+    const uint32_t n = (g_cfg.batch_max_bytes - USB_STREAM_RAW_HDR_BYTES + per - 1u) / per;
+    return (n < USB_STREAM_RAW_MAX_WORDS) ? n : USB_STREAM_RAW_MAX_WORDS;
+}
+
+static void apply_batching_cfg(void)
+{
+    if (g_cfg.batch_max_bytes > USB_STREAM_BATCH_BUF_BYTES) {
+        g_cfg.batch_max_bytes = (uint16_t)USB_STREAM_BATCH_BUF_BYTES;
+    }
+    g_batch_latency_cycles = hal_us_to_cycles(g_cfg.batch_max_latency_us);
+    g_anchor_cycles = hal_us_to_cycles(g_cfg.time_anchor_interval_us);
+}
+
 static inline usb_stream_event_rec_type_t active_rec_type(void) {
+    if (g_cfg.rowmask_enabled) return USB_EVT_REC_V2_ROWMASK;
     return g_cfg.timestamps_enabled ? USB_EVT_REC_V1_TICKS : USB_EVT_REC_V1_NOTS;
 }
 
+static inline uint32_t mask_popcount(const uint32_t *mask)
+{
+    uint32_t n = 0u;
+    for (uint32_t w = 0u; w < AER_BURST_COL_MASK_WORDS; ++w) {
+        uint32_t m = mask[w];
+        while (m) { m &= m - 1u; ++n; }
+    }
+    return n;
+}
+
+/* One ROWMASK record for the burst; mask words are serialized little-endian. */
+static bool send_rowmask(uint8_t row, const uint32_t *mask, uint32_t events, uint32_t t_ticks)
+{
+    if (!hal_stdio_is_connected()) {
+        g_stats.events_dropped_not_connected += events;
+        return false;
+    }
+
+    usb_evt_v2_rowmask_t e;
+    e.rec_type   = (uint8_t)USB_EVT_REC_V2_ROWMASK;
+    e.flags      = (uint8_t)USB_EVT_FLAG_ON;
+    e.row        = row;
+    e.mask_bytes = (uint8_t)USB_EVT_ROWMASK_BYTES;
+    e.t_ticks    = g_cfg.timestamps_enabled ? t_ticks : 0u;
+    for (uint32_t i = 0u; i < USB_EVT_ROWMASK_BYTES; ++i) {
+        e.col_mask[i] = (uint8_t)(mask[i / 4u] >> (8u * (i % 4u)));
+    }
+
+    return emit_records(&e, sizeof(e), events);
+}
+
 void usb_stream_init(const usb_stream_cfg_t *cfg)
 {
     if (cfg) g_cfg = *cfg;
     g_stats = (usb_stream_stats_t){0};
+    g_batch.len = 0u;
+    g_batch.events = 0u;
+    g_raw.n = 0u;
+    g_raw.next_index = 0u;
+    g_anchor_last = hal_cycles_now();
+    apply_batching_cfg();
+}
+
+const usb_stream_cfg_t *usb_stream_config(void)
+{
+    return &g_cfg;
+}
+
+void usb_stream_set_batching(uint16_t max_bytes, uint32_t max_latency_us)
+{
+    (void)usb_stream_flush();
+    g_cfg.batch_max_bytes      = max_bytes;
+    g_cfg.batch_max_latency_us = max_latency_us;
+    apply_batching_cfg();
+}
+
+void usb_stream_poll(void)
+{
+    if (g_batch.len != 0u && g_cfg.batch_max_latency_us != 0u
+        && hal_cycles_diff(hal_cycles_now(), g_batch.t0_cycles) >= g_batch_latency_cycles) {
+        (void)batch_flush(&g_stats.flush_latency);
+    }
+    if (g_raw.n != 0u && g_cfg.batch_max_latency_us != 0u
+        && hal_cycles_diff(hal_cycles_now(), g_raw.t0_cycles) >= g_batch_latency_cycles) {
+        (void)raw_flush(&g_stats.flush_latency);
+    }
+
+    if (g_cfg.time_anchor_interval_us != 0u
+        && hal_cycles_diff(hal_cycles_now(), g_anchor_last) >= g_anchor_cycles) {
+        (void)usb_stream_send_time_anchor();
+    }
+
+    /* Deferred log records, then keep the CDC endpoint fed from whatever
+     * the TX buffers hold. */
+    (void)hal_dlog_flush();
+    hal_stream_poll();
+}
+
+bool usb_stream_flush(void)
+{
+    const bool ok = batch_flush(&g_stats.flush_explicit);
+    return raw_flush(&g_stats.flush_explicit) && ok;
+}
+
+void usb_stream_set_raw_passthrough(bool enabled)
+{
+    (void)usb_stream_flush();
+    g_cfg.raw_passthrough = enabled;
+}
+
+bool usb_stream_raw_passthrough(void)
+{
+    return g_cfg.raw_passthrough;
+}
+
+bool usb_stream_send_raw_words(const uint32_t *words, const uint32_t *ts, uint32_t n)
+{
+    if (n == 0u) return true;
+    if (!words) return false;
+
+    if (!hal_stdio_is_connected()) {
+        g_stats.raw_words_dropped_not_connected += n;
+        g_raw.next_index += n;
+        return false;
+    }
+
+    const bool timed = (ts != NULL) && g_cfg.timestamps_enabled;
+    bool ok = true;
+    if (g_raw.n != 0u && g_raw.timed != timed) {
+        ok = raw_flush(&g_stats.flush_size);
+    }
+
+    const uint32_t limit = raw_batch_words(timed);
+    uint32_t done = 0u;
+    while (done < n) {
+        if (g_raw.n == 0u) {
+            g_raw.timed = timed;
+            g_raw.index = g_raw.next_index;
+            g_raw.t0_cycles = hal_cycles_now();
+        }
+        uint32_t k = (g_raw.n < limit) ? limit - g_raw.n : 0u;
+        if (k > n - done) k = n - done;
+        for (uint32_t i = 0u; i < k; ++i) {
+            g_raw.words[g_raw.n + i] = (uint16_t)(words[done + i] & AER_RAW_MASK);
+        }
+        if (timed) {
+            memcpy(&g_raw.ticks[g_raw.n], &ts[done], 4u * k);
+        }
+        g_raw.n = (uint16_t)(g_raw.n + k);
+        g_raw.next_index += k;
+        done += k;
+
+        if (g_raw.n >= limit) {
+            ok = raw_flush(&g_stats.flush_size) && ok;
+        }
+    }
+    if (g_cfg.batch_max_bytes == 0u) {
+        ok = raw_write() && ok;
+    }
+    return ok;
 }
 
 void usb_stream_set_timestamps_enabled(bool enabled)
@@ -54,6 +417,11 @@ void usb_stream_set_timestamps_enabled(bool enabled)
     g_cfg.timestamps_enabled = enabled;
 }
 
+void usb_stream_set_rowmask_enabled(bool enabled)
+{
+    g_cfg.rowmask_enabled = enabled;
+}
+
 usb_stream_event_rec_type_t usb_stream_event_record_type(void)
 {
     return active_rec_type();
@@ -80,20 +448,223 @@ bool usb_stream_send_event(uint8_t row, uint8_t col, uint8_t flags)
         e.row      = row;
         e.col      = col;
         e.t_ticks  = hal_cycles_now();
-        ok = hal_stream_write(HAL_STREAM_EVENT_BIN, &e, (uint16_t)sizeof(e));
+        ok = emit_records(&e, sizeof(e), 1u);
     } else {
         usb_evt_v1_nots_t e;
         e.rec_type = (uint8_t)USB_EVT_REC_V1_NOTS;
         e.flags    = flags;
         e.row      = row;
         e.col      = col;
-        ok = hal_stream_write(HAL_STREAM_EVENT_BIN, &e, (uint16_t)sizeof(e));
+        ok = emit_records(&e, sizeof(e), 1u);
+    }
+
+    return ok;
+}
+
+/* Emission-time stamp for the non-_at entry points (no counter read when off). */
+static inline uint32_t emit_ticks(void)
+{
+    return g_cfg.timestamps_enabled ? hal_cycles_now() : 0u;
+}
+
+bool usb_stream_send_on_burst(uint8_t row, const uint8_t *cols, uint16_t count)
+{
+    return usb_stream_send_on_burst_at(row, cols, count, emit_ticks(), NULL);
+}
+
+bool usb_stream_send_on_burst_at(uint8_t row, const uint8_t *cols, uint16_t count,
+                                 uint32_t t_burst, const uint32_t *col_t)
+{
+    if (count == 0u) return true;
+    if (!cols) return false;
+
+    if (g_cfg.rowmask_enabled) {
+        uint32_t mask[AER_BURST_COL_MASK_WORDS] = {0};
+        for (uint16_t i = 0u; i < count; ++i) {
+            if (cols[i] < AER_COLS) mask[cols[i] >> 5] |= 1u << (cols[i] & 31u);
+        }
+        /* Count set bits, not list entries: repeats share one bit. */
+        return send_rowmask(row, mask, mask_popcount(mask), t_burst);
+    }
+
+    if (!hal_stdio_is_connected()) {
+        g_stats.events_dropped_not_connected += count;
+        return false;
+    }
+
+    /* One packet (or batch append) per chunk; records are the same layout as single events. */
+    static uint8_t buf[USB_STREAM_BURST_MAX_RECS * sizeof(usb_evt_v1_ticks_t)];
+
+    const uint8_t  flags   = (uint8_t)USB_EVT_FLAG_ON;
+    const bool     ticks   = g_cfg.timestamps_enabled;
+
+    bool ok = true;
+    uint16_t done = 0u;
+    while (ok && done < count) {
+        uint16_t n = (uint16_t)(count - done);
+        if (n > USB_STREAM_BURST_MAX_RECS) n = (uint16_t)USB_STREAM_BURST_MAX_RECS;
+
+        size_t len = 0u;
+        for (uint16_t i = 0u; i < n; ++i) {
+            if (ticks) {
+                usb_evt_v1_ticks_t e;
+                e.rec_type = (uint8_t)USB_EVT_REC_V1_TICKS;
+                e.flags    = flags;
+                e.row      = row;
+                e.col      = cols[done + i];
+                e.t_ticks  = col_t ? col_t[done + i] : t_burst;
+                memcpy(&buf[len], &e, sizeof(e));
+                len += sizeof(e);
+            } else {
+                usb_evt_v1_nots_t e;
+                e.rec_type = (uint8_t)USB_EVT_REC_V1_NOTS;
+                e.flags    = flags;
+                e.row      = row;
+                e.col      = cols[done + i];
+                memcpy(&buf[len], &e, sizeof(e));
+                len += sizeof(e);
+            }
+        }
+
+        ok = emit_records(buf, len, n);
+        done = (uint16_t)(done + n);
+    }
+    return ok;
+}
+
+bool usb_stream_send_on_burst_mask(uint8_t row, const uint32_t *col_mask)
+{
+    return usb_stream_send_on_burst_mask_at(row, col_mask, emit_ticks());
+}
+
+bool usb_stream_send_on_burst_mask_at(uint8_t row, const uint32_t *col_mask, uint32_t t_burst)
+{
+    if (!col_mask) return false;
+
+    if (g_cfg.rowmask_enabled) {
+        return send_rowmask(row, col_mask, mask_popcount(col_mask), t_burst);
+    }
+
+    uint8_t cols[AER_COLS];
+    const uint16_t n = aer_burst_mask_to_cols(col_mask, cols);
+    return usb_stream_send_on_burst_at(row, cols, n, t_burst, NULL);
+}
+
+bool usb_stream_send_hello(void)
+{
+    /* Keep ordering: everything queued before HELLO goes out first. */
+    (void)usb_stream_flush();
+
+    usb_stream_hello_t h;
+    h.hello_ver       = (uint8_t)USB_STREAM_HELLO_VER;
+    h.frame_ver       = (uint8_t)HAL_STREAM_VER;
+    h.rows            = (uint16_t)AER_ROWS;
+    h.cols            = (uint16_t)AER_COLS;
+    h.index_bits      = (uint8_t)AER_INDEX_BITS;
+    h.data_width_bits = g_cfg.data_width_bits;
+    h.event_rec_type  = (uint8_t)(g_cfg.timestamps_enabled ? USB_EVT_REC_V1_TICKS : USB_EVT_REC_V1_NOTS);
+    h.burst_rec_type  = (uint8_t)active_rec_type();
+    h.rec_types_mask  = (1u << USB_EVT_REC_V1_NOTS) | (1u << USB_EVT_REC_V1_TICKS)
+                      | (1u << USB_EVT_REC_V2_ROWMASK);
+    h.tick_hz         = hal_cycles_hz();
+    h.flags           = (uint8_t)((g_cfg.timestamps_enabled ? USB_STREAM_HELLO_F_TIMESTAMPS : 0u)
+                      | (g_cfg.rowmask_enabled ? USB_STREAM_HELLO_F_ROWMASK : 0u)
+                      | (hal_cycles_is_exact() ? USB_STREAM_HELLO_F_TICKS_EXACT : 0u)
+                      | (g_cfg.latch_timestamps ? USB_STREAM_HELLO_F_LATCH_TIME : 0u)
+                      | (g_cfg.time_anchor_interval_us != 0u ? USB_STREAM_HELLO_F_TIME_ANCHORS : 0u)
+                      | (g_cfg.raw_passthrough ? USB_STREAM_HELLO_F_RAW_WORDS : 0u));
+    h.rsvd            = 0u;
+    h.batch_max_bytes = g_cfg.batch_max_bytes;
+    h.batch_max_latency_us = g_cfg.batch_max_latency_us;
+
+    const bool ok = hal_stream_write(HAL_STREAM_HELLO, &h, (uint16_t)sizeof(h));
+    if (ok) g_stats.hello_sent++;
+
+    /* A (re)connected host needs a reference before the next t_ticks. */
+    if (ok && g_cfg.time_anchor_interval_us != 0u) {
+        (void)usb_stream_send_time_anchor();
     }
+    return ok;
+}
+
+bool usb_stream_send_time_anchor(void)
+{
+    (void)usb_stream_flush();
+
+    usb_stream_time_anchor_t a;
+    a.anchor_ver = (uint8_t)USB_STREAM_TIME_ANCHOR_VER;
+    a.rsvd[0]    = 0u;
+    a.rsvd[1]    = 0u;
+    a.rsvd[2]    = 0u;
+    a.tick_hz    = hal_cycles_hz();
+    a.t_ticks64  = hal_cycles_now64();
+    a.t_us       = hal_time_us_now();
+    g_anchor_last = (uint32_t)a.t_ticks64;
+
+    const bool ok = hal_stream_write(HAL_STREAM_TIME_ANCHOR, &a, (uint16_t)sizeof(a));
+    if (ok) g_stats.anchors_sent++;
+    return ok;
+}
+
+bool usb_stream_send_loss_summary(const usb_stream_loss_src_t *src)
+{
+    /* Counters must include every record the host could have seen before this frame. */
+    (void)usb_stream_flush();
+
+    const hal_stream_stats_t *tx = hal_stream_stats();
 
-    if (ok) g_stats.events_sent++;
+    usb_stream_loss_t l;
+    l.loss_ver  = (uint8_t)USB_STREAM_LOSS_VER;
+    l.rsvd[0]   = 0u;
+    l.rsvd[1]   = 0u;
+    l.rsvd[2]   = 0u;
+    l.t_ticks   = hal_cycles_now();
+    l.frames_written       = tx->frames_written;
+    l.frames_failed        = tx->frames_failed;
+    l.frames_not_connected = tx->frames_not_connected;
+    l.events_sent                  = g_stats.events_sent;
+    l.events_dropped_not_connected = g_stats.events_dropped_not_connected;
+    l.events_dropped_write_failed  = g_stats.events_dropped_write_failed;
+    l.ring_dropped       = src ? src->ring_dropped : 0u;
+    l.burst_cols_dropped = src ? src->burst_cols_dropped : 0u;
+    l.words_invalid      = src ? src->words_invalid : 0u;
+
+    const bool ok = hal_stream_write(HAL_STREAM_LOSS, &l, (uint16_t)sizeof(l));
+    if (ok) g_stats.loss_sent++;
     return ok;
 }
 
+bool usb_stream_send_ring_stats(uint8_t ring_id, const ringbuf_u32_t *rb)
+{
+    const ringbuf_u32_stats_t *st = ringbuf_u32_stats(rb);
+    if (!st) return false;
+
+    usb_stream_ring_stats_t r;
+    r.ring_ver   = (uint8_t)USB_STREAM_RING_STATS_VER;
+    r.ring_id    = ring_id;
+    r.buckets    = (uint8_t)RINGBUF_STATS_BUCKETS;
+    r.rsvd       = 0u;
+    r.slots      = rb->capacity - 1u;
+    r.level      = ringbuf_u32_count(rb);
+    r.high_water = st->high_water;
+    r.push_full  = st->push_full;
+    r.publishes  = st->publishes;
+    for (uint32_t b = 0u; b < RINGBUF_STATS_BUCKETS; ++b) {
+        r.hist[b] = st->hist[b];
+    }
+
+    const bool ok = hal_stream_write(HAL_STREAM_RING_STATS, &r, (uint16_t)sizeof(r));
+    if (ok) g_stats.ring_stats_sent++;
+    return ok;
+}
+
+bool usb_stream_on_host_byte(uint8_t byte)
+{
+    if (byte != (uint8_t)USB_STREAM_HELLO_REQUEST) return false;
+    (void)usb_stream_send_hello();
+    return true;
+}
+
 const usb_stream_stats_t *usb_stream_stats(void)
 {
     return &g_stats;
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "aer_cfg.h"  // AER_COLS
+#include "ringbuf.h"  // ringbuf_u32_t (ring stats reports)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -15,55 +18,348 @@ extern "C" {
  * payload format for decoded events and stream metadata.
  *
  * Design goals:
- *  - ON events only (row/col), timestamp taken at *event emission* time.
+ *  - ON events only (row/col). Timestamps are the receiver's latch times when
+ *    the caller has them (usb_stream_send_on_burst_at() & co.), otherwise
+ *    taken at *event emission* time; HELLO says which.
  *  - Timestamps enabled now, but easy to disable later without breaking host parsing.
  *  - Send a HELLO descriptor so the host learns the active event record type.
+ *  - Raw passthrough: ship the latched bus words themselves (HAL_STREAM_RAW_BIN)
+ *    and leave decode and burst assembly to the host.
+ */
+
+/* --- HELLO / capability descriptor (HAL_STREAM_HELLO frames) ---
+ * Sent when the host opens the port (DTR asserted, including re-opens) and
+ * whenever the host writes the USB_STREAM_HELLO_REQUEST byte.
+ * Layout (little-endian, packed), version USB_STREAM_HELLO_VER:
+ *   u8  hello_ver            USB_STREAM_HELLO_VER
+ *   u8  frame_ver            HAL_STREAM_VER of the AERS headers
+ *   u16 rows, u16 cols       sensor geometry
+ *   u8  index_bits           bits per row/col address
+ *   u8  data_width_bits      DATA bus lines
+ *   u8  event_rec_type       record type used for single events
+ *   u8  burst_rec_type       record type used for bursts
+ *   u32 rec_types_mask       bit n set => record type n may appear in the stream
+ *   u32 tick_hz              rate of t_ticks fields (hal_cycles_hz())
+ *   u8  flags                USB_STREAM_HELLO_F_*
+ *   u8  rsvd                 0
+ *   u16 batch_max_bytes      usb_stream_cfg_t batching (0 = one frame per send)
+ *   u32 batch_max_latency_us
+ * 26 bytes. Later versions only append fields; hosts ignore trailing bytes.
+ */
+#define USB_STREAM_HELLO_VER        1u
+#define USB_STREAM_HELLO_REQUEST    '?'
+
+enum {
+    USB_STREAM_HELLO_F_TIMESTAMPS  = 0x01u,  // t_ticks fields are filled
+    USB_STREAM_HELLO_F_ROWMASK     = 0x02u,  // bursts go out as USB_EVT_REC_V2_ROWMASK
+    USB_STREAM_HELLO_F_TICKS_EXACT = 0x04u,  // ticks come from a real cycle counter (not us-derived)
+    USB_STREAM_HELLO_F_LATCH_TIME  = 0x08u,  // t_ticks = word latch time (V1: the column word,
+                                             // ROWMASK: the row word), not emission time
+    USB_STREAM_HELLO_F_TIME_ANCHORS = 0x10u, // HAL_STREAM_TIME_ANCHOR frames follow HELLO and
+                                             // repeat every time_anchor_interval_us
+    USB_STREAM_HELLO_F_RAW_WORDS   = 0x20u,  // raw passthrough: bus words go out as
+                                             // HAL_STREAM_RAW_BIN, no EVENT_BIN records
+};
+
+/* --- Time anchor (HAL_STREAM_TIME_ANCHOR frames) ---
+ * Every t_ticks field is the low 32 bits of the cycle counter and wraps every
+ * 2^32 / tick_hz seconds (~28.6 s at 150 MHz). An anchor carries the full
+ * 64-bit count (hal_cycles_now64()) so the host can rebuild absolute ticks:
+ *   t64 = anchor.t_ticks64 + (int32_t)(t_ticks - (uint32_t)anchor.t_ticks64)
+ * using the most recent anchor. That is exact for any t_ticks within 2^31
+ * ticks (~14.3 s) of the anchor, before or after it (latch times can be older
+ * than the anchor that precedes their record), so anchors every second leave
+ * a wide margin. Sent right after HELLO and then periodically by
+ * usb_stream_poll(); pending records are flushed first, so stream order is
+ * kept.
+ * Layout (little-endian, packed), version USB_STREAM_TIME_ANCHOR_VER:
+ *   u8  anchor_ver     USB_STREAM_TIME_ANCHOR_VER
+ *   u8  rsvd[3]        0
+ *   u32 tick_hz        hal_cycles_hz()
+ *   u64 t_ticks64      hal_cycles_now64(): ticks since boot
+ *   u64 t_us           hal_time_us_now() read next to it
+ * 24 bytes. Later versions only append fields.
+ */
+#define USB_STREAM_TIME_ANCHOR_VER 1u
+
+/* --- Loss summary (HAL_STREAM_LOSS frames) ---
+ * Sent periodically by the application so the host can tell how much was lost
+ * and where. All counters are cumulative since boot and wrap at 2^32; the host
+ * works with deltas between summaries, so a lost summary costs nothing.
+ * Layout (little-endian, packed), version USB_STREAM_LOSS_VER:
+ *   u8  loss_ver             USB_STREAM_LOSS_VER
+ *   u8  rsvd[3]              0
+ *   u32 t_ticks              hal_cycles_now() when the summary was built
+ *   u32 frames_written       hal_stream_stats(), before this frame
+ *   u32 frames_failed
+ *   u32 frames_not_connected
+ *   u32 events_sent          usb_stream_stats()
+ *   u32 events_dropped_not_connected
+ *   u32 events_dropped_write_failed
+ *   u32 ring_dropped         usb_stream_loss_src_t (receiver side)
+ *   u32 burst_cols_dropped
+ *   u32 words_invalid
+ * 44 bytes. Later versions only append fields.
+ *
+ * Together with the frame seq (hal_stdio.h) the host can split losses into:
+ * never captured (ring_dropped), mangled on the bus (words_invalid,
+ * burst_cols_dropped), refused by the USB stack (events_dropped_*), and
+ * dropped after the device believed it sent them (seq gaps).
+ */
+#define USB_STREAM_LOSS_VER 1u
+
+/* Receiver-side counters the application owns; usb_stream adds its own. */
+typedef struct usb_stream_loss_src_s {
+    uint32_t ring_dropped;        // raw words dropped because the raw ring was full
+    uint32_t burst_cols_dropped;  // columns lost to burst overflow/range (aer_burst_t.cols_dropped_total)
+    uint32_t words_invalid;       // raw words the decoder rejected (aer_burst_t.words_ignored)
+} usb_stream_loss_src_t;
+
+/* --- Ring occupancy stats (HAL_STREAM_RING_STATS frames) ---
+ * Snapshot of one ring's RINGBUF_STATS instrumentation, sent next to the loss
+ * summary so RAW_RB_CAPACITY & co. can be sized from field data.
+ * Layout (little-endian, packed), version USB_STREAM_RING_STATS_VER:
+ *   u8  ring_ver        USB_STREAM_RING_STATS_VER
+ *   u8  ring_id         USB_STREAM_RING_*
+ *   u8  buckets         number of hist entries (RINGBUF_STATS_BUCKETS)
+ *   u8  rsvd            0
+ *   u32 slots           usable slots (capacity - 1)
+ *   u32 level           fill level when the snapshot was taken
+ *   u32 high_water      max fill level after a push/commit
+ *   u32 push_full       items rejected because the ring was full
+ *   u32 publishes       samples in hist
+ *   u32 hist[buckets]   bucket 0 = empty, bucket b = level in [2^(b-1), 2^b)
+ * Counters are cumulative since boot (or the last ringbuf_u32_stats_reset()).
+ */
+#define USB_STREAM_RING_STATS_VER 1u
+
+enum {
+    USB_STREAM_RING_RAW = 0u,   // raw word capture ring (aer_rx_poll -> decoder)
+};
+
+/* --- Raw word passthrough (HAL_STREAM_RAW_BIN frames) ---
+ * With raw_passthrough the application hands usb_stream the latched words
+ * as they leave the raw ring (usb_stream_send_raw_words()) instead of
+ * decoding them: the host sees exactly what was on DATA, in order, and runs
+ * aer_decode_word()/aer_burst_feed() itself (host/aer_raw_decode.h). Words
+ * are batched like event records (batch_max_bytes / batch_max_latency_us).
+ * Layout (little-endian, packed), version USB_STREAM_RAW_VER:
+ *   u8  raw_ver         USB_STREAM_RAW_VER
+ *   u8  flags           USB_STREAM_RAW_F_*
+ *   u16 nwords
+ *   u32 word_index      words handed to usb_stream_send_raw_words() since
+ *                       usb_stream_init() before this frame's first word;
+ *                       a jump tells the host how many words it missed
+ *   u16 words[nwords]   DATA lines as latched, bit i = DATA[i]
+ *   u32 t_ticks[nwords] latch time of each word (USB_STREAM_RAW_F_TICKS only)
+ * 8 + 2 (or 6 with ticks) bytes per word. Words dropped on the receiver side
+ * (raw ring full) never reach usb_stream and leave no gap in word_index; the
+ * loss summary reports them. In this mode the loss summary's events_* and
+ * burst fields stay 0; refused frames show as word_index jumps.
  */
+#define USB_STREAM_RAW_VER          1u
+#define USB_STREAM_RAW_HDR_BYTES    8u
+#define USB_STREAM_RAW_MAX_WORDS    128u   // per frame
+
+enum {
+    USB_STREAM_RAW_F_TICKS = 0x01u,        // t_ticks[] follows words[]
+};
 
 /* --- Stream payload versions / record types (inside HAL_STREAM_EVENT_BIN) --- */
 typedef enum usb_stream_event_rec_type_e {
     USB_EVT_REC_V1_NOTS = 1,  // row/col + flags (no timestamp)
     USB_EVT_REC_V1_TICKS  = 2,  // row/col + flags + t_ticks (cycle counter)
+    USB_EVT_REC_V2_ROWMASK = 3, // one row burst: row + column bitmask + t_ticks
+    USB_EVT_REC_V2_DELTA   = 4, // delta-timestamp block (aer_evpack.h); reserved, not emitted yet
 } usb_stream_event_rec_type_t;
 
+/*
+ * USB_EVT_REC_V2_ROWMASK layout (little-endian, packed):
+ *   u8  rec_type    = 3
+ *   u8  flags       USB_EVT_FLAG_*
+ *   u8  row
+ *   u8  mask_bytes  = USB_EVT_ROWMASK_BYTES (lets the host size the record)
+ *   u32 t_ticks     burst start: row word latch time with USB_STREAM_HELLO_F_LATCH_TIME,
+ *                   else burst emission time (0 when timestamps are disabled)
+ *   u8  col_mask[mask_bytes]   bit (c % 8) of byte (c / 8) set => column c ON
+ * 12 bytes for a 32-column sensor, whatever the number of columns in the burst.
+ */
+#define USB_EVT_ROWMASK_BYTES ((AER_COLS + 7u) / 8u)
+
 /* --- Flags inside event payload (yours to extend) --- */
 enum {
     USB_EVT_FLAG_ON = 0x01u,   // pixel ON event (as requested)
 };
 
+/* --- Packet batching ---
+ * Records are appended to one packet buffer and sent as a single
+ * HAL_STREAM_EVENT_BIN frame when:
+ *  - size:    the pending payload reaches batch_max_bytes (or the next record
+ *             would not fit in the buffer),
+ *  - latency: usb_stream_poll() sees the oldest pending record is at least
+ *             batch_max_latency_us old,
+ *  - explicit: usb_stream_flush() is called.
+ * batch_max_bytes == 0 disables batching (one frame per send call).
+ */
+#define USB_STREAM_BATCH_BUF_BYTES 512u
+
 /* --- Optional stats for diagnostics --- */
 typedef struct usb_stream_stats_s {
     uint32_t events_sent;
     uint32_t events_dropped_not_connected;
+    uint32_t events_dropped_write_failed;  // lost with a frame hal_stream_write() rejected
+
+    uint32_t packets_sent;       // HAL_STREAM_EVENT_BIN frames written
+    uint32_t flush_size;         // batch flushed because it was full
+    uint32_t flush_latency;      // batch flushed by usb_stream_poll() deadline
+    uint32_t flush_explicit;     // batch flushed by usb_stream_flush()
+
+    uint32_t hello_sent;         // HELLO descriptors written
+    uint32_t loss_sent;          // loss summaries written
+    uint32_t ring_stats_sent;    // ring occupancy snapshots written
+    uint32_t anchors_sent;       // time anchors written
+
+    uint32_t raw_words_sent;                 // in accepted HAL_STREAM_RAW_BIN frames
+    uint32_t raw_words_dropped_not_connected;
+    uint32_t raw_words_dropped_write_failed; // lost with a refused RAW_BIN frame
+    uint32_t raw_packets_sent;               // HAL_STREAM_RAW_BIN frames written
 } usb_stream_stats_t;
 
 /* --- Configuration structure --- */
 typedef struct usb_stream_cfg_s {
     bool     timestamps_enabled;  // true => USB_EVT_REC_V1_TICKS
     uint8_t  data_width_bits;     // for metadata
+    bool     rowmask_enabled;     // true => bursts go out as USB_EVT_REC_V2_ROWMASK
+    bool     latch_timestamps;    // advertise USB_STREAM_HELLO_F_LATCH_TIME: the app sends
+                                  // through the *_at() calls with receiver latch times
+
+    uint16_t batch_max_bytes;     // flush threshold in payload bytes (0 = no batching, max USB_STREAM_BATCH_BUF_BYTES)
+    uint32_t batch_max_latency_us;// max age of a pending record before usb_stream_poll() flushes (0 = size/explicit only)
+
+    uint32_t time_anchor_interval_us; // HAL_STREAM_TIME_ANCHOR period (0 = no anchors); keep well under
+                                      // 2^31 ticks so hosts can unwrap and hal_cycles_now64() stays fed
+
+    bool     raw_passthrough;     // advertise USB_STREAM_HELLO_F_RAW_WORDS: the app streams raw
+                                  // words (usb_stream_send_raw_words()) instead of events
 } usb_stream_cfg_t;
 
 /** Initialize the stream wrapper (does not init USB itself; call hal_stdio_init() first). */
 void usb_stream_init(const usb_stream_cfg_t *cfg);
 
+/** Active configuration (batching as clamped by init/usb_stream_set_batching()). */
+const usb_stream_cfg_t *usb_stream_config(void);
+
 /** Enable/disable timestamps going forward */
 void usb_stream_set_timestamps_enabled(bool enabled);
 
-/** Get the active record type used for events. */
+/** Enable/disable row-bitmask burst records going forward */
+void usb_stream_set_rowmask_enabled(bool enabled);
+
+/**
+ * Switch between decoded events and raw word passthrough going forward
+ * (pending records are flushed first). The host learns the mode from HELLO,
+ * so send one after switching.
+ */
+void usb_stream_set_raw_passthrough(bool enabled);
+bool usb_stream_raw_passthrough(void);
+
+/** Change batching thresholds going forward (pending records are flushed first). */
+void usb_stream_set_batching(uint16_t max_bytes, uint32_t max_latency_us);
+
+/**
+ * Call from the main loop: flushes the pending batch once its latency bound
+ * is hit, sends a time anchor when one is due, packs deferred log records
+ * (hal_dlog_flush()) and hands queued frames to the link (hal_stream_poll()).
+ */
+void usb_stream_poll(void);
+
+/** Send any pending batched records now. Returns false if the write failed. */
+bool usb_stream_flush(void);
+
+/** Get the active record type used for events (bursts, when rowmask is enabled). */
 usb_stream_event_rec_type_t usb_stream_event_record_type(void);
 
 /**
  * Send one ON event (row,col). Flags will include USB_EVT_FLAG_ON.
  * Timestamp is included only if timestamps are enabled.
+ * With batching enabled, "sent" means queued; send functions return false only
+ * when not connected or when a flush they triggered failed.
  */
 bool usb_stream_send_on_event(uint8_t row, uint8_t col);
 
+/**
+ * Send a whole burst of ON events (one row, count columns) as a single framed
+ * packet, sharing one timestamp taken at emission:
+ *  - rowmask enabled: one USB_EVT_REC_V2_ROWMASK record
+ *  - otherwise: count V1 records back to back; bursts larger than
+ *    USB_STREAM_BURST_MAX_RECS are split over several packets.
+ */
+#define USB_STREAM_BURST_MAX_RECS 64u
+bool usb_stream_send_on_burst(uint8_t row, const uint8_t *cols, uint16_t count);
+
+/**
+ * Same as usb_stream_send_on_burst() for callers that already hold the burst
+ * as a column bitmask (AER_BURST_COL_MASK_WORDS words, bit c = column c).
+ * With rowmask enabled the mask is sent as-is in one USB_EVT_REC_V2_ROWMASK
+ * record; otherwise it is expanded to per-column records.
+ */
+bool usb_stream_send_on_burst_mask(uint8_t row, const uint32_t *col_mask);
+
+/**
+ * Latch-time variants: the caller supplies the timestamps instead of
+ * usb_stream reading hal_cycles_now() at emission. t_burst is the burst
+ * start (row word latch, used by ROWMASK records); col_t, if not NULL, holds
+ * one latch time per cols[] entry for V1 records (else they use t_burst).
+ * Ignored when timestamps are disabled.
+ */
+bool usb_stream_send_on_burst_at(uint8_t row, const uint8_t *cols, uint16_t count,
+                                 uint32_t t_burst, const uint32_t *col_t);
+bool usb_stream_send_on_burst_mask_at(uint8_t row, const uint32_t *col_mask, uint32_t t_burst);
+
+/**
+ * Raw passthrough: queue n latched words (and, if ts is not NULL and
+ * timestamps are enabled, their latch times) for HAL_STREAM_RAW_BIN frames.
+ * Words are sent whatever the current mode; raw_passthrough only decides
+ * what HELLO advertises. Returns false when not connected or when a flush
+ * it triggered failed (the words are counted as dropped).
+ */
+bool usb_stream_send_raw_words(const uint32_t *words, const uint32_t *ts, uint32_t n);
+
 /**
  * If we ever want to send custom flags in the future, use this.
  * (Still treated as an "event" record.)
  */
 bool usb_stream_send_event(uint8_t row, uint8_t col, uint8_t flags);
 
+/** Send the HELLO descriptor now (flushes pending batched records first). */
+bool usb_stream_send_hello(void);
+
+/**
+ * Send a loss summary now (flushes pending batched records first, so the
+ * counters cover everything the host received before it). src may be NULL
+ * when the caller has no receiver-side counters.
+ */
+bool usb_stream_send_loss_summary(const usb_stream_loss_src_t *src);
+
+/**
+ * Send a time anchor now (flushes pending batched records first). Reads
+ * hal_cycles_now64() even when the write fails, which keeps its wrap
+ * tracking current while the host is away.
+ */
+bool usb_stream_send_time_anchor(void);
+
+/**
+ * Send a ring occupancy snapshot for rb tagged with ring_id. Returns false
+ * (nothing sent) when ringbuf was built without RINGBUF_STATS.
+ */
+bool usb_stream_send_ring_stats(uint8_t ring_id, const ringbuf_u32_t *rb);
+
+/**
+ * Feed one byte received from the host; answers USB_STREAM_HELLO_REQUEST.
+ * Returns true if the byte was consumed.
+ */
+bool usb_stream_on_host_byte(uint8_t byte);
+
 /** Get internal counters. */
 const usb_stream_stats_t *usb_stream_stats(void);
 
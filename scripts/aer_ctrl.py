@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Runtime control of a running pico_aer_rx over its CDC port (usb_ctrl.h).
+
+Sends one "AERC" command frame and prints the HAL_STREAM_CTRL_RSP answer;
+event frames that arrive meanwhile are skipped. The tables below mirror
+usb_ctrl.h and host/aer_ctrl_client.c.
+
+    aer_ctrl.py ping
+    aer_ctrl.py get [name ...]
+    aer_ctrl.py set raw_words=1 batch_latency_us=500
+    aer_ctrl.py stats
+    aer_ctrl.py reset-stats
+    aer_ctrl.py hello
+"""
+import argparse
+import struct
+import sys
+import time
+
+import serial
+
+from print_events import (HAL_STREAM_CTRL_RSP, HAL_STREAM_HELLO, HELLO_REQUEST,
+                          FramedStreamReader, auto_find_port, parse_hello)
+
+CTRL_MAGIC = b"AERC"
+CTRL_VER = 1
+CTRL_HDR_FMT = "<4sBBHH"     # magic, ver, cmd, len, tag
+RSP_HDR_FMT = "<BBHB3x"      # ctrl_ver, cmd, tag, status
+KV_FMT = "<BI"
+MAX_PAYLOAD = 64
+
+CMD_PING, CMD_GET_PARAMS, CMD_SET_PARAMS, CMD_GET_STATS, CMD_RESET_STATS = range(5)
+
+STATUS_NAMES = ("ok", "bad_frame", "unknown_cmd", "unknown_param", "bad_value", "unavailable")
+
+# usb_ctrl_param_t order
+PARAM_NAMES = ("timestamps", "rowmask", "raw_words", "batch_max_bytes", "batch_latency_us",
+               "sink_enabled", "rx_overflow", "rx_bp_timeout_us", "rx_valid_timeout_us",
+               "rx_neutral_timeout_us")
+
+# GET_STATS body: counters in usb_ctrl_stat_t order; version 2 adds the main
+# loop tasks (aer_sched.h) with their cycles at cycles_hz
+STATS_VER = 2
+STATS_HDR_FMT_V1 = "<B3xQQ"
+STATS_HDR_FMT = "<BBBxQQI"
+STATS_TASK_FMT = "<8sIIII"
+STAT_NAMES = ("rx_words_ok", "rx_dropped_full", "rx_dropped_oldest", "rx_bp_stalls",
+              "rx_bp_timeouts", "rx_timeouts_valid", "rx_timeouts_neutral",
+              "bursts", "words_invalid", "cols_dropped",
+              "events_emitted", "events_send_failed", "mode_switches",
+              "events_sent", "raw_words_sent", "raw_words_dropped",
+              "frames_written", "frames_failed", "bytes_sent")
+
+
+def encode_cmd(cmd: int, tag: int, payload: bytes = b"") -> bytes:
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError("payload too long")
+    return struct.pack(CTRL_HDR_FMT, CTRL_MAGIC, CTRL_VER, cmd, len(payload), tag) + payload
+
+
+def param_key(name: str) -> int:
+    try:
+        return PARAM_NAMES.index(name)
+    except ValueError:
+        raise SystemExit(f"unknown parameter '{name}' (known: {', '.join(PARAM_NAMES)})")
+
+
+def param_name(key: int) -> str:
+    return PARAM_NAMES[key] if key < len(PARAM_NAMES) else f"param{key}"
+
+
+def parse_kv(body: bytes) -> list[tuple[int, int]]:
+    n = struct.calcsize(KV_FMT)
+    return [struct.unpack_from(KV_FMT, body, i) for i in range(0, len(body) - n + 1, n)]
+
+
+def format_kv(kv: list[tuple[int, int]]) -> str:
+    return "\n".join(f"{param_name(k)} = {v}" for k, v in kv)
+
+
+def format_stats(body: bytes) -> str:
+    ver = body[0] if body else 0
+    if ver == 1 and len(body) >= struct.calcsize(STATS_HDR_FMT_V1):
+        hdr = struct.calcsize(STATS_HDR_FMT_V1)
+        _, t_us, t_us_reset = struct.unpack_from(STATS_HDR_FMT_V1, body, 0)
+        n_counters, n_tasks, cycles_hz = (len(body) - hdr) // 4, 0, 0
+    elif ver == STATS_VER and len(body) >= struct.calcsize(STATS_HDR_FMT):
+        hdr = struct.calcsize(STATS_HDR_FMT)
+        _, n_counters, n_tasks, t_us, t_us_reset, cycles_hz = struct.unpack_from(STATS_HDR_FMT, body, 0)
+        if len(body) < hdr + 4 * n_counters + struct.calcsize(STATS_TASK_FMT) * n_tasks:
+            return f"short stats body: {body.hex()}"
+    else:
+        return f"unknown stats body: {body.hex()}"
+    counters = struct.unpack_from(f"<{n_counters}I", body, hdr)
+    lines = [f"over {(t_us - t_us_reset) / 1e6:.3f} s (device time {t_us / 1e6:.3f} s)"]
+    for i, v in enumerate(counters):
+        lines.append(f"{STAT_NAMES[i] if i < len(STAT_NAMES) else f'counter{i}'} = {v}")
+    off = hdr + 4 * n_counters
+    us = 1e6 / cycles_hz if cycles_hz else 0.0
+    for _ in range(n_tasks):
+        name, runs, overruns, cycles_max, interval_max = struct.unpack_from(STATS_TASK_FMT, body, off)
+        off += struct.calcsize(STATS_TASK_FMT)
+        name = name.rstrip(b"\0").decode(errors="replace")
+        lines.append(f"task {name:<8} runs {runs}  overruns {overruns}  "
+                     f"max {cycles_max * us:.2f} us  interval max {interval_max * us:.2f} us")
+    return "\n".join(lines)
+
+
+def transact(reader: FramedStreamReader, ser: serial.Serial, cmd: int, payload: bytes,
+             timeout: float) -> tuple[int, bytes] | None:
+    """Send one command; returns (status, body) of its response, or None on timeout."""
+    tag = int(time.monotonic() * 1000) & 0xFFFF
+    ser.write(encode_cmd(cmd, tag, payload))
+    deadline = time.monotonic() + timeout
+    while True:
+        pkt = reader.read_packet(deadline)
+        if pkt is None:
+            return None
+        _, ptype, data = pkt
+        if ptype == HAL_STREAM_HELLO:
+            hello = parse_hello(data)
+            if hello:
+                print(f"[hello] flags=0x{hello['flags']:02x} event_rec={hello['event_rec_type']} "
+                      f"burst_rec={hello['burst_rec_type']} "
+                      f"batch={hello['batch_max_bytes']}B/{hello['batch_max_latency_us']}us")
+            continue
+        if ptype != HAL_STREAM_CTRL_RSP or len(data) < struct.calcsize(RSP_HDR_FMT):
+            continue
+        ver, rcmd, rtag, status = struct.unpack_from(RSP_HDR_FMT, data, 0)
+        if ver == CTRL_VER and rcmd == cmd and rtag == tag:
+            return status, data[struct.calcsize(RSP_HDR_FMT):]
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Query and change pico_aer_rx settings at runtime (usb_ctrl.h).")
+    ap.add_argument("--port", default=None, help="Serial port (e.g., /dev/ttyACM0, COM5). If omitted, tries auto-detect.")
+    ap.add_argument("--baud", type=int, default=115200, help="Baud (ignored for USB CDC, but required by pyserial).")
+    ap.add_argument("--timeout", type=float, default=1.0, help="Seconds to wait for the response.")
+    ap.add_argument("command", choices=("ping", "hello", "get", "set", "stats", "reset-stats"))
+    ap.add_argument("args", nargs="*", help="get: parameter names (none = all); set: name=value ...")
+    args = ap.parse_args()
+
+    if args.command == "get":
+        cmd, payload = CMD_GET_PARAMS, bytes(param_key(n) for n in args.args)
+    elif args.command == "set":
+        if not args.args:
+            ap.error("set needs name=value")
+        payload = b""
+        for a in args.args:
+            name, sep, value = a.partition("=")
+            if not sep:
+                ap.error(f"expected name=value, got '{a}'")
+            payload += struct.pack(KV_FMT, param_key(name), int(value, 0))
+        cmd = CMD_SET_PARAMS
+    elif args.command in ("ping", "hello"):
+        cmd, payload = CMD_PING, b""
+    elif args.command == "stats":
+        cmd, payload = CMD_GET_STATS, b""
+    else:
+        cmd, payload = CMD_RESET_STATS, b""
+
+    port = args.port or auto_find_port()
+    if not port:
+        print("No serial ports found.")
+        sys.exit(1)
+
+    with serial.Serial(port, args.baud, timeout=0.1) as ser:
+        reader = FramedStreamReader(ser)
+        if args.command == "hello":
+            ser.write(HELLO_REQUEST)
+            deadline = time.monotonic() + args.timeout
+            while (pkt := reader.read_packet(deadline)) is not None:
+                if pkt[1] == HAL_STREAM_HELLO and (hello := parse_hello(pkt[2])):
+                    for k, v in hello.items():
+                        print(f"{k} = {v}")
+                    return
+            print("no HELLO received")
+            sys.exit(1)
+
+        rsp = transact(reader, ser, cmd, payload, args.timeout)
+        if rsp is None:
+            print("no response (firmware without the control channel?)")
+            sys.exit(1)
+        status, body = rsp
+        if status != 0:
+            what = f" ({format_kv(parse_kv(body))})" if body else ""
+            print(f"error: {STATUS_NAMES[status] if status < len(STATUS_NAMES) else status}{what}")
+            sys.exit(1)
+
+        if args.command == "ping":
+            (mask,) = struct.unpack_from("<I", body, 0)
+            print("available: " + ", ".join(param_name(k) for k in range(32) if mask & (1 << k)))
+        elif args.command in ("get", "set"):
+            print(format_kv(parse_kv(body)))
+        elif args.command == "stats":
+            print(format_stats(body))
+        else:
+            print("counters reset")
+
+
+if __name__ == "__main__":
+    main()
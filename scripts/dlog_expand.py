@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Expand deferred binary log records (HAL_STREAM_LOG_BIN, hal_dlog.h).
+
+The device sends message ids and raw 32-bit arguments; the formats live in
+dlog_table.json, generated next to hal_dlog_ids.h by scripts/gen_dlog_table.py
+(build/gen/ for the host build, the CMake binary dir for the firmware).
+
+As a tool it reads a framed AERS byte stream (e.g. aer_sim -o capture.bin,
+or a raw dump of the CDC port) from a file or stdin and prints the log:
+LOG_TEXT frames as they are, LOG_BIN records expanded. print_events.py
+--dlog-table uses the same functions on a live port.
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+MAGIC = b"AERS"
+HDR_LEN_V1 = 8   # magic(4) + ver(1) + type(1) + len(2)
+HDR_LEN_V2 = 10  # v1 + seq(2)
+
+# hal_stream_type_t (from hal_stdio.h)
+HAL_STREAM_LOG_TEXT = 1
+HAL_STREAM_HELLO = 5
+HAL_STREAM_TIME_ANCHOR = 8
+HAL_STREAM_LOG_BIN = 9
+
+# LOG_BIN payload (hal_dlog.h), version 1
+DLOG_HDR_FMT = "<BBHII"   # log_ver, nrec, rsvd, table_id, dropped
+DLOG_REC_FMT = "<HBBI"    # id, level, nargs, t_ticks; then u32 args[nargs]
+DLOG_VER = 1
+
+LEVEL_NAMES = {0: "E", 1: "W", 2: "I", 3: "D", 4: "T"}  # hal_log_level_t
+
+HELLO_TICK_HZ_OFF = 14    # tick_hz in the HELLO payload (usb_stream.h)
+ANCHOR_FMT = "<B3xIQQ"    # anchor_ver, tick_hz, t_ticks64, t_us
+
+# One C conversion; the length modifier is dropped before Python formatting.
+CONV_RE = re.compile(r"%(?:%|([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|l)?([diuxXoc]))")
+
+
+def load_table(path: str) -> dict:
+    """dlog_table.json -> {"table_id": int, "messages": {id: entry}}."""
+    with open(path, encoding="utf-8") as f:
+        t = json.load(f)
+    return {"table_id": t["table_id"], "messages": {m["id"]: m for m in t["messages"]}}
+
+
+def parse_log_bin(payload: bytes) -> dict | None:
+    """Decode a LOG_BIN payload; None if truncated or of an unknown version."""
+    hlen = struct.calcsize(DLOG_HDR_FMT)
+    if len(payload) < hlen:
+        return None
+    ver, nrec, _, table_id, dropped = struct.unpack_from(DLOG_HDR_FMT, payload, 0)
+    if ver != DLOG_VER:
+        return None
+    recs, i = [], hlen
+    for _ in range(nrec):
+        if i + 8 > len(payload):
+            return None
+        rid, level, nargs, t_ticks = struct.unpack_from(DLOG_REC_FMT, payload, i)
+        i += 8
+        if i + 4 * nargs > len(payload):
+            return None
+        args = list(struct.unpack_from(f"<{nargs}I", payload, i))
+        i += 4 * nargs
+        recs.append({"id": rid, "level": level, "t_ticks": t_ticks, "args": args})
+    return {"table_id": table_id, "dropped": dropped, "records": recs}
+
+
+def c_format(fmt: str, args: list[int]) -> str:
+    """printf() the way the device would have, for 32-bit integer arguments."""
+    it = iter(args)
+
+    def conv(m: re.Match) -> str:
+        if m.group(0) == "%%":
+            return "%"
+        flags, width, prec, length, c = m.groups()
+        v = next(it, 0)
+        bits = {"hh": 8, "h": 16}.get(length, 32)
+        v &= (1 << bits) - 1
+        if c in "di":
+            if v >= 1 << (bits - 1):
+                v -= 1 << bits
+            c = "d"
+        elif c == "u":
+            c = "d"
+        elif c == "c":
+            return f"%{flags}{width or ''}s" % chr(v & 0xFF)
+        spec = f"%{flags}{width or ''}{'.' + prec if prec is not None else ''}{c}"
+        return spec % v
+
+    return CONV_RE.sub(conv, fmt)
+
+
+def expand_record(table: dict | None, rec: dict) -> str:
+    """Message text for one record; raw id and arguments if the id is unknown."""
+    m = table["messages"].get(rec["id"]) if table else None
+    if m is None or m["nargs"] != len(rec["args"]):
+        return f"dlog#{rec['id']} " + " ".join(f"0x{a:x}" for a in rec["args"])
+    return c_format(m["fmt"], rec["args"])
+
+
+class DlogExpander:
+    """Per-stream state: table check, loss reporting and timestamps."""
+
+    def __init__(self, table: dict | None):
+        self.table = table
+        self.tick_hz = 0
+        self.anchor = None        # (t_ticks64, t_us)
+        self.dropped_prev = 0
+        self.warned_table = False
+
+    def on_hello(self, payload: bytes):
+        if len(payload) >= HELLO_TICK_HZ_OFF + 4:
+            self.tick_hz = struct.unpack_from("<I", payload, HELLO_TICK_HZ_OFF)[0]
+
+    def on_anchor(self, payload: bytes):
+        if len(payload) >= struct.calcsize(ANCHOR_FMT):
+            _, tick_hz, t64, t_us = struct.unpack_from(ANCHOR_FMT, payload, 0)
+            self.tick_hz = tick_hz or self.tick_hz
+            self.anchor = (t64, t_us)
+
+    def _time(self, t32: int) -> str:
+        if self.anchor and self.tick_hz:
+            d = (t32 - self.anchor[0]) & 0xFFFFFFFF
+            if d >= 0x80000000:
+                d -= 0x100000000
+            return f"{(self.anchor[0] + d) / self.tick_hz:.6f}s"
+        return f"t={t32}"
+
+    def lines(self, payload: bytes) -> list[str]:
+        """Printable lines for one LOG_BIN payload."""
+        f = parse_log_bin(payload)
+        if f is None:
+            return [f"[dlog] bad LOG_BIN payload ({len(payload)} bytes)"]
+        out = []
+        if self.table and f["table_id"] != self.table["table_id"] and not self.warned_table:
+            out.append(f"[dlog] warning: device table 0x{f['table_id']:08x} != "
+                       f"0x{self.table['table_id']:08x}; messages may be wrong")
+            self.warned_table = True
+        lost = (f["dropped"] - self.dropped_prev) & 0xFFFFFFFF
+        if lost:
+            out.append(f"[dlog] {lost} record(s) lost (ring full)")
+        self.dropped_prev = f["dropped"]
+        for r in f["records"]:
+            lvl = LEVEL_NAMES.get(r["level"], str(r["level"]))
+            out.append(f"[{self._time(r['t_ticks'])}][{lvl}] {expand_record(self.table, r)}")
+        return out
+
+
+def iter_frames(data: bytes):
+    """(ptype, payload) for each complete frame; resyncs on MAGIC."""
+    i = 0
+    while True:
+        i = data.find(MAGIC, i)
+        if i < 0 or i + HDR_LEN_V1 > len(data):
+            return
+        ver, ptype, plen = data[i + 4], data[i + 5], struct.unpack_from("<H", data, i + 6)[0]
+        hdr = HDR_LEN_V1 if ver < 2 else HDR_LEN_V2
+        if i + hdr + plen > len(data):
+            return
+        yield ptype, data[i + hdr:i + hdr + plen]
+        i += hdr + plen
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Print the device log from a framed AERS capture.")
+    ap.add_argument("capture", nargs="?", default="-", help="Capture file (default: stdin).")
+    ap.add_argument("--table", required=True, help="dlog_table.json from gen_dlog_table.py")
+    ap.add_argument("--stats", action="store_true", help="Print per-message counts at the end.")
+    args = ap.parse_args()
+
+    table = load_table(args.table)
+    data = sys.stdin.buffer.read() if args.capture == "-" else open(args.capture, "rb").read()
+
+    exp = DlogExpander(table)
+    counts = {}
+    for ptype, payload in iter_frames(data):
+        if ptype == HAL_STREAM_HELLO:
+            exp.on_hello(payload)
+        elif ptype == HAL_STREAM_TIME_ANCHOR:
+            exp.on_anchor(payload)
+        elif ptype == HAL_STREAM_LOG_TEXT:
+            print(payload.decode("utf-8", errors="replace").rstrip("\n"))
+        elif ptype == HAL_STREAM_LOG_BIN:
+            f = parse_log_bin(payload)
+            for r in (f["records"] if f else []):
+                counts[r["id"]] = counts.get(r["id"], 0) + 1
+            for line in exp.lines(payload):
+                print(line)
+
+    if args.stats:
+        for rid, n in sorted(counts.items()):
+            m = table["messages"].get(rid)
+            print(f"{n:8d}  {m['name'] if m else f'dlog#{rid}'}")
+
+
+if __name__ == "__main__":
+    main()
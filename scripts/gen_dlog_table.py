@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+"""Generate the deferred-log message table (hal_dlog.h) from the sources.
+
+Scans C sources for HAL_DLOG<n>(level, DLOG_NAME, "format", args...) sites
+and writes:
+  --header  hal_dlog_ids.h: DLOG_NAME ids and HAL_DLOG_TABLE_ID for the device
+  --table   dlog_table.json: id -> name, level, format, argument count, sites,
+            read by scripts/dlog_expand.py
+
+Ids are assigned in name order, so they only change when messages are added
+or removed; HAL_DLOG_TABLE_ID (CRC-32 of the table) travels in every LOG_BIN
+frame so the host can tell it has the wrong table. Files are only rewritten
+when their content changes.
+"""
+import argparse
+import json
+import re
+import sys
+import zlib
+from pathlib import Path
+
+TABLE_VER = 1
+MAX_ARGS = 4  # HAL_DLOG_MAX_ARGS
+
+SITE_RE = re.compile(r"\bHAL_DLOG([0-9])\s*\(")
+CONV_RE = re.compile(r"%(?:%|(?P<flags>[-+ #0]*)(?P<width>\d+|\*)?(?:\.(?P<prec>\d+|\*))?"
+                     r"(?P<len>hh|h|ll|l|j|z|t|L)?(?P<conv>.))")
+SUPPORTED_CONV = set("diuxXoc")
+SUPPORTED_LEN = {None, "hh", "h", "l"}
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", "\"": "\"", "'": "'",
+           "a": "\a", "b": "\b", "f": "\f", "v": "\v", "?": "?"}
+
+
+class SiteError(Exception):
+    pass
+
+
+def strip_comments(src: str) -> str:
+    """Blank out comments (keeping newlines, so line numbers hold) but not strings."""
+    out, i, n = [], 0, len(src)
+    while i < n:
+        c = src[i]
+        if c in "\"'":
+            j = i + 1
+            while j < n and src[j] != c:
+                j += 2 if src[j] == "\\" else 1
+            out.append(src[i:j + 1])
+            i = j + 1
+        elif src.startswith("//", i):
+            j = src.find("\n", i)
+            j = n if j < 0 else j
+            out.append(" " * (j - i))
+            i = j
+        elif src.startswith("/*", i):
+            j = src.find("*/", i + 2)
+            j = n if j < 0 else j + 2
+            out.append(re.sub(r"[^\n]", " ", src[i:j]))
+            i = j
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def split_args(src: str, start: int) -> list[str]:
+    """Top-level comma-separated arguments of the call whose '(' is at start - 1."""
+    args, depth, i, cur = [], 0, start, []
+    while i < len(src):
+        c = src[i]
+        if c in "\"'":
+            j = i + 1
+            while j < len(src) and src[j] != c:
+                j += 2 if src[j] == "\\" else 1
+            cur.append(src[i:j + 1])
+            i = j + 1
+            continue
+        if c in "([{":
+            depth += 1
+        elif c in ")]}":
+            if depth == 0:
+                args.append("".join(cur).strip())
+                return args
+            depth -= 1
+        elif c == "," and depth == 0:
+            args.append("".join(cur).strip())
+            cur = []
+            i += 1
+            continue
+        cur.append(c)
+        i += 1
+    raise SiteError("unterminated call")
+
+
+def unescape(body: str) -> str:
+    out, i = [], 0
+    while i < len(body):
+        c = body[i]
+        if c != "\\":
+            out.append(c)
+            i += 1
+            continue
+        e = body[i + 1]
+        if e == "x":
+            m = re.match(r"[0-9a-fA-F]+", body[i + 2:])
+            out.append(chr(int(m.group(0), 16)))
+            i += 2 + len(m.group(0))
+        elif e in "01234567":
+            m = re.match(r"[0-7]{1,3}", body[i + 1:])
+            out.append(chr(int(m.group(0), 8)))
+            i += 1 + len(m.group(0))
+        else:
+            out.append(ESCAPES.get(e, e))
+            i += 2
+    return "".join(out)
+
+
+def parse_format(arg: str) -> str:
+    """Concatenate adjacent string literals; anything else is an error."""
+    parts = re.findall(r'"((?:[^"\\]|\\.)*)"', arg)
+    if not parts or re.sub(r'"((?:[^"\\]|\\.)*)"', "", arg).strip():
+        raise SiteError("format must be a string literal")
+    return unescape("".join(parts))
+
+
+def count_conversions(fmt: str) -> int:
+    n = 0
+    for m in CONV_RE.finditer(fmt):
+        if m.group(0) == "%%":
+            continue
+        if (m.group("conv") not in SUPPORTED_CONV or m.group("len") not in SUPPORTED_LEN
+                or m.group("width") == "*" or m.group("prec") == "*"):
+            raise SiteError(f"unsupported conversion {m.group(0)!r} (32-bit integers and %c only)")
+        n += 1
+    return n
+
+
+def scan(paths: list[Path], root: Path) -> dict:
+    msgs = {}
+    for path in paths:
+        src = strip_comments(path.read_text(encoding="utf-8", errors="replace"))
+        try:
+            rel = path.resolve().relative_to(root).as_posix()
+        except ValueError:
+            rel = path.as_posix()
+        for m in SITE_RE.finditer(src):
+            line_start = src.rfind("\n", 0, m.start()) + 1
+            if re.fullmatch(r"\s*#\s*define\s+", src[line_start:m.start()]):
+                continue  # the macro definitions themselves
+            where = f"{rel}:{src.count(chr(10), 0, m.start()) + 1}"
+            try:
+                nargs = int(m.group(1))
+                args = split_args(src, m.end())
+                if len(args) < 3:
+                    raise SiteError("expected (level, id, format, ...)")
+                level, name = args[0], args[1]
+                if not re.fullmatch(r"DLOG_\w+", name):
+                    raise SiteError(f"id {name!r} must be a DLOG_* name")
+                fmt = parse_format(args[2])
+                if nargs > MAX_ARGS:
+                    raise SiteError(f"at most {MAX_ARGS} arguments")
+                if len(args) - 3 != nargs:
+                    raise SiteError(f"HAL_DLOG{nargs} with {len(args) - 3} arguments")
+                if count_conversions(fmt) != nargs:
+                    raise SiteError(f"format has {count_conversions(fmt)} conversions, {nargs} arguments")
+            except SiteError as e:
+                raise SiteError(f"{where}: {e}") from None
+
+            prev = msgs.get(name)
+            if prev and (prev["fmt"] != fmt or prev["nargs"] != nargs):
+                raise SiteError(f"{where}: {name} already used with another format at {prev['sites'][0]}")
+            if prev:
+                prev["sites"].append(where)
+            else:
+                msgs[name] = {"name": name, "level": level, "fmt": fmt, "nargs": nargs, "sites": [where]}
+    return msgs
+
+
+def build_table(msgs: dict) -> dict:
+    entries = [dict(id=i, **msgs[name]) for i, name in enumerate(sorted(msgs))]
+    key = json.dumps([[e["id"], e["name"], e["fmt"], e["nargs"]] for e in entries], separators=(",", ":"))
+    return {"table_ver": TABLE_VER, "table_id": zlib.crc32(key.encode()), "messages": entries}
+
+
+def render_header(table: dict) -> str:
+    lines = [
+        "// Generated by scripts/gen_dlog_table.py from the HAL_DLOG*() sites; do not edit.",
+        "#pragma once",
+        "",
+        f"#define HAL_DLOG_TABLE_ID 0x{table['table_id']:08X}u",
+        f"#define HAL_DLOG_NUM_IDS  {len(table['messages'])}u",
+        "",
+    ]
+    for e in table["messages"]:
+        lines.append(f"#define {e['name']} {e['id']}u")
+    return "\n".join(lines) + "\n"
+
+
+def write_if_changed(path: Path, text: str):
+    if path.exists() and path.read_text(encoding="utf-8") == text:
+        return
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_text(text, encoding="utf-8")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Generate the deferred-log id header and host table.")
+    ap.add_argument("--header", type=Path, required=True, help="hal_dlog_ids.h to write")
+    ap.add_argument("--table", type=Path, required=True, help="dlog_table.json to write")
+    ap.add_argument("--root", type=Path, default=Path.cwd(), help="Paths in the table are relative to this.")
+    ap.add_argument("sources", type=Path, nargs="+", help="C sources/headers to scan")
+    args = ap.parse_args()
+
+    try:
+        table = build_table(scan(args.sources, args.root.resolve()))
+    except SiteError as e:
+        print(f"gen_dlog_table: {e}", file=sys.stderr)
+        sys.exit(1)
+    write_if_changed(args.header, render_header(table))
+    write_if_changed(args.table, json.dumps(table, indent=2) + "\n")
+
+
+if __name__ == "__main__":
+    main()
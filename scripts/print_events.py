@@ -7,20 +7,148 @@ import serial
 from serial.tools import list_ports
 
 MAGIC = b"AERS"
-HDR_LEN = 8  # magic(4) + ver(1) + type(1) + len(2)
+HDR_LEN_V1 = 8   # magic(4) + ver(1) + type(1) + len(2)
+HDR_LEN_V2 = 10  # v1 + seq(2): u16 frame sequence number
 
 # hal_stream_type_t (from hal_stdio.h)
 HAL_STREAM_LOG_TEXT  = 1
 HAL_STREAM_EVENT_BIN = 2
 HAL_STREAM_RAW_BIN   = 3
 HAL_STREAM_MARKER    = 4
+HAL_STREAM_HELLO     = 5
+HAL_STREAM_LOSS      = 6
+HAL_STREAM_RING_STATS = 7
+HAL_STREAM_TIME_ANCHOR = 8
+HAL_STREAM_LOG_BIN   = 9
+HAL_STREAM_CTRL_RSP  = 10  # usb_ctrl.h responses, see aer_ctrl.py
 
 # usb_stream_event_rec_type_t (from usb_stream.h)
 USB_EVT_REC_V1_NOTS  = 1  # rec_type,u8 flags,u8 row,u8 col,u8
 USB_EVT_REC_V1_TICKS = 2  # above + u32 ticks
+USB_EVT_REC_V2_ROWMASK = 3  # rec_type,u8 flags,u8 row,u8 mask_bytes,u8 ticks,u32 col_mask,u8[mask_bytes]
+ROWMASK_HDR_LEN = 8
 
 USB_EVT_FLAG_ON = 0x01
 
+# HELLO descriptor (HAL_STREAM_HELLO payload, usb_stream.h), version 1
+HELLO_FMT = "<BBHHBBBBIIBBHI"
+HELLO_FIELDS = ("hello_ver", "frame_ver", "rows", "cols", "index_bits", "data_width_bits",
+                "event_rec_type", "burst_rec_type", "rec_types_mask", "tick_hz",
+                "flags", "rsvd", "batch_max_bytes", "batch_max_latency_us")
+HELLO_REQUEST = b"?"
+
+# Loss summary (HAL_STREAM_LOSS payload, usb_stream.h), version 1; counters are cumulative
+LOSS_FMT = "<B3xIIIIIIIIII"
+LOSS_FIELDS = ("loss_ver", "t_ticks", "frames_written", "frames_failed", "frames_not_connected",
+               "events_sent", "events_dropped_not_connected", "events_dropped_write_failed",
+               "ring_dropped", "burst_cols_dropped", "words_invalid")
+
+# Ring occupancy snapshot (HAL_STREAM_RING_STATS payload, usb_stream.h), version 1
+RING_STATS_FMT = "<BBBxIIIII"
+RING_STATS_FIELDS = ("ring_ver", "ring_id", "buckets", "slots", "level", "high_water",
+                     "push_full", "publishes")
+RING_NAMES = {0: "raw"}
+
+# Raw passthrough (HAL_STREAM_RAW_BIN payload, usb_stream.h), version 1; then
+# u16 words[nwords] and, with RAW_F_TICKS, u32 t_ticks[nwords]
+RAW_HDR_FMT = "<BBHI"   # raw_ver, flags, nwords, word_index
+RAW_F_TICKS = 0x01
+
+# Time anchor (HAL_STREAM_TIME_ANCHOR payload, usb_stream.h), version 1
+ANCHOR_FMT = "<B3xIQQ"
+ANCHOR_FIELDS = ("anchor_ver", "tick_hz", "t_ticks64", "t_us")
+
+
+def parse_hello(payload: bytes) -> dict | None:
+    """Decode a HELLO payload; trailing bytes from newer versions are ignored."""
+    if len(payload) < struct.calcsize(HELLO_FMT):
+        return None
+    return dict(zip(HELLO_FIELDS, struct.unpack_from(HELLO_FMT, payload, 0)))
+
+
+def parse_loss(payload: bytes) -> dict | None:
+    """Decode a loss summary payload; trailing bytes from newer versions are ignored."""
+    if len(payload) < struct.calcsize(LOSS_FMT):
+        return None
+    return dict(zip(LOSS_FIELDS, struct.unpack_from(LOSS_FMT, payload, 0)))
+
+
+def parse_ring_stats(payload: bytes) -> dict | None:
+    """Decode a ring stats payload; hist holds `buckets` u32 counts."""
+    base = struct.calcsize(RING_STATS_FMT)
+    if len(payload) < base:
+        return None
+    d = dict(zip(RING_STATS_FIELDS, struct.unpack_from(RING_STATS_FMT, payload, 0)))
+    if len(payload) < base + 4 * d["buckets"]:
+        return None
+    d["hist"] = list(struct.unpack_from(f"<{d['buckets']}I", payload, base))
+    return d
+
+
+def parse_anchor(payload: bytes) -> dict | None:
+    """Decode a time anchor payload; trailing bytes from newer versions are ignored."""
+    if len(payload) < struct.calcsize(ANCHOR_FMT):
+        return None
+    return dict(zip(ANCHOR_FIELDS, struct.unpack_from(ANCHOR_FMT, payload, 0)))
+
+
+class TickUnwrapper:
+    """Rebuilds 64-bit ticks from 32-bit t_ticks using the latest time anchor:
+    exact within +-2^31 ticks of the anchor (usb_stream.h)."""
+
+    def __init__(self):
+        self.anchor = None
+
+    def on_anchor(self, a: dict):
+        self.anchor = a
+
+    def unwrap(self, t32: int) -> int | None:
+        if self.anchor is None:
+            return None
+        base = self.anchor["t_ticks64"]
+        d = (t32 - base) & 0xFFFFFFFF
+        if d >= 0x80000000:
+            d -= 0x100000000
+        return base + d
+
+    def format(self, t32: int) -> str:
+        t64 = self.unwrap(t32)
+        if t64 is None or not self.anchor["tick_hz"]:
+            return f"ticks={t32}"
+        return f"ticks={t64} t={t64 / self.anchor['tick_hz']:.9f}s"
+
+
+def format_ring_stats(r: dict) -> str:
+    """One line: fill level, high-water mark and the non-empty histogram buckets
+    (bucket b covers levels [2^(b-1), 2^b); the last one is open-ended)."""
+    name = RING_NAMES.get(r["ring_id"], str(r["ring_id"]))
+    last = len(r["hist"]) - 1
+
+    def label(b: int) -> str:
+        if b == 0:
+            return "0"
+        return f">={1 << (b - 1)}" if b == last else f"<{1 << b}"
+
+    hist = " ".join(f"{label(b)}:{n}" for b, n in enumerate(r["hist"]) if n)
+    return (f"{name} level={r['level']}/{r['slots']} high_water={r['high_water']} "
+            f"push_full={r['push_full']} hist[{hist}]")
+
+
+def loss_delta(prev: dict | None, cur: dict) -> dict:
+    """Per-counter increase since the previous summary (u32 wrap-safe)."""
+    if prev is None:
+        return {k: cur[k] for k in LOSS_FIELDS[2:]}
+    return {k: (cur[k] - prev[k]) & 0xFFFFFFFF for k in LOSS_FIELDS[2:]}
+
+
+def format_loss(d: dict, seq_lost: int) -> str:
+    """One line: what was sent and where data went missing over the interval."""
+    usb_lost = d["events_dropped_not_connected"] + d["events_dropped_write_failed"]
+    return (f"sent={d['events_sent']} ev | ring_full={d['ring_dropped']} words "
+            f"invalid={d['words_invalid']} words cols_dropped={d['burst_cols_dropped']} "
+            f"usb_refused={usb_lost} ev frames_failed={d['frames_failed']} "
+            f"seq_gap={seq_lost} frames")
+
 
 def auto_find_port() -> str | None:
     """Try to auto-pick a likely Pico CDC port."""
@@ -46,6 +174,13 @@ class FramedStreamReader:
     def __init__(self, ser: serial.Serial):
         self.ser = ser
         self.buf = bytearray()
+        self.seq_next = None   # expected seq of the next v2 frame
+        self.seq_lost = 0      # frames missing according to seq gaps (cumulative)
+
+    def _track_seq(self, seq: int):
+        if self.seq_next is not None:
+            self.seq_lost += (seq - self.seq_next) & 0xFFFF
+        self.seq_next = (seq + 1) & 0xFFFF
 
     def _read_some(self):
         data = self.ser.read(self.ser.in_waiting or 1)
@@ -55,12 +190,14 @@ class FramedStreamReader:
     def _find_magic(self) -> int:
         return self.buf.find(MAGIC)
 
-    def read_packet(self):
+    def read_packet(self, deadline: float | None = None):
         """
-        Returns (ver:int, ptype:int, payload:bytes) or None if not enough data yet.
-        Resyncs on MAGIC.
+        Returns (ver:int, ptype:int, payload:bytes), or None once time.monotonic()
+        passes deadline (None = wait forever). Resyncs on MAGIC.
         """
         while True:
+            if deadline is not None and time.monotonic() >= deadline:
+                return None
             self._read_some()
 
             idx = self._find_magic()
@@ -74,28 +211,38 @@ class FramedStreamReader:
             if idx > 0:
                 del self.buf[:idx]
 
-            if len(self.buf) < HDR_LEN:
+            if len(self.buf) < HDR_LEN_V1:
                 continue
 
-            # Parse header: AERS, ver, type, len_le
-            # Header layout: magic[4], ver:u8, type:u8, len:u16le
+            # Parse header: AERS, ver, type, len_le[, seq_le]
+            # v1: magic[4], ver:u8, type:u8, len:u16le
+            # v2: v1 + seq:u16le
             ver = self.buf[4]
             ptype = self.buf[5]
             plen = struct.unpack_from("<H", self.buf, 6)[0]
+            hdr_len = HDR_LEN_V1 if ver < 2 else HDR_LEN_V2
 
-            total_len = HDR_LEN + plen
+            total_len = hdr_len + plen
             if len(self.buf) < total_len:
                 continue
 
-            payload = bytes(self.buf[HDR_LEN:total_len])
+            if ver >= 2:
+                self._track_seq(struct.unpack_from("<H", self.buf, 8)[0])
+            payload = bytes(self.buf[hdr_len:total_len])
             del self.buf[:total_len]
             return ver, ptype, payload
 
 
-def decode_and_print_events(payload: bytes, show_ticks: bool):
+def mask_to_cols(mask: bytes):
+    """Column indices set in a little-endian column bitmask, ascending."""
+    return [8 * b + bit for b, byte in enumerate(mask) for bit in range(8) if byte & (1 << bit)]
+
+
+def decode_and_print_events(payload: bytes, show_ticks: bool, clock: TickUnwrapper):
     """
     Payload is the inner bytes of HAL_STREAM_EVENT_BIN.
-    Your usb_stream sends 1 record per packet, but we allow multiple.
+    usb_stream sends one record per packet for single events and several
+    back-to-back records per packet for whole bursts.
     """
     i = 0
     while i < len(payload):
@@ -114,9 +261,21 @@ def decode_and_print_events(payload: bytes, show_ticks: bool):
             i += 8
             if flags & USB_EVT_FLAG_ON:
                 if show_ticks:
-                    print(f"ON  row={row:02d} col={col:02d}  ticks={ticks}")
+                    print(f"ON  row={row:02d} col={col:02d}  {clock.format(ticks)}")
                 else:
                     print(f"ON  row={row:02d} col={col:02d}")
+        elif rec_type == USB_EVT_REC_V2_ROWMASK:
+            if i + ROWMASK_HDR_LEN > len(payload):
+                return
+            _, flags, row, mask_bytes, ticks = struct.unpack_from("<BBBBI", payload, i)
+            if i + ROWMASK_HDR_LEN + mask_bytes > len(payload):
+                return
+            cols = mask_to_cols(payload[i + ROWMASK_HDR_LEN:i + ROWMASK_HDR_LEN + mask_bytes])
+            i += ROWMASK_HDR_LEN + mask_bytes
+            if flags & USB_EVT_FLAG_ON:
+                suffix = f"  {clock.format(ticks)}" if show_ticks else ""
+                for col in cols:
+                    print(f"ON  row={row:02d} col={col:02d}{suffix}")
         else:
             # Unknown record type: bail out so we don't desync the stream
             print(f"[warn] Unknown event record type {rec_type}; payload_len={len(payload)}")
@@ -128,9 +287,15 @@ def main():
     ap.add_argument("--port", default=None, help="Serial port (e.g., /dev/ttyACM0, COM5). If omitted, tries auto-detect.")
     ap.add_argument("--baud", type=int, default=115200, help="Baud (ignored for USB CDC, but required by pyserial).")
     ap.add_argument("--show-non-events", action="store_true", help="Print non-event packets (markers/logs) too.")
-    ap.add_argument("--show-ticks", action="store_true", help="Print cycle ticks timestamps when present.")
+    ap.add_argument("--show-ticks", action="store_true", help="Print cycle tick timestamps when present (64-bit and seconds once a time anchor arrived).")
+    ap.add_argument("--dlog-table", default=None, help="dlog_table.json (scripts/gen_dlog_table.py): print the device's binary log records.")
     args = ap.parse_args()
 
+    dlog = None
+    if args.dlog_table:
+        from dlog_expand import DlogExpander, load_table
+        dlog = DlogExpander(load_table(args.dlog_table))
+
     port = args.port or auto_find_port()
     if not port:
         print("No serial ports found.")
@@ -139,7 +304,11 @@ def main():
     print(f"Opening {port} ...")
     with serial.Serial(port, args.baud, timeout=0.1) as ser:
         reader = FramedStreamReader(ser)
+        ser.write(HELLO_REQUEST)  # device also sends HELLO on port open
         print("Listening (Ctrl+C to stop)...")
+        loss_prev, seq_lost_prev = None, 0
+        clock = TickUnwrapper()
+        raw_next = None
 
         try:
             while True:
@@ -149,7 +318,43 @@ def main():
                 ver, ptype, payload = pkt
 
                 if ptype == HAL_STREAM_EVENT_BIN:
-                    decode_and_print_events(payload, show_ticks=args.show_ticks)
+                    decode_and_print_events(payload, show_ticks=args.show_ticks, clock=clock)
+                elif ptype == HAL_STREAM_HELLO:
+                    hello = parse_hello(payload)
+                    if hello and dlog:
+                        dlog.on_hello(payload)
+                    if hello:
+                        print(f"[hello] {hello['rows']}x{hello['cols']} "
+                              f"event_rec={hello['event_rec_type']} burst_rec={hello['burst_rec_type']} "
+                              f"tick_hz={hello['tick_hz']} flags=0x{hello['flags']:02x} "
+                              f"batch={hello['batch_max_bytes']}B/{hello['batch_max_latency_us']}us")
+                elif ptype == HAL_STREAM_LOSS:
+                    loss = parse_loss(payload)
+                    if loss:
+                        d = loss_delta(loss_prev, loss)
+                        print(f"[loss] {format_loss(d, reader.seq_lost - seq_lost_prev)}")
+                        loss_prev, seq_lost_prev = loss, reader.seq_lost
+                elif ptype == HAL_STREAM_RING_STATS:
+                    ring = parse_ring_stats(payload)
+                    if ring:
+                        print(f"[ring] {format_ring_stats(ring)}")
+                elif ptype == HAL_STREAM_TIME_ANCHOR:
+                    anchor = parse_anchor(payload)
+                    if anchor:
+                        clock.on_anchor(anchor)
+                    if dlog:
+                        dlog.on_anchor(payload)
+                elif ptype == HAL_STREAM_RAW_BIN:
+                    # Decoding is host/aer_raw_dump's job (same codec as the device).
+                    if len(payload) >= struct.calcsize(RAW_HDR_FMT):
+                        _, flags, nwords, index = struct.unpack_from(RAW_HDR_FMT, payload, 0)
+                        gap = (index - raw_next) & 0xFFFFFFFF if raw_next is not None else 0
+                        raw_next = (index + nwords) & 0xFFFFFFFF
+                        print(f"[raw] {nwords} words @{index}{' +ticks' if flags & RAW_F_TICKS else ''}"
+                              f"{f'  ({gap} lost)' if gap else ''}")
+                elif ptype == HAL_STREAM_LOG_BIN and dlog:
+                    for line in dlog.lines(payload):
+                        print(line)
                 elif args.show_non_events:
                     # Helpful for debug if you enable markers/logs
                     if ptype in (HAL_STREAM_LOG_TEXT, HAL_STREAM_MARKER):
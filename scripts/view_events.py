@@ -9,20 +9,103 @@ from serial.tools import list_ports
 
 
 MAGIC = b"AERS"
-HDR_LEN = 8  # magic(4) + ver(1) + type(1) + len(2)
+HDR_LEN_V1 = 8   # magic(4) + ver(1) + type(1) + len(2)
+HDR_LEN_V2 = 10  # v1 + seq(2): u16 frame sequence number
 
 # hal_stream_type_t
 HAL_STREAM_LOG_TEXT  = 1
 HAL_STREAM_EVENT_BIN = 2
 HAL_STREAM_RAW_BIN   = 3
 HAL_STREAM_MARKER    = 4
+HAL_STREAM_HELLO     = 5
+HAL_STREAM_LOSS      = 6
+HAL_STREAM_RING_STATS = 7
 
 # usb_stream_event_rec_type_t
 USB_EVT_REC_V1_NOTS  = 1
 USB_EVT_REC_V1_TICKS = 2
+USB_EVT_REC_V2_ROWMASK = 3
+ROWMASK_HDR_LEN = 8  # rec_type, flags, row, mask_bytes, u32 ticks; then col_mask[mask_bytes]
 
 USB_EVT_FLAG_ON = 0x01
 
+# HELLO descriptor (HAL_STREAM_HELLO payload, usb_stream.h), version 1
+HELLO_FMT = "<BBHHBBBBIIBBHI"
+HELLO_FIELDS = ("hello_ver", "frame_ver", "rows", "cols", "index_bits", "data_width_bits",
+                "event_rec_type", "burst_rec_type", "rec_types_mask", "tick_hz",
+                "flags", "rsvd", "batch_max_bytes", "batch_max_latency_us")
+HELLO_REQUEST = b"?"
+
+# Loss summary (HAL_STREAM_LOSS payload, usb_stream.h), version 1; counters are cumulative
+LOSS_FMT = "<B3xIIIIIIIIII"
+LOSS_FIELDS = ("loss_ver", "t_ticks", "frames_written", "frames_failed", "frames_not_connected",
+               "events_sent", "events_dropped_not_connected", "events_dropped_write_failed",
+               "ring_dropped", "burst_cols_dropped", "words_invalid")
+
+# Ring occupancy snapshot (HAL_STREAM_RING_STATS payload, usb_stream.h), version 1
+RING_STATS_FMT = "<BBBxIIIII"
+RING_STATS_FIELDS = ("ring_ver", "ring_id", "buckets", "slots", "level", "high_water",
+                     "push_full", "publishes")
+RING_NAMES = {0: "raw"}
+
+
+def parse_hello(payload: bytes) -> dict | None:
+    """Decode a HELLO payload; trailing bytes from newer versions are ignored."""
+    if len(payload) < struct.calcsize(HELLO_FMT):
+        return None
+    return dict(zip(HELLO_FIELDS, struct.unpack_from(HELLO_FMT, payload, 0)))
+
+
+def parse_loss(payload: bytes) -> dict | None:
+    """Decode a loss summary payload; trailing bytes from newer versions are ignored."""
+    if len(payload) < struct.calcsize(LOSS_FMT):
+        return None
+    return dict(zip(LOSS_FIELDS, struct.unpack_from(LOSS_FMT, payload, 0)))
+
+
+def parse_ring_stats(payload: bytes) -> dict | None:
+    """Decode a ring stats payload; hist holds `buckets` u32 counts."""
+    base = struct.calcsize(RING_STATS_FMT)
+    if len(payload) < base:
+        return None
+    d = dict(zip(RING_STATS_FIELDS, struct.unpack_from(RING_STATS_FMT, payload, 0)))
+    if len(payload) < base + 4 * d["buckets"]:
+        return None
+    d["hist"] = list(struct.unpack_from(f"<{d['buckets']}I", payload, base))
+    return d
+
+
+def format_ring_stats(r: dict) -> str:
+    """One line: fill level, high-water mark and the non-empty histogram buckets
+    (bucket b covers levels [2^(b-1), 2^b); the last one is open-ended)."""
+    name = RING_NAMES.get(r["ring_id"], str(r["ring_id"]))
+    last = len(r["hist"]) - 1
+
+    def label(b: int) -> str:
+        if b == 0:
+            return "0"
+        return f">={1 << (b - 1)}" if b == last else f"<{1 << b}"
+
+    hist = " ".join(f"{label(b)}:{n}" for b, n in enumerate(r["hist"]) if n)
+    return (f"{name} level={r['level']}/{r['slots']} high_water={r['high_water']} "
+            f"push_full={r['push_full']} hist[{hist}]")
+
+
+def loss_delta(prev: dict | None, cur: dict) -> dict:
+    """Per-counter increase since the previous summary (u32 wrap-safe)."""
+    if prev is None:
+        return {k: cur[k] for k in LOSS_FIELDS[2:]}
+    return {k: (cur[k] - prev[k]) & 0xFFFFFFFF for k in LOSS_FIELDS[2:]}
+
+
+def format_loss(d: dict, seq_lost: int) -> str:
+    """One line: what was sent and where data went missing over the interval."""
+    usb_lost = d["events_dropped_not_connected"] + d["events_dropped_write_failed"]
+    return (f"sent={d['events_sent']} ev | ring_full={d['ring_dropped']} words "
+            f"invalid={d['words_invalid']} words cols_dropped={d['burst_cols_dropped']} "
+            f"usb_refused={usb_lost} ev frames_failed={d['frames_failed']} "
+            f"seq_gap={seq_lost} frames")
+
 
 def auto_find_port() -> str | None:
     ports = list(list_ports.comports())
@@ -45,6 +128,13 @@ class FramedStreamReader:
     def __init__(self, ser: serial.Serial):
         self.ser = ser
         self.buf = bytearray()
+        self.seq_next = None   # expected seq of the next v2 frame
+        self.seq_lost = 0      # frames missing according to seq gaps (cumulative)
+
+    def _track_seq(self, seq: int):
+        if self.seq_next is not None:
+            self.seq_lost += (seq - self.seq_next) & 0xFFFF
+        self.seq_next = (seq + 1) & 0xFFFF
 
     def _read_some(self):
         data = self.ser.read(self.ser.in_waiting or 1)
@@ -65,17 +155,20 @@ class FramedStreamReader:
             if idx > 0:
                 del self.buf[:idx]
 
-            if len(self.buf) < HDR_LEN:
+            if len(self.buf) < HDR_LEN_V1:
                 continue
 
             ver = self.buf[4]
             ptype = self.buf[5]
             plen = struct.unpack_from("<H", self.buf, 6)[0]
-            total = HDR_LEN + plen
+            hdr_len = HDR_LEN_V1 if ver < 2 else HDR_LEN_V2
+            total = hdr_len + plen
             if len(self.buf) < total:
                 continue
 
-            payload = bytes(self.buf[HDR_LEN:total])
+            if ver >= 2:
+                self._track_seq(struct.unpack_from("<H", self.buf, 8)[0])
+            payload = bytes(self.buf[hdr_len:total])
             del self.buf[:total]
             return ver, ptype, payload
 
@@ -105,6 +198,21 @@ def extract_on_events(payload: bytes):
             if flags & USB_EVT_FLAG_ON:
                 yield row, col
 
+        elif rec_type == USB_EVT_REC_V2_ROWMASK:
+            if i + ROWMASK_HDR_LEN > len(payload):
+                return
+            _, flags, row, mask_bytes, _ticks = struct.unpack_from("<BBBBI", payload, i)
+            end = i + ROWMASK_HDR_LEN + mask_bytes
+            if end > len(payload):
+                return
+            if flags & USB_EVT_FLAG_ON:
+                for b, byte in enumerate(payload[i + ROWMASK_HDR_LEN:end]):
+                    while byte:
+                        low = byte & -byte
+                        yield row, 8 * b + low.bit_length() - 1
+                        byte ^= low
+            i = end
+
         else:
             # Unknown record type; stop to avoid desync
             return
@@ -131,6 +239,7 @@ def main():
     print(f"Opening {port} ...")
     ser = serial.Serial(port, args.baud, timeout=0.0)
     reader = FramedStreamReader(ser)
+    ser.write(HELLO_REQUEST)  # device also sends HELLO on port open
 
     # 32x32 grid stores "last seen time" in seconds
     last_seen = [[-1.0 for _ in range(32)] for _ in range(32)]
@@ -141,6 +250,7 @@ def main():
     pygame.display.set_caption("AER 32x32 ON Events")
     clock = pygame.time.Clock()
 
+    loss_prev, seq_lost_prev = None, 0
     running = True
     try:
         while running:
@@ -162,6 +272,25 @@ def main():
                     break
 
                 ver, ptype, payload = reader.read_packet()
+                if ptype == HAL_STREAM_HELLO:
+                    hello = parse_hello(payload)
+                    if hello:
+                        print(f"[hello] {hello['rows']}x{hello['cols']} tick_hz={hello['tick_hz']}")
+                        if (hello["rows"], hello["cols"]) != (32, 32):
+                            print("[warn] viewer is fixed at 32x32; events outside are ignored")
+                    continue
+                if ptype == HAL_STREAM_LOSS:
+                    loss = parse_loss(payload)
+                    if loss:
+                        d = loss_delta(loss_prev, loss)
+                        print(f"[loss] {format_loss(d, reader.seq_lost - seq_lost_prev)}")
+                        loss_prev, seq_lost_prev = loss, reader.seq_lost
+                    continue
+                if ptype == HAL_STREAM_RING_STATS:
+                    ring = parse_ring_stats(payload)
+                    if ring:
+                        print(f"[ring] {format_ring_stats(ring)}")
+                    continue
                 if ptype != HAL_STREAM_EVENT_BIN:
                     continue
 
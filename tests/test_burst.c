@@ -167,7 +167,289 @@ static void test_col_overflow_warning(void)
 
     TASSERT_EQ_U32(emitted, (uint32_t)AER_COLS);
     TASSERT_EQ_U32(sink.n, (uint32_t)AER_COLS);
+#if AER_BURST_COL_BITMASK
+    /* The 5 extra words repeat columns 0..4: merged, never an overflow. */
+    TASSERT((aer_burst_errors(&b) & AER_BURST_WARN_COL_OVERFLOW) == 0u);
+    TASSERT((aer_burst_errors(&b) & AER_BURST_WARN_COL_DUP) != 0u);
+#else
     TASSERT((aer_burst_errors(&b) & AER_BURST_WARN_COL_OVERFLOW) != 0u);
+#endif
+}
+
+#if AER_BURST_COL_BITMASK
+static void test_col_bitmask_dedupe_sorted(void)
+{
+    aer_burst_t b;
+    aer_burst_init(&b);
+
+    event_sink_t sink = {0};
+
+    (void)aer_burst_feed(&b, make_ok_payload(3u), on_event, &sink);   /* ROW=3 */
+    const uint8_t cols[] = { 31u, 4u, 17u, 4u, 0u, 31u, 9u };
+    for (uint32_t i = 0; i < sizeof(cols); ++i) {
+        (void)aer_burst_feed(&b, make_ok_payload(cols[i]), on_event, &sink);
+    }
+    TASSERT_EQ_U32(b.col_count, 5u);
+
+    uint16_t emitted = aer_burst_feed(&b, make_tail(), on_event, &sink);
+    TASSERT_EQ_U32(emitted, 5u);
+    TASSERT_EQ_U32(sink.n, 5u);
+    const uint8_t want[] = { 0u, 4u, 9u, 17u, 31u };
+    for (uint32_t i = 0; i < sizeof(want); ++i) {
+        TASSERT_EQ_U8(sink.ev[i].row, 3u);
+        TASSERT_EQ_U8(sink.ev[i].col, want[i]);
+    }
+    TASSERT((aer_burst_errors(&b) & AER_BURST_WARN_COL_DUP) != 0u);
+
+    /* Mask is cleared for the next burst. */
+    for (uint32_t w = 0; w < AER_BURST_COL_MASK_WORDS; ++w) {
+        TASSERT_EQ_U32(b.col_mask[w], 0u);
+    }
+}
+#endif
+
+/* ---------------- span capture ---------------- */
+
+typedef struct {
+    uint32_t calls;
+    uint8_t  row;
+    uint8_t  cols[AER_COLS];
+    uint16_t count;
+    aer_burst_info_t info;
+} span_sink_t;
+
+static void on_span(uint8_t row, const uint8_t* cols, uint16_t count,
+                    const aer_burst_info_t* info, void* user)
+{
+    span_sink_t* s = (span_sink_t*)user;
+    s->calls++;
+    s->row = row;
+    s->count = count;
+    for (uint16_t i = 0; i < count && i < (uint16_t)AER_COLS; ++i) s->cols[i] = cols[i];
+    s->info = *info;
+}
+
+static void test_span_callback(void)
+{
+    aer_burst_t b;
+    aer_burst_init(&b);
+
+    span_sink_t span = {0};
+
+    (void)aer_burst_feed_span(&b, make_ok_payload(4u), on_span, &span);  /* ROW=4 */
+    (void)aer_burst_feed_span(&b, make_ok_payload(1u), on_span, &span);  /* COL=1 */
+    (void)aer_burst_feed_span(&b, make_ok_payload(30u), on_span, &span); /* COL=30 */
+    (void)aer_burst_feed_span(&b, make_ok_payload(2u), on_span, &span);  /* COL=2 */
+    TASSERT_EQ_U32(span.calls, 0u);
+
+    uint16_t emitted = aer_burst_feed_span(&b, make_tail(), on_span, &span);
+    TASSERT_EQ_U32(emitted, 3u);
+    TASSERT_EQ_U32(span.calls, 1u);
+    TASSERT_EQ_U8(span.row, 4u);
+    TASSERT_EQ_U32(span.count, 3u);
+#if AER_BURST_COL_BITMASK
+    TASSERT_EQ_U8(span.cols[0], 1u);
+    TASSERT_EQ_U8(span.cols[1], 2u);
+    TASSERT_EQ_U8(span.cols[2], 30u);
+    TASSERT(span.info.col_mask != NULL);
+#else
+    TASSERT_EQ_U8(span.cols[0], 1u);
+    TASSERT_EQ_U8(span.cols[1], 30u);
+    TASSERT_EQ_U8(span.cols[2], 2u);
+    TASSERT(span.info.col_mask == NULL);
+#endif
+    TASSERT_EQ_U32(span.info.seq, 0u);
+    TASSERT_EQ_U32(span.info.cols_dropped, 0u);
+    TASSERT_EQ_U32(b.events_emitted, 3u);
+
+    /* Second burst repeats columns past AER_COLS words. */
+    (void)aer_burst_feed_span(&b, make_ok_payload(7u), on_span, &span);
+    for (uint32_t i = 0; i < (uint32_t)AER_COLS + 3u; ++i) {
+        (void)aer_burst_feed_span(&b, make_ok_payload((uint8_t)(i & 0x1Fu)), on_span, &span);
+    }
+    emitted = aer_burst_feed_span(&b, make_tail(), on_span, &span);
+    TASSERT_EQ_U32(emitted, (uint32_t)AER_COLS);
+    TASSERT_EQ_U32(span.calls, 2u);
+    TASSERT_EQ_U8(span.row, 7u);
+    TASSERT_EQ_U32(span.info.seq, 1u);
+#if AER_BURST_COL_BITMASK
+    /* Merged, nothing lost. */
+    TASSERT_EQ_U32(span.info.cols_dropped, 0u);
+    TASSERT_EQ_U32(b.cols_dropped_total, 0u);
+    TASSERT((span.info.err_flags & AER_BURST_WARN_COL_DUP) != 0u);
+#else
+    /* Overflow: metadata reports the dropped columns, the total keeps them. */
+    TASSERT_EQ_U32(span.info.cols_dropped, 3u);
+    TASSERT_EQ_U32(b.cols_dropped_total, 3u);
+    TASSERT((span.info.err_flags & AER_BURST_WARN_COL_OVERFLOW) != 0u);
+#endif
+
+    /* Adapter fans a span out to per-event callbacks in order. */
+    event_sink_t sink = {0};
+    aer_burst_event_adapter_t a = { on_event, &sink };
+    const uint8_t cols[3] = { 9u, 0u, 5u };
+    aer_burst_span_to_events(6u, cols, 3u, &span.info, &a);
+    TASSERT_EQ_U32(sink.n, 3u);
+    TASSERT_EQ_U8(sink.ev[0].row, 6u);
+    TASSERT_EQ_U8(sink.ev[0].col, 9u);
+    TASSERT_EQ_U8(sink.ev[2].col, 5u);
+}
+
+/* Fused raw path must match decode + feed on every word, including invalid,
+ * neutral, and out-of-range ones, across both parser states.
+ */
+static void test_feed_raw_matches_two_step(void)
+{
+    aer_burst_t a, b;
+    aer_burst_init(&a);
+    aer_burst_init(&b);
+
+    event_sink_t sink_a = {0};
+    event_sink_t sink_b = {0};
+
+    uint32_t seed = 0xC0FFEEu;
+    for (uint32_t i = 0; i < 20000u; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+
+        aer_raw_word_t raw = 0u;
+        const uint8_t payload = (uint8_t)((seed >> 8) % 8u == 0u
+            ? AER_TAIL_PAYLOAD : ((seed >> 11) & ((1u << AER_INDEX_BITS) - 1u)));
+        (void)aer_encode_payload(payload, &raw, NULL);
+
+        switch ((seed >> 20) % 16u) {
+            case 0u: raw ^= (aer_raw_word_t)(1u << ((seed >> 24) % AER_DATA_WIDTH)); break;
+            case 1u: raw = 0u; break;
+            case 2u: raw |= (aer_raw_word_t)(1u << AER_DATA_WIDTH); break;
+            default: break;
+        }
+
+        const uint16_t ea = aer_burst_feed(&a, aer_decode_word(raw), on_event, &sink_a);
+        const uint16_t eb = aer_burst_feed_raw(&b, raw, on_event, &sink_b);
+        TASSERT_EQ_U32(ea, eb);
+        TASSERT(aer_burst_state(&a) == aer_burst_state(&b));
+
+        /* Keep the capture buffers from saturating. */
+        if (sink_a.n > 512u || sink_b.n > 512u) {
+            TASSERT_EQ_U32(sink_a.n, sink_b.n);
+            for (uint32_t k = 0; k < sink_a.n && k < sink_b.n; ++k) {
+                TASSERT_EQ_U8(sink_a.ev[k].row, sink_b.ev[k].row);
+                TASSERT_EQ_U8(sink_a.ev[k].col, sink_b.ev[k].col);
+            }
+            sink_a.n = 0u;
+            sink_b.n = 0u;
+        }
+    }
+
+    TASSERT_EQ_U32(sink_a.n, sink_b.n);
+    TASSERT_EQ_U32(a.err_flags, b.err_flags);
+    TASSERT_EQ_U32(a.bursts_completed, b.bursts_completed);
+    TASSERT_EQ_U32(a.events_emitted, b.events_emitted);
+    TASSERT_EQ_U32(a.words_ignored, b.words_ignored);
+    TASSERT(a.words_ignored > 0u);
+}
+
+/* Array feed (ring span drain) must match the per-word fused path,
+ * whatever the chunking. Both paths are fed chunk by chunk and compared
+ * per chunk, so every event (incl. bursts split across chunks) is checked
+ * without outgrowing event_sink_t.
+ */
+static void test_feed_raw_words_matches_single(void)
+{
+    static aer_raw_word_t words[4096];
+    uint32_t seed = 0xBADC0DEu;
+    for (uint32_t i = 0; i < 4096u; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const uint8_t payload = (uint8_t)((seed >> 8) % 6u == 0u
+            ? AER_TAIL_PAYLOAD : ((seed >> 11) & ((1u << AER_INDEX_BITS) - 1u)));
+        (void)aer_encode_payload(payload, &words[i], NULL);
+        if ((seed >> 20) % 16u == 0u) words[i] = 0u;
+    }
+
+    aer_burst_t a, b;
+    aer_burst_init(&a);
+    aer_burst_init(&b);
+    static event_sink_t sink_a, sink_b;
+    aer_burst_event_adapter_t ad_a = { on_event, &sink_a };
+    aer_burst_event_adapter_t ad_b = { on_event, &sink_b };
+    const uint32_t cap = (uint32_t)(sizeof(sink_a.ev) / sizeof(sink_a.ev[0]));
+
+    uint32_t ea = 0u, eb = 0u, total = 0u;
+    size_t off = 0u, chunk = 1u;
+    while (off < 4096u) {
+        const size_t n = (4096u - off < chunk) ? 4096u - off : chunk;
+        sink_a.n = 0u;
+        sink_b.n = 0u;
+        for (size_t i = off; i < off + n; ++i) {
+            ea += aer_burst_feed_raw_span(&a, words[i], aer_burst_span_to_events, &ad_a);
+        }
+        eb += aer_burst_feed_raw_words_span(&b, &words[off], n, aer_burst_span_to_events, &ad_b);
+
+        TASSERT(sink_a.n < cap);
+        TASSERT_EQ_U32(sink_a.n, sink_b.n);
+        for (uint32_t k = 0; k < sink_a.n && k < sink_b.n; ++k) {
+            TASSERT_EQ_U8(sink_a.ev[k].row, sink_b.ev[k].row);
+            TASSERT_EQ_U8(sink_a.ev[k].col, sink_b.ev[k].col);
+        }
+        total += sink_a.n;
+        off += n;
+        chunk = chunk * 3u % 97u + 1u;
+    }
+
+    TASSERT_EQ_U32(ea, eb);
+    TASSERT(ea > 0u);
+    TASSERT_EQ_U32(total, ea);
+    TASSERT_EQ_U32(a.words_ignored, b.words_ignored);
+    TASSERT_EQ_U32(a.bursts_completed, b.bursts_completed);
+    TASSERT_EQ_U32(aer_burst_feed_raw_words_span(&b, NULL, 4u, NULL, NULL), 0u);
+}
+
+/* Timed feed: the row word's time and the tail's time reach the callback;
+ * list mode also carries one time per column, in the column order.
+ */
+static void test_feed_raw_words_ts(void)
+{
+    aer_raw_word_t words[6];
+    const uint8_t payloads[6] = { 5u, 3u, 17u, 3u, (uint8_t)AER_TAIL_PAYLOAD, 9u };
+    for (uint32_t i = 0; i < 6u; ++i) (void)aer_encode_payload(payloads[i], &words[i], NULL);
+    const uint32_t ts[5] = { 1000u, 1010u, 1020u, 1030u, 1040u };
+#if AER_BURST_COL_BITMASK
+    const uint32_t n_cols = 2u;   /* repeated column merged */
+#else
+    const uint32_t n_cols = 3u;
+#endif
+
+    aer_burst_t b;
+    aer_burst_init(&b);
+    span_sink_t span = {0};
+
+    TASSERT_EQ_U32(aer_burst_feed_raw_words_ts_span(&b, words, ts, 5u, on_span, &span), n_cols);
+    TASSERT_EQ_U32(span.calls, 1u);
+    TASSERT_EQ_U8(span.row, 5u);
+    TASSERT(span.info.timed);
+    TASSERT_EQ_U32(span.info.t_row, 1000u);
+    TASSERT_EQ_U32(span.info.t_tail, 1040u);
+#if AER_BURST_COL_BITMASK
+    TASSERT(span.info.col_t == NULL);
+#else
+    TASSERT(span.info.col_t != NULL);
+    if (span.info.col_t) {
+        TASSERT_EQ_U32(span.info.col_t[0], 1010u);
+        TASSERT_EQ_U32(span.info.col_t[1], 1020u);
+        TASSERT_EQ_U32(span.info.col_t[2], 1030u);
+    }
+#endif
+
+    /* Untimed feeds report untimed bursts. */
+    const aer_raw_word_t untimed[3] = { words[5], words[1], words[4] };
+    TASSERT_EQ_U32(aer_burst_feed_raw_words_span(&b, untimed, 3u, on_span, &span), 1u);
+    TASSERT_EQ_U32(span.calls, 2u);
+    TASSERT_EQ_U8(span.row, 9u);
+    TASSERT(!span.info.timed);
+    TASSERT(span.info.col_t == NULL);
+
+    /* NULL times fall back to the untimed path. */
+    TASSERT_EQ_U32(aer_burst_feed_raw_words_ts_span(&b, words, NULL, 5u, on_span, &span), n_cols);
+    TASSERT(!span.info.timed);
 }
 
 int main(void)
@@ -177,9 +459,16 @@ int main(void)
     test_multi_col_burst();
     test_invalid_words_ignored();
     test_col_overflow_warning();
+    test_feed_raw_matches_two_step();
+    test_span_callback();
+    test_feed_raw_words_matches_single();
+    test_feed_raw_words_ts();
+#if AER_BURST_COL_BITMASK
+    test_col_bitmask_dedupe_sorted();
+#endif
 
     if (g_failures == 0) {
-        printf("[PASS] test_burst\n");
+        printf("[PASS] test_burst (%s cols)\n", AER_BURST_COL_BITMASK ? "bitmask" : "list");
         return 0;
     }
 
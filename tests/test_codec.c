@@ -188,9 +188,52 @@ static void test_codec_core_cases(void)
     }
 }
 
+/* Both decoder implementations must agree bit-for-bit on every masked raw word,
+ * and on words carrying out-of-range bits above the DATA bus.
+ */
+static bool results_equal(aer_codec_result_t a, aer_codec_result_t b)
+{
+    return a.ok == b.ok && a.payload == b.payload &&
+           a.is_tail == b.is_tail && a.err_flags == b.err_flags;
+}
+
+static void test_codec_lut_matches_loop(void)
+{
+#if AER_CODEC_LUT_AVAILABLE
+    const uint32_t n_words = 1u << AER_DATA_WIDTH;
+    uint32_t mismatches = 0u;
+
+    for (uint32_t raw = 0u; raw < n_words; ++raw) {
+        if (!results_equal(aer_decode_word_lut(raw), aer_decode_word_loop(raw))) {
+            if (mismatches++ < 8u) {
+                fprintf(stderr, "[FAIL] lut/loop mismatch at raw=0x%03x\n", (unsigned)raw);
+            }
+        }
+    }
+
+    /* Out-of-range bits (every bit above the bus, plus all-ones). */
+    for (uint32_t raw = 0u; raw < n_words; raw += 7u) {
+        for (uint32_t bit = AER_DATA_WIDTH; bit < 32u; ++bit) {
+            const aer_raw_word_t w = (aer_raw_word_t)(raw | (1u << bit));
+            if (!results_equal(aer_decode_word_lut(w), aer_decode_word_loop(w))) {
+                if (mismatches++ < 8u) {
+                    fprintf(stderr, "[FAIL] lut/loop mismatch at raw=0x%08x\n", (unsigned)w);
+                }
+            }
+        }
+    }
+    if (!results_equal(aer_decode_word_lut(0xFFFFFFFFu), aer_decode_word_loop(0xFFFFFFFFu))) {
+        ++mismatches;
+    }
+
+    TASSERT_EQ_U32(mismatches, 0u);
+#endif
+}
+
 int main(void)
 {
     test_codec_core_cases();
+    test_codec_lut_matches_loop();
 
     /* Golden vector files. (Run from repo root so paths resolve.) */
     run_codec_vectors("tests/vectors/codec_valid.txt");
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../common/include/aer_cfg.h"
+#include "../common/include/aer_types.h"
+#include "../common/include/aer_codec.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+/* ---------------- input generation ---------------- */
+
+static uint32_t xorshift32(uint32_t* s)
+{
+    uint32_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *s = x;
+    return x;
+}
+
+/* Every masked word, then random words (some with out-of-range bits), then a
+ * mostly-valid stream; an odd total length exercises the scalar tails.
+ */
+static size_t build_inputs(aer_raw_word_t* out, size_t cap)
+{
+    size_t n = 0u;
+    for (uint32_t raw = 0u; raw <= (uint32_t)AER_RAW_MASK && n < cap; ++raw) {
+        out[n++] = raw;
+    }
+
+    uint32_t seed = 0xC0FFEEu;
+    for (uint32_t i = 0u; i < 3001u && n < cap; ++i) {
+        const uint32_t r = xorshift32(&seed);
+        out[n++] = (i % 5u == 0u) ? r : (r & (uint32_t)AER_RAW_MASK);
+    }
+
+    for (uint32_t i = 0u; i < 2003u && n < cap; ++i) {
+        const uint32_t r = xorshift32(&seed);
+        aer_raw_word_t raw = 0u;
+        (void)aer_encode_payload((uint8_t)(r & ((1u << AER_PAYLOAD_BITS) - 1u)), &raw, NULL);
+        out[n++] = raw;
+    }
+    return n;
+}
+
+/* ---------------- tests ---------------- */
+
+static const aer_codec_batch_impl_t k_impls[] = {
+    AER_CODEC_BATCH_AUTO, AER_CODEC_BATCH_SCALAR, AER_CODEC_BATCH_SSE2, AER_CODEC_BATCH_AVX2,
+};
+
+static void test_batch_matches_scalar_decoder(const aer_raw_word_t* in, size_t n)
+{
+    aer_codec_result_t* out = (aer_codec_result_t*)malloc(n * sizeof(*out));
+    uint8_t* payload = (uint8_t*)malloc(n);
+    uint8_t* status  = (uint8_t*)malloc(n);
+    TASSERT(out && payload && status);
+    if (!out || !payload || !status) { free(out); free(payload); free(status); return; }
+
+    size_t expect_ok = 0u;
+    for (size_t i = 0u; i < n; ++i) {
+        expect_ok += aer_decode_word_loop(in[i]).ok ? 1u : 0u;
+    }
+
+    for (size_t k = 0u; k < sizeof(k_impls) / sizeof(k_impls[0]); ++k) {
+        const aer_codec_batch_impl_t impl = k_impls[k];
+        if (!aer_codec_batch_impl_available(impl)) {
+            printf("  (impl %d not available, skipped)\n", (int)impl);
+            continue;
+        }
+
+        memset(out, 0xA5, n * sizeof(*out));
+        memset(payload, 0xA5, n);
+        memset(status, 0xA5, n);
+
+        const size_t ok_aos = aer_decode_words_impl(impl, in, n, out);
+        const size_t ok_soa = aer_decode_words_soa_impl(impl, in, n, payload, status);
+        TASSERT_EQ_U32(ok_aos, expect_ok);
+        TASSERT_EQ_U32(ok_soa, expect_ok);
+
+        uint32_t mismatches = 0u;
+        for (size_t i = 0u; i < n; ++i) {
+            const aer_codec_result_t ref = aer_decode_word_loop(in[i]);
+            const uint8_t ref_st = (uint8_t)((ref.ok ? AER_CODEC_ST_OK : 0u) |
+                                             (ref.is_tail ? AER_CODEC_ST_TAIL : 0u) |
+                                             (ref.err_flags << AER_CODEC_ST_ERR_SHIFT));
+
+            const bool same = out[i].ok == ref.ok && out[i].payload == ref.payload &&
+                              out[i].is_tail == ref.is_tail && out[i].err_flags == ref.err_flags &&
+                              payload[i] == ref.payload && status[i] == ref_st;
+            if (!same && mismatches++ < 8u) {
+                fprintf(stderr, "[FAIL] impl %d: mismatch at i=%zu raw=0x%08x "
+                        "(aos ok=%d p=%u err=0x%x | soa p=%u st=0x%02x | ref ok=%d p=%u err=0x%x)\n",
+                        (int)impl, i, (unsigned)in[i],
+                        (int)out[i].ok, out[i].payload, (unsigned)out[i].err_flags,
+                        payload[i], status[i],
+                        (int)ref.ok, ref.payload, (unsigned)ref.err_flags);
+            }
+        }
+        TASSERT_EQ_U32(mismatches, 0u);
+        TASSERT(aer_codec_status_err((uint8_t)(AER_CODEC_ERR_MULTI_HOT << AER_CODEC_ST_ERR_SHIFT))
+                == AER_CODEC_ERR_MULTI_HOT);
+    }
+
+    free(out);
+    free(payload);
+    free(status);
+}
+
+static void test_batch_short_and_empty(void)
+{
+    aer_raw_word_t raw[3] = {0u, 0u, 0u};
+    (void)aer_encode_payload(5u, &raw[0], NULL);
+    (void)aer_encode_payload((uint8_t)AER_TAIL_PAYLOAD, &raw[2], NULL);
+
+    aer_codec_result_t out[3];
+    TASSERT_EQ_U32(aer_decode_words(raw, 0u, out), 0u);
+    TASSERT_EQ_U32(aer_decode_words(NULL, 3u, out), 0u);
+    TASSERT_EQ_U32(aer_decode_words(raw, 3u, out), 2u);
+    TASSERT(out[0].ok && out[0].payload == 5u);
+    TASSERT(!out[1].ok && (out[1].err_flags & AER_CODEC_ERR_NEUTRAL) != 0u);
+    TASSERT(out[2].ok && out[2].is_tail);
+}
+
+/* SoA AUTO stays on the table path when there is one (faster than SIMD there). */
+static void test_auto_impls(void)
+{
+    TASSERT(aer_codec_batch_impl_available(aer_codec_batch_impl_active()));
+    TASSERT(aer_codec_batch_impl_available(aer_codec_batch_soa_impl_active()));
+#if AER_CODEC_USE_LUT
+    TASSERT_EQ_U32(aer_codec_batch_soa_impl_active(), AER_CODEC_BATCH_SCALAR);
+#else
+    TASSERT_EQ_U32(aer_codec_batch_soa_impl_active(), aer_codec_batch_impl_active());
+#endif
+}
+
+int main(void)
+{
+    enum { CAP = 16384 };
+    aer_raw_word_t* in = (aer_raw_word_t*)malloc(CAP * sizeof(*in));
+    if (!in) return 1;
+    const size_t n = build_inputs(in, CAP);
+
+    test_batch_matches_scalar_decoder(in, n);
+    /* Misaligned start + odd length. */
+    test_batch_matches_scalar_decoder(in + 1, n - 2u);
+    test_batch_short_and_empty();
+    test_auto_impls();
+
+    free(in);
+
+    if (g_failures == 0) {
+        printf("[PASS] test_codec_batch (auto impl %d, soa %d)\n", (int)aer_codec_batch_impl_active(),
+               (int)aer_codec_batch_soa_impl_active());
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_codec_batch: %d failures\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,193 @@
+#define _POSIX_C_SOURCE 200809L /* pthreads, sched_yield() */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../common/include/aer_event_ring.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+/* Deterministic event for sequence number i. */
+static aer_event_rec_t make_ev(uint32_t i)
+{
+    aer_event_rec_t e;
+    e.row = (uint8_t)(i % 32u);
+    e.col = (uint8_t)((i / 32u) % 32u);
+    e.flags = (uint8_t)(1u + (i & 1u));
+    e.rsvd = 0u;
+    e.t_ticks = i * 2654435761u;
+    return e;
+}
+
+static bool ev_eq(const aer_event_rec_t* a, const aer_event_rec_t* b)
+{
+    return a->row == b->row && a->col == b->col && a->flags == b->flags && a->t_ticks == b->t_ticks;
+}
+
+static void test_push_pop(void)
+{
+    aer_event_rec_t storage[4];
+    aer_event_ring_t rb;
+    TASSERT(!aer_event_ring_init(&rb, storage, 3u));
+    TASSERT(aer_event_ring_init(&rb, storage, 4u));
+    TASSERT_EQ_U32(aer_event_ring_capacity(&rb), 4u);
+
+    aer_event_rec_t out = {0};
+    TASSERT(!aer_event_ring_pop(&rb, &out));
+
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        TASSERT(aer_event_ring_push(&rb, make_ev(i)));
+    }
+    TASSERT(!aer_event_ring_push(&rb, make_ev(99u)));
+    TASSERT_EQ_U32(aer_event_ring_count(&rb), 4u);
+
+    TASSERT(aer_event_ring_peek(&rb, &out));
+    aer_event_rec_t e0 = make_ev(0u);
+    TASSERT(ev_eq(&out, &e0));
+
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        aer_event_rec_t want = make_ev(i);
+        TASSERT(aer_event_ring_pop(&rb, &out));
+        TASSERT(ev_eq(&out, &want));
+    }
+    TASSERT_EQ_U32(aer_event_ring_free(&rb), 4u);
+}
+
+static void test_claim_commit(void)
+{
+    aer_event_rec_t storage[8];
+    aer_event_ring_t rb;
+    TASSERT(aer_event_ring_init(&rb, storage, 8u));
+
+    /* Move the indices to slot 6 so the claims wrap. */
+    aer_event_rec_t out = {0};
+    for (uint32_t i = 0u; i < 6u; ++i) {
+        TASSERT(aer_event_ring_push(&rb, make_ev(i)));
+        TASSERT(aer_event_ring_pop(&rb, &out));
+    }
+
+    aer_event_ring_span_t ws;
+    TASSERT_EQ_U32(aer_event_ring_write_claim(&rb, &ws), 8u);
+    TASSERT(ws.ptr[0] == &storage[6]);
+    TASSERT_EQ_U32(ws.len[0], 2u);
+    TASSERT(ws.ptr[1] == &storage[0]);
+    TASSERT_EQ_U32(ws.len[1], 6u);
+
+    /* Produce 5 in place: 2 at the end, 3 wrapped. */
+    uint32_t k = 100u;
+    for (uint32_t i = 0u; i < 2u; ++i) ws.ptr[0][i] = make_ev(k++);
+    for (uint32_t i = 0u; i < 3u; ++i) ws.ptr[1][i] = make_ev(k++);
+    aer_event_ring_write_commit(&rb, 5u);
+
+    aer_event_ring_span_t rs;
+    TASSERT_EQ_U32(aer_event_ring_read_claim(&rb, &rs), 5u);
+    TASSERT_EQ_U32(rs.len[0], 2u);
+    TASSERT_EQ_U32(rs.len[1], 3u);
+    k = 100u;
+    for (uint32_t p = 0u; p < 2u; ++p) {
+        for (uint32_t i = 0u; i < rs.len[p]; ++i) {
+            aer_event_rec_t want = make_ev(k++);
+            TASSERT(ev_eq(&rs.ptr[p][i], &want));
+        }
+    }
+    aer_event_ring_read_commit(&rb, 3u);
+    TASSERT_EQ_U32(aer_event_ring_count(&rb), 2u);
+
+    /* Over-commits are clamped. */
+    aer_event_ring_read_commit(&rb, 50u);
+    TASSERT_EQ_U32(aer_event_ring_count(&rb), 0u);
+    TASSERT_EQ_U32(aer_event_ring_write_claim(&rb, &ws), 8u);
+    aer_event_ring_write_commit(&rb, 50u);
+    TASSERT_EQ_U32(aer_event_ring_count(&rb), 8u);
+    TASSERT_EQ_U32(aer_event_ring_write_claim(&rb, &ws), 0u);
+    TASSERT_EQ_U32(ws.len[0] + ws.len[1], 0u);
+}
+
+/* ---------------- two-thread stress (span producer, pop consumer) ---------------- */
+
+#define STRESS_EVENTS (1u << 20)
+
+static void* producer_main(void* p)
+{
+    aer_event_ring_t* rb = (aer_event_ring_t*)p;
+    uint32_t i = 0u;
+    while (i < STRESS_EVENTS) {
+        aer_event_ring_span_t s;
+        if (aer_event_ring_write_claim(rb, &s) == 0u) {
+            sched_yield();
+            continue;
+        }
+        /* Fill at most 7 per claim to exercise partial commits. */
+        uint32_t n = 0u;
+        for (uint32_t pc = 0u; pc < 2u; ++pc) {
+            for (uint32_t j = 0u; j < s.len[pc] && n < 7u && i + n < STRESS_EVENTS; ++j) {
+                s.ptr[pc][j] = make_ev(i + n);
+                n++;
+            }
+        }
+        aer_event_ring_write_commit(rb, n);
+        i += n;
+    }
+    return NULL;
+}
+
+static void test_stress_threads(void)
+{
+    static aer_event_rec_t storage[64];
+    aer_event_ring_t rb;
+    TASSERT(aer_event_ring_init(&rb, storage, 64u));
+
+    pthread_t th;
+    TASSERT(pthread_create(&th, NULL, producer_main, &rb) == 0);
+
+    uint32_t expect = 0u, errors = 0u;
+    while (expect < STRESS_EVENTS) {
+        aer_event_rec_t e;
+        if (!aer_event_ring_pop(&rb, &e)) {
+            sched_yield();
+            continue;
+        }
+        aer_event_rec_t want = make_ev(expect);
+        errors += ev_eq(&e, &want) ? 0u : 1u;
+        expect++;
+    }
+
+    pthread_join(th, NULL);
+    TASSERT_EQ_U32(errors, 0u);
+}
+
+int main(void)
+{
+    test_push_pop();
+    test_claim_commit();
+    test_stress_threads();
+
+    if (g_failures == 0) {
+        printf("[PASS] test_event_ring\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_event_ring: %d failures\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../common/include/aer_cfg.h"
+#include "../common/include/aer_evpack.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+#define MAX_EVENTS 4096u
+
+static uint32_t lcg(uint32_t* s)
+{
+    *s = *s * 1664525u + 1013904223u;
+    return *s;
+}
+
+/* Encode events[] into as many packets as needed, decode each packet and
+ * compare with the input.
+ */
+static void round_trip(const aer_evpack_event_t* ev, uint32_t n, size_t packet_bytes, uint32_t anchor_every)
+{
+    static uint8_t pkt[1024];
+    static aer_evpack_event_t dec[MAX_EVENTS];
+
+    aer_evpack_enc_t enc;
+    aer_evpack_enc_init(&enc, pkt, packet_bytes, anchor_every);
+
+    uint32_t next_check = 0u;
+    uint32_t packets = 0u;
+
+    for (uint32_t i = 0u; i <= n; ++i) {
+        const bool last = (i == n);
+        if (!last && aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks)) {
+            continue;
+        }
+
+        /* Packet full (or end of input): decode and compare. */
+        size_t got = 0u;
+        TASSERT(aer_evpack_decode(pkt, aer_evpack_enc_len(&enc), dec, MAX_EVENTS, &got));
+        TASSERT_EQ_U32(got, enc.events);
+        for (size_t k = 0u; k < got && next_check + k < n; ++k) {
+            TASSERT_EQ_U32(dec[k].row, ev[next_check + k].row);
+            TASSERT_EQ_U32(dec[k].col, ev[next_check + k].col);
+            TASSERT_EQ_U32(dec[k].t_ticks, ev[next_check + k].t_ticks);
+        }
+        next_check += (uint32_t)got;
+        packets++;
+
+        aer_evpack_enc_reset(&enc);
+        if (!last) {
+            /* An empty packet always has room for one event. */
+            TASSERT(aer_evpack_enc_put(&enc, ev[i].row, ev[i].col, ev[i].t_ticks));
+        }
+    }
+
+    TASSERT_EQ_U32(next_check, n);
+    TASSERT(packets >= 1u);
+}
+
+static void test_round_trip_random(void)
+{
+    static aer_evpack_event_t ev[MAX_EVENTS];
+    uint32_t seed = 0xBEEF1234u;
+    uint32_t t = 0xFFFF0000u; /* wraps through zero */
+
+    for (uint32_t i = 0u; i < MAX_EVENTS; ++i) {
+        const uint32_t r = lcg(&seed);
+        switch ((r >> 28) & 0x7u) {
+            case 0u: t += 0u; break;                              /* same burst */
+            case 1u: t += (r >> 8) & 0x3Fu; break;                /* 1-byte-ish delta */
+            case 2u: t += (r >> 8) & 0x1FFFu; break;
+            case 3u: t += (r >> 4) & 0x3FFFFu; break;             /* up to max delta */
+            case 4u: t += AER_EVPACK_MAX_DELTA + 1u + (r & 0xFFFFu); break; /* forces anchor */
+            case 5u: t -= (r >> 8) & 0xFFu; break;                /* backwards */
+            default: t += (r >> 12) & 0xFFFu; break;
+        }
+        ev[i].row = (uint8_t)((r >> 3) % AER_ROWS);
+        ev[i].col = (uint8_t)((r >> 13) % AER_COLS);
+        ev[i].t_ticks = t;
+    }
+
+    round_trip(ev, MAX_EVENTS, 1024u, 0u);
+    round_trip(ev, MAX_EVENTS, 256u, 0u);
+    round_trip(ev, MAX_EVENTS, 64u, 16u);
+    round_trip(ev, MAX_EVENTS, 9u, 1u);   /* one event per block, tiny packets */
+}
+
+static void test_sizes(void)
+{
+    uint8_t buf[64];
+    aer_evpack_enc_t enc;
+    aer_evpack_enc_init(&enc, buf, sizeof(buf), 0u);
+
+    /* First event: anchor header + address-only varint. */
+    TASSERT(aer_evpack_enc_put(&enc, 31u, 31u, 1000u));
+    const size_t first = aer_evpack_enc_len(&enc);
+    TASSERT_EQ_U32(enc.anchors, 1u);
+    TASSERT(first <= AER_EVPACK_BLOCK_HDR + AER_EVPACK_MAX_VARINT);
+
+    /* Same timestamp: just the address bits. */
+    TASSERT(aer_evpack_enc_put(&enc, 31u, 0u, 1000u));
+    TASSERT(aer_evpack_enc_len(&enc) - first <= (AER_EVPACK_ADDR_BITS + 6u) / 7u);
+
+    /* Max delta stays in the block, one more tick opens a new anchor. */
+    size_t before = aer_evpack_enc_len(&enc);
+    TASSERT(aer_evpack_enc_put(&enc, 1u, 2u, 1000u + AER_EVPACK_MAX_DELTA));
+    TASSERT_EQ_U32(enc.anchors, 1u);
+    TASSERT(aer_evpack_enc_len(&enc) - before <= AER_EVPACK_MAX_VARINT);
+
+    TASSERT(aer_evpack_enc_put(&enc, 1u, 3u, 1000u + 2u * AER_EVPACK_MAX_DELTA + 1u));
+    TASSERT_EQ_U32(enc.anchors, 2u);
+    TASSERT_EQ_U32(enc.events, 4u);
+}
+
+static void test_full_and_malformed(void)
+{
+    uint8_t buf[8];
+    aer_evpack_enc_t enc;
+    aer_evpack_enc_init(&enc, buf, sizeof(buf), 0u);
+
+    TASSERT(aer_evpack_enc_put(&enc, 1u, 1u, 0u));   /* 6 + 1 bytes (addr 33 < 128) */
+    TASSERT(aer_evpack_enc_put(&enc, 0u, 1u, 0u));   /* +1 */
+    TASSERT(!aer_evpack_enc_put(&enc, 2u, 2u, 0u));  /* full: nothing written */
+    TASSERT_EQ_U32(aer_evpack_enc_len(&enc), 8u);
+    TASSERT_EQ_U32(enc.events, 2u);
+
+    aer_evpack_event_t dec[4];
+    size_t got = 0u;
+    TASSERT(aer_evpack_decode(buf, 8u, dec, 4u, &got));
+    TASSERT_EQ_U32(got, 2u);
+
+    /* Truncated varint / truncated header / wrong record type / empty block. */
+    const uint8_t trunc_var[] = { AER_EVPACK_REC_DELTA, 1u, 0u, 0u, 0u, 0u, 0x80u };
+    TASSERT(!aer_evpack_decode(trunc_var, sizeof(trunc_var), dec, 4u, &got));
+    const uint8_t trunc_hdr[] = { AER_EVPACK_REC_DELTA, 1u, 0u };
+    TASSERT(!aer_evpack_decode(trunc_hdr, sizeof(trunc_hdr), dec, 4u, &got));
+    const uint8_t wrong_type[] = { 2u, 1u, 3u, 4u, 0u, 0u, 0u, 0u };
+    TASSERT(!aer_evpack_decode(wrong_type, sizeof(wrong_type), dec, 4u, &got));
+    const uint8_t empty_blk[] = { AER_EVPACK_REC_DELTA, 0u, 0u, 0u, 0u, 0u };
+    TASSERT(!aer_evpack_decode(empty_blk, sizeof(empty_blk), dec, 4u, &got));
+
+    TASSERT(aer_evpack_decode(NULL, 0u, dec, 4u, &got));
+    TASSERT_EQ_U32(got, 0u);
+}
+
+int main(void)
+{
+    test_round_trip_random();
+    test_sizes();
+    test_full_and_malformed();
+
+    if (g_failures == 0) {
+        printf("[PASS] test_evpack\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_evpack: %d failures\n", g_failures);
+    return 1;
+}
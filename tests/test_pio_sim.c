@@ -0,0 +1,348 @@
+/*
+ * tests/test_pio_sim.c
+ *
+ * PIO model (host/sim/pio_sim.c): assembler encodings and state machine
+ * timing; then pico_aer_rx/aer_rx.pio + aer_rx_pio.c (PIO/DMA receiver)
+ * against the simulated 4-phase sender: protocol, order, cycle counts,
+ * backpressure.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "aer_cfg.h"
+#include "aer_codec.h"
+#include "ringbuf.h"
+
+#include "aer_tx_model.h"
+#include "hal_sim.h"
+#include "pio_sim.h"
+
+#include "hal_gpio.h"
+#include "aer_rx_pio.h"
+
+#include "aer_rx_pio_src.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+/* ---------------- assembler ---------------- */
+
+/* Reference encodings as emitted by pioasm. */
+static void test_assembler(void)
+{
+    static const char src[] =
+        ".program other\n"
+        "    nop\n"
+        ".program t\n"
+        ".side_set 1 opt\n"
+        ".define PUBLIC N 12\n"
+        "start:\n"
+        "    nop                     ; comment\n"
+        "    push block\n"
+        "    pull block\n"
+        ".wrap_target\n"
+        "    mov isr, null\n"
+        "    in pins, N              // other comment\n"
+        "    mov x, isr\n"
+        "    jmp !x start\n"
+        "    set pins, 1 side 1 [1]\n"
+        "    out x, 32\n"
+        "    wait 1 gpio 5\n"
+        "    jmp x-- start side 0\n"
+        ".wrap\n"
+        "    mov x, ~y\n"
+        "    push noblock\n"
+        "% c-sdk {\n"
+        "    this is not assembled\n"
+        "%}\n";
+    static const uint16_t expect[] = {
+        0xA042, 0x8020, 0x80A0, 0xA0C3, 0x400C, 0xA026, 0x0020,
+        0xF901, 0x6020, 0x2085, 0x1040, 0xA02A, 0x8000,
+    };
+
+    pio_sim_program_t prog;
+    char err[128];
+    TASSERT(pio_sim_assemble(src, "t", &prog, err, sizeof(err)));
+    TASSERT_EQ_U32(prog.len, sizeof(expect) / sizeof(expect[0]));
+    for (uint32_t i = 0u; i < prog.len; ++i) {
+        TASSERT_EQ_U32(prog.instr[i], expect[i]);
+    }
+    TASSERT_EQ_U32(prog.wrap_target, 3u);
+    TASSERT_EQ_U32(prog.wrap, 10u);
+    TASSERT_EQ_U32(prog.sideset_bits, 2u);
+    TASSERT(prog.sideset_opt);
+    int32_t v = 0;
+    TASSERT(pio_sim_symbol(&prog, "N", &v) && v == 12);
+    TASSERT(pio_sim_symbol(&prog, "start", &v) && v == 0);
+
+    /* First program when no name is given. */
+    TASSERT(pio_sim_assemble(src, NULL, &prog, err, sizeof(err)));
+    TASSERT_EQ_U32(prog.len, 1u);
+
+    /* Errors carry the line number. */
+    TASSERT(!pio_sim_assemble(".program e\n  nop\n  jmp nowhere\n", NULL, &prog, err, sizeof(err)));
+    TASSERT(strncmp(err, "line 3:", 7) == 0);
+    TASSERT(!pio_sim_assemble(".program e\n.side_set 1\n  nop\n", NULL, &prog, err, sizeof(err)));
+    TASSERT(!pio_sim_assemble(".program e\n  irq 0\n", NULL, &prog, err, sizeof(err)));
+    TASSERT(!pio_sim_assemble(".program e\n  nop [32]\n", NULL, &prog, err, sizeof(err)));
+
+    /* The firmware program assembles and declares its DATA width. */
+    TASSERT(pio_sim_assemble(aer_rx_pio_src, "aer_rx", &prog, err, sizeof(err)));
+    TASSERT(pio_sim_symbol(&prog, "DATA_BITS", &v) && v == (int32_t)AER_DATA_WIDTH);
+    TASSERT(prog.len <= 8u);
+}
+
+/* ---------------- state machine ---------------- */
+
+static uint32_t g_pins_in;
+static uint32_t g_pins_out;
+
+static uint32_t test_read_pins(void *user) { (void)user; return g_pins_in; }
+
+static void test_write_pins(uint32_t values, uint32_t mask, void *user)
+{
+    (void)user;
+    g_pins_out = (g_pins_out & ~mask) | (values & mask);
+}
+
+static void test_state_machine(void)
+{
+    pio_sim_program_t prog;
+    char err[128];
+    TASSERT(pio_sim_assemble(
+        ".program count\n"
+        ".side_set 1 opt\n"
+        "    set x, 3        side 1\n"
+        "loop:\n"
+        "    jmp x-- loop [1]\n"          /* x = 3,2,1 taken, 0 falls through: 4 x 2 cycles */
+        "    mov isr, x      side 0\n"
+        "    push block\n"
+        "    set y, 5\n"
+        "    in y, 3\n"
+        "    in y, 3\n"
+        "again:\n"
+        "    push block\n"
+        "    jmp again\n",
+        NULL, &prog, err, sizeof(err)));
+
+    pio_sim_sm_cfg_t cfg = pio_sim_sm_cfg_default();
+    cfg.sideset_base = 7u;
+    cfg.in_shift_right = false;
+    pio_sim_t sm;
+    g_pins_out = 0u;
+    pio_sim_init(&sm, &prog, &cfg, test_read_pins, test_write_pins, NULL);
+
+    pio_sim_step(&sm);
+    TASSERT_EQ_U32(g_pins_out, 1u << 7);
+    for (int i = 0; i < 8; ++i) pio_sim_step(&sm);
+    TASSERT_EQ_U32(sm.stats.delay_cycles, 4u);
+    TASSERT_EQ_U32(sm.x, 0xFFFFFFFFu);
+    pio_sim_step(&sm);                              /* mov isr, x side 0 */
+    TASSERT_EQ_U32(g_pins_out, 0u);
+    pio_sim_step(&sm);                              /* push */
+    TASSERT_EQ_U32(pio_sim_rx_level(&sm), 1u);
+    TASSERT_EQ_U32(sm.stats.cycles, 11u);
+
+    /* Left shift: 5 then 5 -> 0b101101. */
+    for (int i = 0; i < 4; ++i) pio_sim_step(&sm);
+    uint32_t w = 0u;
+    TASSERT(pio_sim_rx_get(&sm, &w) && w == 0xFFFFFFFFu);
+    TASSERT(pio_sim_rx_get(&sm, &w) && w == 45u);
+
+    /* 4-deep FIFO: "push block" stalls once full, without running on. */
+    for (int i = 0; i < 64; ++i) pio_sim_step(&sm);
+    TASSERT_EQ_U32(pio_sim_rx_level(&sm), PIO_SIM_FIFO_DEPTH);
+    TASSERT(sm.rxstall);
+    TASSERT(sm.stats.stall_cycles > 0u);
+    const uint64_t stalled = sm.stats.stall_cycles;
+    pio_sim_step(&sm);
+    TASSERT(sm.stats.stall_cycles == stalled + 1u);
+    TASSERT(pio_sim_rx_get(&sm, &w));
+    pio_sim_step(&sm);
+    TASSERT_EQ_U32(pio_sim_rx_level(&sm), PIO_SIM_FIFO_DEPTH);
+    TASSERT_EQ_U32(sm.stats.rx_dropped, 0u);
+
+    /* wait pin is in_base-relative */
+    TASSERT(pio_sim_assemble(".program w\n    wait 1 pin 2\n    set x, 1\n", NULL, &prog, err, sizeof(err)));
+    cfg = pio_sim_sm_cfg_default();
+    cfg.in_base = 4u;
+    g_pins_in = 1u << 2;
+    pio_sim_init(&sm, &prog, &cfg, test_read_pins, test_write_pins, NULL);
+    pio_sim_step(&sm);
+    pio_sim_step(&sm);
+    TASSERT_EQ_U32(sm.x, 0u);
+    g_pins_in = 1u << 6;
+    pio_sim_step(&sm);
+    pio_sim_step(&sm);
+    TASSERT_EQ_U32(sm.x, 1u);
+}
+
+/* ---------------- aer_rx.pio on the simulated bus ---------------- */
+
+#define N_WORDS 2000u
+
+static aer_raw_word_t g_sent[N_WORDS];
+static uint32_t g_got[N_WORDS];
+
+static void load_words(uint32_t gap_ticks)
+{
+    aer_waveform_t wf;
+    aer_waveform_init(&wf);
+    aer_tx_model_t m;
+    aer_tx_model_init(&m, NULL, &wf, 0u);
+    for (uint32_t i = 0u; i < N_WORDS; ++i) {
+        aer_raw_word_t raw = 0u;
+        (void)aer_encode_payload((uint8_t)((i * 37u) % (AER_ROWS + 1u)), &raw, NULL);
+        g_sent[i] = raw;
+        (void)aer_tx_model_emit_word(&m, raw);
+        m.t += gap_ticks;
+    }
+    TASSERT(hal_sim_load_waveform(&wf));
+    aer_waveform_free(&wf);
+}
+
+static void gpio_init_default(void)
+{
+    hal_gpio_init(&(hal_gpio_cfg_t){
+        .data_base = 2u, .data_width = (uint8_t)AER_DATA_WIDTH, .ack_pin = 14u,
+        .ack_active_high = true, .data_pull_down = true,
+    });
+}
+
+/*
+ * Main loop shape of pico_aer_rx.c with AER_RX_USE_PIO: poll, then drain at
+ * most drain_max words per pass (0 = all), every drain_every passes.
+ * Returns the number of words drained.
+ */
+static uint32_t run_pio(ringbuf_u32_t *rb, aer_rx_pio_t *rx, uint32_t drain_max, uint32_t drain_every)
+{
+    uint32_t got = 0u, pass = 0u, iters = 0u;
+    while ((!hal_sim_tx_done() || aer_rx_pio_backlog(rx) != 0u || !ringbuf_u32_is_empty(rb))
+           && iters++ < 10000000u) {
+        (void)aer_rx_pio_poll(rx);
+        if (++pass % drain_every == 0u) {
+            uint32_t tmp[64];
+            const uint32_t max = (drain_max && drain_max < 64u) ? drain_max : 64u;
+            const uint32_t n = ringbuf_u32_pop_n(rb, tmp, max);
+            for (uint32_t i = 0u; i < n && got < N_WORDS; ++i) g_got[got++] = tmp[i];
+        }
+        hal_sim_spin();
+    }
+    return got;
+}
+
+static void test_pio_receiver(void)
+{
+    /* 1 ns ticks: the sender drives each word as soon as the handshake allows. */
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.tx.tick_ns = 1u;
+    hal_sim_init(&cfg);
+    gpio_init_default();
+    load_words(0u);
+
+    static uint32_t storage[64] __attribute__((aligned(256)));
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+    aer_rx_pio_t rx;
+    TASSERT(aer_rx_pio_init(&rx, &rb));
+
+    const uint32_t got = run_pio(&rb, &rx, 0u, 1u);
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT(hal_sim_tx_done());
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(tx->words_acked, N_WORDS);
+    TASSERT_EQ_U32(got, N_WORDS);
+    TASSERT_EQ_U32(rx.stats.words_ok, N_WORDS);
+    TASSERT(memcmp(g_got, g_sent, sizeof(g_got)) == 0);
+
+    /*
+     * Cycle budget per word with the sender never waiting on the schedule:
+     * 2 (see valid) + 2 (latch, push) + ACK high until DATA clears
+     * (data_clear_ns = 3 clocks at 150 MHz) + 2 (see neutral) + ACK low
+     * until the next word (setup_ns = 3 clocks) = 12 to 14 clocks, i.e.
+     * >= 10.7 Mwords/s at 150 MHz against ~8 for the split CPU loop.
+     */
+    const pio_sim_t *sm = hal_pio_rx_sim_sm();
+    TASSERT(sm != NULL);
+    if (sm) {
+        const double cyc_per_word = (double)sm->stats.cycles / (double)N_WORDS;
+        TASSERT(cyc_per_word >= 10.0 && cyc_per_word <= 14.0);
+        TASSERT_EQ_U32(sm->stats.rx_dropped, 0u);
+    }
+    const double ns_per_word = (double)hal_sim_now_ns() / (double)N_WORDS;
+    TASSERT(ns_per_word < 100.0);
+
+    aer_rx_pio_stop(&rx);
+    TASSERT(hal_pio_rx_sim_sm() == NULL);
+}
+
+/* Slow consumer: DMA runs out of room, the state machine stalls with ACK low,
+ * the sender waits. Nothing is lost or reordered. */
+static void test_pio_backpressure(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.tx.tick_ns = 1u;
+    hal_sim_init(&cfg);
+    gpio_init_default();
+    load_words(0u);
+
+    static uint32_t storage[16] __attribute__((aligned(64)));
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 16u));
+    aer_rx_pio_t rx;
+    TASSERT(aer_rx_pio_init(&rx, &rb));
+
+    const uint32_t got = run_pio(&rb, &rx, 1u, 16u);
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(tx->words_acked, N_WORDS);
+    TASSERT_EQ_U32(got, N_WORDS);
+    TASSERT(memcmp(g_got, g_sent, sizeof(g_got)) == 0);
+    TASSERT(rx.stats.bp_stalls > 0u);
+    TASSERT(tx->behind_max_ns > 0u);
+    aer_rx_pio_stop(&rx);
+
+    /* Rings the DMA cannot wrap are refused. */
+    static uint32_t odd[12] __attribute__((aligned(64)));
+    TASSERT(ringbuf_u32_init(&rb, odd, 12u));
+    TASSERT(!aer_rx_pio_init(&rx, &rb));
+    TASSERT(ringbuf_u32_init(&rb, storage + 1, 8u));
+    TASSERT(!aer_rx_pio_init(&rx, &rb));
+}
+
+int main(void)
+{
+    test_assembler();
+    test_state_machine();
+    test_pio_receiver();
+    test_pio_backpressure();
+    hal_sim_shutdown();
+
+    if (g_failures == 0) {
+        printf("[PASS] test_pio_sim\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_pio_sim: %d failures\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../common/include/ringbuf.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+#define CAP 8u
+
+static void test_single_ops(void)
+{
+    uint32_t storage[CAP];
+    ringbuf_u32_t rb;
+    TASSERT(!ringbuf_u32_init(&rb, storage, 1u));
+    TASSERT(ringbuf_u32_init(&rb, storage, CAP));
+
+    uint32_t v = 0u;
+    TASSERT(ringbuf_u32_is_empty(&rb));
+    TASSERT(!ringbuf_u32_pop(&rb, &v));
+
+    for (uint32_t i = 0u; i < CAP - 1u; ++i) {
+        TASSERT(ringbuf_u32_push(&rb, i));
+    }
+    TASSERT(ringbuf_u32_is_full(&rb));
+    TASSERT(!ringbuf_u32_push(&rb, 99u));
+    TASSERT_EQ_U32(ringbuf_u32_count(&rb), CAP - 1u);
+    TASSERT_EQ_U32(ringbuf_u32_free(&rb), 0u);
+
+    TASSERT(ringbuf_u32_peek(&rb, &v));
+    TASSERT_EQ_U32(v, 0u);
+    for (uint32_t i = 0u; i < CAP - 1u; ++i) {
+        TASSERT(ringbuf_u32_pop(&rb, &v));
+        TASSERT_EQ_U32(v, i);
+    }
+    TASSERT(ringbuf_u32_is_empty(&rb));
+}
+
+/* push_n/pop_n must behave like the same number of push/pop calls, at every
+ * head position and for partial transfers.
+ */
+static void test_bulk_matches_single(void)
+{
+    uint32_t storage[CAP];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, CAP));
+
+    uint32_t src[CAP + 4u], dst[CAP + 4u];
+    uint32_t next_in = 0u, next_out = 0u;
+
+    for (uint32_t round = 0u; round < 50u; ++round) {
+        const uint32_t want = round % (CAP + 3u);
+        for (uint32_t i = 0u; i < want; ++i) src[i] = next_in + i;
+
+        const uint32_t room = ringbuf_u32_free(&rb);
+        const uint32_t pushed = ringbuf_u32_push_n(&rb, src, want);
+        TASSERT_EQ_U32(pushed, (want < room) ? want : room);
+        next_in += pushed;
+
+        const uint32_t take = (round * 7u) % (CAP + 2u);
+        const uint32_t avail = ringbuf_u32_count(&rb);
+        const uint32_t popped = ringbuf_u32_pop_n(&rb, dst, take);
+        TASSERT_EQ_U32(popped, (take < avail) ? take : avail);
+        for (uint32_t i = 0u; i < popped; ++i) {
+            TASSERT_EQ_U32(dst[i], next_out + i);
+        }
+        next_out += popped;
+        TASSERT_EQ_U32(ringbuf_u32_count(&rb), next_in - next_out);
+    }
+
+    TASSERT_EQ_U32(ringbuf_u32_push_n(&rb, NULL, 3u), 0u);
+    TASSERT_EQ_U32(ringbuf_u32_pop_n(&rb, NULL, 3u), 0u);
+}
+
+static void test_claim_commit_wrap(void)
+{
+    uint32_t storage[CAP];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, CAP));
+
+    /* Move head/tail to index 5 so claims wrap. */
+    uint32_t tmp[5] = {0};
+    TASSERT_EQ_U32(ringbuf_u32_push_n(&rb, tmp, 5u), 5u);
+    TASSERT_EQ_U32(ringbuf_u32_pop_n(&rb, tmp, 5u), 5u);
+
+    ringbuf_u32_span_t ws;
+    TASSERT_EQ_U32(ringbuf_u32_write_claim(&rb, &ws), CAP - 1u);
+    TASSERT(ws.ptr[0] == &storage[5]);
+    TASSERT_EQ_U32(ws.len[0], 3u);
+    TASSERT(ws.ptr[1] == &storage[0]);
+    TASSERT_EQ_U32(ws.len[1], 4u);
+    TASSERT_EQ_U32(ringbuf_u32_span_total(&ws), CAP - 1u);
+
+    /* Fill 5 in place (3 + 2 wrapped), publish them. */
+    for (uint32_t i = 0u; i < 3u; ++i) ws.ptr[0][i] = 10u + i;
+    for (uint32_t i = 0u; i < 2u; ++i) ws.ptr[1][i] = 13u + i;
+    ringbuf_u32_write_commit(&rb, 5u);
+    TASSERT_EQ_U32(ringbuf_u32_count(&rb), 5u);
+
+    ringbuf_u32_span_t rs;
+    TASSERT_EQ_U32(ringbuf_u32_read_claim(&rb, &rs), 5u);
+    TASSERT_EQ_U32(rs.len[0], 3u);
+    TASSERT_EQ_U32(rs.len[1], 2u);
+    uint32_t expect = 10u;
+    for (uint32_t p = 0u; p < 2u; ++p) {
+        for (uint32_t i = 0u; i < rs.len[p]; ++i) {
+            TASSERT_EQ_U32(rs.ptr[p][i], expect++);
+        }
+    }
+
+    /* Partial release keeps the rest readable. */
+    ringbuf_u32_read_commit(&rb, 4u);
+    uint32_t v = 0u;
+    TASSERT(ringbuf_u32_pop(&rb, &v));
+    TASSERT_EQ_U32(v, 14u);
+
+    /* Over-commit is clamped; empty claim is a zero span. */
+    ringbuf_u32_read_commit(&rb, 3u);
+    TASSERT(ringbuf_u32_is_empty(&rb));
+    TASSERT_EQ_U32(ringbuf_u32_read_claim(&rb, &rs), 0u);
+    TASSERT_EQ_U32(rs.len[0] + rs.len[1], 0u);
+
+    TASSERT_EQ_U32(ringbuf_u32_write_claim(&rb, &ws), CAP - 1u);
+    ringbuf_u32_write_commit(&rb, 100u);
+    TASSERT(ringbuf_u32_is_full(&rb));
+    TASSERT_EQ_U32(ringbuf_u32_write_claim(&rb, &ws), 0u);
+}
+
+#if RINGBUF_STATS
+static void test_stats(void)
+{
+    uint32_t storage[64];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+
+    const ringbuf_u32_stats_t* st = ringbuf_u32_stats(&rb);
+    TASSERT(st != NULL);
+    TASSERT_EQ_U32(st->high_water, 0u);
+    TASSERT_EQ_U32(st->publishes, 0u);
+
+    /* Fill levels 1..5 via push: buckets 1, 2, 2, 3, 3. */
+    for (uint32_t i = 0u; i < 5u; ++i) {
+        TASSERT(ringbuf_u32_push(&rb, i));
+    }
+    TASSERT_EQ_U32(st->publishes, 5u);
+    TASSERT_EQ_U32(st->high_water, 5u);
+    TASSERT_EQ_U32(st->hist[1], 1u);
+    TASSERT_EQ_U32(st->hist[2], 2u);
+    TASSERT_EQ_U32(st->hist[3], 2u);
+
+    /* Draining does not lower the high-water mark. */
+    uint32_t tmp[64];
+    TASSERT_EQ_U32(ringbuf_u32_pop_n(&rb, tmp, 64u), 5u);
+    TASSERT_EQ_U32(st->high_water, 5u);
+
+    /* push_n is one sample; the overflow part is counted as push_full. */
+    TASSERT_EQ_U32(ringbuf_u32_push_n(&rb, tmp, 64u), 63u);
+    TASSERT_EQ_U32(st->publishes, 6u);
+    TASSERT_EQ_U32(st->high_water, 63u);
+    TASSERT_EQ_U32(st->hist[6], 1u);
+    TASSERT_EQ_U32(st->push_full, 1u);
+
+    TASSERT(!ringbuf_u32_push(&rb, 1u));
+    TASSERT_EQ_U32(st->push_full, 2u);
+
+    /* Bucket mapping, including the clamp of the last bucket. */
+    TASSERT_EQ_U32(ringbuf_stats_bucket(0u), 0u);
+    TASSERT_EQ_U32(ringbuf_stats_bucket(1u), 1u);
+    TASSERT_EQ_U32(ringbuf_stats_bucket(1023u), 10u);
+    TASSERT_EQ_U32(ringbuf_stats_bucket(1024u), 11u);
+    TASSERT_EQ_U32(ringbuf_stats_bucket(0xFFFFFFFFu), RINGBUF_STATS_BUCKETS - 1u);
+
+    ringbuf_u32_stats_reset(&rb);
+    TASSERT_EQ_U32(st->high_water, 0u);
+    TASSERT_EQ_U32(st->push_full, 0u);
+    TASSERT_EQ_U32(ringbuf_u32_count(&rb), 63u);
+}
+#endif
+
+int main(void)
+{
+    test_single_ops();
+    test_bulk_matches_single();
+    test_claim_commit_wrap();
+#if RINGBUF_STATS
+    test_stats();
+#else
+    TASSERT(ringbuf_u32_stats(NULL) == NULL);
+#endif
+
+    if (g_failures == 0) {
+        printf("[PASS] test_ringbuf (stats %s)\n", RINGBUF_STATS ? "on" : "off");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_ringbuf: %d failures\n", g_failures);
+    return 1;
+}
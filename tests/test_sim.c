@@ -0,0 +1,1660 @@
+/*
+ * tests/test_sim.c
+ *
+ * Firmware receive path (aer_rx_poll, usb_stream, aer_event_sink) running
+ * against the host HAL simulator: real 4-phase handshakes on a simulated bus,
+ * overflow policies, the dual-core split, and the framed output stream.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "aer_cfg.h"
+#include "aer_codec.h"
+#include "aer_burst.h"
+#include "ringbuf.h"
+#include "spsc_ring.h"
+
+#include "aer_tx_model.h"
+#include "hal_sim.h"
+
+#include "hal_gpio.h"
+#include "hal_stdio.h"
+#include "hal_dlog.h"
+#include "hal_time.h"
+#include "aer_rx_poll.h"
+#include "usb_stream.h"
+#include "usb_ctrl.h"
+#include "aer_event_sink.h"
+#include "aer_sched.h"
+#include "aer_raw_decode.h"
+#include "aer_ctrl_client.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+/* ---------------- traffic ---------------- */
+
+#define MAX_EVENTS 4096u
+
+typedef struct {
+    uint8_t  row, col;
+    uint64_t t_row, t_col;      /* waveform ticks the row / column word is scheduled at */
+} event_t;
+
+typedef struct {
+    event_t ev[MAX_EVENTS];
+    uint32_t n;
+} event_list_t;
+
+static aer_raw_word_t encode(uint32_t payload)
+{
+    aer_raw_word_t raw = 0u;
+    (void)aer_encode_payload((uint8_t)payload, &raw, NULL);
+    return raw;
+}
+
+/* n_bursts bursts of 1..4 ascending columns; expected events go to *exp. */
+static void build_traffic(aer_waveform_t *wf, uint32_t n_bursts, uint32_t gap_ticks,
+                          event_list_t *exp)
+{
+    aer_tx_model_t m;
+    aer_tx_model_init(&m, NULL, wf, 0u);
+    exp->n = 0u;
+
+    for (uint32_t b = 0u; b < n_bursts; ++b) {
+        const uint32_t row = (b * 7u) % AER_ROWS;
+        const uint32_t ncols = 1u + (b % 4u);
+        const uint64_t t_row = m.t;
+        (void)aer_tx_model_emit_word(&m, encode(row));
+        for (uint32_t c = 0u; c < ncols; ++c) {
+            const uint32_t col = (b + 5u * c) % AER_COLS;
+            if (c != 0u && col <= exp->ev[exp->n - 1u].col) break;
+            exp->ev[exp->n].t_row = t_row;
+            exp->ev[exp->n].t_col = m.t;
+            (void)aer_tx_model_emit_word(&m, encode(col));
+            exp->ev[exp->n].row = (uint8_t)row;
+            exp->ev[exp->n].col = (uint8_t)col;
+            exp->n++;
+        }
+        (void)aer_tx_model_emit_word(&m, encode(AER_TAIL_PAYLOAD));
+        m.t += gap_ticks;
+    }
+}
+
+static void load_traffic(uint32_t n_bursts, uint32_t gap_ticks, event_list_t *exp)
+{
+    aer_waveform_t wf;
+    aer_waveform_init(&wf);
+    build_traffic(&wf, n_bursts, gap_ticks, exp);
+    TASSERT(hal_sim_load_waveform(&wf));
+    aer_waveform_free(&wf);
+}
+
+/* ---------------- frame capture (V1_NOTS records) ---------------- */
+
+typedef struct {
+    event_list_t got;
+    uint32_t frames;
+    uint32_t hello;
+    uint32_t seq_errors;
+    uint16_t next_seq;
+} frame_capture_t;
+
+static void on_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    frame_capture_t *fc = (frame_capture_t *)user;
+    if (fc->frames != 0u && seq != fc->next_seq) fc->seq_errors++;
+    fc->next_seq = (uint16_t)(seq + 1u);
+    fc->frames++;
+
+    if (type == HAL_STREAM_HELLO) fc->hello++;
+    if (type != HAL_STREAM_EVENT_BIN) return;
+    for (uint16_t i = 0u; i + 4u <= len; i += 4u) {
+        if (payload[i] != USB_EVT_REC_V1_NOTS || fc->got.n >= MAX_EVENTS) continue;
+        fc->got.ev[fc->got.n].row = payload[i + 2u];
+        fc->got.ev[fc->got.n].col = payload[i + 3u];
+        fc->got.n++;
+    }
+}
+
+static bool events_equal(const event_list_t *a, const event_list_t *b)
+{
+    if (a->n != b->n) return false;
+    for (uint32_t i = 0u; i < a->n; ++i) {
+        if (a->ev[i].row != b->ev[i].row || a->ev[i].col != b->ev[i].col) return false;
+    }
+    return true;
+}
+
+/* ---------------- tests ---------------- */
+
+static event_list_t g_exp;
+static frame_capture_t g_fc;
+
+/* Firmware main loop shape: one handshake, drain everything, stream per burst. */
+static void test_lossless_pipeline(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    load_traffic(300u, 40u, &g_exp);
+
+    memset(&g_fc, 0, sizeof(g_fc));
+    hal_sim_set_frame_sink(on_frame, &g_fc);
+
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = false, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .rowmask_enabled = false, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+
+    uint32_t storage[64];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+
+    /* Host asks for HELLO; answered from the loop like service_host(). */
+    TASSERT(hal_sim_host_write((const uint8_t *)"?", 1u));
+
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || !ringbuf_u32_is_empty(&rb)) && iters++ < 1000000u) {
+        usb_stream_poll();
+        int c;
+        while ((c = hal_stdio_getc_nonblocking()) >= 0) {
+            (void)usb_stream_on_host_byte((uint8_t)c);
+        }
+        if (hal_gpio_read_data_raw() == 0u) {
+            hal_sim_spin();
+            continue;
+        }
+        TASSERT(aer_rx_poll_step(&rx) == AER_RX_POLL_OK);
+
+        ringbuf_u32_span_t rd;
+        const uint32_t n = ringbuf_u32_read_claim(&rb, &rd);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            (void)aer_burst_feed_raw_words_span(&burst, rd.ptr[p], rd.len[p],
+                                                aer_event_sink_on_burst, &sink);
+        }
+        ringbuf_u32_read_commit(&rb, n);
+    }
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT(hal_sim_tx_done());
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(tx->words_acked, tx->words_total);
+    TASSERT_EQ_U32(aer_rx_poll_stats(&rx)->words_ok, tx->words_total);
+    TASSERT_EQ_U32(aer_rx_poll_dropped(&rx), 0u);
+    TASSERT_EQ_U32(burst.bursts_completed, 300u);
+
+    TASSERT(events_equal(&g_fc.got, &g_exp));
+    TASSERT_EQ_U32(g_fc.hello, 1u);
+    TASSERT_EQ_U32(g_fc.seq_errors, 0u);
+    TASSERT(hal_sim_now_ns() > 0u);
+
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* Overloaded consumer: up to 64 handshakes per loop, 4 words drained per loop. */
+typedef struct {
+    uint32_t consumed;          /* words handed to the parser */
+    aer_raw_word_t last_word;
+    uint32_t events;
+    uint32_t stall_episodes;    /* counted here, from rx.bp_stalled */
+} overload_result_t;
+
+static void on_burst_count(uint8_t row, const uint8_t *cols, uint16_t count,
+                           const aer_burst_info_t *info, void *user)
+{
+    (void)row; (void)cols; (void)info;
+    ((overload_result_t *)user)->events += count;
+}
+
+static aer_rx_poll_t run_overload(aer_rx_overflow_t policy, uint32_t bp_timeout_us,
+                                  uint32_t drain_per_loop, overload_result_t *res)
+{
+    hal_sim_init(NULL);
+    load_traffic(200u, 0u, &g_exp);
+
+    uint32_t storage[16];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 16u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 1u, 0u);
+    aer_rx_poll_set_overflow(&rx, policy, bp_timeout_us);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+    memset(res, 0, sizeof(*res));
+
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || (drain_per_loop != 0u && !ringbuf_u32_is_empty(&rb)))
+           && iters++ < 1000000u) {
+        /* A held word on a ring that is still full continues the same stall. */
+        const bool held = rx.bp_stalled && ringbuf_u32_is_full(&rb);
+        (void)aer_rx_poll_service(&rx, 64u, 0u);
+        if (rx.bp_stalled && !held) res->stall_episodes++;
+
+        ringbuf_u32_span_t rd;
+        uint32_t n = ringbuf_u32_read_claim(&rb, &rd);
+        if (n > drain_per_loop) n = drain_per_loop;
+        for (uint32_t i = 0u; i < n; ++i) {
+            const uint32_t w = (i < rd.len[0]) ? rd.ptr[0][i] : rd.ptr[1][i - rd.len[0]];
+            (void)aer_burst_feed_raw_span(&burst, (aer_raw_word_t)w, on_burst_count, res);
+            res->last_word = (aer_raw_word_t)w;
+        }
+        ringbuf_u32_read_commit(&rb, n);
+        res->consumed += n;
+    }
+    TASSERT(hal_sim_tx_done());
+    TASSERT_EQ_U32(hal_sim_tx_stats()->protocol_errors, 0u);
+    return rx;
+}
+
+static void test_overflow_policies(void)
+{
+    overload_result_t r;
+
+    /* DROP_NEWEST: every word handshaked, the overflow never reaches the ring. */
+    aer_rx_poll_t rx = run_overload(AER_RX_OVERFLOW_DROP_NEWEST, 0u, 4u, &r);
+    const uint32_t total = hal_sim_tx_stats()->words_total;
+    TASSERT_EQ_U32(rx.stats.words_ok, total);
+    TASSERT(rx.stats.dropped_full > 0u);
+    TASSERT_EQ_U32(rx.stats.dropped_oldest, 0u);
+    TASSERT_EQ_U32(rx.stats.bp_stalls, 0u);
+    TASSERT_EQ_U32(r.consumed + rx.stats.dropped_full, total);
+
+    /* BACKPRESSURE without timeout: the sender waits, nothing is lost. */
+    rx = run_overload(AER_RX_OVERFLOW_BACKPRESSURE, 0u, 4u, &r);
+    TASSERT_EQ_U32(rx.stats.words_ok, total);
+    TASSERT_EQ_U32(aer_rx_poll_dropped(&rx), 0u);
+    TASSERT(r.stall_episodes > 0u);
+    TASSERT_EQ_U32(rx.stats.bp_stalls, r.stall_episodes);
+    TASSERT_EQ_U32(rx.stats.bp_timeouts, 0u);
+    TASSERT_EQ_U32(r.consumed, total);
+    TASSERT_EQ_U32(r.events, g_exp.n);
+    TASSERT(hal_sim_tx_stats()->behind_max_ns > 0u);
+
+    /* DROP_OLDEST: the newest words survive; the last one sent is the last consumed. */
+    rx = run_overload(AER_RX_OVERFLOW_DROP_OLDEST, 0u, 4u, &r);
+    TASSERT_EQ_U32(rx.stats.words_ok, total);
+    TASSERT(rx.stats.dropped_oldest > 0u);
+    TASSERT_EQ_U32(rx.stats.dropped_full, 0u);
+    TASSERT_EQ_U32(r.consumed + rx.stats.dropped_oldest, total);
+    TASSERT_EQ_U32(r.last_word, encode(AER_TAIL_PAYLOAD));
+
+    /* BACKPRESSURE with a dead consumer: each stall gives up after the timeout,
+     * the ring keeps its 15 words and the bus keeps moving.
+     */
+    rx = run_overload(AER_RX_OVERFLOW_BACKPRESSURE, 5u, 0u, &r);
+    TASSERT_EQ_U32(rx.stats.words_ok, total);
+    TASSERT_EQ_U32(rx.stats.bp_timeouts, total - 15u);
+    TASSERT_EQ_U32(rx.stats.bp_stalls, total - 15u);   /* one stall per word, however many retries */
+    TASSERT_EQ_U32(rx.stats.dropped_full, total - 15u);
+    TASSERT(hal_sim_now_ns() >= (uint64_t)(total - 15u) * 5000u);
+}
+
+/* AER_RX_DUAL_CORE shape: core1 (a thread) handshakes into a small SPSC
+ * ring with BACKPRESSURE, core0 (this thread) drains and streams. Real
+ * concurrency on the ring; every event must come out, in order.
+ */
+typedef struct {
+    aer_rx_poll_t *rx;
+    atomic_bool    done;
+} split_core1_t;
+
+static void *split_core1(void *p)
+{
+    split_core1_t *c1 = (split_core1_t *)p;
+    hal_sim_set_core(1u);
+    while (!hal_sim_tx_done()) {
+        if (hal_gpio_read_data_raw() == 0u) {
+            hal_sim_spin();
+        } else if (aer_rx_poll_step(c1->rx) == AER_RX_POLL_NO_SPACE) {
+            sched_yield();
+        }
+    }
+    atomic_store_explicit(&c1->done, true, memory_order_release);
+    return NULL;
+}
+
+static void test_dual_core_split(void)
+{
+    hal_sim_init(NULL);
+    hal_sim_set_bus_core(1u);
+    load_traffic(1000u, 0u, &g_exp);
+
+    memset(&g_fc, 0, sizeof(g_fc));
+    hal_sim_set_frame_sink(on_frame, &g_fc);
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = false, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .rowmask_enabled = false, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+
+    static uint32_t storage[16];
+    static spsc_ring_u32_t ring;
+    TASSERT(spsc_ring_u32_init(&ring, storage, 16u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init_spsc(&rx, &ring, 0u, 0u);
+    aer_rx_poll_set_overflow(&rx, AER_RX_OVERFLOW_BACKPRESSURE, 0u);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+
+    split_core1_t c1 = { .rx = &rx };
+    atomic_init(&c1.done, false);
+    pthread_t th;
+    TASSERT(pthread_create(&th, NULL, split_core1, &c1) == 0);
+
+    for (;;) {
+        const bool done = atomic_load_explicit(&c1.done, memory_order_acquire);
+        usb_stream_poll();
+        spsc_ring_u32_span_t rd;
+        const uint32_t n = spsc_ring_u32_read_claim(&ring, &rd);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            (void)aer_burst_feed_raw_words_span(&burst, rd.ptr[p], rd.len[p],
+                                                aer_event_sink_on_burst, &sink);
+        }
+        spsc_ring_u32_read_commit(&ring, n);
+        if (n == 0u) {
+            if (done) break;
+            sched_yield();
+        }
+    }
+    pthread_join(th, NULL);
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(tx->words_acked, tx->words_total);
+    TASSERT_EQ_U32(rx.stats.words_ok, tx->words_total);
+    TASSERT_EQ_U32(aer_rx_poll_dropped(&rx), 0u);
+    TASSERT_EQ_U32(burst.bursts_completed, 1000u);
+    TASSERT(events_equal(&g_fc.got, &g_exp));
+    TASSERT_EQ_U32(g_fc.seq_errors, 0u);
+
+    /* Only the bus core's clock moved with the handshakes. */
+    TASSERT(hal_sim_core_now_ns(1u) > hal_sim_core_now_ns(0u));
+
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/*
+ * Latch timestamps end to end: the consumer only drains once 24 words are
+ * queued, so emission runs well behind the bus, yet every record carries the
+ * time its row (ROWMASK) or column (V1_TICKS) word was latched.
+ */
+typedef struct {
+    uint8_t  row[MAX_EVENTS], col[MAX_EVENTS];
+    uint32_t t[MAX_EVENTS];
+    uint32_t n;
+} ticks_capture_t;
+
+static void on_ticks_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    (void)seq;
+    ticks_capture_t *tc = (ticks_capture_t *)user;
+    if (type != HAL_STREAM_EVENT_BIN) return;
+
+    uint16_t i = 0u;
+    while (i + 8u <= len && tc->n < MAX_EVENTS) {
+        uint32_t t;
+        memcpy(&t, &payload[i + 4u], sizeof(t));
+        if (payload[i] == USB_EVT_REC_V1_TICKS) {
+            tc->row[tc->n] = payload[i + 2u];
+            tc->col[tc->n] = payload[i + 3u];
+            tc->t[tc->n++] = t;
+            i = (uint16_t)(i + 8u);
+        } else if (payload[i] == USB_EVT_REC_V2_ROWMASK) {
+            for (uint32_t c = 0u; c < AER_COLS && tc->n < MAX_EVENTS; ++c) {
+                if ((payload[i + 8u + c / 8u] >> (c % 8u)) & 1u) {
+                    tc->row[tc->n] = payload[i + 2u];
+                    tc->col[tc->n] = (uint8_t)c;
+                    tc->t[tc->n++] = t;
+                }
+            }
+            i = (uint16_t)(i + 8u + payload[i + 3u]);
+        } else {
+            break;
+        }
+    }
+}
+
+static void run_latch_timestamps(bool rowmask)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    load_traffic(200u, 40u, &g_exp);
+
+    static ticks_capture_t tc;
+    memset(&tc, 0, sizeof(tc));
+    hal_sim_set_frame_sink(on_ticks_frame, &tc);
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = true, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .rowmask_enabled = rowmask, .latch_timestamps = true,
+        .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+
+    uint32_t storage[64];
+    uint32_t ts[64];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    aer_rx_poll_set_timestamps(&rx, ts);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || !ringbuf_u32_is_empty(&rb)) && iters++ < 1000000u) {
+        usb_stream_poll();
+        if (hal_gpio_read_data_raw() != 0u) {
+            (void)aer_rx_poll_step(&rx);
+        } else {
+            hal_sim_spin();
+        }
+        if (ringbuf_u32_count(&rb) < 24u && !hal_sim_tx_done()) continue;
+
+        ringbuf_u32_span_t rd;
+        const uint32_t n = ringbuf_u32_read_claim(&rb, &rd);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            (void)aer_burst_feed_raw_words_ts_span(&burst, rd.ptr[p], ts + (rd.ptr[p] - storage),
+                                                   rd.len[p], aer_event_sink_on_burst, &sink);
+        }
+        ringbuf_u32_read_commit(&rb, n);
+    }
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    hal_sim_set_frame_sink(NULL, NULL);
+
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(aer_rx_poll_dropped(&rx), 0u);
+    TASSERT_EQ_U32(tc.n, g_exp.n);
+
+    /* Latched within one poll (gpio read + spin) of being driven; the sender
+     * is driven late only when the handshake held it up. */
+    const uint64_t slack_ns = tx->behind_max_ns + cfg.cost.gpio_read_ns + cfg.cost.spin_ns + 10u;
+    uint64_t worst_ns = 0u;
+    for (uint32_t i = 0u; i < tc.n && i < g_exp.n; ++i) {
+        TASSERT(tc.row[i] == g_exp.ev[i].row && tc.col[i] == g_exp.ev[i].col);
+        const uint64_t sched = (rowmask ? g_exp.ev[i].t_row : g_exp.ev[i].t_col) * cfg.tx.tick_ns;
+        const uint64_t got = (uint64_t)tc.t[i] * 1000u / (cfg.clk_hz / 1000000u);
+        TASSERT(got + 10u >= sched);
+        if (got > sched && got - sched > worst_ns) worst_ns = got - sched;
+    }
+    TASSERT(worst_ns <= slack_ns);
+}
+
+static void test_latch_timestamps(void)
+{
+    run_latch_timestamps(true);
+    run_latch_timestamps(false);
+}
+
+/*
+ * 64-bit ticks across several 32-bit wraps (~28.6 s each at 150 MHz), read
+ * from both cores, and the host-side unwrap of 32-bit t_ticks against the
+ * HAL_STREAM_TIME_ANCHOR frames usb_stream_poll() sends.
+ */
+typedef struct {
+    uint64_t t64[128];
+    uint32_t tick_hz;
+    uint32_t n;
+} anchor_capture_t;
+
+static void on_anchor_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    (void)seq;
+    anchor_capture_t *ac = (anchor_capture_t *)user;
+    if (type != HAL_STREAM_TIME_ANCHOR || len < 24u || ac->n >= 128u) return;
+    TASSERT_EQ_U32(payload[0], USB_STREAM_TIME_ANCHOR_VER);
+    memcpy(&ac->tick_hz, &payload[4], sizeof(ac->tick_hz));
+    memcpy(&ac->t64[ac->n++], &payload[8], sizeof(uint64_t));
+}
+
+/* Expected ticks for a virtual time (hal_cycles_now() rounding). */
+static uint64_t ticks_at(uint64_t ns, uint32_t clk_hz)
+{
+    const uint64_t per_us = clk_hz / 1000000u;
+    return (ns / 1000u) * per_us + ((ns % 1000u) * per_us) / 1000u;
+}
+
+static void test_cycles64_and_anchors(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+
+    static anchor_capture_t ac;
+    memset(&ac, 0, sizeof(ac));
+    hal_sim_set_frame_sink(on_anchor_frame, &ac);
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = true, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .time_anchor_interval_us = 1000000u,
+    });
+    TASSERT(usb_stream_send_hello());
+    hal_stream_poll();
+    TASSERT_EQ_U32(ac.n, 1u);     /* anchor follows HELLO */
+
+    /* 100 s in uneven steps, alternating cores (their clocks stay close).
+     * The 64-bit count is core0's; core1 only reads its 32-bit counter. */
+    uint64_t prev = 0u;
+    uint32_t step = 0u;
+    while (hal_sim_now_ns() < 100000000000ull) {
+        const uint8_t core = (uint8_t)(step & 1u);
+        hal_sim_set_core(core);
+        hal_sim_advance_ns(hal_sim_core_now_ns((uint8_t)(core ^ 1u)) - hal_sim_now_ns()
+                           + 137000000ull + (uint64_t)(step % 7u) * 51000000ull);
+        if (core == 0u) {
+            const uint64_t t = hal_cycles_now64();
+            TASSERT(t == ticks_at(hal_sim_now_ns(), cfg.clk_hz));
+            TASSERT((uint32_t)t == hal_cycles_now());
+            TASSERT(t > prev);
+            prev = t;
+            usb_stream_poll();
+        } else {
+            TASSERT(hal_cycles_now() == (uint32_t)ticks_at(hal_sim_now_ns(), cfg.clk_hz));
+        }
+        ++step;
+    }
+    hal_sim_set_core(0u);
+    TASSERT(prev > 3ull * 0x100000000ull);
+
+    /* Anchors roughly once a second, exact, strictly increasing. */
+    TASSERT(ac.n >= 60u);
+    TASSERT_EQ_U32(ac.tick_hz, cfg.clk_hz);
+    for (uint32_t i = 1u; i < ac.n; ++i) TASSERT(ac.t64[i] > ac.t64[i - 1u]);
+    TASSERT_EQ_U32(usb_stream_stats()->anchors_sent, ac.n);
+
+    /* Host unwrap: any 32-bit stamp within +-2^31 ticks of an anchor. */
+    const uint64_t a = ac.t64[ac.n / 2u];
+    const int64_t offs[4] = { -2000000000ll, -1500000ll, 0, 2100000000ll };
+    for (uint32_t k = 0u; k < 4u; ++k) {
+        const uint64_t truth = (uint64_t)((int64_t)a + offs[k]);
+        const uint32_t t32 = (uint32_t)truth;
+        TASSERT(a + (uint64_t)(int64_t)(int32_t)(t32 - (uint32_t)a) == truth);
+    }
+
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* No host: stream writes fail cleanly and are counted, the receiver is unaffected. */
+static void test_disconnected(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.connected = false;
+    hal_sim_init(&cfg);
+    TASSERT(!hal_stream_write(HAL_STREAM_MARKER, "x", 1u));
+    TASSERT_EQ_U32(hal_sim_stream_stats()->frames, 0u);
+
+    hal_sim_set_connected(true);
+    TASSERT(hal_stream_marker("x"));
+    hal_stream_poll();
+    TASSERT_EQ_U32(hal_sim_stream_stats()->frames_by_type[HAL_STREAM_MARKER], 1u);
+    TASSERT_EQ_U32(hal_sim_stream_stats()->bytes, HAL_STREAM_HDR_LEN + 1u);
+}
+
+/* Rowmask mode counts mask bits: repeated columns collapse into one event,
+ * out-of-range ones are not sent, and the loss counter sees the same count. */
+static void test_rowmask_repeats(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = true, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .rowmask_enabled = true, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+
+    const uint8_t cols[6] = { 3u, 3u, 7u, (uint8_t)AER_COLS, 7u, 0u };
+    TASSERT(usb_stream_send_on_burst(1u, cols, 6u));
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    TASSERT_EQ_U32(usb_stream_stats()->events_sent, 3u);
+
+    hal_sim_set_connected(false);
+    TASSERT(!usb_stream_send_on_burst(1u, cols, 6u));
+    TASSERT_EQ_U32(usb_stream_stats()->events_dropped_not_connected, 3u);
+    hal_sim_set_connected(true);
+}
+
+/* Slow USB link: writes never block, frames queue then get refused with a
+ * seq gap, and what was queued reaches the host with the link's latency. */
+static void test_slow_link(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.cdc.bytes_per_s = 100000u;    /* 10 us per byte */
+    cfg.cdc.fifo_bytes  = 64u;
+    hal_sim_init(&cfg);
+    memset(&g_fc, 0, sizeof(g_fc));
+    hal_sim_set_frame_sink(on_frame, &g_fc);
+
+    uint8_t rec[4] = { (uint8_t)USB_EVT_REC_V1_NOTS, 0u, 0u, 0u };
+    const hal_iovec_t iov[2] = { { rec, 2u }, { &rec[2], 2u } };
+    const uint32_t frame_bytes = HAL_STREAM_HDR_LEN + sizeof(rec);
+    const uint32_t n_frames = 4u * HAL_STREAM_TX_BUF_BYTES / frame_bytes;
+
+    uint32_t ok = 0u;
+    for (uint32_t i = 0u; i < n_frames; ++i) {
+        rec[2] = (uint8_t)(i >> 4);
+        rec[3] = (uint8_t)i;
+        if (hal_stream_writev(HAL_STREAM_EVENT_BIN, iov, 2u)) ok++;
+        hal_sim_advance_ns(1000u);
+    }
+    /* Less than 2 ms of writing against ~1 s of link time: two buffers' worth fit. */
+    const hal_stream_stats_t *hs = hal_stream_stats();
+    TASSERT(ok < n_frames);
+    TASSERT(ok * frame_bytes <= 2u * HAL_STREAM_TX_BUF_BYTES + cfg.cdc.fifo_bytes);
+    TASSERT_EQ_U32(hs->frames_written, ok);
+    TASSERT_EQ_U32(hs->frames_failed, n_frames - ok);
+    TASSERT(g_fc.frames < ok);
+
+    TASSERT(hal_sim_stream_drain(10000000000ull));
+    const hal_sim_stream_stats_t *fs = hal_sim_stream_stats();
+    TASSERT_EQ_U32(g_fc.frames, ok);
+    TASSERT_EQ_U32(fs->frames, ok);
+    TASSERT_EQ_U32(g_fc.got.n, ok);   /* each payload reassembled from its pieces */
+    TASSERT_EQ_U32(hal_stream_stats()->bytes_sent, ok * frame_bytes);
+    TASSERT_EQ_U32(g_fc.seq_errors, 0u);
+
+    /* The last frame waited for everything queued before it; drain returns
+     * once the rest fits in the FIFO. */
+    TASSERT(fs->latency_max_ns >= (uint64_t)(ok - 1u) * frame_bytes * 10000u - (uint64_t)n_frames * 1000u);
+    TASSERT(hal_sim_now_ns() >= (uint64_t)(ok * frame_bytes - cfg.cdc.fifo_bytes) * 10000u);
+
+    /* Next frame after the refused ones: the host sees the gap. */
+    TASSERT(hal_stream_marker("x"));
+    TASSERT(hal_sim_stream_drain(10000000000ull));
+    TASSERT_EQ_U32(g_fc.seq_errors, 1u);
+    TASSERT_EQ_U32((uint16_t)(g_fc.next_seq - 1u), n_frames);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* ---------------- raw word passthrough (HAL_STREAM_RAW_BIN) ---------------- */
+
+/* Decoded on the "host" twice: per frame from the sim's frame callback, and
+ * from the re-serialised byte stream in odd chunks (as read from the port). */
+typedef struct {
+    aer_raw_decoder_t dec;
+    event_list_t got;
+    uint32_t t[MAX_EVENTS];
+    bool     timed;
+    uint32_t event_frames;
+    uint16_t raw_len_max;
+    uint8_t  bytes[1u << 17];
+    uint32_t nbytes;
+} raw_capture_t;
+
+static void on_raw_burst(uint8_t row, const uint8_t *cols, uint16_t count,
+                         const aer_burst_info_t *info, void *user)
+{
+    raw_capture_t *rc = (raw_capture_t *)user;
+    for (uint16_t i = 0u; i < count && rc->got.n < MAX_EVENTS; ++i) {
+        rc->t[rc->got.n] = info->col_t ? info->col_t[i] : info->t_row;
+        rc->got.ev[rc->got.n].row = row;
+        rc->got.ev[rc->got.n].col = cols[i];
+        rc->got.n++;
+    }
+    rc->timed = info->timed;
+}
+
+static void on_raw_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    raw_capture_t *rc = (raw_capture_t *)user;
+    if (type == HAL_STREAM_EVENT_BIN) rc->event_frames++;
+    if (type == HAL_STREAM_RAW_BIN && len > rc->raw_len_max) rc->raw_len_max = len;
+    (void)aer_raw_decoder_frame(&rc->dec, type, seq, payload, len);
+
+    if (rc->nbytes + HAL_STREAM_HDR_LEN + len > sizeof(rc->bytes)) return;
+    const uint8_t h[HAL_STREAM_HDR_LEN] = { 'A', 'E', 'R', 'S', HAL_STREAM_VER, type,
+                                           (uint8_t)len, (uint8_t)(len >> 8), (uint8_t)seq, (uint8_t)(seq >> 8) };
+    memcpy(&rc->bytes[rc->nbytes], h, sizeof(h));
+    memcpy(&rc->bytes[rc->nbytes + sizeof(h)], payload, len);
+    rc->nbytes += (uint32_t)sizeof(h) + len;
+}
+
+static raw_capture_t g_rc;
+
+static void raw_capture_start(void)
+{
+    memset(&g_rc, 0, sizeof(g_rc));
+    aer_raw_decoder_init(&g_rc.dec, &(aer_raw_decoder_cfg_t){ .burst_cb = on_raw_burst, .user = &g_rc });
+    hal_sim_set_frame_sink(on_raw_frame, &g_rc);
+}
+
+/* The receive loop of run_latch_timestamps(), draining into usb_stream_send_raw_words(). */
+static void test_raw_passthrough(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    load_traffic(300u, 40u, &g_exp);
+    raw_capture_start();
+
+    usb_stream_init(&(usb_stream_cfg_t){
+        .timestamps_enabled = true, .data_width_bits = (uint8_t)AER_DATA_WIDTH,
+        .latch_timestamps = true, .raw_passthrough = true,
+        .batch_max_bytes = 256u, .batch_max_latency_us = 100u,
+    });
+    TASSERT(usb_stream_raw_passthrough());
+    TASSERT(usb_stream_send_hello());
+
+    uint32_t storage[64];
+    uint32_t ts[64];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    aer_rx_poll_set_timestamps(&rx, ts);
+
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || !ringbuf_u32_is_empty(&rb)) && iters++ < 1000000u) {
+        usb_stream_poll();
+        if (hal_gpio_read_data_raw() != 0u) {
+            (void)aer_rx_poll_step(&rx);
+        } else {
+            hal_sim_spin();
+        }
+        ringbuf_u32_span_t rd;
+        const uint32_t n = ringbuf_u32_read_claim(&rb, &rd);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            TASSERT(usb_stream_send_raw_words(rd.ptr[p], ts + (rd.ptr[p] - storage), rd.len[p]));
+        }
+        ringbuf_u32_read_commit(&rb, n);
+    }
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    hal_sim_set_frame_sink(NULL, NULL);
+
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    const usb_stream_stats_t *us = usb_stream_stats();
+    const aer_raw_decoder_stats_t *ds = &g_rc.dec.stats;
+    TASSERT_EQ_U32(tx->protocol_errors, 0u);
+    TASSERT_EQ_U32(us->raw_words_sent, tx->words_total);
+    TASSERT_EQ_U32(us->raw_packets_sent, ds->frames);
+    TASSERT_EQ_U32(ds->words, tx->words_total);
+    TASSERT_EQ_U32(ds->words_lost, 0u);
+    TASSERT_EQ_U32(ds->frames_bad, 0u);
+    TASSERT_EQ_U32(ds->seq_lost, 0u);
+    TASSERT_EQ_U32(ds->hello, 1u);
+    TASSERT(ds->hello_flags & USB_STREAM_HELLO_F_RAW_WORDS);
+    TASSERT_EQ_U32(g_rc.event_frames, 0u);
+    TASSERT_EQ_U32(g_rc.dec.burst.bursts_completed, 300u);
+
+    /* Same events as the on-device decode, with their latch times. */
+    TASSERT(events_equal(&g_rc.got, &g_exp));
+    TASSERT(g_rc.timed);
+    const uint64_t slack_ns = tx->behind_max_ns + cfg.cost.gpio_read_ns + cfg.cost.spin_ns + 10u;
+    for (uint32_t i = 0u; i < g_rc.got.n && i < g_exp.n; ++i) {
+        const uint64_t sched = g_exp.ev[i].t_col * cfg.tx.tick_ns;
+        const uint64_t got = (uint64_t)g_rc.t[i] * 1000u / (cfg.clk_hz / 1000000u);
+        TASSERT(got + 10u >= sched && got <= sched + slack_ns);
+    }
+
+    /* Batched by size (one word past 256 bytes at most) and by latency. */
+    TASSERT(g_rc.raw_len_max <= 256u + 5u);
+    TASSERT(ds->frames < tx->words_total / 16u);
+
+    /* The byte stream decodes the same, garbage before the first magic included. */
+    static aer_raw_decoder_t dec2;
+    static raw_capture_t rc2;
+    memset(&rc2, 0, sizeof(rc2));
+    aer_raw_decoder_init(&dec2, &(aer_raw_decoder_cfg_t){ .burst_cb = on_raw_burst, .user = &rc2 });
+    aer_raw_decoder_bytes(&dec2, (const uint8_t *)"AER\x00junk", 8u);
+    for (uint32_t off = 0u; off < g_rc.nbytes; off += 7u) {
+        const uint32_t k = (g_rc.nbytes - off < 7u) ? g_rc.nbytes - off : 7u;
+        aer_raw_decoder_bytes(&dec2, &g_rc.bytes[off], k);
+    }
+    TASSERT_EQ_U32(dec2.stats.frames, ds->frames);
+    TASSERT_EQ_U32(dec2.stats.words, ds->words);
+    TASSERT_EQ_U32(dec2.stats.seq_lost, 0u);
+    TASSERT(events_equal(&rc2.got, &g_exp));
+}
+
+/* n words of bursts (row r, cols r+1 and r+3, tail) starting at word *k of
+ * the sequence. A column read as a row would give an event 2 columns off. */
+static void raw_words(uint32_t *w, uint32_t n, uint32_t *k)
+{
+    static const uint32_t off[3] = { 0u, 1u, 3u };
+    for (uint32_t i = 0u; i < n; ++i, ++*k) {
+        const uint32_t row = (*k / 4u) % (AER_COLS - 3u);
+        w[i] = encode((*k % 4u == 3u) ? AER_TAIL_PAYLOAD : row + off[*k % 4u]);
+    }
+}
+
+/* Words lost before the host (no host, refused frames) show up as word_index
+ * gaps; the burst they cut is discarded rather than misassembled. */
+static void test_raw_passthrough_loss(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.cdc.bytes_per_s = 100000u;
+    cfg.cdc.fifo_bytes  = 64u;
+    hal_sim_init(&cfg);
+    raw_capture_start();
+    usb_stream_init(&(usb_stream_cfg_t){
+        .data_width_bits = (uint8_t)AER_DATA_WIDTH, .raw_passthrough = true,
+        .batch_max_bytes = 0u,
+    });
+
+    uint32_t w[31];
+    uint32_t k = 0u;
+    raw_words(w, 30u, &k);
+    TASSERT(usb_stream_send_raw_words(w, NULL, 30u));
+    hal_sim_set_connected(false);
+    raw_words(w, 9u, &k);                   /* cuts a burst both ways */
+    TASSERT(!usb_stream_send_raw_words(w, NULL, 9u));
+    TASSERT_EQ_U32(usb_stream_stats()->raw_words_dropped_not_connected, 9u);
+    hal_sim_set_connected(true);
+
+    /* 31-word frames (0.8 ms of link each) every 0.3 ms: once the buffers
+     * fill, about half are refused, in runs that end at arbitrary words. */
+    uint32_t sent = 39u;
+    for (uint32_t i = 0u; i < 200u; ++i) {
+        raw_words(w, 31u, &k);
+        (void)usb_stream_send_raw_words(w, NULL, 31u);
+        sent += 31u;
+        hal_sim_advance_ns(300000u);
+    }
+    TASSERT(hal_sim_stream_drain(100000000000ull));
+    raw_words(w, 3u, &k);                   /* accepted: the host sees the last gap */
+    TASSERT(usb_stream_send_raw_words(w, NULL, 3u));
+    sent += 3u;
+    TASSERT(hal_sim_stream_drain(100000000000ull));
+    hal_sim_set_frame_sink(NULL, NULL);
+
+    const usb_stream_stats_t *us = usb_stream_stats();
+    const aer_raw_decoder_stats_t *ds = &g_rc.dec.stats;
+    TASSERT(us->raw_words_dropped_write_failed > 0u);
+    TASSERT_EQ_U32(us->raw_words_sent + us->raw_words_dropped_write_failed
+                   + us->raw_words_dropped_not_connected, sent);
+    TASSERT_EQ_U32(ds->words, us->raw_words_sent);
+    TASSERT_EQ_U32(ds->words_lost, sent - us->raw_words_sent);
+    TASSERT(ds->bursts_discarded > 0u);
+    TASSERT(ds->words_skipped > 0u);
+    TASSERT_EQ_U32(ds->frames_bad, 0u);
+    TASSERT(!g_rc.timed);
+
+    /* Every event the host did assemble is one that was sent: no column was
+     * taken for a row after a gap. */
+    TASSERT(g_rc.got.n > 0u);
+    for (uint32_t i = 0u; i < g_rc.got.n; ++i) {
+        const uint32_t d = (uint32_t)g_rc.got.ev[i].col - g_rc.got.ev[i].row;
+        TASSERT(d == 1u || d == 3u);
+    }
+}
+
+/* ---------------- host control channel (usb_ctrl) ---------------- */
+
+typedef struct {
+    uint8_t  types[64];          /* frame types, in arrival order */
+    uint32_t frames;
+    uint8_t  hello_flags;
+    uint8_t  rsp_buf[256];       /* last CTRL_RSP payload */
+    aer_ctrl_rsp_t rsp;
+    uint32_t rsps;
+    uint16_t tag;
+} ctrl_capture_t;
+
+static void on_ctrl_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    (void)seq;
+    ctrl_capture_t *cc = (ctrl_capture_t *)user;
+    cc->types[cc->frames++ % 64u] = type;
+    if (type == HAL_STREAM_HELLO && len > 18u) cc->hello_flags = payload[18];
+    if (type != HAL_STREAM_CTRL_RSP || len > sizeof(cc->rsp_buf)) return;
+    memcpy(cc->rsp_buf, payload, len);
+    if (aer_ctrl_parse_rsp(cc->rsp_buf, len, &cc->rsp)) cc->rsps++;
+}
+
+static ctrl_capture_t g_cc;
+
+/* Type of the frame k frames before the last one. */
+static uint8_t ctrl_frame_back(uint32_t k)
+{
+    return g_cc.types[(g_cc.frames - 1u - k) % 64u];
+}
+
+static void ctrl_bytes(const uint8_t *p, size_t n)
+{
+    for (size_t i = 0u; i < n; ++i) {
+        (void)usb_ctrl_on_host_byte(p[i]);
+    }
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+}
+
+/* One command, a byte at a time; its response (or NULL). */
+static const aer_ctrl_rsp_t *ctrl_call(uint8_t cmd, const void *payload, uint16_t len)
+{
+    uint8_t f[AER_CTRL_FRAME_MAX];
+    const size_t n = aer_ctrl_encode(f, cmd, ++g_cc.tag, payload, len);
+    const uint32_t rsps = g_cc.rsps;
+    ctrl_bytes(f, n);
+    if (g_cc.rsps != rsps + 1u || g_cc.rsp.tag != g_cc.tag || g_cc.rsp.cmd != cmd) return NULL;
+    return &g_cc.rsp;
+}
+
+static const aer_ctrl_rsp_t *ctrl_set(const char *assignments)
+{
+    aer_ctrl_kv_t kv[USB_CTRL_P_COUNT];
+    const int n = aer_ctrl_parse_assignments(assignments, kv, USB_CTRL_P_COUNT);
+    TASSERT(n > 0);
+    uint8_t f[AER_CTRL_FRAME_MAX];
+    const size_t len = aer_ctrl_encode_set(f, ++g_cc.tag, kv, (uint32_t)n);
+    const uint32_t rsps = g_cc.rsps;
+    ctrl_bytes(f, len);
+    return (g_cc.rsps == rsps + 1u && g_cc.rsp.tag == g_cc.tag) ? &g_cc.rsp : NULL;
+}
+
+static uint32_t rsp_u32(const aer_ctrl_rsp_t *r, uint32_t off)
+{
+    uint32_t v = 0u;
+    if (r && r->body_len >= off + 4u) memcpy(&v, &r->body[off], 4u);
+    return v;
+}
+
+/* One step of *(uint64_t *)ctx ns of virtual time. */
+static uint32_t sched_one_step(aer_sched_task_t *t)
+{
+    const uint32_t t0 = hal_cycles_now();
+    hal_sim_advance_ns(*(const uint64_t *)t->ctx);
+    (void)aer_sched_step(t, t0);
+    return 1u;
+}
+
+static uint32_t sched_usb(aer_sched_task_t *t)
+{
+    (void)t;
+    usb_stream_poll();
+    return 0u;
+}
+
+/* Parameters, statuses, all-or-nothing SET, stats baseline, framing errors. */
+static void test_ctrl_channel(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    memset(&g_cc, 0, sizeof(g_cc));
+    hal_sim_set_frame_sink(on_ctrl_frame, &g_cc);
+
+    usb_stream_init(&(usb_stream_cfg_t){
+        .data_width_bits = (uint8_t)AER_DATA_WIDTH, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+    uint32_t storage[16];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 16u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    uint64_t step_ns = 3000u;
+    aer_sched_task_t tasks[2] = {
+        { .name = "decode", .fn = sched_one_step, .ctx = &step_ns, .budget_us = 5u },
+        { .name = "usb",    .fn = sched_usb },
+    };
+    aer_sched_t sched;
+    aer_sched_init(&sched, tasks, 2u);
+    usb_ctrl_init(&(usb_ctrl_cfg_t){
+        .rx = &rx, .rx_stats = aer_rx_poll_stats(&rx), .sink = &sink, .burst = &burst, .sched = &sched,
+    });
+
+    const aer_ctrl_rsp_t *r = ctrl_call(USB_CTRL_CMD_PING, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+    TASSERT_EQ_U32(rsp_u32(r, 0u), (1u << USB_CTRL_P_COUNT) - 1u);
+
+    /* GET: all, then a chosen subset in the order asked. */
+    aer_ctrl_kv_t kv[USB_CTRL_P_COUNT];
+    r = ctrl_call(USB_CTRL_CMD_GET_PARAMS, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+    TASSERT_EQ_U32(aer_ctrl_rsp_kv(r, kv, USB_CTRL_P_COUNT), USB_CTRL_P_COUNT);
+    TASSERT_EQ_U32(kv[USB_CTRL_P_BATCH_MAX_BYTES].value, 64u);
+    TASSERT_EQ_U32(kv[USB_CTRL_P_SINK_ENABLED].value, 1u);
+    TASSERT_EQ_U32(kv[USB_CTRL_P_RAW_WORDS].value, 0u);
+    const uint8_t keys[2] = { USB_CTRL_P_BATCH_LATENCY_US, USB_CTRL_P_TIMESTAMPS };
+    r = ctrl_call(USB_CTRL_CMD_GET_PARAMS, keys, 2u);
+    TASSERT(r && aer_ctrl_rsp_kv(r, kv, USB_CTRL_P_COUNT) == 2u);
+    TASSERT(kv[0].key == USB_CTRL_P_BATCH_LATENCY_US && kv[0].value == 100u);
+    TASSERT(kv[1].key == USB_CTRL_P_TIMESTAMPS && kv[1].value == 0u);
+
+    /* A record format change is announced by HELLO, just before the response. */
+    r = ctrl_set("timestamps=1,rowmask=1");
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+    TASSERT_EQ_U32(aer_ctrl_rsp_kv(r, kv, USB_CTRL_P_COUNT), 2u);
+    TASSERT(usb_stream_config()->timestamps_enabled && usb_stream_config()->rowmask_enabled);
+    TASSERT_EQ_U32(ctrl_frame_back(0u), HAL_STREAM_CTRL_RSP);
+    TASSERT_EQ_U32(ctrl_frame_back(1u), HAL_STREAM_HELLO);
+    TASSERT(g_cc.hello_flags & USB_STREAM_HELLO_F_TIMESTAMPS);
+
+    /* All or nothing: the bad kv comes back and the good one is not applied. */
+    uint8_t f[AER_CTRL_FRAME_MAX];
+    const aer_ctrl_kv_t bad[2] = { { USB_CTRL_P_RAW_WORDS, 1u }, { 77u, 1u } };
+    const uint32_t frames = g_cc.frames;
+    ctrl_bytes(f, aer_ctrl_encode_set(f, ++g_cc.tag, bad, 2u));
+    TASSERT_EQ_U32(g_cc.frames, frames + 1u);          /* no HELLO */
+    TASSERT_EQ_U32(g_cc.rsp.status, USB_CTRL_ST_UNKNOWN_PARAM);
+    TASSERT(aer_ctrl_rsp_kv(&g_cc.rsp, kv, 1u) == 1u && kv[0].key == 77u);
+    TASSERT(!usb_stream_raw_passthrough());
+    r = ctrl_set("batch_max_bytes=100000");
+    TASSERT(r && r->status == USB_CTRL_ST_BAD_VALUE);
+    TASSERT_EQ_U32(usb_stream_config()->batch_max_bytes, 64u);
+    r = ctrl_set("rx_overflow=3");
+    TASSERT(r && r->status == USB_CTRL_ST_BAD_VALUE);
+
+    r = ctrl_set("rx_valid_timeout_us=50,rx_overflow=1,rx_bp_timeout_us=7");
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+    TASSERT_EQ_U32(rx.wait_valid_timeout_us, 50u);
+    TASSERT_EQ_U32(rx.overflow, AER_RX_OVERFLOW_BACKPRESSURE);
+    TASSERT_EQ_U32(rx.backpressure_timeout_us, 7u);
+
+    /* GET_STATS counts from the last RESET_STATS; the counters keep running. */
+    uint32_t w[4] = { encode(3u), encode(4u), encode(9u), encode(AER_TAIL_PAYLOAD) };
+    TASSERT_EQ_U32(aer_event_sink_on_words(&sink, &burst, w, NULL, 4u), 4u);
+    aer_ctrl_stats_t st;
+    r = ctrl_call(USB_CTRL_CMD_GET_STATS, NULL, 0u);
+    TASSERT(r && aer_ctrl_rsp_stats(r, &st));
+    TASSERT_EQ_U32(st.counters[USB_CTRL_STAT_EVENTS_EMITTED], 2u);
+    TASSERT_EQ_U32(st.counters[USB_CTRL_STAT_BURSTS], 1u);
+    TASSERT_EQ_U32((uint32_t)st.t_us_reset, 0u);
+
+    /* ...and carries the main loop's task accounting, which RESET_STATS clears. */
+    (void)aer_sched_run_once(&sched);
+    step_ns = 7000u;
+    (void)aer_sched_run_once(&sched);
+    r = ctrl_call(USB_CTRL_CMD_GET_STATS, NULL, 0u);
+    TASSERT(r && aer_ctrl_rsp_stats(r, &st));
+    TASSERT_EQ_U32(st.ver, USB_CTRL_STATS_VER);
+    TASSERT_EQ_U32(st.cycles_hz, hal_cycles_hz());
+    TASSERT_EQ_U32(st.n_tasks, 2u);
+    TASSERT(strcmp(st.tasks[0].name, "decode") == 0 && strcmp(st.tasks[1].name, "usb") == 0);
+    TASSERT_EQ_U32(st.tasks[0].runs, 2u);
+    TASSERT_EQ_U32(st.tasks[0].overruns, 1u);
+    TASSERT_EQ_U32(st.tasks[0].cycles_max, tasks[0].stats.cycles_max);
+    TASSERT(st.tasks[0].cycles_max >= hal_us_to_cycles(7u));
+    TASSERT_EQ_U32(st.tasks[1].interval_max, tasks[1].stats.interval_max);
+    TASSERT(st.tasks[1].interval_max >= hal_us_to_cycles(7u));
+    hal_sim_advance_ns(5000000u);
+    r = ctrl_call(USB_CTRL_CMD_RESET_STATS, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_OK && r->body_len == 0u);
+    TASSERT_EQ_U32(aer_event_sink_on_words(&sink, &burst, w, NULL, 4u), 4u);
+    r = ctrl_call(USB_CTRL_CMD_GET_STATS, NULL, 0u);
+    TASSERT(r && aer_ctrl_rsp_stats(r, &st));
+    TASSERT_EQ_U32(st.counters[USB_CTRL_STAT_EVENTS_EMITTED], 2u);
+    TASSERT_EQ_U32(st.counters[USB_CTRL_STAT_FRAMES_WRITTEN], 1u);   /* the RESET response */
+    TASSERT(st.t_us_reset >= 5000u && st.t_us >= st.t_us_reset);
+    TASSERT_EQ_U32(aer_event_sink_stats(&sink)->events_emitted, 4u);
+    TASSERT(st.n_tasks == 2u && st.tasks[0].runs == 0u && st.tasks[0].cycles_max == 0u);
+
+    /* Framing: unknown command, payload where none is taken, bad version. */
+    r = ctrl_call(99u, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_UNKNOWN_CMD);
+    r = ctrl_call(USB_CTRL_CMD_PING, "x", 1u);
+    TASSERT(r && r->status == USB_CTRL_ST_BAD_FRAME);
+    const uint32_t rsps = g_cc.rsps;
+    const uint8_t bad_ver[10] = { 'A', 'E', 'R', 'C', 7u, USB_CTRL_CMD_PING, 0u, 0u, 1u, 0u };
+    ctrl_bytes(bad_ver, sizeof(bad_ver));
+    TASSERT(g_cc.rsps == rsps + 1u && g_cc.rsp.status == USB_CTRL_ST_BAD_FRAME && g_cc.rsp.tag == 1u);
+
+    /* Stray bytes are skipped, '?' still asks for HELLO, a false start restarts. */
+    const uint32_t ignored = usb_ctrl_counters()->bytes_ignored;
+    ctrl_bytes((const uint8_t *)"xyz?AE", 6u);
+    TASSERT_EQ_U32(ctrl_frame_back(0u), HAL_STREAM_HELLO);
+    TASSERT_EQ_U32(usb_ctrl_counters()->bytes_ignored, ignored + 3u);
+    r = ctrl_call(USB_CTRL_CMD_PING, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+
+    /* A frame left half-sent is dropped after the timeout. */
+    aer_ctrl_encode(f, USB_CTRL_CMD_RESET_STATS, 0u, NULL, 0u);
+    ctrl_bytes(f, 6u);
+    hal_sim_advance_ns((uint64_t)USB_CTRL_RX_TIMEOUT_US * 2000u);
+    r = ctrl_call(USB_CTRL_CMD_PING, NULL, 0u);
+    TASSERT(r && r->status == USB_CTRL_ST_OK);
+    TASSERT_EQ_U32(usb_ctrl_counters()->frames_timed_out, 1u);
+
+    /* The receiver on another core: its parameters are not ours to set. */
+    usb_ctrl_init(&(usb_ctrl_cfg_t){ .rx_stats = aer_rx_poll_stats(&rx), .sink = &sink, .burst = &burst });
+    r = ctrl_call(USB_CTRL_CMD_PING, NULL, 0u);
+    TASSERT(r && (rsp_u32(r, 0u) >> USB_CTRL_P_RX_OVERFLOW) == 0u);
+    r = ctrl_set("sink_enabled=0,rx_overflow=0");
+    TASSERT(r && r->status == USB_CTRL_ST_UNAVAILABLE);
+    TASSERT(sink.cfg.enabled);
+    const uint8_t rx_key = USB_CTRL_P_RX_NEUTRAL_TIMEOUT_US;
+    r = ctrl_call(USB_CTRL_CMD_GET_PARAMS, &rx_key, 1u);
+    TASSERT(r && r->status == USB_CTRL_ST_UNAVAILABLE);
+    r = ctrl_call(USB_CTRL_CMD_GET_PARAMS, NULL, 0u);
+    TASSERT(r && aer_ctrl_rsp_kv(r, kv, USB_CTRL_P_COUNT) == USB_CTRL_P_RX_OVERFLOW);
+
+    TASSERT_EQ_U32(usb_ctrl_counters()->rsp_failed, 0u);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* Host-decoded RAW_BIN events, appended to the same list as EVENT_BIN ones. */
+static void on_switch_burst(uint8_t row, const uint8_t *cols, uint16_t count,
+                            const aer_burst_info_t *info, void *user)
+{
+    (void)info;
+    event_list_t *got = (event_list_t *)user;
+    for (uint16_t i = 0u; i < count && got->n < MAX_EVENTS; ++i) {
+        got->ev[got->n].row = row;
+        got->ev[got->n].col = cols[i];
+        got->n++;
+    }
+}
+
+static void on_switch_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    on_frame(type, seq, payload, len, &g_fc);
+    (void)aer_raw_decoder_frame((aer_raw_decoder_t *)user, type, seq, payload, len);
+}
+
+/* Raw passthrough switched on and back off by host commands mid-burst, in
+ * the firmware loop shape: every event arrives once, in order. */
+static void test_ctrl_mode_switch(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    load_traffic(300u, 40u, &g_exp);
+
+    memset(&g_fc, 0, sizeof(g_fc));
+    static aer_raw_decoder_t dec;
+    aer_raw_decoder_init(&dec, &(aer_raw_decoder_cfg_t){ .burst_cb = on_switch_burst, .user = &g_fc.got });
+    hal_sim_set_frame_sink(on_switch_frame, &dec);
+
+    usb_stream_init(&(usb_stream_cfg_t){
+        .data_width_bits = (uint8_t)AER_DATA_WIDTH, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+    uint32_t storage[64];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 64u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+    usb_ctrl_init(&(usb_ctrl_cfg_t){ .rx = &rx, .rx_stats = aer_rx_poll_stats(&rx), .sink = &sink, .burst = &burst });
+
+    const uint32_t total = hal_sim_tx_stats()->words_total;
+    uint8_t f[AER_CTRL_FRAME_MAX];
+    uint32_t sent = 0u;
+    uint32_t decoded = 0u;
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || !ringbuf_u32_is_empty(&rb)) && iters++ < 1000000u) {
+        usb_stream_poll();
+
+        /* The host sends each command while a burst is half received. */
+        const uint32_t acked = hal_sim_tx_stats()->words_acked;
+        if (sent < 2u && acked >= (sent + 1u) * total / 3u && aer_burst_state(&burst) != AER_BURST_EXPECT_ROW
+            && !sink.raw_active) {
+            const aer_ctrl_kv_t kv = { USB_CTRL_P_RAW_WORDS, 1u };
+            TASSERT(hal_sim_host_write(f, aer_ctrl_encode_set(f, (uint16_t)sent, &kv, 1u)));
+            sent++;
+        } else if (sent == 1u && acked >= 2u * total / 3u && !sink.raw_at_boundary) {
+            const aer_ctrl_kv_t kv = { USB_CTRL_P_RAW_WORDS, 0u };
+            TASSERT(hal_sim_host_write(f, aer_ctrl_encode_set(f, (uint16_t)sent, &kv, 1u)));
+            sent++;
+        }
+        int c;
+        while ((c = hal_stdio_getc_nonblocking()) >= 0) {
+            (void)usb_ctrl_on_host_byte((uint8_t)c);
+        }
+
+        if (hal_gpio_read_data_raw() == 0u) {
+            hal_sim_spin();
+            continue;
+        }
+        TASSERT(aer_rx_poll_step(&rx) == AER_RX_POLL_OK);
+        ringbuf_u32_span_t rd;
+        const uint32_t n = ringbuf_u32_read_claim(&rb, &rd);
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            decoded += aer_event_sink_on_words(&sink, &burst, rd.ptr[p], NULL, rd.len[p]);
+        }
+        ringbuf_u32_read_commit(&rb, n);
+    }
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    hal_sim_set_frame_sink(NULL, NULL);
+
+    const aer_event_sink_stats_t *ss = aer_event_sink_stats(&sink);
+    const usb_stream_stats_t *us = usb_stream_stats();
+    TASSERT_EQ_U32(sent, 2u);
+    TASSERT_EQ_U32(usb_ctrl_counters()->cmds_ok, 2u);
+    TASSERT_EQ_U32(ss->mode_switches, 2u);
+    TASSERT(!usb_stream_raw_passthrough());
+    TASSERT(us->raw_words_sent > 0u && us->events_sent > 0u);
+    TASSERT_EQ_U32(decoded + us->raw_words_sent, total);
+    TASSERT_EQ_U32(dec.stats.words, us->raw_words_sent);
+    TASSERT_EQ_U32(dec.stats.words_lost, 0u);
+    TASSERT_EQ_U32(dec.stats.words_skipped, 0u);
+    TASSERT_EQ_U32(g_fc.seq_errors, 0u);
+    TASSERT_EQ_U32(burst.bursts_completed + dec.burst.bursts_completed, 300u);
+
+    /* Neither side saw a partial burst, and the records arrived in order. */
+    TASSERT(events_equal(&g_fc.got, &g_exp));
+}
+
+/* ---------------- budgeted main loop (aer_sched) ---------------- */
+
+#define SCHED_DECODE_NS_PER_WORD 500u
+#define SCHED_CHUNK_WORDS        8u
+
+typedef struct {
+    aer_rx_poll_t    *rx;
+    ringbuf_u32_t    *rb;
+    aer_burst_t      *burst;
+    aer_event_sink_t *sink;
+    uint32_t          word_cycles;
+    uint32_t          stall_episodes;
+} sched_loop_t;
+
+static uint32_t sched_acquire(aer_sched_task_t *t)
+{
+    sched_loop_t *l = (sched_loop_t *)t->ctx;
+    if (hal_gpio_read_data_raw() == 0u) return 0u;
+    const bool held = l->rx->bp_stalled && ringbuf_u32_is_full(l->rb);
+    const uint32_t n = aer_rx_poll_service(l->rx, 256u, t->budget_us);
+    if (l->rx->bp_stalled && !held) l->stall_episodes++;
+    return n;
+}
+
+/* A slow consumer: SCHED_DECODE_NS_PER_WORD of virtual time per word, in
+ * chunks cut to the budget like pico_aer_rx.c's task_decode(). */
+static uint32_t sched_decode(aer_sched_task_t *t)
+{
+    sched_loop_t *l = (sched_loop_t *)t->ctx;
+    uint32_t done = 0u;
+    for (;;) {
+        uint32_t max = aer_sched_fit_count(t, l->word_cycles, SCHED_CHUNK_WORDS);
+        if (max == 0u) {
+            if (done != 0u) return done;
+            max = 1u;
+        }
+        const uint32_t t_chunk = hal_cycles_now();
+        ringbuf_u32_span_t rd;
+        uint32_t n = ringbuf_u32_read_claim(l->rb, &rd);
+        if (n > max) n = max;
+        if (rd.len[0] > n) rd.len[0] = n;
+        rd.len[1] = n - rd.len[0];
+        for (uint32_t p = 0u; p < 2u; ++p) {
+            (void)aer_burst_feed_raw_words_span(l->burst, rd.ptr[p], rd.len[p], aer_event_sink_on_burst, l->sink);
+        }
+        ringbuf_u32_read_commit(l->rb, n);
+        hal_sim_advance_ns((uint64_t)n * SCHED_DECODE_NS_PER_WORD);
+        if (n == 0u) return done;
+        done += n;
+        l->word_cycles = (aer_sched_step(t, t_chunk) + n - 1u) / n;
+    }
+}
+
+/*
+ * pico_aer_rx.c's loop against a decoder far slower than the bus: nothing is
+ * lost under backpressure, and the budgets bound how long the handshake and
+ * USB wait for their turn, however much backlog builds up.
+ */
+static void test_sched_budgets(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    hal_sim_init(&cfg);
+    load_traffic(300u, 0u, &g_exp);
+
+    memset(&g_fc, 0, sizeof(g_fc));
+    hal_sim_set_frame_sink(on_frame, &g_fc);
+    usb_stream_init(&(usb_stream_cfg_t){
+        .data_width_bits = (uint8_t)AER_DATA_WIDTH, .batch_max_bytes = 64u, .batch_max_latency_us = 100u,
+    });
+    aer_event_sink_t sink;
+    aer_event_sink_init(&sink, &(aer_event_sink_cfg_t){ .enabled = true });
+    uint32_t storage[256];
+    ringbuf_u32_t rb;
+    TASSERT(ringbuf_u32_init(&rb, storage, 256u));
+    aer_rx_poll_t rx;
+    aer_rx_poll_init(&rx, &rb, 0u, 0u);
+    aer_rx_poll_set_overflow(&rx, AER_RX_OVERFLOW_BACKPRESSURE, 0u);
+    aer_burst_t burst;
+    aer_burst_init(&burst);
+
+    sched_loop_t l = { .rx = &rx, .rb = &rb, .burst = &burst, .sink = &sink };
+    aer_sched_task_t tasks[3] = {
+        { .name = "acquire", .fn = sched_acquire, .ctx = &l, .budget_us = 10u },
+        { .name = "decode",  .fn = sched_decode,  .ctx = &l, .budget_us = 10u },
+        { .name = "usb",     .fn = sched_usb,     .ctx = &l },
+    };
+    aer_sched_t sched;
+    aer_sched_init(&sched, tasks, 3u);
+    TASSERT_EQ_U32(tasks[0].budget_cycles, hal_us_to_cycles(10u));
+    TASSERT_EQ_U32(tasks[2].budget_cycles, 0u);
+
+    uint32_t iters = 0u;
+    while ((!hal_sim_tx_done() || !ringbuf_u32_is_empty(&rb)) && iters++ < 1000000u) {
+        if (aer_sched_run_once(&sched) == 0u) hal_sim_spin();
+    }
+    TASSERT(usb_stream_flush());
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+
+    const hal_sim_tx_stats_t *tx = hal_sim_tx_stats();
+    TASSERT(hal_sim_tx_done());
+    TASSERT_EQ_U32(tx->words_acked, tx->words_total);
+    TASSERT_EQ_U32(aer_rx_poll_dropped(&rx), 0u);
+    TASSERT(l.stall_episodes > 0u);     /* the decoder really was the bottleneck */
+    TASSERT_EQ_U32(rx.stats.bp_stalls, l.stall_episodes);
+    TASSERT(events_equal(&g_fc.got, &g_exp));
+
+    /* Every task ran every pass; the work adds up. */
+    const aer_sched_stats_t *ss = &sched.stats;
+    TASSERT(ss->passes > 0u);
+    for (uint32_t i = 0u; i < 3u; ++i) {
+        TASSERT_EQ_U32(tasks[i].stats.runs, ss->passes);
+        TASSERT(tasks[i].stats.cycles_max <= ss->pass_cycles_max);
+    }
+    TASSERT_EQ_U32(tasks[0].stats.work, tx->words_total);
+    TASSERT_EQ_U32(tasks[1].stats.work, tx->words_total);
+    TASSERT_EQ_U32(tasks[2].stats.idle_runs, ss->passes);
+
+    /* A run stops within one handshake past its budget; the decoder cuts its
+     * chunks to what is left, so it stays within it and never overruns... */
+    const uint32_t slack = hal_us_to_cycles(SCHED_CHUNK_WORDS * SCHED_DECODE_NS_PER_WORD / 1000u + 1u);
+    TASSERT(tasks[0].stats.cycles_max <= tasks[0].budget_cycles + slack);
+    TASSERT(tasks[1].stats.cycles_max <= tasks[1].budget_cycles);
+    TASSERT_EQ_U32(tasks[1].stats.overruns, 0u);
+    TASSERT(tasks[1].stats.step_cycles_max >= hal_us_to_cycles(SCHED_CHUNK_WORDS * SCHED_DECODE_NS_PER_WORD / 1000u));
+    /* ...so the USB task and the handshake wait at most one pass of budgets. */
+    const uint32_t pass_bound = tasks[0].budget_cycles + tasks[1].budget_cycles + 2u * slack;
+    TASSERT(tasks[2].stats.interval_max <= pass_bound);
+    TASSERT(tasks[0].stats.interval_max <= pass_bound);
+    TASSERT(tx->wait_ack_max_ns <= (uint64_t)pass_bound * 1000000000ull / hal_cycles_hz());
+
+    /* A periodic task runs at most once per period. */
+    aer_sched_task_t slow = { .name = "slow", .fn = sched_usb, .period_us = 100u };
+    aer_sched_init(&sched, &slow, 1u);
+    for (uint32_t i = 0u; i < 1000u; ++i) {
+        (void)aer_sched_run_once(&sched);
+        hal_sim_advance_ns(1000u);
+    }
+    TASSERT_EQ_U32(sched.stats.passes, 1000u);
+    TASSERT(slow.stats.runs >= 9u && slow.stats.runs <= 10u);
+    TASSERT(slow.stats.interval_max >= hal_us_to_cycles(100u));
+
+    /* An overrun is a step that alone is longer than the budget. */
+    uint64_t step_ns = 4000u;
+    aer_sched_task_t stepped = { .name = "stepped", .fn = sched_one_step, .ctx = &step_ns, .budget_us = 5u };
+    aer_sched_init(&sched, &stepped, 1u);
+    (void)aer_sched_run_once(&sched);
+    TASSERT_EQ_U32(stepped.stats.overruns, 0u);
+    step_ns = 6000u;
+    (void)aer_sched_run_once(&sched);
+    TASSERT_EQ_U32(stepped.stats.overruns, 1u);
+    TASSERT(stepped.stats.step_cycles_max >= hal_us_to_cycles(6u));
+
+    aer_sched_reset_stats(&sched);
+    TASSERT_EQ_U32(sched.stats.passes, 0u);
+    TASSERT_EQ_U32(stepped.stats.runs, 0u);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* ---------------- deferred binary log (hal_dlog) ---------------- */
+
+#define DLOG_CAP 1024u
+
+typedef struct {
+    uint16_t id[DLOG_CAP];
+    uint8_t  level[DLOG_CAP];
+    uint8_t  nargs[DLOG_CAP];
+    uint32_t t[DLOG_CAP];
+    uint32_t args[DLOG_CAP][HAL_DLOG_MAX_ARGS];
+    uint32_t n;
+    uint32_t frames;
+    uint32_t bad;               /* malformed LOG_BIN frames */
+    uint32_t table_id;          /* from the last frame */
+    uint32_t dropped;           /* cumulative count from the last frame */
+} dlog_capture_t;
+
+/* Decodes the LOG_BIN layout documented in hal_dlog.h. */
+static void on_dlog_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    (void)seq;
+    dlog_capture_t *dc = (dlog_capture_t *)user;
+    if (type != HAL_STREAM_LOG_BIN) return;
+    dc->frames++;
+    if (len < 12u || payload[0] != HAL_DLOG_VER || payload[2] != 0u || payload[3] != 0u) {
+        dc->bad++;
+        return;
+    }
+    memcpy(&dc->table_id, &payload[4], 4u);
+    memcpy(&dc->dropped, &payload[8], 4u);
+
+    uint32_t i = 12u;
+    for (uint32_t r = 0u; r < payload[1]; ++r) {
+        if (i + 8u > len || i + 8u + 4u * payload[i + 3u] > len || dc->n >= DLOG_CAP) {
+            dc->bad++;
+            return;
+        }
+        const uint32_t k = dc->n++;
+        dc->id[k] = (uint16_t)(payload[i] | (payload[i + 1u] << 8));
+        dc->level[k] = payload[i + 2u];
+        dc->nargs[k] = payload[i + 3u];
+        memcpy(&dc->t[k], &payload[i + 4u], 4u);
+        memcpy(dc->args[k], &payload[i + 8u], 4u * dc->nargs[k]);
+        i += 8u + 4u * dc->nargs[k];
+    }
+    if (i != len) dc->bad++;
+}
+
+static dlog_capture_t g_dc;
+
+static void dlog_capture_start(void)
+{
+    memset(&g_dc, 0, sizeof(g_dc));
+    hal_sim_set_frame_sink(on_dlog_frame, &g_dc);
+}
+
+static void test_dlog_records(void)
+{
+    hal_sim_init(NULL);
+    dlog_capture_start();
+
+    /* Level filter: the simulator starts at HAL_LOG_INFO. */
+    const uint32_t a[2] = { 0xDEADBEEFu, 7u };
+    TASSERT(hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, a));
+    hal_sim_advance_ns(1000u);
+    TASSERT(!hal_dlog_write(HAL_LOG_DEBUG, DLOG_RX_BP_TIMEOUT, 2u, a));
+    HAL_DLOG0(HAL_LOG_ERROR, DLOG_RX_NEUTRAL_TIMEOUT, "no args");
+    TASSERT_EQ_U32(hal_dlog_pending(), 2u);
+    TASSERT_EQ_U32(hal_dlog_stats()->filtered, 1u);
+    TASSERT_EQ_U32(g_dc.frames, 0u);   /* nothing formatted or sent at the site */
+
+    TASSERT_EQ_U32(hal_dlog_flush(), 2u);
+    TASSERT_EQ_U32(hal_dlog_pending(), 0u);
+    hal_stream_poll();
+    TASSERT_EQ_U32(g_dc.frames, 1u);
+    TASSERT_EQ_U32(g_dc.bad, 0u);
+    TASSERT_EQ_U32(g_dc.table_id, HAL_DLOG_TABLE_ID);
+    TASSERT_EQ_U32(g_dc.dropped, 0u);
+    TASSERT_EQ_U32(g_dc.n, 2u);
+    TASSERT_EQ_U32(g_dc.id[0], DLOG_RX_BP_TIMEOUT);
+    TASSERT_EQ_U32(g_dc.level[0], HAL_LOG_WARN);
+    TASSERT_EQ_U32(g_dc.nargs[0], 2u);
+    TASSERT_EQ_U32(g_dc.args[0][0], 0xDEADBEEFu);
+    TASSERT_EQ_U32(g_dc.args[0][1], 7u);
+    TASSERT_EQ_U32(g_dc.id[1], DLOG_RX_NEUTRAL_TIMEOUT);
+    TASSERT_EQ_U32(g_dc.nargs[1], 0u);
+    TASSERT(g_dc.t[1] - g_dc.t[0] >= hal_cycles_hz() / 1000000u);   /* the site's time, not the flush's */
+
+    /* Full ring: the newest records are dropped and the count travels in the frames. */
+    for (uint32_t i = 0u; i < HAL_DLOG_RING_LEN + 5u; ++i) {
+        const uint32_t b[2] = { i, 0u };
+        (void)hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, b);
+    }
+    TASSERT_EQ_U32(hal_dlog_stats()->dropped, 5u);
+    g_dc.n = 0u;
+    g_dc.frames = 0u;
+    TASSERT_EQ_U32(hal_dlog_flush(), HAL_DLOG_RING_LEN);
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    TASSERT_EQ_U32(g_dc.n, HAL_DLOG_RING_LEN);
+    TASSERT(g_dc.frames > 1u);   /* split at HAL_DLOG_FRAME_BYTES */
+    TASSERT_EQ_U32(g_dc.dropped, 5u);
+    for (uint32_t i = 0u; i < g_dc.n; ++i) TASSERT_EQ_U32(g_dc.args[i][0], i);
+
+    /* No host: records are discarded instead of filling the ring. */
+    hal_sim_set_connected(false);
+    TASSERT(hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, a));
+    TASSERT_EQ_U32(hal_dlog_flush(), 0u);
+    TASSERT_EQ_U32(hal_dlog_pending(), 0u);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* Slow link: a refused LOG_BIN frame leaves its records queued for the next flush. */
+static void test_dlog_backpressure(void)
+{
+    hal_sim_cfg_t cfg = hal_sim_cfg_default();
+    cfg.cdc.bytes_per_s = 100000u;
+    cfg.cdc.fifo_bytes  = 64u;
+    hal_sim_init(&cfg);
+    dlog_capture_start();
+
+    static const uint8_t fill[256];
+    while (hal_stream_write(HAL_STREAM_MARKER, fill, sizeof(fill))) {}
+    while (hal_stream_write(HAL_STREAM_MARKER, fill, 1u)) {}
+
+    const uint32_t a[2] = { 1u, 2u };
+    TASSERT(hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, a));
+    TASSERT_EQ_U32(hal_dlog_flush(), 0u);
+    TASSERT_EQ_U32(hal_dlog_pending(), 1u);
+    TASSERT_EQ_U32(hal_dlog_stats()->frames_deferred, 1u);
+
+    TASSERT(hal_sim_stream_drain(10000000000ull));
+    TASSERT_EQ_U32(hal_dlog_flush(), 1u);
+    TASSERT(hal_sim_stream_drain(10000000000ull));
+    TASSERT_EQ_U32(g_dc.n, 1u);
+    TASSERT_EQ_U32(g_dc.args[0][1], 2u);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* Core1 (a thread) and the core0 main loop log concurrently while core0
+ * flushes: every record arrives once, in per-core order, or is counted as
+ * dropped. */
+#define DLOG_PER_PRODUCER 400u
+
+static void *dlog_core1(void *p)
+{
+    (void)p;
+    hal_sim_set_core(1u);
+    for (uint32_t i = 0u; i < DLOG_PER_PRODUCER; ++i) {
+        const uint32_t a[2] = { 1u, i };
+        (void)hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, a);
+        if ((i & 15u) == 0u) sched_yield();
+    }
+    return NULL;
+}
+
+static void test_dlog_producers(void)
+{
+    hal_sim_init(NULL);
+    dlog_capture_start();
+
+    pthread_t th;
+    TASSERT(pthread_create(&th, NULL, dlog_core1, NULL) == 0);
+    for (uint32_t i = 0u; i < DLOG_PER_PRODUCER; ++i) {
+        const uint32_t a[2] = { 0u, i };
+        (void)hal_dlog_write(HAL_LOG_WARN, DLOG_RX_BP_TIMEOUT, 2u, a);
+        if ((i & 7u) == 0u) {
+            (void)hal_dlog_flush();
+            hal_stream_poll();
+        }
+        sched_yield();
+    }
+    pthread_join(th, NULL);
+    (void)hal_dlog_flush();
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+
+    uint32_t next[2] = { 0u, 0u };
+    uint32_t out_of_order = 0u;
+    for (uint32_t i = 0u; i < g_dc.n; ++i) {
+        const uint32_t who = g_dc.args[i][0] & 1u;
+        if (g_dc.args[i][1] < next[who]) out_of_order++;
+        next[who] = g_dc.args[i][1] + 1u;
+    }
+    TASSERT_EQ_U32(g_dc.bad, 0u);
+    TASSERT_EQ_U32(out_of_order, 0u);
+    TASSERT_EQ_U32(g_dc.n + hal_dlog_stats()->dropped, 2u * DLOG_PER_PRODUCER);
+    TASSERT_EQ_U32(g_dc.dropped, hal_dlog_stats()->dropped);
+    TASSERT_EQ_U32(hal_dlog_stats()->records, g_dc.n);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+/* The receiver's backpressure timeout is logged through the deferred path. */
+static void test_dlog_rx_sites(void)
+{
+    overload_result_t r;
+    const aer_rx_poll_t rx = run_overload(AER_RX_OVERFLOW_BACKPRESSURE, 5u, 0u, &r);
+    TASSERT(rx.stats.bp_timeouts > HAL_DLOG_RING_LEN);
+    const hal_dlog_stats_t *ds = hal_dlog_stats();
+    TASSERT_EQ_U32(ds->records, HAL_DLOG_RING_LEN);   /* nobody flushed in run_overload() */
+    TASSERT_EQ_U32(ds->records + ds->dropped, rx.stats.bp_timeouts);
+
+    dlog_capture_start();
+    TASSERT_EQ_U32(hal_dlog_flush(), HAL_DLOG_RING_LEN);
+    TASSERT(hal_sim_stream_drain(1000000000ull));
+    TASSERT_EQ_U32(g_dc.id[0], DLOG_RX_BP_TIMEOUT);
+    TASSERT_EQ_U32(g_dc.args[0][0], 5u);   /* timeout_us */
+    TASSERT_EQ_U32(g_dc.args[0][1], 1u);   /* bp_timeouts so far */
+    TASSERT_EQ_U32(g_dc.dropped, rx.stats.bp_timeouts - HAL_DLOG_RING_LEN);
+    hal_sim_set_frame_sink(NULL, NULL);
+}
+
+int main(void)
+{
+    test_lossless_pipeline();
+    test_overflow_policies();
+    test_dual_core_split();
+    test_latch_timestamps();
+    test_cycles64_and_anchors();
+    test_disconnected();
+    test_rowmask_repeats();
+    test_slow_link();
+    test_raw_passthrough();
+    test_raw_passthrough_loss();
+    test_ctrl_channel();
+    test_ctrl_mode_switch();
+    test_sched_budgets();
+    test_dlog_records();
+    test_dlog_backpressure();
+    test_dlog_producers();
+    test_dlog_rx_sites();
+    hal_sim_shutdown();
+
+    if (g_failures == 0) {
+        printf("[PASS] test_sim\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_sim: %d failures\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,185 @@
+#define _POSIX_C_SOURCE 200809L /* pthreads, sched_yield() */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../common/include/spsc_ring.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+static void test_init(void)
+{
+    uint32_t storage[8];
+    spsc_ring_u32_t rb;
+
+    TASSERT(!spsc_ring_u32_init(NULL, storage, 8u));
+    TASSERT(!spsc_ring_u32_init(&rb, NULL, 8u));
+    TASSERT(!spsc_ring_u32_init(&rb, storage, 0u));
+    TASSERT(!spsc_ring_u32_init(&rb, storage, 1u));
+    TASSERT(!spsc_ring_u32_init(&rb, storage, 6u));
+    TASSERT(spsc_ring_u32_init(&rb, storage, 8u));
+    TASSERT_EQ_U32(spsc_ring_u32_capacity(&rb), 8u);
+    TASSERT_EQ_U32(spsc_ring_u32_count(&rb), 0u);
+    TASSERT_EQ_U32(spsc_ring_u32_free(&rb), 8u);
+}
+
+static void test_full_empty_wrap(void)
+{
+    uint32_t storage[4];
+    spsc_ring_u32_t rb;
+    TASSERT(spsc_ring_u32_init(&rb, storage, 4u));
+
+    uint32_t v = 0u;
+    TASSERT(!spsc_ring_u32_pop(&rb, &v));
+    TASSERT(!spsc_ring_u32_peek(&rb, &v));
+
+    /* All slots usable (no reserved empty slot). */
+    for (uint32_t i = 0u; i < 4u; ++i) {
+        TASSERT(spsc_ring_u32_push(&rb, 100u + i));
+    }
+    TASSERT(!spsc_ring_u32_push(&rb, 999u));
+    TASSERT(spsc_ring_u32_is_full(&rb));
+    TASSERT_EQ_U32(spsc_ring_u32_count(&rb), 4u);
+    TASSERT_EQ_U32(spsc_ring_u32_free(&rb), 0u);
+
+    TASSERT(spsc_ring_u32_peek(&rb, &v));
+    TASSERT_EQ_U32(v, 100u);
+    TASSERT(spsc_ring_u32_pop(&rb, &v));
+    TASSERT(!spsc_ring_u32_is_full(&rb));
+    TASSERT(spsc_ring_u32_push(&rb, 104u));
+
+    /* Walk the indices around the storage many times. */
+    uint32_t next_in = 105u, next_out = 101u;
+    for (uint32_t round = 0u; round < 37u; ++round) {
+        const uint32_t k = 1u + (round % 4u);
+        for (uint32_t i = 0u; i < k; ++i) {
+            TASSERT(spsc_ring_u32_pop(&rb, &v));
+            TASSERT_EQ_U32(v, next_out++);
+        }
+        for (uint32_t i = 0u; i < k; ++i) {
+            TASSERT(spsc_ring_u32_push(&rb, next_in++));
+        }
+        TASSERT(!spsc_ring_u32_push(&rb, 999u));
+    }
+    while (spsc_ring_u32_pop(&rb, &v)) {
+        TASSERT_EQ_U32(v, next_out++);
+    }
+    TASSERT_EQ_U32(next_out, next_in);
+
+    spsc_ring_u32_reset(&rb);
+    TASSERT_EQ_U32(spsc_ring_u32_count(&rb), 0u);
+    TASSERT(spsc_ring_u32_push(&rb, 7u));
+    TASSERT(spsc_ring_u32_pop(&rb, &v));
+    TASSERT_EQ_U32(v, 7u);
+}
+
+/* Free-running counters must survive 2^32 wrap. */
+static void test_counter_wrap(void)
+{
+    uint32_t storage[8];
+    spsc_ring_u32_t rb;
+    TASSERT(spsc_ring_u32_init(&rb, storage, 8u));
+
+    const uint32_t start = 0xFFFFFFFCu;
+    atomic_store(&rb.head, start);
+    atomic_store(&rb.tail, start);
+    rb.head_cache = start;
+    rb.tail_cache = start;
+
+    for (uint32_t i = 0u; i < 8u; ++i) {
+        TASSERT(spsc_ring_u32_push(&rb, i));
+    }
+    TASSERT(!spsc_ring_u32_push(&rb, 99u));
+    TASSERT_EQ_U32(spsc_ring_u32_count(&rb), 8u);
+
+    uint32_t v = 0u;
+    for (uint32_t i = 0u; i < 8u; ++i) {
+        TASSERT(spsc_ring_u32_pop(&rb, &v));
+        TASSERT_EQ_U32(v, i);
+    }
+    TASSERT(!spsc_ring_u32_pop(&rb, &v));
+}
+
+/* ---------------- two-thread stress ---------------- */
+
+#define STRESS_ITEMS (1u << 22)
+
+static void* producer_main(void* p)
+{
+    spsc_ring_u32_t* rb = (spsc_ring_u32_t*)p;
+    for (uint32_t i = 0u; i < STRESS_ITEMS; ++i) {
+        /* Scramble values so a stale slot read cannot look correct by accident. */
+        const uint32_t v = i * 2654435761u;
+        while (!spsc_ring_u32_push(rb, v)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void test_stress_threads(uint32_t capacity)
+{
+    static uint32_t storage[1024];
+    spsc_ring_u32_t rb;
+    TASSERT(capacity <= 1024u);
+    TASSERT(spsc_ring_u32_init(&rb, storage, capacity));
+
+    pthread_t th;
+    TASSERT(pthread_create(&th, NULL, producer_main, &rb) == 0);
+
+    uint32_t expect = 0u;
+    uint32_t errors = 0u;
+    while (expect < STRESS_ITEMS) {
+        uint32_t v = 0u;
+        if (!spsc_ring_u32_pop(&rb, &v)) {
+            sched_yield();
+            continue;
+        }
+        if (v != expect * 2654435761u) {
+            errors++;
+        }
+        expect++;
+    }
+
+    pthread_join(th, NULL);
+    TASSERT_EQ_U32(errors, 0u);
+    TASSERT_EQ_U32(spsc_ring_u32_count(&rb), 0u);
+}
+
+int main(void)
+{
+    test_init();
+    test_full_empty_wrap();
+    test_counter_wrap();
+    test_stress_threads(2u);
+    test_stress_threads(1024u);
+
+    if (g_failures == 0) {
+        printf("[PASS] test_spsc_ring\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_spsc_ring: %d failures\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,402 @@
+#define _POSIX_C_SOURCE 200809L /* pthreads, sched_yield() */
+
+/*
+ * tests/test_stream_tx.c
+ *
+ * hal_stream_tx (lock-free framed TX buffers) against a fake byte port:
+ * framing of gathered payloads, refusal and seq gaps when both buffers are
+ * busy, disconnects, and several producer threads writing at once while one
+ * sender thread drains (the main loop on the device).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "hal_stdio.h"
+#include "hal_stream_tx.h"
+
+/* ---------------- tiny test helpers ---------------- */
+
+static int g_failures = 0;
+
+#define TASSERT(cond) do { \
+    if (!(cond)) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define TASSERT_EQ_U32(a,b) do { \
+    uint32_t _a = (uint32_t)(a); \
+    uint32_t _b = (uint32_t)(b); \
+    if (_a != _b) { \
+        ++g_failures; \
+        fprintf(stderr, "[FAIL] %s:%d: %s (%u) != %s (%u)\n", __FILE__, __LINE__, #a, _a, #b, _b); \
+    } \
+} while (0)
+
+/* ---------------- fake port ---------------- */
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t cap;
+    uint32_t len;
+    uint32_t limit;        /* bytes it will still accept (UINT32_MAX = no limit) */
+    uint32_t max_chunk;    /* most bytes per write call (0 = any) */
+    uint32_t rng;
+    uint32_t flushes;
+    atomic_bool connected;
+} fake_port_t;
+
+static bool fp_connected(void *ctx)
+{
+    return atomic_load_explicit(&((fake_port_t *)ctx)->connected, memory_order_relaxed);
+}
+
+/* Only hal_stream_tx_kick() calls this (one sender), so no locking here either. */
+static uint32_t fp_write(void *ctx, const uint8_t *buf, uint32_t len)
+{
+    fake_port_t *p = (fake_port_t *)ctx;
+    uint32_t n = len;
+    if (p->max_chunk) {
+        p->rng = p->rng * 1664525u + 1013904223u;
+        const uint32_t c = (p->rng >> 16) % (p->max_chunk + 1u);   /* 0 = port full this time */
+        if (n > c) n = c;
+    }
+    if (n > p->limit) n = p->limit;
+    if (n > p->cap - p->len) n = p->cap - p->len;
+    memcpy(&p->buf[p->len], buf, n);
+    p->len += n;
+    if (p->limit != UINT32_MAX) p->limit -= n;
+    return n;
+}
+
+static void fp_flush(void *ctx) { ((fake_port_t *)ctx)->flushes++; }
+
+static void fp_init(fake_port_t *p, uint32_t cap)
+{
+    memset(p, 0, sizeof(*p));
+    p->buf = (uint8_t *)malloc(cap);
+    p->cap = p->buf ? cap : 0u;
+    p->limit = UINT32_MAX;
+    p->rng = 12345u;
+    atomic_init(&p->connected, true);
+}
+
+static void tx_attach(hal_stream_tx_t *tx, fake_port_t *p)
+{
+    const hal_stream_port_t port = { fp_connected, fp_write, fp_flush, p };
+    hal_stream_tx_init(tx, &port);
+}
+
+/* Walk the frames in p->buf; calls fn for each, returns frames seen (or -1 on bad framing). */
+typedef void (*frame_fn_t)(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user);
+
+static int parse_frames(const fake_port_t *p, frame_fn_t fn, void *user)
+{
+    int n = 0;
+    uint32_t i = 0u;
+    while (i < p->len) {
+        if (p->len - i < HAL_STREAM_HDR_LEN || memcmp(&p->buf[i], "AERS", 4) != 0
+            || p->buf[i + 4u] != HAL_STREAM_VER) {
+            return -1;
+        }
+        const uint16_t len = (uint16_t)(p->buf[i + 6u] | (p->buf[i + 7u] << 8));
+        const uint16_t seq = (uint16_t)(p->buf[i + 8u] | (p->buf[i + 9u] << 8));
+        if (p->len - i - HAL_STREAM_HDR_LEN < len) return -1;
+        if (fn) fn(p->buf[i + 5u], seq, &p->buf[i + HAL_STREAM_HDR_LEN], len, user);
+        i += HAL_STREAM_HDR_LEN + len;
+        n++;
+    }
+    return n;
+}
+
+/* ---------------- single writer ---------------- */
+
+typedef struct {
+    uint32_t n;
+    uint8_t  type[64];
+    uint16_t seq[64];
+    uint16_t len[64];
+    uint8_t  payload[64][64];
+} frames_t;
+
+static void collect(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    frames_t *f = (frames_t *)user;
+    if (f->n >= 64u) return;
+    f->type[f->n] = type;
+    f->seq[f->n] = seq;
+    f->len[f->n] = len;
+    memcpy(f->payload[f->n], payload, (len < 64u) ? len : 64u);
+    f->n++;
+}
+
+static hal_stream_tx_t g_tx;
+
+static void test_gather(void)
+{
+    fake_port_t p;
+    fp_init(&p, 4096u);
+    tx_attach(&g_tx, &p);
+
+    const uint8_t hdr[3] = { 1u, 2u, 3u };
+    const char *body = "hello";
+    const hal_iovec_t iov[4] = { { hdr, 3u }, { NULL, 7u }, { body, 5u }, { body, 0u } };
+    uint16_t seq = 0xFFFFu;
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, iov, 4u, &seq));
+    TASSERT_EQ_U32(seq, 0u);
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_LOG_TEXT, iov, 0u, &seq));
+    TASSERT_EQ_U32(seq, 1u);
+
+    /* Writers never touch the port; one kick sends both frames. */
+    TASSERT_EQ_U32(p.len, 0u);
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), 2u * HAL_STREAM_HDR_LEN + 8u);
+    hal_stream_tx_kick(&g_tx);
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), 0u);
+    TASSERT(p.flushes > 0u);
+
+    frames_t f = {0};
+    TASSERT_EQ_U32(parse_frames(&p, collect, &f), 2u);
+    TASSERT_EQ_U32(f.type[0], HAL_STREAM_MARKER);
+    TASSERT_EQ_U32(f.len[0], 8u);
+    TASSERT(memcmp(f.payload[0], "\x01\x02\x03hello", 8u) == 0);
+    TASSERT_EQ_U32(f.type[1], HAL_STREAM_LOG_TEXT);
+    TASSERT_EQ_U32(f.seq[1], 1u);
+    TASSERT_EQ_U32(f.len[1], 0u);
+
+    TASSERT_EQ_U32(g_tx.stats.frames_written, 2u);
+    TASSERT_EQ_U32(g_tx.stats.bytes_sent, 2u * HAL_STREAM_HDR_LEN + 8u);
+    free(p.buf);
+}
+
+static void test_full_and_gaps(void)
+{
+    fake_port_t p;
+    fp_init(&p, 65536u);
+    p.limit = 0u;               /* host not reading */
+    tx_attach(&g_tx, &p);
+
+    uint8_t payload[100];
+    memset(payload, 0xA5, sizeof(payload));
+    const hal_iovec_t iov = { payload, (uint16_t)sizeof(payload) };
+    const uint32_t per_buf = HAL_STREAM_TX_BUF_BYTES / (HAL_STREAM_HDR_LEN + sizeof(payload));
+
+    /* Buffer 0 fills and is sealed by the writer that finds it full, then buffer 1. */
+    uint32_t ok = 0u, refused = 0u;
+    for (uint32_t i = 0u; i < 4u * per_buf; ++i) {
+        if (hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_EVENT_BIN, &iov, 1u, NULL)) ok++;
+        else refused++;
+    }
+    TASSERT_EQ_U32(ok, 2u * per_buf);
+    TASSERT_EQ_U32(p.len, 0u);
+    TASSERT_EQ_U32(g_tx.stats.frames_failed, refused);
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), ok * (HAL_STREAM_HDR_LEN + sizeof(payload)));
+
+    /* Larger than a buffer: refused even with room. */
+    static uint8_t big[HAL_STREAM_TX_BUF_BYTES];
+    const hal_iovec_t big_iov = { big, (uint16_t)sizeof(big) };
+    TASSERT(!hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_EVENT_BIN, &big_iov, 1u, NULL));
+    refused++;
+
+    /* Host drains: everything queued goes out, one kick per buffer at most. */
+    p.limit = UINT32_MAX;
+    hal_stream_tx_kick(&g_tx);
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), 0u);
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, &iov, 1u, NULL));
+    hal_stream_tx_kick(&g_tx);
+
+    /* Seqs on the wire: increasing, the refused ones missing. */
+    frames_t f = {0};
+    TASSERT_EQ_U32(parse_frames(&p, collect, &f), ok + 1u);
+    uint32_t gaps = 0u;
+    for (uint32_t i = 1u; i < f.n; ++i) {
+        const uint16_t d = (uint16_t)(f.seq[i] - f.seq[i - 1u]);
+        TASSERT(d >= 1u);
+        gaps += d - 1u;
+    }
+    TASSERT_EQ_U32(gaps, refused);
+    TASSERT_EQ_U32(f.type[f.n - 1u], HAL_STREAM_MARKER);
+    free(p.buf);
+}
+
+static void test_disconnect(void)
+{
+    fake_port_t p;
+    fp_init(&p, 4096u);
+    p.limit = 0u;
+    tx_attach(&g_tx, &p);
+
+    const hal_iovec_t iov = { "abc", 3u };
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, &iov, 1u, NULL));
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, &iov, 1u, NULL));
+
+    /* Host goes away: new writes are refused without a seq, queued bytes dropped. */
+    atomic_store(&p.connected, false);
+    uint16_t seq = 0u;
+    TASSERT(!hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, &iov, 1u, &seq));
+    TASSERT_EQ_U32(g_tx.stats.frames_not_connected, 1u);
+    hal_stream_tx_kick(&g_tx);
+    hal_stream_tx_kick(&g_tx);
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), 0u);
+    TASSERT_EQ_U32(g_tx.stats.bytes_dropped, 2u * (HAL_STREAM_HDR_LEN + 3u));
+    TASSERT_EQ_U32(p.len, 0u);
+
+    atomic_store(&p.connected, true);
+    p.limit = UINT32_MAX;
+    TASSERT(hal_stream_tx_writev(&g_tx, (uint8_t)HAL_STREAM_MARKER, &iov, 1u, &seq));
+    TASSERT_EQ_U32(seq, 2u);
+    hal_stream_tx_kick(&g_tx);
+    TASSERT_EQ_U32(p.len, HAL_STREAM_HDR_LEN + 3u);
+    free(p.buf);
+}
+
+/* ---------------- concurrent writers ---------------- */
+
+#define STRESS_THREADS 4u
+#define STRESS_FRAMES  20000u
+
+typedef struct {
+    uint32_t id;
+    atomic_uint *go;
+    atomic_uint *writers_left;
+} writer_arg_t;
+
+static void *writer_thread(void *a_)
+{
+    const writer_arg_t *a = (const writer_arg_t *)a_;
+    while (atomic_load(a->go) == 0u) sched_yield();
+
+    uint8_t head[5];
+    uint8_t body[48];
+    for (uint32_t i = 0u; i < STRESS_FRAMES; ++i) {
+        head[0] = (uint8_t)a->id;
+        memcpy(&head[1], &i, 4u);
+        const uint16_t n = (uint16_t)(i % sizeof(body));
+        for (uint16_t k = 0u; k < n; ++k) body[k] = (uint8_t)(i + k * 7u + a->id);
+        const hal_iovec_t iov[2] = { { head, 5u }, { body, n } };
+        (void)hal_stream_tx_writev(&g_tx, (uint8_t)(16u + a->id), iov, 2u, NULL);
+        if ((i & 63u) == 0u) sched_yield();
+    }
+    atomic_fetch_sub(a->writers_left, 1u);
+    return NULL;
+}
+
+typedef struct {
+    atomic_uint *go;
+    atomic_uint *writers_left;
+} sender_arg_t;
+
+/* The single sender, polling like the main loop until every writer is done. */
+static void *sender_thread(void *a_)
+{
+    const sender_arg_t *a = (const sender_arg_t *)a_;
+    while (atomic_load(a->go) == 0u) sched_yield();
+    while (atomic_load(a->writers_left) != 0u) {
+        hal_stream_tx_kick(&g_tx);
+        sched_yield();
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint32_t next[STRESS_THREADS];  /* lowest counter still allowed per thread */
+    uint32_t frames;
+    uint32_t bad;
+    uint32_t gaps;
+    uint16_t last_seq;
+} stress_check_t;
+
+static void check_frame(uint8_t type, uint16_t seq, const uint8_t *payload, uint16_t len, void *user)
+{
+    stress_check_t *c = (stress_check_t *)user;
+    if (c->frames != 0u) {
+        const uint16_t d = (uint16_t)(seq - c->last_seq);
+        if (d == 0u) c->bad++;
+        else c->gaps += d - 1u;
+    }
+    c->last_seq = seq;
+    c->frames++;
+
+    const uint32_t id = (uint32_t)type - 16u;
+    if (id >= STRESS_THREADS || len < 5u || payload[0] != id) {
+        c->bad++;
+        return;
+    }
+    uint32_t i;
+    memcpy(&i, &payload[1], 4u);
+    if (i < c->next[id] || len != 5u + i % 48u) {
+        c->bad++;
+        return;
+    }
+    c->next[id] = i + 1u;
+    for (uint16_t k = 0u; k < len - 5u; ++k) {
+        if (payload[5u + k] != (uint8_t)(i + k * 7u + id)) {
+            c->bad++;
+            return;
+        }
+    }
+}
+
+static void test_concurrent_writers(void)
+{
+    fake_port_t p;
+    fp_init(&p, STRESS_THREADS * STRESS_FRAMES * (HAL_STREAM_HDR_LEN + 5u + 48u));
+    p.max_chunk = 8u;           /* a slow host: buffers fill, some frames are refused */
+    tx_attach(&g_tx, &p);
+
+    atomic_uint go, writers_left;
+    atomic_init(&go, 0u);
+    atomic_init(&writers_left, STRESS_THREADS);
+    pthread_t th[STRESS_THREADS];
+    writer_arg_t args[STRESS_THREADS];
+    for (uint32_t t = 0u; t < STRESS_THREADS; ++t) {
+        args[t] = (writer_arg_t){ t, &go, &writers_left };
+        TASSERT(pthread_create(&th[t], NULL, writer_thread, &args[t]) == 0);
+    }
+    pthread_t sender;
+    sender_arg_t sender_arg = { &go, &writers_left };
+    TASSERT(pthread_create(&sender, NULL, sender_thread, &sender_arg) == 0);
+    atomic_store(&go, 1u);
+    for (uint32_t t = 0u; t < STRESS_THREADS; ++t) pthread_join(th[t], NULL);
+    pthread_join(sender, NULL);
+
+    for (uint32_t k = 0u; k < 100000u && hal_stream_tx_pending(&g_tx) != 0u; ++k) {
+        hal_stream_tx_kick(&g_tx);
+    }
+    TASSERT_EQ_U32(hal_stream_tx_pending(&g_tx), 0u);
+
+    stress_check_t c = {0};
+    const int n = parse_frames(&p, check_frame, &c);
+    const uint32_t written = atomic_load(&g_tx.stats.frames_written);
+    const uint32_t failed = atomic_load(&g_tx.stats.frames_failed);
+    TASSERT(n >= 0);
+    TASSERT_EQ_U32(c.bad, 0u);
+    TASSERT_EQ_U32((uint32_t)n, written);
+    TASSERT_EQ_U32(written + failed, STRESS_THREADS * STRESS_FRAMES);
+    TASSERT(c.gaps <= failed);   /* refusals after the last received frame leave no gap */
+    TASSERT_EQ_U32(atomic_load(&g_tx.stats.bytes_sent), p.len);
+    free(p.buf);
+}
+
+int main(void)
+{
+    test_gather();
+    test_full_and_gaps();
+    test_disconnect();
+    test_concurrent_writers();
+
+    if (g_failures == 0) {
+        printf("[PASS] test_stream_tx\n");
+        return 0;
+    }
+
+    fprintf(stderr, "[FAIL] test_stream_tx: %d failures\n", g_failures);
+    return 1;
+}